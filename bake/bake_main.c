@@ -0,0 +1,181 @@
+/**
+ ***************************************************************************************************
+ *
+ * \file  bake_main.c
+ *
+ * \brief This file contains main function of table generator. Lens specification is parsed,
+ *        map and remap plan are generated for fixed resolution and format, and everything is
+ *        written as const data into C source and header, that are linked into target.
+ *
+ * \arg author:  Dejan Milojica
+ * \arg version: 1.2
+ * \arg date:    13.01.2021
+ *
+ ***************************************************************************************************
+ */
+
+/* ============================================================================================== */
+/*                               Internal Include Files                                           */
+/* ============================================================================================== */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "../core/lib/ldc_log.h"
+#include "../core/baked_tables/baked_tables.h"
+
+/* ============================================================================================== */
+/*                              Global Variables                                                  */
+/* ============================================================================================== */
+
+#define BAKE_HELP_MESSAGE (\
+    "Table generator supports the following arguments:\n"\
+    "--help                   Help\n"\
+    "-p [CSV FILE]            Lens camera specification file\n"\
+    "-o [PATH]                Output files, PATH.c and PATH.h\n"\
+    "-n [NAME]                Name of tables, default BakedTables_Linked\n"\
+    "-w [WIDTH]               Width of frames\n"\
+    "-h [HEIGHT]              Height of frames\n"\
+    "-f [1-9]                 YUV type of remap plan, default 1 (NV12)\n"\
+    "-i [0-1]                 Interpolation of remap plan, 0 nearest (default), 1 bilinear\n"\
+    "-t [0-2]                 Tables, 0 lens only, 1 lens and map, 2 lens, map and plan "\
+    "(default)\n")
+
+#define BAKE_INVALID_ARGUMENTS_MESSAGE (\
+    "Invalid arguments. Run the generator with --help for help on how to use it.\n")
+
+#define BAKE_MAX_PATH (4096)
+
+/* ============================================================================================== */
+/*                              Internal Helper Functions                                         */
+/* ============================================================================================== */
+
+static void BakeMain_PrintLogMessage(LDC_LogLevel level, LDC_Status status, const char* message,
+                                     void* user_data)
+{
+    (void)level;
+    (void)user_data;
+
+    printf("%s (%s)\n", message, LdcLog_GetStatusName(status));
+}
+
+/* ============================================================================================== */
+/*                                        Main Function                                           */
+/* ============================================================================================== */
+
+int32_t main(int32_t argc, char** argv)
+{
+    const char* lensFileName = NULL;
+    const char* outputPath = NULL;
+    const char* name = BAKED_TABLES_DEFAULT_NAME;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t yuvType = YUV420_NV12;
+    uint32_t interpolation = LDC_INTERPOLATION_NEAREST;
+    uint32_t tables = 2;
+    int32_t argIteratorCounter;
+    char sourceName[BAKE_MAX_PATH];
+    char headerName[BAKE_MAX_PATH];
+    const LensProfile* lens = NULL;
+    LDC_Map map;
+    Remap_Plan plan;
+    LDC_Status status;
+
+    LdcLog_SetCallback(BakeMain_PrintLogMessage, NULL);
+
+    for(argIteratorCounter = 1;argIteratorCounter < argc;argIteratorCounter++)
+    {
+        uint32_t* value = NULL;
+
+        if(0 == strcmp(argv[argIteratorCounter], "--help"))
+        {
+            printf(BAKE_HELP_MESSAGE);
+            return EXIT_SUCCESS;
+        }
+        else if(argIteratorCounter + 1 >= argc)
+        {
+            printf(BAKE_INVALID_ARGUMENTS_MESSAGE);
+            return EXIT_FAILURE;
+        }
+        else if(0 == strcmp(argv[argIteratorCounter], "-p"))
+        {
+            lensFileName = argv[++argIteratorCounter];
+            continue;
+        }
+        else if(0 == strcmp(argv[argIteratorCounter], "-o"))
+        {
+            outputPath = argv[++argIteratorCounter];
+            continue;
+        }
+        else if(0 == strcmp(argv[argIteratorCounter], "-n"))
+        {
+            name = argv[++argIteratorCounter];
+            continue;
+        }
+
+        value = (0 == strcmp(argv[argIteratorCounter], "-w")) ? &width :
+                (0 == strcmp(argv[argIteratorCounter], "-h")) ? &height :
+                (0 == strcmp(argv[argIteratorCounter], "-f")) ? &yuvType :
+                (0 == strcmp(argv[argIteratorCounter], "-i")) ? &interpolation :
+                (0 == strcmp(argv[argIteratorCounter], "-t")) ? &tables : NULL;
+
+        if(NULL == value || 1 != sscanf(argv[++argIteratorCounter], "%u", value))
+        {
+            printf(BAKE_INVALID_ARGUMENTS_MESSAGE);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if(NULL == lensFileName || NULL == outputPath || tables > 2U ||
+       (tables > 0U && (0U == width || 0U == height)) ||
+       snprintf(sourceName, sizeof(sourceName), "%s.c", outputPath) >= BAKE_MAX_PATH ||
+       snprintf(headerName, sizeof(headerName), "%s.h", outputPath) >= BAKE_MAX_PATH)
+    {
+        printf(BAKE_INVALID_ARGUMENTS_MESSAGE);
+        return EXIT_FAILURE;
+    }
+
+    if(LensProfile_LoadFile(0U, lensFileName, &lens))
+    {
+        return EXIT_FAILURE;
+    }
+
+    if(tables > 0U && FrameCorrection_GenerateMap(&map, width, height, NULL, NULL, 0, lens, NULL))
+    {
+        printf("Map generation failed.\n");
+        LensProfile_Release(lens);
+        return EXIT_FAILURE;
+    }
+
+    if(tables > 1U && Remap_CreatePlan(&plan, &map, (YUV_Type)yuvType,
+                                       (LDC_Interpolation)interpolation))
+    {
+        printf(BAKE_INVALID_ARGUMENTS_MESSAGE);
+        FrameCorrection_FreeMap(&map);
+        LensProfile_Release(lens);
+        return EXIT_FAILURE;
+    }
+
+    status = BakedTables_Write(name, sourceName, headerName, lensFileName, lens,
+                               (tables > 0U) ? &map : NULL, (tables > 1U) ? &plan : NULL);
+
+    if(LDC_STATUS_OK == status)
+    {
+        printf("Tables %s written to %s and %s\n", name, sourceName, headerName);
+    }
+
+    if(tables > 1U)
+    {
+        Remap_FreePlan(&plan);
+    }
+
+    if(tables > 0U)
+    {
+        FrameCorrection_FreeMap(&map);
+    }
+
+    LensProfile_Release(lens);
+
+    return (LDC_STATUS_OK == status) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,396 @@
+/**
+ ***************************************************************************************************
+ *
+ * \file  baked_tables.c
+ *
+ * \brief This file contains API for baking preprocessed lens profile, map and remap plan into C
+ *        source, as const data. Floating point values are written as hexadecimal literals, so
+ *        baked tables are bit exact.
+ *
+ * \arg author:  Dejan Milojica
+ * \arg version: 1.2
+ * \arg date:    13.01.2021
+ *
+ ***************************************************************************************************
+ */
+
+/* ============================================================================================== */
+/*                                       Include Files                                            */
+/* ============================================================================================== */
+
+#include "baked_tables.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include "../lib/ldc_log.h"
+#include "../lib/ldc_internal.h"
+
+/* ============================================================================================== */
+/*                                       Global variables                                         */
+/* ============================================================================================== */
+
+#define BAKED_TABLES_VALUES_PER_LINE (8U)
+
+/* ============================================================================================== */
+/*                              Internal Helper Functions                                         */
+/* ============================================================================================== */
+
+static int32_t BakedTables_IsIdentifier(const char* const name)
+{
+    size_t length = strlen(name);
+    size_t i;
+
+    if(0U == length || length >= BAKED_TABLES_MAX_NAME || isdigit((unsigned char)name[0]))
+    {
+        return 0;
+    }
+
+    for(i = 0;i < length;i++)
+    {
+        if(!isalnum((unsigned char)name[i]) && '_' != name[i])
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/* Separator before value i of array, with line break after every few values. */
+static void BakedTables_WriteSeparator(FILE* fp, size_t i)
+{
+    if(0U == i)
+    {
+        fprintf(fp, "    ");
+    }
+    else if(0U == i % BAKED_TABLES_VALUES_PER_LINE)
+    {
+        fprintf(fp, ",\n    ");
+    }
+    else
+    {
+        fprintf(fp, ", ");
+    }
+}
+
+static void BakedTables_WriteFloat(FILE* fp, float value)
+{
+    /* Positions without source are never read. */
+    fprintf(fp, "%af", isfinite(value) ? (double)value : -1.0);
+}
+
+static void BakedTables_WriteDoubles(FILE* fp, const char* const name, const char* const suffix,
+                                     const double* const values, size_t count)
+{
+    size_t i;
+
+    fprintf(fp, "static const double %s_%s[%zu] =\n{\n", name, suffix, count);
+    for(i = 0;i < count;i++)
+    {
+        BakedTables_WriteSeparator(fp, i);
+        fprintf(fp, "%a", values[i]);
+    }
+    fprintf(fp, "\n};\n\n");
+}
+
+static void BakedTables_WriteFloats(FILE* fp, const char* const name, const char* const suffix,
+                                    const float* const values, size_t count)
+{
+    size_t i;
+
+    fprintf(fp, "static const float %s_%s[%zu] =\n{\n", name, suffix, count);
+    for(i = 0;i < count;i++)
+    {
+        BakedTables_WriteSeparator(fp, i);
+        BakedTables_WriteFloat(fp, values[i]);
+    }
+    fprintf(fp, "\n};\n\n");
+}
+
+/* Entries of plan inside of map spans, other entries are not computed. */
+static void BakedTables_WritePlanWords(FILE* fp, const char* const name, const char* const suffix,
+                                       const uint32_t* const values, const LDC_Map* const map)
+{
+    size_t count = (size_t)map->width * map->height;
+    size_t i = 0;
+    uint32_t y;
+    uint32_t x;
+    uint32_t s;
+
+    fprintf(fp, "static const uint32_t %s_%s[%zu] =\n{\n", name, suffix, count);
+    for(y = 0;y < map->height;y++)
+    {
+        s = map->row_spans[y];
+
+        for(x = 0;x < map->width;x++, i++)
+        {
+            while(s < map->row_spans[y + 1] && map->spans[s].end <= x)
+            {
+                s++;
+            }
+
+            BakedTables_WriteSeparator(fp, i);
+            fprintf(fp, "%uU", (s < map->row_spans[y + 1] && map->spans[s].start <= x) ?
+                               values[i] : 0U);
+        }
+    }
+    fprintf(fp, "\n};\n\n");
+}
+
+static void BakedTables_WriteLens(FILE* fp, const char* const name,
+                                  const LensProfile* const lens)
+{
+    const FastMap_RadialLut* lut = &lens->lut;
+    uint32_t n = lens->num_of_useful_elements;
+    uint32_t table = (NULL != lens->angle && n > 0U);
+    uint32_t segments = (table && NULL != lens->slope);
+    uint32_t i;
+
+    if(table)
+    {
+        BakedTables_WriteDoubles(fp, name, "angle", lens->angle, n);
+        BakedTables_WriteDoubles(fp, name, "height", lens->height, n);
+    }
+
+    if(segments)
+    {
+        BakedTables_WriteDoubles(fp, name, "slope", lens->slope, n);
+        BakedTables_WriteDoubles(fp, name, "intercept", lens->intercept, n);
+    }
+
+    fprintf(fp, "static const LensProfile %s_lens =\n{\n", name);
+    fprintf(fp, "    .lens_id = %uU,\n", lens->lens_id);
+    fprintf(fp, "    .hash = 0x%016llXULL,\n", (unsigned long long)lens->hash);
+    fprintf(fp, table ? "    .angle = (double*)%s_angle,\n" : "    .angle = NULL,\n", name);
+    fprintf(fp, table ? "    .height = (double*)%s_height,\n" : "    .height = NULL,\n", name);
+    fprintf(fp, segments ? "    .slope = (double*)%s_slope,\n" : "    .slope = NULL,\n", name);
+    fprintf(fp, segments ? "    .intercept = (double*)%s_intercept,\n" :
+                           "    .intercept = NULL,\n", name);
+    fprintf(fp, "    .num_of_useful_elements = %uU,\n", n);
+    fprintf(fp, "    .focal_length_in_mm = %a,\n", lens->focal_length_in_mm);
+    fprintf(fp, "    .sensor_pixel_pitch_in_mm = %a,\n", lens->sensor_pixel_pitch_in_mm);
+    fprintf(fp, "    .scaling_factor = %a,\n", lens->scaling_factor);
+    fprintf(fp, "    .model =\n    {\n        .type = (LensModel_Type)%d,\n",
+            (int32_t)lens->model.type);
+    fprintf(fp, "        .focal_length = %a,\n        .k = {", lens->model.focal_length);
+    for(i = 0;i < LENS_MODEL_NUM_OF_COEFFICIENTS;i++)
+    {
+        fprintf(fp, (0U == i) ? "%a" : ", %a", lens->model.k[i]);
+    }
+    fprintf(fp, "}\n    },\n    .lut =\n    {\n        .r_d =\n        {\n");
+    for(i = 0;i < FAST_MAP_NUM_OF_LUT_SAMPLES;i++)
+    {
+        fprintf(fp, (0U == i) ? "        " :
+                    (0U == i % BAKED_TABLES_VALUES_PER_LINE) ? ",\n        " : ", ");
+        BakedTables_WriteFloat(fp, lut->r_d[i]);
+    }
+    fprintf(fp, "\n        },\n        .theta_step_inv = %af,\n", (double)lut->theta_step_inv);
+    fprintf(fp, "        .z = %af,\n        .hc = %af,\n        .vc = %af,\n", (double)lut->z,
+            (double)lut->hc, (double)lut->vc);
+    fprintf(fp, "        .model = (LensModel_Type)%d,\n        .f = %af,\n        .k = {",
+            (int32_t)lut->model, (double)lut->f);
+    for(i = 0;i < LENS_MODEL_NUM_OF_COEFFICIENTS;i++)
+    {
+        fprintf(fp, (0U == i) ? "%af" : ", %af", (double)lut->k[i]);
+    }
+    fprintf(fp, "}\n    },\n    .ref_count = LENS_PROFILE_STATIC\n};\n\n");
+}
+
+static void BakedTables_WriteMap(FILE* fp, const char* const name, const LDC_Map* const map)
+{
+    size_t size = (size_t)map->width * map->height;
+    uint32_t i;
+
+    BakedTables_WriteFloats(fp, name, "h_d", map->h_d, size);
+    BakedTables_WriteFloats(fp, name, "v_d", map->v_d, size);
+
+    fprintf(fp, "static const LDC_Roi %s_rois[%u] =\n{\n", name, map->num_of_rois);
+    for(i = 0;i < map->num_of_rois;i++)
+    {
+        fprintf(fp, "    {%uU, %uU, %uU, %uU}%s\n", map->rois[i].x, map->rois[i].y,
+                map->rois[i].width, map->rois[i].height,
+                (i + 1U < map->num_of_rois) ? "," : "");
+    }
+    fprintf(fp, "};\n\n");
+
+    fprintf(fp, "static const uint32_t %s_row_spans[%u] =\n{\n", name, map->height + 1U);
+    for(i = 0;i <= map->height;i++)
+    {
+        BakedTables_WriteSeparator(fp, i);
+        fprintf(fp, "%uU", map->row_spans[i]);
+    }
+    fprintf(fp, "\n};\n\n");
+
+    fprintf(fp, "static const LDC_Span %s_spans[%u] =\n{\n", name, LDC_MAX(map->num_of_spans, 1U));
+    for(i = 0;i < map->num_of_spans;i++)
+    {
+        BakedTables_WriteSeparator(fp, i);
+        fprintf(fp, "{%uU, %uU}", map->spans[i].start, map->spans[i].end);
+    }
+    fprintf(fp, (0U == map->num_of_spans) ? "    {0U, 0U}\n};\n\n" : "\n};\n\n");
+
+    fprintf(fp, "static const LDC_Map %s_map =\n{\n", name);
+    fprintf(fp, "    .width = %uU,\n    .height = %uU,\n", map->width, map->height);
+    fprintf(fp, "    .src_width = %uU,\n    .src_height = %uU,\n", map->src_width,
+            map->src_height);
+    fprintf(fp, "    .scale = %a,\n    .centre_x = %a,\n    .centre_y = %a,\n", map->scale,
+            map->centre_x, map->centre_y);
+    fprintf(fp, "    .h_d = (float*)%s_h_d,\n    .v_d = (float*)%s_v_d,\n", name, name);
+    fprintf(fp, "    .rois = (LDC_Roi*)%s_rois,\n    .num_of_rois = %uU,\n", name,
+            map->num_of_rois);
+    fprintf(fp, "    .row_spans = (uint32_t*)%s_row_spans,\n", name);
+    fprintf(fp, "    .spans = (LDC_Span*)%s_spans,\n    .num_of_spans = %uU\n};\n\n", name,
+            map->num_of_spans);
+}
+
+static void BakedTables_WritePlan(FILE* fp, const char* const name, const Remap_Plan* const plan)
+{
+    uint32_t bilinear = (LDC_INTERPOLATION_BILINEAR == plan->interpolation);
+
+    BakedTables_WritePlanWords(fp, name, "luma_offset", plan->luma_offset, plan->map);
+    BakedTables_WritePlanWords(fp, name, "chroma_offset", plan->chroma_offset, plan->map);
+
+    if(bilinear)
+    {
+        BakedTables_WritePlanWords(fp, name, "luma_weight", plan->luma_weight, plan->map);
+        BakedTables_WritePlanWords(fp, name, "chroma_weight", plan->chroma_weight, plan->map);
+    }
+
+    fprintf(fp, "static const Remap_Plan %s_plan =\n{\n", name);
+    fprintf(fp, "    .map = &%s_map,\n    .yuv_type = (YUV_Type)%d,\n", name,
+            (int32_t)plan->yuv_type);
+    fprintf(fp, "    .interpolation = (LDC_Interpolation)%d,\n", (int32_t)plan->interpolation);
+    fprintf(fp, "    .luma_offset = (uint32_t*)%s_luma_offset,\n", name);
+    fprintf(fp, "    .chroma_offset = (uint32_t*)%s_chroma_offset,\n", name);
+    fprintf(fp, bilinear ? "    .luma_weight = (uint32_t*)%s_luma_weight,\n" :
+                           "    .luma_weight = NULL,\n", name);
+    fprintf(fp, bilinear ? "    .chroma_weight = (uint32_t*)%s_chroma_weight\n};\n\n" :
+                           "    .chroma_weight = NULL\n};\n\n", name);
+}
+
+static void BakedTables_WriteString(FILE* fp, const char* const text)
+{
+    const char* c;
+
+    fputc('"', fp);
+    for(c = text;'\0' != *c;c++)
+    {
+        if('"' == *c || '\\' == *c)
+        {
+            fputc('\\', fp);
+        }
+        fputc(isprint((unsigned char)*c) ? *c : '?', fp);
+    }
+    fputc('"', fp);
+}
+
+/* ============================================================================================== */
+/*                                                                                                */
+/*                                       API Functions                                            */
+/*                                                                                                */
+/* ============================================================================================== */
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     BakedTables_Write
+ *
+ * \brief  Write C source and header with tables, as const data. Source defines tables as
+ *         const BakedTables of given name, and header declares it. Positions of map outside of
+ *         spans, that are never read, are written as -1, and entries of plan outside of spans
+ *         as 0.
+ *
+ * \param  [In]  name             Name of tables, C identifier.
+ * \param  [In]  source_filename  Filename of written C source.
+ * \param  [In]  header_filename  Filename of written header, included by source.
+ * \param  [In]  lens_filename    Lens specification file, recorded in tables.
+ * \param  [In]  lens             Lens profile.
+ * \param  [In]  map              Map, or NULL for lens only.
+ * \param  [In]  plan             Remap plan of map, or NULL.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status BakedTables_Write(const char* const name, const char* const source_filename,
+                             const char* const header_filename, const char* const lens_filename,
+                             const LensProfile* const lens, const LDC_Map* const map,
+                             const Remap_Plan* const plan)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    const char* header_basename;
+    FILE* source = NULL;
+    FILE* header = NULL;
+
+    if(NULL == name || NULL == source_filename || NULL == header_filename ||
+       NULL == lens_filename || NULL == lens || !BakedTables_IsIdentifier(name) ||
+       (NULL != plan && (NULL == map || plan->map != map)))
+    {
+        status = LDC_STATUS_INVALID_ARGUMENT;
+        LdcLog_Write(LDC_LOG_ERROR, status, "Invalid arguments of baked tables");
+        return status;
+    }
+
+    source = fopen(source_filename, "w");
+    header = fopen(header_filename, "w");
+
+    if(NULL == source || NULL == header)
+    {
+        status = LDC_STATUS_FILE_ERROR;
+        LdcLog_Write(LDC_LOG_ERROR, status, "Error opening baked tables file");
+    }
+    else
+    {
+        header_basename = strrchr(header_filename, '/');
+        header_basename = (NULL == header_basename) ? header_filename : header_basename + 1;
+
+        fprintf(header, "/* Baked lens distortion correction tables, generated from %s. */\n\n",
+                lens_filename);
+        fprintf(header, "#ifndef %s_H\n#define %s_H\n\n", name, name);
+        fprintf(header, "#include \"baked_tables.h\"\n\n");
+        fprintf(header, "extern const BakedTables %s;\n\n#endif\n", name);
+
+        fprintf(source, "/* Baked lens distortion correction tables, generated from %s. */\n\n",
+                lens_filename);
+        fprintf(source, "#include \"%s\"\n\n", header_basename);
+
+        BakedTables_WriteLens(source, name, lens);
+
+        if(NULL != map)
+        {
+            BakedTables_WriteMap(source, name, map);
+        }
+
+        if(NULL != plan)
+        {
+            BakedTables_WritePlan(source, name, plan);
+        }
+
+        fprintf(source, "const BakedTables %s =\n{\n    .source = ", name);
+        BakedTables_WriteString(source, lens_filename);
+        fprintf(source, ",\n    .lens = &%s_lens,\n", name);
+        fprintf(source, (NULL != map) ? "    .map = &%s_map,\n" : "    .map = NULL,\n", name);
+        fprintf(source, (NULL != plan) ? "    .plan = &%s_plan\n};\n" : "    .plan = NULL\n};\n",
+                name);
+
+        if(ferror(source) || ferror(header))
+        {
+            status = LDC_STATUS_FILE_ERROR;
+            LdcLog_Write(LDC_LOG_ERROR, status, "Error writing baked tables file");
+        }
+    }
+
+    if(NULL != source && fclose(source))
+    {
+        status = LDC_STATUS_FILE_ERROR;
+    }
+
+    if(NULL != header && fclose(header))
+    {
+        status = LDC_STATUS_FILE_ERROR;
+    }
+
+    return status;
+}
@@ -0,0 +1,103 @@
+/**
+ ***************************************************************************************************
+ *
+ * \file  baked_tables.h
+ *
+ * \brief This file contains API for baking preprocessed lens profile, map and remap plan into C
+ *        source, as const data. Baked tables are linked into targets with fixed lens and frame
+ *        resolution, so correction starts without parsing of lens CSV and map generation, and
+ *        tables are kept in read only pages, shared by processes.
+ *
+ * \arg author:  Dejan Milojica
+ * \arg version: 1.2
+ * \arg date:    13.01.2021
+ *
+ ***************************************************************************************************
+ */
+
+#ifndef BAKED_TABLES_H
+#define BAKED_TABLES_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================================== */
+/*                                       Include Files                                            */
+/* ============================================================================================== */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "../lib/ldc_types.h"
+#include "../lens_registry/lens_registry.h"
+#include "../correction_distortion/correction_distortion.h"
+#include "../remap/remap.h"
+
+/* ============================================================================================== */
+/*                                     Macros & Typedefs                                          */
+/* ============================================================================================== */
+
+#define BAKED_TABLES_DEFAULT_NAME ("BakedTables_Linked")
+#define BAKED_TABLES_MAX_NAME (64U)             /* Max length of name of tables.               */
+
+/**
+ ***************************************************************************************************
+ *
+ * \typedef BakedTables
+ *
+ * \brief   Structure which represents baked tables. Lens profile is static (see
+ *          LENS_PROFILE_STATIC), and map and plan must not be released with
+ *          FrameCorrection_FreeMap and Remap_FreePlan.
+ *
+ ***************************************************************************************************
+ */
+typedef struct
+{
+    const char* source;                         /* Lens specification file of tables.     */
+    const LensProfile* lens;                    /* Static lens profile.                   */
+    const LDC_Map* map;                         /* Map of source resolution, or NULL.     */
+    const Remap_Plan* plan;                     /* Remap plan of map, or NULL.            */
+}BakedTables;
+
+#ifdef LDC_BAKED_TABLES
+/* Tables linked in with build option LDC_BAKED_TABLES, generated with default name. */
+extern const BakedTables BakedTables_Linked;
+#endif
+
+/* ============================================================================================== */
+/*                                     Function Declarations                                      */
+/* ============================================================================================== */
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     BakedTables_Write
+ *
+ * \brief  Write C source and header with tables, as const data. Source defines tables as
+ *         const BakedTables of given name, and header declares it. Positions of map outside of
+ *         spans, that are never read, are written as -1, and entries of plan outside of spans
+ *         as 0.
+ *
+ * \param  [In]  name             Name of tables, C identifier.
+ * \param  [In]  source_filename  Filename of written C source.
+ * \param  [In]  header_filename  Filename of written header, included by source.
+ * \param  [In]  lens_filename    Lens specification file, recorded in tables.
+ * \param  [In]  lens             Lens profile.
+ * \param  [In]  map              Map, or NULL for lens only.
+ * \param  [In]  plan             Remap plan of map, or NULL.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status BakedTables_Write(const char* const name, const char* const source_filename,
+                             const char* const header_filename, const char* const lens_filename,
+                             const LensProfile* const lens, const LDC_Map* const map,
+                             const Remap_Plan* const plan);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -17,6 +17,9 @@
 /* ============================================================================================== */
 
 #include "correction_distortion.h"
+#include "../remap/remap.h"
+#include "../lib/ldc_internal.h"
+#include "../lib/ldc_log.h"
 #include <string.h>
 #include <math.h>
 #include <stdlib.h>
@@ -27,6 +30,16 @@
 /*                                       Global variables                                         */
 /* ============================================================================================== */
 
+/* Arguments of map generation, shared by all bands of rows. */
+typedef struct
+{
+    LDC_Map* map;
+    const LensProfile* lens;
+    const FastMap_RadialLut* lut;
+    uint32_t reference;
+    LDC_Status status;
+}FrameCorrection_MapTask;
+
 
 /* ============================================================================================== */
 /*                              Internal Helper Functions                                         */
@@ -58,8 +71,8 @@ LDC_Status WriteOperation_WritePixelsPositions2File(const char* const filename,
     FILE* fp = fopen(filename, "w");
     if (NULL == fp)
     {
-        printf(PIXELS_POSITION_FILE_OPENING_ERROR_MESSAGE);
-        status = LDC_STATUS_ERROR;
+        status = LDC_STATUS_FILE_ERROR;
+        LdcLog_Write(LDC_LOG_ERROR, status, PIXELS_POSITION_FILE_OPENING_ERROR_MESSAGE);
     }
     else
     {
@@ -82,325 +95,877 @@ LDC_Status WriteOperation_WritePixelsPositions2File(const char* const filename,
 }
 
 
-static void cart2pol(uint32_t width, uint32_t height, double** xt, double** yt,
-                     double** phi, double **r)
+static void cart2pol(uint32_t count, const double* const xt, const double* const yt,
+                     double* phi, double* r)
 {
-    uint32_t i;
     uint32_t j;
 
-    for(i = 0;i < height;i++)
+    for(j = 0;j < count;j++)
     {
-        for(j = 0;j < width;j++)
-        {
-            /* Pythagorean theorem. */
-            r[i][j] = sqrt(pow(xt[i][j], 2) + pow(yt[i][j], 2));
-
-            /*Find Four-Quadrant Inverse Tangent of a Point. */
-            phi[i][j] = atan2(yt[i][j], xt[i][j]);
-        }
+        /* Pythagorean theorem. */
+        r[j] = sqrt(pow(xt[j], 2) + pow(yt[j], 2));
 
+        /*Find Four-Quadrant Inverse Tangent of a Point. */
+        phi[j] = atan2(yt[j], xt[j]);
     }
 
 }
 
 
-static void pol2cart(uint32_t width, uint32_t height, double** h_d, double** v_d,
-                     double** phi, double** r_d)
+static void pol2cart(uint32_t count, double* h_d, double* v_d,
+                     const double* const phi, const double* const r_d)
 {
-    uint32_t i;
     uint32_t j;
 
-    for(i = 0;i < height;i++)
+    for(j = 0;j < count;j++)
     {
-        for(j = 0;j < width;j++)
+       /* If we have one side length, and one angle, we can get other two triangle len sides.*/
+        h_d[j] = r_d[j] * cos(phi[j]);
+        v_d[j] = r_d[j] * sin(phi[j]);
+    }
+
+}
+
+static LDC_Status FrameCorrection_XYZ2Distorted(const LensProfile* const lens, LDC_Map* map,
+                                                const LDC_Roi* const roi)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+
+    uint32_t i;
+    uint32_t j;
+    double z;
+    double* xt;
+    double* yt;
+    double* phi;
+    double* r;
+    double* theta;
+    double* r_d;
+    double hc = (map->src_width - 1)/2;     /* Optical centre, in source frame. */
+    double vc = (map->src_height - 1)/2;
+    double out_hc = (map->width - 1)/2;     /* Centre of output frame.          */
+    double out_vc = (map->frame_height - 1)/2;
+
+    z = (lens->focal_length_in_mm / lens->sensor_pixel_pitch_in_mm) / lens->scaling_factor;
+
+    /* One row of region, for every step of mapping. */
+    xt        = (double*)malloc(roi->width * sizeof(double));
+    yt        = (double*)malloc(roi->width * sizeof(double));
+    phi       = (double*)malloc(roi->width * sizeof(double));
+    r         = (double*)malloc(roi->width * sizeof(double));
+    theta     = (double*)malloc(roi->width * sizeof(double));
+    r_d       = (double*)malloc(roi->width * sizeof(double));
+
+    if(NULL == xt || NULL == yt || NULL == phi || NULL == r || NULL == theta || NULL == r_d)
+    {
+        status = LDC_STATUS_OUT_OF_MEMORY;
+    }
+    else
+    {
+        for(i = roi->y;i < roi->y + roi->height;i++)
         {
-           /* If we have one side length, and one angle, we can get other two triangle len sides.*/
-            h_d[i][j] = r_d[i][j] * cos(phi[i][j]);
-            v_d[i][j] = r_d[i][j] * sin(phi[i][j]);
+            float* h_d_row = map->h_d + (size_t)i * map->width + roi->x;
+            float* v_d_row = map->v_d + (size_t)i * map->width + roi->x;
+
+            /* Output pixel to corrected source plane, and substract position of centar. */
+            for(j = 0;j < roi->width;j++)
+            {
+                xt[j] = ((double)(roi->x + j) - out_hc) * map->scale + (map->centre_x - hc);
+                yt[j] = ((double)(map->first_row + i) - out_vc) * map->scale +
+                        (map->centre_y - vc);
+            }
+
+            /* Cartesian to Polar. */
+            cart2pol(roi->width, xt, yt, phi, r);
+
+            for(j = 0;j < roi->width;j++)
+            {
+                /* Four-Quadrant Inverse Tangent of a Point. */
+                theta[j] = atan2(r[j], z);
+            }
+
+            /* Linear Interpolation of row. */
+            LensProfile_InterpolateHeight(lens, theta, r_d, roi->width);
+
+            /* Polar to Cartesian, cartesian positions are not needed any more. */
+            pol2cart(roi->width, xt, yt, phi, r_d);
+
+            /* On every pixel position, add vertical and horizontal position of centar. */
+            for(j = 0;j < roi->width;j++)
+            {
+                h_d_row[j] = (float)(xt[j] + hc);
+                v_d_row[j] = (float)(yt[j] + vc);
+            }
         }
     }
 
+    free(xt);
+    free(yt);
+    free(phi);
+    free(r);
+    free(theta);
+    free(r_d);
+
+    return status;
+}
+
+static void FrameCorrection_XYZ2DistortedFast(const FastMap_RadialLut* const lut, LDC_Map* map,
+                                              const LDC_Roi* const roi)
+{
+    uint32_t i;
+    double hc = (map->src_width - 1)/2;     /* Optical centre, in source frame. */
+    double vc = (map->src_height - 1)/2;
+    double out_hc = (map->width - 1)/2;     /* Centre of output frame.          */
+    double out_vc = (map->frame_height - 1)/2;
+    float xt0 = (float)(((double)roi->x - out_hc) * map->scale + (map->centre_x - hc));
+
+    for(i = roi->y;i < roi->y + roi->height;i++)
+    {
+        float yt = (float)(((double)(map->first_row + i) - out_vc) * map->scale +
+                           (map->centre_y - vc));
+
+        FastMap_DistortRow(lut, roi->width, xt0, (float)map->scale, yt,
+                           map->h_d + (size_t)i * map->width + roi->x,
+                           map->v_d + (size_t)i * map->width + roi->x);
+    }
+}
+
+static int32_t FrameCorrection_IsValidPosition(float h_d, float v_d,
+                                               uint32_t width, uint32_t height)
+{
+    /* Rounded position (int32_t)(p + 0.5) is inside of [0, size), exactly when
+       p + 0.5 is inside of (-1, size). NaN positions are never valid. */
+    return (h_d + 0.5f > -1.0f) && (h_d + 0.5f < (float)width) &&
+           (v_d + 0.5f > -1.0f) && (v_d + 0.5f < (float)height);
 }
 
-static LDC_Status ParamOperation_ReadParametersOfCorrection(LensSpec* lens_spec,
-                                                            const char* const filename)
+static LDC_Status FrameCorrection_AppendSpan(LDC_Map* map, uint32_t* capacity,
+                                             uint32_t start, uint32_t end)
 {
     LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
 
-    FILE* fp = fopen(filename, "r");
-    if (NULL == fp)
+    if(map->num_of_spans == *capacity)
     {
-        printf(PARAMETERS_FILE_OPENING_ERROR_MESSAGE);
-        status = LDC_STATUS_ERROR;
+        uint32_t new_capacity = (0U == *capacity) ? map->height : 2U * (*capacity);
+        LDC_Span* spans = (LDC_Span*)realloc(map->spans, new_capacity * sizeof(LDC_Span));
+
+        if(NULL == spans)
+        {
+            status = LDC_STATUS_OUT_OF_MEMORY;
+        }
+        else
+        {
+            map->spans = spans;
+            *capacity = new_capacity;
+        }
     }
-    else
+
+    if(LDC_STATUS_OK == status)
     {
+        map->spans[map->num_of_spans].start = start;
+        map->spans[map->num_of_spans].end = end;
+        map->num_of_spans++;
+    }
+
+    return status;
+}
+
+static LDC_Status FrameCorrection_BuildSpans(LDC_Map* map)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    uint32_t capacity = 0;
+    uint32_t y;
 
-        double focal_length;
-        double pixel_pitch;
-        double scaling_factor;
-        double angle;
-        double imageHeightInmm;
+    map->row_spans = (uint32_t*)malloc((map->height + 1) * sizeof(uint32_t));
+    if(NULL == map->row_spans)
+    {
+        status = LDC_STATUS_OUT_OF_MEMORY;
+    }
+
+    for(y = 0;y < map->height && LDC_STATUS_OK == status;y++)
+    {
+        uint32_t first = map->num_of_spans;
+        uint32_t i;
+        uint32_t j;
+        uint32_t k;
 
-        /* Read Focal length/ Pixel pitch/ Scaling factor. */
+        map->row_spans[y] = first;
 
-        if((fscanf(fp, "%lf,\n,", &focal_length)) != EOF)
+        /* Runs of valid positions, inside of every region that covers the row. */
+        for(i = 0;i < map->num_of_rois && LDC_STATUS_OK == status;i++)
         {
-            if((fscanf(fp, "%lf,\n,", &pixel_pitch)) != EOF)
+            const LDC_Roi* roi = &map->rois[i];
+            const float* h_d = map->h_d + (size_t)y * map->width;
+            const float* v_d = map->v_d + (size_t)y * map->width;
+            uint32_t src_width = map->src_width;
+            uint32_t src_height = map->src_height;
+            uint32_t x = roi->x;
+            uint32_t x_end = roi->x + roi->width;
+            uint32_t start;
+
+            if(y < roi->y || y >= roi->y + roi->height)
             {
-                if((fscanf(fp, "%lf,\n,", &scaling_factor))== EOF)
+                continue;
+            }
+
+            /* Skip invalid positions, and then find end of run of valid positions. */
+            while(x < x_end && LDC_STATUS_OK == status)
+            {
+                while(x < x_end &&
+                      !FrameCorrection_IsValidPosition(h_d[x], v_d[x], src_width, src_height))
                 {
-                    printf(LENS_PARAMETERS_FILE_READING_ERROR_MESSAGE);
-                    status = LDC_STATUS_ERROR;
+                    x++;
                 }
-                else
+
+                start = x;
+
+                while(x < x_end &&
+                      FrameCorrection_IsValidPosition(h_d[x], v_d[x], src_width, src_height))
                 {
-                    lens_spec->focal_length_in_mm = focal_length;
-                    lens_spec->sensor_pixel_pitch_in_mm = pixel_pitch;
-                    lens_spec->scaling_factor = scaling_factor;
-
-                    uint32_t i = 0;
-
-                    /* Read Angle / Height of Lens Camera. */
-                    while (fscanf(fp, "%lf, %lf\n", &angle, &imageHeightInmm) != EOF)
-                    {
-                        lens_spec->angle[i] = angle / 180 * M_PI; /* Degree to Radian. */
-                        lens_spec->height[i++]
-                                    = imageHeightInmm / lens_spec->sensor_pixel_pitch_in_mm;
-                    }
-
-                    /* Set number of array elements. */
-                    lens_spec -> num_of_useful_elements = i - 1;
-
-                    /* If there is no lens parameters, we need to protect our program from crash.*/
-                    if(lens_spec -> num_of_useful_elements <= 0)
-                    {
-                        printf(LENS_PARAMETERS_FILE_READING_ERROR_MESSAGE);
-                        status = LDC_STATUS_ERROR;
-                    }
+                    x++;
+                }
 
+                if(start < x)
+                {
+                    status = FrameCorrection_AppendSpan(map, &capacity, start, x);
                 }
             }
-            else
+        }
+
+        /* Sort spans of row by start, and merge spans of overlapping regions. */
+        for(i = first + 1;i < map->num_of_spans;i++)
+        {
+            LDC_Span span = map->spans[i];
+
+            for(j = i;j > first && map->spans[j - 1].start > span.start;j--)
             {
-                printf(LENS_PARAMETERS_FILE_READING_ERROR_MESSAGE);
-                status = LDC_STATUS_ERROR;
+                map->spans[j] = map->spans[j - 1];
             }
+            map->spans[j] = span;
         }
-        else
+
+        for(i = first, k = first;i < map->num_of_spans;i++)
         {
-            printf(LENS_PARAMETERS_FILE_READING_ERROR_MESSAGE);
-            status = LDC_STATUS_ERROR;
+            if(k > first && map->spans[i].start <= map->spans[k - 1].end)
+            {
+                map->spans[k - 1].end = LDC_MAX(map->spans[k - 1].end, map->spans[i].end);
+            }
+            else
+            {
+                map->spans[k++] = map->spans[i];
+            }
         }
+        map->num_of_spans = k;
+    }
 
-        fclose(fp);
+    if(LDC_STATUS_OK == status)
+    {
+        map->row_spans[map->height] = map->num_of_spans;
     }
 
     return status;
 }
 
-static int32_t findNearestNeighbourIndex(double value, const double* const x, int32_t len)
+static void FrameCorrection_GenerateMapBand(void* arg, uint32_t index)
 {
-    double dist;
-    int32_t idx;
-    int32_t i;
+    FrameCorrection_MapTask* task = (FrameCorrection_MapTask*)arg;
+    const LDC_Map* map = task->map;
+    uint32_t y_begin = index * MAP_ROWS_PER_TASK;
+    uint32_t y_end = LDC_MIN(y_begin + MAP_ROWS_PER_TASK, map->height);
+    uint32_t i;
+
+    /* Regions are visited in same order as in serial generation, so overlapping regions
+       leave same values, for any number of threads. */
+    for(i = 0;i < map->num_of_rois;i++)
+    {
+        LDC_Roi band = map->rois[i];
+        uint32_t roi_begin = LDC_MAX(band.y, y_begin);
+        uint32_t roi_end = LDC_MIN(band.y + band.height, y_end);
+
+        if(roi_begin < roi_end)
+        {
+            band.y = roi_begin;
+            band.height = roi_end - roi_begin;
 
-    idx = -1;
-    dist = DBL_MAX;
+            if(!task->reference)
+            {
+                FrameCorrection_XYZ2DistortedFast(task->lut, task->map, &band);
+            }
+            else if(FrameCorrection_XYZ2Distorted(task->lens, task->map, &band))
+            {
+                __atomic_store_n(&task->status, LDC_STATUS_OUT_OF_MEMORY, __ATOMIC_RELAXED);
+            }
+        }
+    }
+}
 
-    for(i = 0;i < len;i++)
+static LDC_Status FrameCorrection_GenerateMapInternal(LDC_Map* map, uint32_t width,
+                                                     uint32_t height,
+                                                     const LDC_OutputSpec* const output,
+                                                     const LDC_Roi* const rois,
+                                                     uint32_t num_of_rois,
+                                                     const LensProfile* const lens,
+                                                     uint32_t reference, uint32_t first_row,
+                                                     uint32_t num_of_rows, WorkerPool* pool)
+{
+    FastMap_RadialLut lut;
+    FrameCorrection_MapTask task;
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    LDC_OutputSpec strip;
+    uint32_t frame_height = (NULL == output) ? height : output->height;
+
+    /* Strip keeps scale and centre of whole output frame, only its height differs. */
+    strip.width = (NULL == output) ? width : output->width;
+    strip.height = (0U == num_of_rows) ? frame_height : num_of_rows;
+    strip.scale = (NULL == output) ? 0.0 : output->scale;
+    strip.centre_x = (NULL == output) ? 0.0 : output->centre_x;
+    strip.centre_y = (NULL == output) ? 0.0 : output->centre_y;
+    strip.use_centre = (NULL == output) ? 0U : output->use_centre;
+
+    if(NULL == lens || (uint64_t)first_row + strip.height > frame_height)
+    {
+        memset(map, 0, sizeof(LDC_Map));
+        status = LDC_STATUS_INVALID_ARGUMENT;
+    }
+    else if(LDC_STATUS_OK != (status = FrameCorrection_AllocateMap(map, width, height, &strip,
+                                                                  rois, num_of_rois)))
+    {
+        /* Status of allocation is returned. */
+    }
+    else
     {
-        double new_dist = ABS(value - x[i]); /* New distance. */
-        if(new_dist <= dist)
+        map->first_row = first_row;
+        map->frame_height = frame_height;
+
+        /* Preprocessed lens function, moved to optical centre of source frame. */
+        memcpy(&lut, &lens->lut, sizeof(FastMap_RadialLut));
+        lut.hc = (float)((width - 1)/2);
+        lut.vc = (float)((height - 1)/2);
+
+        task.map = map;
+        task.lens = lens;
+        task.lut = &lut;
+        task.reference = reference;
+        task.status = LDC_STATUS_OK;
+
+        /* Get position of original pixels! Back Mapping, on bands of rows in parallel. */
+        WorkerPool_Run(pool, FrameCorrection_GenerateMapBand, &task,
+                       (map->height + MAP_ROWS_PER_TASK - 1U) / MAP_ROWS_PER_TASK);
+        status = task.status;
+
+        /* Record spans of valid positions, for remap without range checks. */
+        if(LDC_STATUS_OK == status)
         {
-            dist = new_dist;
-            idx = i;
+            status = FrameCorrection_UpdateSpans(map);
+        }
+
+        if(LDC_STATUS_OK != status)
+        {
+            FrameCorrection_FreeMap(map);
         }
     }
 
-    return idx;
+    return status;
 }
 
-static double* FrameCorrection_LinearInterpolation(double* x, double* y, int32_t sample_points_size,
-                                                   double* xq, int32_t queri_points_size)
-{
-    double* slope;
-    double* intercept;
-    double* yq = (double *) malloc(queri_points_size*sizeof(double)); /* Interpolated array. */
-    int32_t i;
 
-    slope       = (double *)malloc(sample_points_size*sizeof(double));
-    intercept   = (double *)malloc(sample_points_size*sizeof(double));
+/* ============================================================================================== */
+
+/*                                     API Functions                                              */
 
-    for(i = 0;i < sample_points_size;i++)
+/* ============================================================================================== */
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     FrameCorrection_ValidateRois
+ *
+ * \brief  Check that regions of interest are not empty, and that they are inside of frame.
+ *
+ * \param  [In]  width        Width of frame.
+ * \param  [In]  height       Height of frame.
+ * \param  [In]  rois         Regions of interest.
+ * \param  [In]  num_of_rois  Number of regions of interest, at least one.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status FrameCorrection_ValidateRois(uint32_t width, uint32_t height,
+                                        const LDC_Roi* const rois, uint32_t num_of_rois)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    uint32_t i;
+
+    if(0U == num_of_rois)
     {
-        if(i < sample_points_size-1)
-        {
-            double dx;
-            double dy;
+        status = LDC_STATUS_INVALID_ARGUMENT;
+        LdcLog_Write(LDC_LOG_ERROR, status, INVALID_ROI_ERROR_MESSAGE);
+    }
 
-            dx = x[i + 1] - x[i];
-            dy = y[i + 1] - y[i];
-            slope[i] = dy / dx;                     /* Define slope of function. */
-            intercept[i] = y[i] - x[i] * slope[i];  /* Define intercept of function.*/
-        }
-        else
+    for(i = 0;i < num_of_rois;i++)
+    {
+        /* Region must not be empty, and must be inside of frame. */
+        if(0U == rois[i].width || 0U == rois[i].height ||
+           rois[i].x >= width || rois[i].y >= height ||
+           rois[i].width > width - rois[i].x || rois[i].height > height - rois[i].y)
         {
-            slope[i] = slope[i-1];
-            intercept[i] = intercept[i-1];
+            status = LDC_STATUS_INVALID_ARGUMENT;
+            LdcLog_Write(LDC_LOG_ERROR, status, INVALID_ROI_ERROR_MESSAGE);
+            break;
         }
     }
 
-    for(i = 0;i < queri_points_size;i++)
-    {
-        int32_t index_of_nearest_number;
+    return status;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     FrameCorrection_AllocateMap
+ *
+ * \brief  Allocate map, and set its output frame and regions of interest, without computing
+ *         positions. Map builders fill positions inside regions, and then call
+ *         FrameCorrection_UpdateSpans.
+ *
+ * \param  [Out] map          Allocated map. Has to be released with FrameCorrection_FreeMap.
+ * \param  [In]  width        Width of source frame.
+ * \param  [In]  height       Height of source frame.
+ * \param  [In]  output       Output frame specification, or NULL for output same as source.
+ * \param  [In]  rois         Regions of interest in output frame, or NULL for whole frame.
+ * \param  [In]  num_of_rois  Number of regions of interest.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status FrameCorrection_AllocateMap(LDC_Map* map, uint32_t width, uint32_t height,
+                                       const LDC_OutputSpec* const output,
+                                       const LDC_Roi* const rois, uint32_t num_of_rois)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    uint32_t out_width = (NULL == output) ? width : output->width;
+    uint32_t out_height = (NULL == output) ? height : output->height;
 
-        index_of_nearest_number = findNearestNeighbourIndex(xq[i], x, sample_points_size);
-        if(index_of_nearest_number != -1)
+    memset(map, 0, sizeof(LDC_Map));
+
+    if(0U == width || 0U == height || 0U == out_width || 0U == out_height ||
+       (NULL != output && output->scale < 0.0))
+    {
+        status = LDC_STATUS_INVALID_ARGUMENT;
+    }
+    else if(NULL != rois && FrameCorrection_ValidateRois(out_width, out_height,
+                                                         rois, num_of_rois))
+    {
+        status = LDC_STATUS_INVALID_ARGUMENT;
+    }
+    else
+    {
+        map->width = out_width;
+        map->height = out_height;
+        map->src_width = width;
+        map->src_height = height;
+        map->num_of_rois = (NULL == rois) ? 1U : num_of_rois;
+        map->first_row = 0;
+        map->frame_height = out_height;
+
+        /* By default output keeps horizontal field of view, and centre of source frame. */
+        map->scale = (NULL == output || 0.0 == output->scale) ?
+                     (double)width / (double)out_width : output->scale;
+        map->centre_x = (NULL != output && output->use_centre) ?
+                        output->centre_x : (double)((width - 1)/2);
+        map->centre_y = (NULL != output && output->use_centre) ?
+                        output->centre_y : (double)((height - 1)/2);
+
+        /* Entries outside of regions are never touched, so they cost only address space. */
+        map->h_d  = (float*)malloc((size_t)out_width * out_height * sizeof(float));
+        map->v_d  = (float*)malloc((size_t)out_width * out_height * sizeof(float));
+        map->rois = (LDC_Roi*)malloc(map->num_of_rois * sizeof(LDC_Roi));
+
+        if(NULL == map->h_d || NULL == map->v_d || NULL == map->rois)
         {
-            yq[i]=slope[index_of_nearest_number] * xq[i] + intercept[index_of_nearest_number];
+            FrameCorrection_FreeMap(map);
+            status = LDC_STATUS_OUT_OF_MEMORY;
+        }
+        else if(NULL == rois)
+        {
+            map->rois[0].x = 0;
+            map->rois[0].y = 0;
+            map->rois[0].width = out_width;
+            map->rois[0].height = out_height;
         }
         else
         {
-            yq[i]=DBL_MAX;
+            memcpy(map->rois, rois, num_of_rois * sizeof(LDC_Roi));
         }
     }
 
-    free(slope);
-    free(intercept);
+    return status;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     FrameCorrection_UpdateSpans
+ *
+ * \brief  Record spans of valid positions inside regions of map, after positions are changed.
+ *
+ * \param  [In]  map          Map with computed positions.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status FrameCorrection_UpdateSpans(LDC_Map* map)
+{
+    free(map->row_spans);
+    free(map->spans);
+    map->row_spans = NULL;
+    map->spans = NULL;
+    map->num_of_spans = 0;
+
+    return FrameCorrection_BuildSpans(map);
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     FrameCorrection_GenerateMap
+ *
+ * \brief  Generate back mapping of output pixels to positions of distorted source pixels.
+ *         Only map entries inside regions of interest are computed, so cost of generation
+ *         depends on area of regions, not on area of frame. Positions are computed in single
+ *         precision with SIMD, within FAST_MAP_MAX_COORDINATE_ERROR of reference map.
+ *
+ * \param  [Out] map          Generated map. Has to be released with FrameCorrection_FreeMap.
+ * \param  [In]  width        Width of source frame.
+ * \param  [In]  height       Height of source frame.
+ * \param  [In]  output       Output frame specification, or NULL for output same as source.
+ * \param  [In]  rois         Regions of interest in output frame, or NULL for whole frame.
+ * \param  [In]  num_of_rois  Number of regions of interest.
+ * \param  [In]  lens         Lens profile, see LensProfile_LoadFile and LensRegistry_Acquire.
+ * \param  [In]  pool         Worker pool that generates bands of rows in parallel, or NULL.
+ *                            Map is same for any number of threads.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status FrameCorrection_GenerateMap(LDC_Map* map, uint32_t width, uint32_t height,
+                                       const LDC_OutputSpec* const output,
+                                       const LDC_Roi* const rois, uint32_t num_of_rois,
+                                       const LensProfile* const lens, WorkerPool* pool)
+{
+    return FrameCorrection_GenerateMapInternal(map, width, height, output, rois, num_of_rois,
+                                               lens, 0U, 0U, 0U, pool);
+}
 
-    return yq;
+/**
+ ***************************************************************************************************
+ *
+ * \fn     FrameCorrection_GenerateReferenceMap
+ *
+ * \brief  Generate back mapping of output pixels to positions of distorted source pixels.
+ *         Only map entries inside regions of interest are computed, so cost of generation
+ *         depends on area of regions, not on area of frame. Positions are computed in double
+ *         precision with libm, exactly as lens parameter table defines them.
+ *
+ * \param  [Out] map          Generated map. Has to be released with FrameCorrection_FreeMap.
+ * \param  [In]  width        Width of source frame.
+ * \param  [In]  height       Height of source frame.
+ * \param  [In]  output       Output frame specification, or NULL for output same as source.
+ * \param  [In]  rois         Regions of interest in output frame, or NULL for whole frame.
+ * \param  [In]  num_of_rois  Number of regions of interest.
+ * \param  [In]  lens         Lens profile, see LensProfile_LoadFile and LensRegistry_Acquire.
+ * \param  [In]  pool         Worker pool that generates bands of rows in parallel, or NULL.
+ *                            Map is same for any number of threads.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status FrameCorrection_GenerateReferenceMap(LDC_Map* map, uint32_t width, uint32_t height,
+                                                const LDC_OutputSpec* const output,
+                                                const LDC_Roi* const rois, uint32_t num_of_rois,
+                                                const LensProfile* const lens, WorkerPool* pool)
+{
+    return FrameCorrection_GenerateMapInternal(map, width, height, output, rois, num_of_rois,
+                                               lens, 1U, 0U, 0U, pool);
 }
 
-static LDC_Status FrameCorrection_XYZ2Distorted(const char* const filename, uint32_t width,
-                                                uint32_t height, double** x, double** y,
-                                                double hc, double vc,
-                                                double** h_d, double** v_d)
+/**
+ ***************************************************************************************************
+ *
+ * \fn     FrameCorrection_GenerateStripMap
+ *
+ * \brief  Generate map of output rows [first_row, first_row + num_of_rows) of output frame.
+ *         Map has num_of_rows rows, and its positions are exactly same as positions of those
+ *         rows in map of whole frame, generated with FrameCorrection_GenerateMap.
+ *
+ * \param  [Out] map          Generated map. Has to be released with FrameCorrection_FreeMap.
+ * \param  [In]  width        Width of source frame.
+ * \param  [In]  height       Height of source frame.
+ * \param  [In]  output       Output frame specification, or NULL for output same as source.
+ * \param  [In]  first_row    First output row of strip.
+ * \param  [In]  num_of_rows  Output rows of strip.
+ * \param  [In]  rois         Regions of interest in strip, or NULL for whole strip.
+ * \param  [In]  num_of_rois  Number of regions of interest.
+ * \param  [In]  lens         Lens profile, see LensProfile_LoadFile and LensRegistry_Acquire.
+ * \param  [In]  pool         Worker pool that generates bands of rows in parallel, or NULL.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status FrameCorrection_GenerateStripMap(LDC_Map* map, uint32_t width, uint32_t height,
+                                            const LDC_OutputSpec* const output,
+                                            uint32_t first_row, uint32_t num_of_rows,
+                                            const LDC_Roi* const rois, uint32_t num_of_rois,
+                                            const LensProfile* const lens, WorkerPool* pool)
 {
-    LensSpec lens_spec;
     LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
 
-    memset(lens_spec.angle, 0, sizeof(lens_spec.angle));
-    memset(lens_spec.height, 0, sizeof(lens_spec.height));
+    if(0U == num_of_rows)
+    {
+        memset(map, 0, sizeof(LDC_Map));
+        status = LDC_STATUS_ERROR;
+    }
+    else
+    {
+        status = FrameCorrection_GenerateMapInternal(map, width, height, output, rois,
+                                                     num_of_rois, lens, 0U, first_row,
+                                                     num_of_rows, pool);
+    }
 
-    /* Read necessary lens specification parameters. */
-    if(ParamOperation_ReadParametersOfCorrection(&lens_spec, filename))
+    return status;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     FrameCorrection_GetMapMaxError
+ *
+ * \brief  Get maximal difference of source positions between map and reference map, over all
+ *         positions that are valid in reference map.
+ *
+ * \param  [In]  map          Map to check.
+ * \param  [In]  reference    Reference map, with same dimensions and regions.
+ * \param  [Out] max_error    Maximal horizontal or vertical difference, in pixels.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status FrameCorrection_GetMapMaxError(const LDC_Map* const map,
+                                          const LDC_Map* const reference, double* max_error)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+
+    if(NULL == map || NULL == reference || NULL == max_error || NULL == map->h_d ||
+       NULL == reference->row_spans || map->width != reference->width ||
+       map->height != reference->height)
     {
         status = LDC_STATUS_ERROR;
     }
     else
     {
+        uint32_t y;
         uint32_t i;
-        uint32_t j;
-        double f;
-        double z;
-        double** xt;
-        double** yt;
-        double** zt;
-        double** phi;
-        double** r;
-        double** theta;
-        double** r_d;
-
-        f = lens_spec.focal_length_in_mm / lens_spec.sensor_pixel_pitch_in_mm;
-        z = f / lens_spec.scaling_factor;
-
-        xt    = (double**)malloc(height * sizeof(double*));
-        yt    = (double**)malloc(height * sizeof(double*));
-        zt    = (double**)malloc(height * sizeof(double*));
-        phi   = (double**)malloc(height * sizeof(double*));
-        r     = (double**)malloc(height * sizeof(double*));
-        theta = (double**)malloc(height * sizeof(double*));
-        r_d   = (double**)malloc(height * sizeof(double*));
+        uint32_t x;
 
-        for(i = 0;i < height;i++)
-        {
-            xt[i]    = (double*)malloc(width * sizeof(double));
-            yt[i]    = (double*)malloc(width * sizeof(double));
-            zt[i]    = (double*)malloc(width * sizeof(double));
-            phi[i]   = (double*)malloc(width * sizeof(double));
-            r[i]     = (double*)malloc(width * sizeof(double));
-            theta[i] = (double*)malloc(width * sizeof(double));
-        }
+        *max_error = 0.0;
 
-        /* Substract position of centar. */
-        for(i = 0;i < height;i++)
+        for(y = 0;y < reference->height;y++)
         {
-            for(j = 0;j < width;j++)
+            for(i = reference->row_spans[y];i < reference->row_spans[y + 1];i++)
             {
-                xt[i][j] = x[i][j] - hc;
-                yt[i][j] = y[i][j] - vc;
-                zt[i][j] = z;
+                for(x = reference->spans[i].start;x < reference->spans[i].end;x++)
+                {
+                    size_t index = (size_t)y * reference->width + x;
+                    double dh = LDC_ABS((double)map->h_d[index] - (double)reference->h_d[index]);
+                    double dv = LDC_ABS((double)map->v_d[index] - (double)reference->v_d[index]);
+
+                    *max_error = LDC_MAX(*max_error, LDC_MAX(dh, dv));
+                }
             }
         }
+    }
 
-        /* Cartesian to Polar. */
-        cart2pol(width, height, xt, yt, phi, r);
+    return status;
+}
 
-        for(i = 0;i < height;i++)
-        {
-            for(j = 0;j < width;j++)
-            {
-                /* Four-Quadrant Inverse Tangent of a Point. */
-                theta[i][j] = atan2(r[i][j], zt[i][j]);
-            }
-        }
+/**
+ ***************************************************************************************************
+ *
+ * \fn     FrameCorrection_ApplyMap
+ *
+ * \brief  Remap Y, U, V components of frame, with previously generated map. Only output pixels
+ *         inside regions of interest are written, other pixels are left untouched. Pixels
+ *         without valid source pixel are set to border colour.
+ *
+ * \param  [In]  map          Map generated with FrameCorrection_GenerateMap.
+ * \param  [Out] Y_out        Y component of undistorted frame, with resolution of map output.
+ * \param  [Out] U_out        U component of undistorted frame, with resolution of map output.
+ * \param  [Out] V_out        V component of undistorted frame, with resolution of map output.
+ * \param  [In]  Y            Y component of YUV frame, with resolution of map source.
+ * \param  [In]  U            U component of YUV frame, with resolution of map source.
+ * \param  [In]  V            V component of YUV frame, with resolution of map source.
+ * \param  [In]  yuv_type     Type of YUV image.
+ * \param  [In]  rois         Regions of interest, or NULL for all regions computed in map.
+ *                            Every region has to be covered by regions computed in map.
+ * \param  [In]  num_of_rois  Number of regions of interest.
+ * \param  [In]  border       Border colour, or NULL to leave pixels without source untouched.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status FrameCorrection_ApplyMap(const LDC_Map* const map, uint8_t* const Y_out,
+                                    uint8_t* const U_out, uint8_t* const V_out,
+                                    const uint8_t* const Y, const uint8_t* const U,
+                                    const uint8_t* const V, YUV_Type yuv_type,
+                                    const LDC_Roi* const rois, uint32_t num_of_rois,
+                                    const LDC_Color* const border)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    const Remap_Kernels* kernels = Remap_GetKernels(YuvFormat_Get(yuv_type));
 
-        /* Linear Interpolation of matrix. */
-        for(i = 0;i < height;i++)
-        {
-            r_d[i] = FrameCorrection_LinearInterpolation(lens_spec.angle, lens_spec.height,
-                                                         lens_spec.num_of_useful_elements,
-                                                         theta[i], width);
-        }
+    if(NULL == map || NULL == map->h_d || NULL == map->v_d || NULL == map->row_spans ||
+       NULL == Y_out || NULL == U_out || NULL == V_out ||
+       NULL == Y || NULL == U || NULL == V)
+    {
+        status = LDC_STATUS_INVALID_ARGUMENT;
+    }
+    else if(NULL == kernels)
+    {
+        status = LDC_STATUS_UNSUPPORTED_FORMAT;
+    }
+    /* Chroma components are sized by subsampling, so frames have to be its multiples. */
+    else if(YuvFormat_ValidateSize(YuvFormat_Get(yuv_type), map->width, map->height) ||
+            YuvFormat_ValidateSize(YuvFormat_Get(yuv_type), map->src_width, map->src_height))
+    {
+        status = LDC_STATUS_INVALID_ARGUMENT;
+    }
+    else if(NULL != rois && FrameCorrection_ValidateRois(map->width, map->height,
+                                                         rois, num_of_rois))
+    {
+        status = LDC_STATUS_INVALID_ARGUMENT;
+    }
+    else
+    {
+        /* Kernels are selected once for frame, by layout of format. */
+        Remap_Frame frame;
+
+        frame.Y_out = Y_out;
+        frame.U_out = U_out;
+        frame.V_out = V_out;
+        frame.Y = Y;
+        frame.U = U;
+        frame.V = V;
+        frame.width = map->width;
+        frame.src_width = map->src_width;
+        frame.src_height = map->src_height;
+        frame.map_width = map->width;
+        frame.h_d = map->h_d;
+        frame.v_d = map->v_d;
+        frame.plan = NULL;
+
+        Remap_ApplyRois(map, &frame, kernels->map_nearest, kernels->fill, rois, num_of_rois,
+                        border);
+    }
 
-        /* Polar to Cartesian. */
-        pol2cart(width, height, h_d, v_d, phi, r_d);
+    return status;
+}
 
-        /* On every pixel position, add vertical and horizontal position of centar. */
-        for(i = 0;i < height;i++)
+/**
+ ***************************************************************************************************
+ *
+ * \fn     FrameCorrection_GetValidityMask
+ *
+ * \brief  Generate 1-bit mask of output pixels, that have valid source pixel. Bit x % 8 of byte
+ *         y * VALIDITY_MASK_STRIDE(width) + x / 8 is set, when pixel (x, y) is valid.
+ *
+ * \param  [In]  map          Map generated with FrameCorrection_GenerateMap.
+ * \param  [Out] mask         Validity mask, of height * VALIDITY_MASK_STRIDE(width) bytes.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status FrameCorrection_GetValidityMask(const LDC_Map* const map, uint8_t* const mask)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+
+    if(NULL == map || NULL == map->row_spans || NULL == mask)
+    {
+        status = LDC_STATUS_INVALID_ARGUMENT;
+    }
+    else
+    {
+        uint32_t stride = VALIDITY_MASK_STRIDE(map->width);
+        uint32_t y;
+        uint32_t i;
+
+        memset(mask, 0, (size_t)map->height * stride);
+
+        for(y = 0;y < map->height;y++)
         {
-            for(j = 0;j < width;j++)
+            uint8_t* mask_row = &mask[(size_t)y * stride];
+
+            for(i = map->row_spans[y];i < map->row_spans[y + 1];i++)
             {
-                h_d[i][j] += hc;
-                v_d[i][j] += vc;
-            }
-        }
+                uint32_t start = map->spans[i].start;
+                uint32_t end = map->spans[i].end;
 
-        /*
-        WriteOperation_WritePixelsPosition2File("h_d_C.txt",height,width,h_d);
-        WriteOperation_WritePixelsPosition2File("v_d_C.txt",height,width,v_d);
-        */
+                /* Partial bytes bit by bit, whole bytes of span with memset. */
+                while(start < end && (start % 8U) != 0U)
+                {
+                    mask_row[start / 8U] |= (uint8_t)(1U << (start % 8U));
+                    start++;
+                }
 
-        for(i = 0;i < height;i++)
-        {
-            free(xt[i]);
-            free(yt[i]);
-            free(zt[i]);
-            free(phi[i]);
-            free(r[i]);
-            free(theta[i]);
-            free(r_d[i]);
-        }
+                if(end - start >= 8U)
+                {
+                    memset(&mask_row[start / 8U], 0xFF, (end - start) / 8U);
+                    start += ((end - start) / 8U) * 8U;
+                }
 
-        free(xt);
-        free(yt);
-        free(zt);
-        free(r);
-        free(phi);
-        free(theta);
-        free(r_d);
+                while(start < end)
+                {
+                    mask_row[start / 8U] |= (uint8_t)(1U << (start % 8U));
+                    start++;
+                }
+            }
+        }
     }
 
     return status;
 }
 
-
-/* ============================================================================================== */
-
-/*                                     API Functions                                              */
-
-/* ============================================================================================== */
+/**
+ ***************************************************************************************************
+ *
+ * \fn     FrameCorrection_FreeMap
+ *
+ * \brief  Release memory of generated map.
+ *
+ * \param  [In]  map          Map generated with FrameCorrection_GenerateMap.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void FrameCorrection_FreeMap(LDC_Map* map)
+{
+    if(NULL != map)
+    {
+        free(map->h_d);
+        free(map->v_d);
+        free(map->rois);
+        free(map->row_spans);
+        free(map->spans);
+        memset(map, 0, sizeof(LDC_Map));
+    }
+}
 
 /**
  ***************************************************************************************************
@@ -409,7 +974,7 @@ static LDC_Status FrameCorrection_XYZ2Distorted(const char* const filename, uint
  *
  * \brief  Generate YUV image without distortion.
  *
- * \param  [Out] YUV_out      Undistorted YUV frame.
+ * \param  [Out] YUV_out      Undistorted YUV frame, with output resolution.
  * \param  [In]  Y            Y component of YUV frame.
  * \param  [In]  U	          U component of YUV frame.
  * \param  [In]  V            V component of YUV frame.
@@ -417,7 +982,15 @@ static LDC_Status FrameCorrection_XYZ2Distorted(const char* const filename, uint
  * \param  [In]  width        Width of frame.
  * \param  [In]  height       Height of frame.
  * \param  [In]  yuv_type     Type of YUV image.
- * \param  [In]  filename     Lens parameter CSV filename
+ * \param  [In]  lens         Lens profile, see LensProfile_LoadFile and LensProfile_LoadModel.
+ * \param  [In]  output       Output frame specification, or NULL for output same as input.
+ * \param  [In]  rois         Regions of interest, or NULL for whole frame. Pixels outside of
+ *                            regions are set to zero.
+ * \param  [In]  num_of_rois  Number of regions of interest.
+ * \param  [In]  border       Colour of pixels without valid source pixel.
+ * \param  [In]  interpolation  Sampling of source frame.
+ * \param  [Out] mask         Validity mask of output frame (see FrameCorrection_GetValidityMask),
+ *                            or NULL when mask is not needed.
  *
  * \return LDC_Status   Exit status.
  *
@@ -425,133 +998,123 @@ static LDC_Status FrameCorrection_XYZ2Distorted(const char* const filename, uint
  */
 LDC_Status FrameCorrection_CorrectLensDistortion(uint8_t** YUV_out, const uint8_t* const Y,
                                                  const uint8_t* const U, const uint8_t* const V,
-                                                 uint32_t img_size, uint32_t width,
+                                                 size_t img_size, uint32_t width,
                                                  uint32_t height, YUV_Type yuv_type,
-                                                 const char* const filename)
+                                                 const LensProfile* const lens,
+                                                 const LDC_OutputSpec* const output,
+                                                 const LDC_Roi* const rois, uint32_t num_of_rois,
+                                                 const LDC_Color* const border,
+                                                 LDC_Interpolation interpolation,
+                                                 uint8_t* const mask)
 {
 
     LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
 
-    if(NULL == Y || NULL == U || NULL == V)
+    if(NULL == YUV_out || NULL == Y || NULL == U || NULL == V || NULL == border ||
+       NULL == lens)
     {
-        status = LDC_STATUS_ERROR;
+        status = LDC_STATUS_INVALID_ARGUMENT;
+    }
+    else if(NULL == YuvFormat_Get(yuv_type))
+    {
+        status = LDC_STATUS_UNSUPPORTED_FORMAT;
+    }
+    /* Output components are sized by chroma subsampling of format. */
+    else if(img_size < YuvFormat_GetFrameSize(width, height, yuv_type) ||
+            YuvFormat_ValidateSize(YuvFormat_Get(yuv_type), width, height) ||
+            (NULL != output &&
+             YuvFormat_ValidateSize(YuvFormat_Get(yuv_type), output->width, output->height)))
+    {
+        status = LDC_STATUS_INVALID_ARGUMENT;
     }
     else
     {
-        uint32_t i;
-        uint32_t j;
-        uint32_t x;
-        uint32_t y;
         uint8_t* Y_out;
         uint8_t* U_out;
         uint8_t* V_out;
-        double** h_p;
-        double** v_p;
-        double** h_d;
-        double** v_d;
-
-        Y_out = (uint8_t*)malloc(width * height * sizeof ( uint8_t ));
-        U_out = (uint8_t*)malloc((width / 2) * ((int32_t)yuv_type * height / 2)*sizeof(uint8_t));
-        V_out = (uint8_t*)malloc((width / 2) * ((int32_t)yuv_type * height / 2)*sizeof(uint8_t));
-
-        *YUV_out = malloc (img_size * sizeof ( uint8_t ));
-
-        h_p = (double**)malloc(height * sizeof(double*));
-        v_p = (double**)malloc(height * sizeof(double*));
-        h_d = (double**)malloc(height * sizeof(double*));
-        v_d = (double**)malloc(height * sizeof(double*));
-
-
-        for(i = 0;i < height;i++)
-        {
-            h_p[i] = (double*)malloc(width * sizeof(double));
-            v_p[i] = (double*)malloc(width * sizeof(double));
-            h_d[i] = (double*)malloc(width * sizeof(double));
-            v_d[i] = (double*)malloc(width * sizeof(double));
-        }
-
-
-        /* Create Meshgrid. with*/
-        for(i = 0;i < width;i++)
-        {
-            for(j = 0;j < height;j++)
-            {
-                h_p[j][i] = i;
-            }
-        }
-
-        for(i = 0;i < height;i++)
+        LDC_Map map;
+        const YuvFormat* format = YuvFormat_Get(yuv_type);
+        uint32_t bytes_per_sample = format->bytes_per_sample;
+        uint32_t out_width = (NULL == output) ? width : output->width;
+        uint32_t out_height = (NULL == output) ? height : output->height;
+        size_t out_img_size = ComponentsStructure_GetFrameSize(out_width, out_height, yuv_type);
+        size_t out_chroma_size = (size_t)YuvFormat_GetChromaWidth(out_width, yuv_type) *
+                                 YuvFormat_GetChromaHeight(out_height, yuv_type);
+
+        /* With regions of interest, rest of frame is set to zero. */
+        Y_out = (uint8_t*)calloc((size_t)out_width * out_height, bytes_per_sample);
+        U_out = (uint8_t*)calloc(out_chroma_size, bytes_per_sample);
+        V_out = (uint8_t*)calloc(out_chroma_size, bytes_per_sample);
+
+        *YUV_out = malloc (out_img_size * sizeof ( uint8_t ));
+
+        if(NULL == Y_out || NULL == U_out || NULL == V_out || NULL == *YUV_out)
         {
-            for(j = 0;j < width;j++)
-            {
-                v_p[i][j] = i;
-            }
+            status = LDC_STATUS_OUT_OF_MEMORY;
         }
-
-
         /* Get position of original pixels! Back Mapping. */
-        if(FrameCorrection_XYZ2Distorted(filename, width, height, h_p, v_p,
-                                         (width - 1)/2, (height - 1)/2, h_d, v_d))
+        else if(LDC_STATUS_OK != (status = FrameCorrection_GenerateMap(&map, width, height,
+                                                                      output, rois, num_of_rois,
+                                                                      lens, NULL)))
         {
-            status = LDC_STATUS_ERROR;
+            /* Status of map generation is returned. */
         }
         else
         {
-            for(x = 0;x < width;x++)
+            Remap_Plan plan;
+
+            /* Offsets of source pixels are precomputed once, for format and interpolation. */
+            if(LDC_STATUS_OK != (status = Remap_CreatePlan(&plan, &map, yuv_type,
+                                                           interpolation)) ||
+               LDC_STATUS_OK != (status = Remap_ApplyPlan(&plan, Y_out, U_out, V_out, Y, U, V,
+                                                          NULL, 0, border)) ||
+               (NULL != mask &&
+                LDC_STATUS_OK != (status = FrameCorrection_GetValidityMask(&map, mask))))
             {
-                for(y = 0;y < height;y++)
-                {
-
-                    /* Casting the double coordinates into int. Add +0.5 to get higher position. */
-                    int32_t srcX = (int32_t)(h_d[y][x] + 0.5);
-                    int32_t srcY = (int32_t)(v_d[y][x] + 0.5);
-
-                    /* Chech if source coordinates are into the image range. */
-                    if(srcX >= 0 && srcY >= 0 && srcX < width && srcY < height)
-                    {
-                        Y_out[y * width + x] = Y[srcY * width + srcX];
-
-                        U_out[(int32_t)((int32_t)yuv_type*y/2) * (int32_t)(width/2) + (int32_t)(x/2)]
-                        = U[(int32_t)((int32_t)yuv_type*srcY/2)*(int32_t)(width/2)+(int32_t)(srcX/2)];
-
-                        V_out[(int32_t)((int32_t)yuv_type*y/2) * (int32_t)(width/2) + (int32_t)(x/2)]
-                        = V[(int32_t)((int32_t)yuv_type*srcY/2) * (int32_t)(width/2) + (int)(srcX/2)];
-                    }
-                }
+                /* Status of failed step is returned. */
             }
-
-
             /* Create one YUV file, that represent an image! */
-            if(ComponentsStructure_CombineYUVComponents(*YUV_out, Y_out, U_out, V_out,
-                                                        width, height, img_size, yuv_type))
+            else if(ComponentsStructure_CombineYUVComponents(*YUV_out, Y_out, U_out, V_out,
+                                                             out_width, out_height, out_img_size,
+                                                             yuv_type))
             {
-                printf(COMBINE_YUV_COMPONENTS_ERROR_MESSAGE);
                 status = LDC_STATUS_ERROR;
+                LdcLog_Write(LDC_LOG_ERROR, status, COMBINE_YUV_COMPONENTS_ERROR_MESSAGE);
             }
+
+            Remap_FreePlan(&plan);
+            FrameCorrection_FreeMap(&map);
         }
 
         /* Free allocated memory! */
         free(Y_out);
         free(U_out);
         free(V_out);
-
-        for(i = 0;i < height;i++)
-        {
-            free(h_p[i]);
-            free(v_p[i]);
-            free(h_d[i]);
-            free(v_d[i]);
-        }
-
-        free(h_p);
-        free(v_p);
-        free(h_d);
-        free(v_d);
     }
 
     return status;
  }
 
+/**
+ ***************************************************************************************************
+ *
+ * \fn     ComponentsStructure_GetFrameSize
+ *
+ * \brief  Get size of YUV frame in bytes.
+ *
+ * \param  [In]  width        Width of image.
+ * \param  [In]  height       Height of image.
+ * \param  [In]  yuv_type     Type of YUV image.
+ *
+ * \return size_t       Size of frame.
+ *
+ ***************************************************************************************************
+ */
+size_t ComponentsStructure_GetFrameSize(uint32_t width, uint32_t height, YUV_Type yuv_type)
+{
+    return YuvFormat_GetFrameSize(width, height, yuv_type);
+}
+
 
 /**
  ***************************************************************************************************
@@ -575,58 +1138,29 @@ LDC_Status FrameCorrection_CorrectLensDistortion(uint8_t** YUV_out, const uint8_
  */
 LDC_Status ComponentsStructure_SplitYUV2Component(const uint8_t* const YUV, uint8_t** Y,
                                                   uint8_t** U, uint8_t** V, uint32_t width,
-                                                  uint32_t height, uint32_t img_size,
+                                                  uint32_t height, size_t img_size,
                                                   YUV_Type yuv_type)
 {
-
-    *Y = malloc(width*height                                   * sizeof ( uint8_t ));
-    *U = malloc((width / 2) * ((int32_t)yuv_type*height / 2) * sizeof ( uint8_t ));
-    *V = malloc((width / 2) * ((int32_t)yuv_type*height / 2) * sizeof ( uint8_t ));
+    const YuvFormat* format = YuvFormat_Get(yuv_type);
+    uint32_t bytes_per_sample = (NULL == format) ? 1U : format->bytes_per_sample;
+    size_t chroma_size = (size_t)YuvFormat_GetChromaWidth(width, yuv_type) *
+                         YuvFormat_GetChromaHeight(height, yuv_type);
+
+    *Y = malloc((size_t)width * height * bytes_per_sample);
+    *U = malloc(chroma_size * bytes_per_sample);
+    *V = malloc(chroma_size * bytes_per_sample);
     LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
 
-    if(NULL == YUV || NULL == *U || NULL == *V || NULL == *Y)
+    if(NULL == YUV || NULL == *U || NULL == *V || NULL == *Y ||
+       YuvFormat_ValidateSize(format, width, height) ||
+       img_size < YuvFormat_GetFrameSize(width, height, yuv_type))
     {
         status = LDC_STATUS_ERROR;
     }
     else
     {
-        /*   YUV420 nv12   , has 12bpp, and U V components are INTERLEAVED!
-             YUV422i UYVY , has 16bpp, and Y U V components are INTERLEAVED!
-        */
-        uint32_t i;
-        uint32_t j;
-        uint32_t k;
-
-        if(YUV420_NV12 == yuv_type)
-        {
-            /* Create Y component! */
-            memcpy(*Y, YUV, width*height);
-
-            for(i = 0, j = 0;i < width * height / 2;i+=2)
-            {
-                (*U)[j]   = YUV[width * height + i];
-                (*V)[j++] = YUV[width * height + i + 1];
-            }
-        }
-        else if(YUV422I_UYVY == yuv_type)
-        {
-            for(i = 0, j = 0,k = 0;i < img_size;i+=2)
-            {
-                (*Y)[j++]   = YUV[i + 1];
-
-                if(!(i % 4))
-                {
-                    (*U)[k]     = YUV[i];
-                    (*V)[k++]   = YUV[i + 2];
-                }
-            }
-
-        }
-        else
-        {
-            status =  LDC_STATUS_ERROR;
-        }
-
+        /* Layout of planes, and interleaving of components, is described by format. */
+        YuvFormat_Split(format, YUV, *Y, *U, *V, width, height);
     }
 
     return status;
@@ -656,53 +1190,22 @@ LDC_Status ComponentsStructure_SplitYUV2Component(const uint8_t* const YUV, uint
 LDC_Status ComponentsStructure_CombineYUVComponents(uint8_t* const YUV_out, const uint8_t* const Y,
                                                     const uint8_t* const U, const uint8_t* const V,
                                                     uint32_t width, uint32_t height,
-                                                    uint32_t img_size, YUV_Type yuv_type)
+                                                    size_t img_size, YUV_Type yuv_type)
 {
     LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    const YuvFormat* format = YuvFormat_Get(yuv_type);
 
-    if(NULL == YUV_out || NULL == U || NULL == V|| NULL == Y)
+    if(NULL == YUV_out || NULL == U || NULL == V|| NULL == Y ||
+       YuvFormat_ValidateSize(format, width, height) ||
+       img_size < YuvFormat_GetFrameSize(width, height, yuv_type))
     {
         status = LDC_STATUS_ERROR;
     }
     else
     {
-
         /* Create one YUV frame, with Y, U and V components. */
-        uint32_t i;
-        uint32_t j;
-        uint32_t k;
-
-        if(YUV420_NV12 == yuv_type)
-        {
-            memcpy(YUV_out, Y, width*height);
-
-            for(i = 0, j = 0;i < width * height / 2;i+=2)
-            {
-                YUV_out[width * height + i]      = U[j];
-                YUV_out[width * height + i + 1]  = V[j++];
-            }
-        }
-        else if(YUV422I_UYVY == yuv_type)
-        {
-            for(i = 0, j = 0, k = 0;i < img_size;i+=2)
-            {
-                YUV_out[i+1] = Y[j++];
-
-                if(!(i % 4))
-                {
-                    YUV_out[i] = U[k];
-                    YUV_out[i + 2] = V[k++];
-                }
-            }
-
-        }
-        else
-        {
-            status = LDC_STATUS_ERROR;
-        }
-
+        YuvFormat_Combine(format, YUV_out, Y, U, V, width, height);
     }
 
     return status;
 }
-
@@ -27,47 +27,95 @@ extern "C" {
 #include <stdio.h>
 
 #include "../lib/ldc_types.h"
+#include "../lib/yuv_format.h"
+#include "../fast_map/fast_map.h"
+#include "../lens_registry/lens_registry.h"
+#include "../worker_pool/worker_pool.h"
 
 /* ============================================================================================== */
 /*                                     Macros & Typedefs                                          */
 /* ============================================================================================== */
 
-#define min(X,Y) ((X) < (Y) ? (X) : (Y))    /* min/max macros. */
-#define max(X,Y) ((X) > (Y) ? (X) : (Y))
-#define ABS(x) ((x) < 0 ? -(x) : (x))       /* Double abs function.  */
+#define COMBINE_YUV_COMPONENTS_ERROR_MESSAGE (\
+    "Error, Unsuccesfull YUV combination of components.")
 
-#define PARAMETERS_FILE_OPENING_ERROR_MESSAGE (\
-    "Error opening parameters file.\n")
+#define PIXELS_POSITION_FILE_OPENING_ERROR_MESSAGE (\
+    "Error opening file to save pixels position.")
 
-#define LENS_PARAMETERS_FILE_READING_ERROR_MESSAGE (\
-    "Error while reading LENS cameara parameters, from parameters file.\n")
+#define INVALID_ROI_ERROR_MESSAGE (\
+    "Error, region of interest is empty or outside of frame.")
 
-#define COMBINE_YUV_COMPONENTS_ERROR_MESSAGE (\
-    "Error, Unsuccesfull YUV combination of components.\n")
+#define MAP_ROWS_PER_TASK (16U)                             /* Map rows, generated by one task.    */
 
-#define PIXELS_POSITION_FILE_OPENING_ERROR_MESSAGE (\
-    "Error opening file to save pixels position.\n")
+#define VALIDITY_MASK_STRIDE(width) (((width) + 7U) / 8U)   /* Bytes per row of validity mask. */
 
-#define MAX_NUM_OF_LENS_PARAMETER (180U)       /* FoV with 180 degrees. */
+/**
+ ***************************************************************************************************
+ *
+ * \typedef LDC_OutputSpec
+ *
+ * \brief   Structure which represents resolution and placement of output frame, when it differs
+ *          from source frame. Output pixel (x, y) samples corrected source plane at position
+ *          centre + (pixel - output centre) * scale.
+ *
+ ***************************************************************************************************
+ */
+typedef struct
+{
+    uint32_t width;             /* Width of output frame.                                     */
+    uint32_t height;            /* Height of output frame.                                    */
+    double scale;               /* Source pixels per output pixel, 0 for same horizontal FoV. */
+    double centre_x;            /* Horizontal position of output centre in source frame.      */
+    double centre_y;            /* Vertical position of output centre in source frame.        */
+    uint32_t use_centre;        /* Use centre_x/centre_y, instead of centre of source frame.  */
+}LDC_OutputSpec;
 
 /**
  ***************************************************************************************************
  *
- * \typedef LensSpec
+ * \typedef LDC_Span
  *
- * \brief   Structure which represents specification of lens.
+ * \brief   Structure which represents contiguous run of output pixels, with valid source pixels.
  *
  ***************************************************************************************************
  */
 typedef struct
 {
-    double angle[MAX_NUM_OF_LENS_PARAMETER];    /* Array of field angle view in degree.  */
-    double height[MAX_NUM_OF_LENS_PARAMETER];   /* Array of image height in mm.          */
-    uint32_t num_of_useful_elements;            /* Number of elements previous arrays.   */
-    double focal_length_in_mm;                  /* Camera focal length in mm.            */
-    double sensor_pixel_pitch_in_mm;            /* Sensor pixel pitch in mm.             */
-    double scaling_factor;                      /* Image scaling factor.                 */
-}LensSpec;
+    uint32_t start;             /* First pixel of span.           */
+    uint32_t end;               /* One past last pixel of span.   */
+}LDC_Span;
+
+/**
+ ***************************************************************************************************
+ *
+ * \typedef LDC_Map
+ *
+ * \brief   Structure which represents back mapping of output pixels to source pixel positions.
+ *          Positions are stored row by row, and only entries inside regions of interest are
+ *          computed. Spans of valid positions of row y are spans[row_spans[y]] up to
+ *          spans[row_spans[y + 1]], sorted and not overlapping.
+ *
+ ***************************************************************************************************
+ */
+typedef struct
+{
+    uint32_t width;             /* Width of output frame.                             */
+    uint32_t height;            /* Height of output frame.                            */
+    uint32_t src_width;         /* Width of source frame.                             */
+    uint32_t src_height;        /* Height of source frame.                            */
+    double scale;               /* Source pixels per output pixel.                    */
+    double centre_x;            /* Horizontal position of output centre in source.    */
+    double centre_y;            /* Vertical position of output centre in source.      */
+    float* h_d;                 /* Horizontal source position of every output pixel.  */
+    float* v_d;                 /* Vertical source position of every output pixel.    */
+    LDC_Roi* rois;              /* Regions of interest that are computed.             */
+    uint32_t num_of_rois;       /* Number of regions of interest.                     */
+    uint32_t* row_spans;        /* Index of first span of every row, height + 1.      */
+    LDC_Span* spans;            /* Spans of valid positions, of all rows.             */
+    uint32_t num_of_spans;      /* Number of spans.                                   */
+    uint32_t first_row;         /* Output row of map row 0, for map of strip.         */
+    uint32_t frame_height;      /* Height of whole output frame, that map is part of. */
+}LDC_Map;
 
 /* ============================================================================================== */
 /*                              Internal Helper Functions                                         */
@@ -97,6 +145,236 @@ LDC_Status WriteOperation_WritePixelsPositions2File(const char* const filename,
 /*                                     Function Declarations                                      */
 /* ============================================================================================== */
 
+/**
+ ***************************************************************************************************
+ *
+ * \fn     FrameCorrection_ValidateRois
+ *
+ * \brief  Check that regions of interest are not empty, and that they are inside of frame.
+ *
+ * \param  [In]  width        Width of frame.
+ * \param  [In]  height       Height of frame.
+ * \param  [In]  rois         Regions of interest.
+ * \param  [In]  num_of_rois  Number of regions of interest, at least one.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status FrameCorrection_ValidateRois(uint32_t width, uint32_t height,
+                                        const LDC_Roi* const rois, uint32_t num_of_rois);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     FrameCorrection_AllocateMap
+ *
+ * \brief  Allocate map, and set its output frame and regions of interest, without computing
+ *         positions. Map builders fill positions inside regions, and then call
+ *         FrameCorrection_UpdateSpans.
+ *
+ * \param  [Out] map          Allocated map. Has to be released with FrameCorrection_FreeMap.
+ * \param  [In]  width        Width of source frame.
+ * \param  [In]  height       Height of source frame.
+ * \param  [In]  output       Output frame specification, or NULL for output same as source.
+ * \param  [In]  rois         Regions of interest in output frame, or NULL for whole frame.
+ * \param  [In]  num_of_rois  Number of regions of interest.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status FrameCorrection_AllocateMap(LDC_Map* map, uint32_t width, uint32_t height,
+                                       const LDC_OutputSpec* const output,
+                                       const LDC_Roi* const rois, uint32_t num_of_rois);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     FrameCorrection_UpdateSpans
+ *
+ * \brief  Record spans of valid positions inside regions of map, after positions are changed.
+ *
+ * \param  [In]  map          Map with computed positions.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status FrameCorrection_UpdateSpans(LDC_Map* map);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     FrameCorrection_GenerateMap
+ *
+ * \brief  Generate back mapping of output pixels to positions of distorted source pixels.
+ *         Only map entries inside regions of interest are computed, so cost of generation
+ *         depends on area of regions, not on area of frame. Positions are computed in single
+ *         precision with SIMD, within FAST_MAP_MAX_COORDINATE_ERROR of reference map.
+ *
+ * \param  [Out] map          Generated map. Has to be released with FrameCorrection_FreeMap.
+ * \param  [In]  width        Width of source frame.
+ * \param  [In]  height       Height of source frame.
+ * \param  [In]  output       Output frame specification, or NULL for output same as source.
+ * \param  [In]  rois         Regions of interest in output frame, or NULL for whole frame.
+ * \param  [In]  num_of_rois  Number of regions of interest.
+ * \param  [In]  lens         Lens profile, see LensProfile_LoadFile and LensRegistry_Acquire.
+ * \param  [In]  pool         Worker pool that generates bands of rows in parallel, or NULL.
+ *                            Map is same for any number of threads.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status FrameCorrection_GenerateMap(LDC_Map* map, uint32_t width, uint32_t height,
+                                       const LDC_OutputSpec* const output,
+                                       const LDC_Roi* const rois, uint32_t num_of_rois,
+                                       const LensProfile* const lens, WorkerPool* pool);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     FrameCorrection_GenerateReferenceMap
+ *
+ * \brief  Generate back mapping of output pixels to positions of distorted source pixels.
+ *         Only map entries inside regions of interest are computed, so cost of generation
+ *         depends on area of regions, not on area of frame. Positions are computed in double
+ *         precision with libm, exactly as lens parameter table defines them.
+ *
+ * \param  [Out] map          Generated map. Has to be released with FrameCorrection_FreeMap.
+ * \param  [In]  width        Width of source frame.
+ * \param  [In]  height       Height of source frame.
+ * \param  [In]  output       Output frame specification, or NULL for output same as source.
+ * \param  [In]  rois         Regions of interest in output frame, or NULL for whole frame.
+ * \param  [In]  num_of_rois  Number of regions of interest.
+ * \param  [In]  lens         Lens profile, see LensProfile_LoadFile and LensRegistry_Acquire.
+ * \param  [In]  pool         Worker pool that generates bands of rows in parallel, or NULL.
+ *                            Map is same for any number of threads.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status FrameCorrection_GenerateReferenceMap(LDC_Map* map, uint32_t width, uint32_t height,
+                                                const LDC_OutputSpec* const output,
+                                                const LDC_Roi* const rois, uint32_t num_of_rois,
+                                                const LensProfile* const lens, WorkerPool* pool);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     FrameCorrection_GenerateStripMap
+ *
+ * \brief  Generate map of output rows [first_row, first_row + num_of_rows) of output frame.
+ *         Map has num_of_rows rows, and its positions are exactly same as positions of those
+ *         rows in map of whole frame, generated with FrameCorrection_GenerateMap.
+ *
+ * \param  [Out] map          Generated map. Has to be released with FrameCorrection_FreeMap.
+ * \param  [In]  width        Width of source frame.
+ * \param  [In]  height       Height of source frame.
+ * \param  [In]  output       Output frame specification, or NULL for output same as source.
+ * \param  [In]  first_row    First output row of strip.
+ * \param  [In]  num_of_rows  Output rows of strip.
+ * \param  [In]  rois         Regions of interest in strip, or NULL for whole strip.
+ * \param  [In]  num_of_rois  Number of regions of interest.
+ * \param  [In]  lens         Lens profile, see LensProfile_LoadFile and LensRegistry_Acquire.
+ * \param  [In]  pool         Worker pool that generates bands of rows in parallel, or NULL.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status FrameCorrection_GenerateStripMap(LDC_Map* map, uint32_t width, uint32_t height,
+                                            const LDC_OutputSpec* const output,
+                                            uint32_t first_row, uint32_t num_of_rows,
+                                            const LDC_Roi* const rois, uint32_t num_of_rois,
+                                            const LensProfile* const lens, WorkerPool* pool);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     FrameCorrection_GetMapMaxError
+ *
+ * \brief  Get maximal difference of source positions between map and reference map, over all
+ *         positions that are valid in reference map.
+ *
+ * \param  [In]  map          Map to check.
+ * \param  [In]  reference    Reference map, with same dimensions and regions.
+ * \param  [Out] max_error    Maximal horizontal or vertical difference, in pixels.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status FrameCorrection_GetMapMaxError(const LDC_Map* const map,
+                                          const LDC_Map* const reference, double* max_error);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     FrameCorrection_ApplyMap
+ *
+ * \brief  Remap Y, U, V components of frame, with previously generated map. Only output pixels
+ *         inside regions of interest are written, other pixels are left untouched. Pixels
+ *         without valid source pixel are set to border colour.
+ *
+ * \param  [In]  map          Map generated with FrameCorrection_GenerateMap.
+ * \param  [Out] Y_out        Y component of undistorted frame, with resolution of map output.
+ * \param  [Out] U_out        U component of undistorted frame, with resolution of map output.
+ * \param  [Out] V_out        V component of undistorted frame, with resolution of map output.
+ * \param  [In]  Y            Y component of YUV frame, with resolution of map source.
+ * \param  [In]  U            U component of YUV frame, with resolution of map source.
+ * \param  [In]  V            V component of YUV frame, with resolution of map source.
+ * \param  [In]  yuv_type     Type of YUV image.
+ * \param  [In]  rois         Regions of interest, or NULL for all regions computed in map.
+ *                            Every region has to be covered by regions computed in map.
+ * \param  [In]  num_of_rois  Number of regions of interest.
+ * \param  [In]  border       Border colour, or NULL to leave pixels without source untouched.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status FrameCorrection_ApplyMap(const LDC_Map* const map, uint8_t* const Y_out,
+                                    uint8_t* const U_out, uint8_t* const V_out,
+                                    const uint8_t* const Y, const uint8_t* const U,
+                                    const uint8_t* const V, YUV_Type yuv_type,
+                                    const LDC_Roi* const rois, uint32_t num_of_rois,
+                                    const LDC_Color* const border);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     FrameCorrection_GetValidityMask
+ *
+ * \brief  Generate 1-bit mask of output pixels, that have valid source pixel. Bit x % 8 of byte
+ *         y * VALIDITY_MASK_STRIDE(width) + x / 8 is set, when pixel (x, y) is valid.
+ *
+ * \param  [In]  map          Map generated with FrameCorrection_GenerateMap.
+ * \param  [Out] mask         Validity mask, of height * VALIDITY_MASK_STRIDE(width) bytes.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status FrameCorrection_GetValidityMask(const LDC_Map* const map, uint8_t* const mask);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     FrameCorrection_FreeMap
+ *
+ * \brief  Release memory of generated map.
+ *
+ * \param  [In]  map          Map generated with FrameCorrection_GenerateMap.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void FrameCorrection_FreeMap(LDC_Map* map);
+
 /**
  ***************************************************************************************************
  *
@@ -104,7 +382,7 @@ LDC_Status WriteOperation_WritePixelsPositions2File(const char* const filename,
  *
  * \brief  Generate YUV image without distortion.
  *
- * \param  [Out] YUV_out      Undistorted YUV frame.
+ * \param  [Out] YUV_out      Undistorted YUV frame, with output resolution.
  * \param  [In]  Y            Y component of YUV frame.
  * \param  [In]  U            U component of YUV frame.
  * \param  [In]  V            V component of YUV frame.
@@ -112,7 +390,15 @@ LDC_Status WriteOperation_WritePixelsPositions2File(const char* const filename,
  * \param  [In]  width        Width of frame.
  * \param  [In]  height       Height of frame.
  * \param  [In]  yuv_type     Type of YUV image.
- * \param  [In]  filename     Lens parameter CSV filename
+ * \param  [In]  lens         Lens profile, see LensProfile_LoadFile and LensProfile_LoadModel.
+ * \param  [In]  output       Output frame specification, or NULL for output same as input.
+ * \param  [In]  rois         Regions of interest, or NULL for whole frame. Pixels outside of
+ *                            regions are set to zero.
+ * \param  [In]  num_of_rois  Number of regions of interest.
+ * \param  [In]  border       Colour of pixels without valid source pixel.
+ * \param  [In]  interpolation  Sampling of source frame.
+ * \param  [Out] mask         Validity mask of output frame (see FrameCorrection_GetValidityMask),
+ *                            or NULL when mask is not needed.
  *
  * \return LDC_Status   Exit status.
  *
@@ -120,11 +406,33 @@ LDC_Status WriteOperation_WritePixelsPositions2File(const char* const filename,
  */
 LDC_Status FrameCorrection_CorrectLensDistortion(uint8_t** YUV_out, const uint8_t* const Y,
                                                  const uint8_t* const U, const uint8_t* const V,
-                                                 uint32_t img_size, uint32_t width,
+                                                 size_t img_size, uint32_t width,
                                                  uint32_t height, YUV_Type yuv_type,
-                                                 const char* const filename);
+                                                 const LensProfile* const lens,
+                                                 const LDC_OutputSpec* const output,
+                                                 const LDC_Roi* const rois, uint32_t num_of_rois,
+                                                 const LDC_Color* const border,
+                                                 LDC_Interpolation interpolation,
+                                                 uint8_t* const mask);
 
 
+/**
+ ***************************************************************************************************
+ *
+ * \fn     ComponentsStructure_GetFrameSize
+ *
+ * \brief  Get size of YUV frame in bytes.
+ *
+ * \param  [In]  width        Width of image.
+ * \param  [In]  height       Height of image.
+ * \param  [In]  yuv_type     Type of YUV image.
+ *
+ * \return size_t       Size of frame.
+ *
+ ***************************************************************************************************
+ */
+size_t ComponentsStructure_GetFrameSize(uint32_t width, uint32_t height, YUV_Type yuv_type);
+
 /**
  ***************************************************************************************************
  *
@@ -147,7 +455,7 @@ LDC_Status FrameCorrection_CorrectLensDistortion(uint8_t** YUV_out, const uint8_
  */
 LDC_Status ComponentsStructure_SplitYUV2Component(const uint8_t* const YUV, uint8_t** Y,
                                                   uint8_t** U, uint8_t** V, uint32_t width,
-                                                  uint32_t height, uint32_t img_size,
+                                                  uint32_t height, size_t img_size,
                                                   YUV_Type yuv_type);
 
 
@@ -175,7 +483,7 @@ LDC_Status ComponentsStructure_SplitYUV2Component(const uint8_t* const YUV, uint
 LDC_Status ComponentsStructure_CombineYUVComponents(uint8_t* const YUV_out, const uint8_t* const Y,
                                                     const uint8_t* const U, const uint8_t* const V,
                                                     uint32_t width, uint32_t height,
-                                                    uint32_t img_size, YUV_Type yuv_type);
+                                                    size_t img_size, YUV_Type yuv_type);
 
 
 #ifdef __cplusplus
@@ -0,0 +1,620 @@
+/**
+ ***************************************************************************************************
+ *
+ * \file  dirty_remap.c
+ *
+ * \brief This file contains API of incremental correction, with SIMD (AVX2/SSE2) and scalar
+ *        comparison of source blocks.
+ *
+ * \arg author:  Dejan Milojica
+ * \arg version: 1.2
+ * \arg date:    13.01.2021
+ *
+ ***************************************************************************************************
+ */
+
+/* ============================================================================================== */
+/*                                       Include Files                                            */
+/* ============================================================================================== */
+
+#include "dirty_remap.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "../lib/ldc_log.h"
+#include "../lib/ldc_internal.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define DIRTY_REMAP_X86 (1)
+#include <immintrin.h>
+#endif
+
+/* ============================================================================================== */
+/*                                       Global variables                                         */
+/* ============================================================================================== */
+
+#define DIRTY_REMAP_EMPTY (0xFFFFFFFFU)         /* Tile without valid pixels.                  */
+
+/* ============================================================================================== */
+/*                              Internal Helper Functions                                         */
+/* ============================================================================================== */
+
+static void DirtyRemap_CompareRowScalar(const uint8_t* const a, const uint8_t* const b,
+                                        uint32_t size, uint32_t block_bytes, uint8_t* changed)
+{
+    uint32_t start;
+    uint32_t k;
+
+    for(start = 0, k = 0;start < size;start += block_bytes, k++)
+    {
+        if(!changed[k])
+        {
+            changed[k] = (0 != memcmp(a + start, b + start, LDC_MIN(block_bytes, size - start)));
+        }
+    }
+}
+
+#ifdef DIRTY_REMAP_X86
+__attribute__((target("sse2")))
+static void DirtyRemap_CompareRowSSE2(const uint8_t* const a, const uint8_t* const b,
+                                      uint32_t size, uint32_t block_bytes, uint8_t* changed)
+{
+    uint32_t start;
+    uint32_t k;
+
+    for(start = 0, k = 0;start < size;start += block_bytes, k++)
+    {
+        uint32_t end = LDC_MIN(start + block_bytes, size);
+        uint32_t i = start;
+        __m128i diff = _mm_setzero_si128();
+        uint32_t differ;
+
+        if(changed[k])
+        {
+            continue;
+        }
+
+        for(;i + 16U <= end;i += 16U)
+        {
+            diff = _mm_or_si128(diff, _mm_xor_si128(_mm_loadu_si128((const __m128i*)(a + i)),
+                                                    _mm_loadu_si128((const __m128i*)(b + i))));
+        }
+
+        differ = (0xFFFF != _mm_movemask_epi8(_mm_cmpeq_epi8(diff, _mm_setzero_si128())));
+
+        for(;i < end;i++)
+        {
+            differ |= (a[i] != b[i]);
+        }
+
+        changed[k] = (uint8_t)differ;
+    }
+}
+
+__attribute__((target("avx2")))
+static void DirtyRemap_CompareRowAVX2(const uint8_t* const a, const uint8_t* const b,
+                                      uint32_t size, uint32_t block_bytes, uint8_t* changed)
+{
+    uint32_t start;
+    uint32_t k;
+
+    for(start = 0, k = 0;start < size;start += block_bytes, k++)
+    {
+        uint32_t end = LDC_MIN(start + block_bytes, size);
+        uint32_t i = start;
+        __m256i diff = _mm256_setzero_si256();
+        __m128i half;
+        uint32_t differ;
+
+        if(changed[k])
+        {
+            continue;
+        }
+
+        for(;i + 32U <= end;i += 32U)
+        {
+            diff = _mm256_or_si256(diff,
+                                   _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(a + i)),
+                                                    _mm256_loadu_si256((const __m256i*)(b + i))));
+        }
+
+        /* Chroma blocks of 8 bit formats are 16 bytes. */
+        half = _mm_or_si128(_mm256_castsi256_si128(diff), _mm256_extracti128_si256(diff, 1));
+        if(i + 16U <= end)
+        {
+            half = _mm_or_si128(half, _mm_xor_si128(_mm_loadu_si128((const __m128i*)(a + i)),
+                                                    _mm_loadu_si128((const __m128i*)(b + i))));
+            i += 16U;
+        }
+
+        differ = !_mm_testz_si128(half, half);
+
+        for(;i < end;i++)
+        {
+            differ |= (a[i] != b[i]);
+        }
+
+        changed[k] = (uint8_t)differ;
+    }
+}
+#endif
+
+/* Mark blocks of component, with blocks of block_width x block_height samples. */
+static void DirtyRemap_ComparePlane(const DirtyRemap* const dirty, const uint8_t* const plane,
+                                    const uint8_t* const prev, uint32_t width, uint32_t height,
+                                    uint32_t block_width, uint32_t block_height)
+{
+    uint32_t bps = dirty->format->bytes_per_sample;
+    uint32_t y;
+
+    for(y = 0;y < height;y++)
+    {
+        size_t offset = (size_t)y * width * bps;
+
+        dirty->compare(plane + offset, prev + offset, width * bps, block_width * bps,
+                       &dirty->changed[(y / block_height) * dirty->blocks_x]);
+    }
+}
+
+/* Copy changed blocks of component into kept previous component. */
+static void DirtyRemap_CopyPlane(const DirtyRemap* const dirty, uint8_t* const prev,
+                                 const uint8_t* const plane, uint32_t width, uint32_t height,
+                                 uint32_t block_width, uint32_t block_height)
+{
+    uint32_t bps = dirty->format->bytes_per_sample;
+    uint32_t y;
+    uint32_t bx;
+
+    for(y = 0;y < height;y++)
+    {
+        const uint8_t* changed = &dirty->changed[(y / block_height) * dirty->blocks_x];
+        size_t row = (size_t)y * width;
+
+        for(bx = 0;bx < dirty->blocks_x;bx++)
+        {
+            if(changed[bx])
+            {
+                uint32_t x = bx * block_width;
+                size_t offset = (row + x) * bps;
+
+                memcpy(prev + offset, plane + offset, LDC_MIN(block_width, width - x) * bps);
+            }
+        }
+    }
+}
+
+/* Compute source block range of every output tile, from positions of valid pixels. */
+static LDC_Status DirtyRemap_ComputeTileBlocks(DirtyRemap* dirty, uint32_t tiles_y)
+{
+    const LDC_Map* map = dirty->plan->map;
+    uint32_t num_of_tiles = dirty->tiles_x * tiles_y;
+    float* bounds = (float*)malloc(sizeof(float) * 4U * num_of_tiles);
+    uint32_t t;
+    uint32_t y;
+    uint32_t i;
+
+    if(NULL == bounds)
+    {
+        return LDC_STATUS_OUT_OF_MEMORY;
+    }
+
+    for(t = 0;t < num_of_tiles;t++)
+    {
+        bounds[4U * t] = (float)map->src_width;
+        bounds[4U * t + 1U] = (float)map->src_height;
+        bounds[4U * t + 2U] = -1.0f;
+        bounds[4U * t + 3U] = -1.0f;
+    }
+
+    for(y = 0;y < map->height;y++)
+    {
+        float* row_bounds = &bounds[4U * (y / dirty->tile_size) * dirty->tiles_x];
+
+        for(i = map->row_spans[y];i < map->row_spans[y + 1];i++)
+        {
+            uint32_t x;
+
+            for(x = map->spans[i].start;x < map->spans[i].end;x++)
+            {
+                float* tile = &row_bounds[4U * (x / dirty->tile_size)];
+                float h = map->h_d[(size_t)y * map->width + x];
+                float v = map->v_d[(size_t)y * map->width + x];
+
+                tile[0] = LDC_MIN(tile[0], h);
+                tile[1] = LDC_MIN(tile[1], v);
+                tile[2] = LDC_MAX(tile[2], h);
+                tile[3] = LDC_MAX(tile[3], v);
+            }
+        }
+    }
+
+    for(t = 0;t < num_of_tiles;t++)
+    {
+        const float* tile = &bounds[4U * t];
+        uint32_t* blocks = &dirty->tile_blocks[4U * t];
+
+        if(tile[2] < 0.0f)
+        {
+            blocks[0] = DIRTY_REMAP_EMPTY;
+        }
+        else
+        {
+            int32_t x0 = (int32_t)floorf(tile[0]) - (int32_t)DIRTY_REMAP_MARGIN;
+            int32_t y0 = (int32_t)floorf(tile[1]) - (int32_t)DIRTY_REMAP_MARGIN;
+            int32_t x1 = (int32_t)floorf(tile[2]) + (int32_t)DIRTY_REMAP_MARGIN;
+            int32_t y1 = (int32_t)floorf(tile[3]) + (int32_t)DIRTY_REMAP_MARGIN;
+
+            x1 = LDC_MIN(x1, (int32_t)map->src_width - 1);
+            y1 = LDC_MIN(y1, (int32_t)map->src_height - 1);
+            blocks[0] = (uint32_t)LDC_MAX(x0, 0) / dirty->block_size;
+            blocks[1] = (uint32_t)LDC_MAX(y0, 0) / dirty->block_size;
+            blocks[2] = (uint32_t)LDC_MAX(x1, 0) / dirty->block_size;
+            blocks[3] = (uint32_t)LDC_MAX(y1, 0) / dirty->block_size;
+        }
+    }
+
+    free(bounds);
+
+    return LDC_STATUS_OK;
+}
+
+/* Split map regions into tiles, aligned to tile grid of output frame. */
+static uint32_t DirtyRemap_SplitRegions(DirtyRemap* dirty, uint32_t store)
+{
+    const LDC_Map* map = dirty->plan->map;
+    uint32_t size = dirty->tile_size;
+    uint32_t count = 0;
+    uint32_t r;
+
+    for(r = 0;r < map->num_of_rois;r++)
+    {
+        const LDC_Roi* roi = &map->rois[r];
+        uint32_t y;
+        uint32_t x;
+
+        for(y = roi->y;y < roi->y + roi->height;y = (y / size + 1U) * size)
+        {
+            for(x = roi->x;x < roi->x + roi->width;x = (x / size + 1U) * size)
+            {
+                if(store)
+                {
+                    LDC_Roi* region = &dirty->regions[count];
+
+                    region->x = x;
+                    region->y = y;
+                    region->width = LDC_MIN((x / size + 1U) * size, roi->x + roi->width) - x;
+                    region->height = LDC_MIN((y / size + 1U) * size, roi->y + roi->height) - y;
+                    dirty->region_tiles[count] = (y / size) * dirty->tiles_x + x / size;
+                }
+                count++;
+            }
+        }
+    }
+
+    return count;
+}
+
+/* Build summed area table of changed flags. */
+static void DirtyRemap_SumChanged(DirtyRemap* dirty)
+{
+    uint32_t stride = dirty->blocks_x + 1U;
+    uint32_t by;
+    uint32_t bx;
+
+    for(by = 0;by < dirty->blocks_y;by++)
+    {
+        uint32_t row = 0;
+
+        for(bx = 0;bx < dirty->blocks_x;bx++)
+        {
+            row += dirty->changed[by * dirty->blocks_x + bx];
+            dirty->changed_sum[(by + 1U) * stride + bx + 1U] =
+                dirty->changed_sum[by * stride + bx + 1U] + row;
+        }
+    }
+}
+
+static uint32_t DirtyRemap_IsTileDirty(const DirtyRemap* const dirty, uint32_t tile)
+{
+    const uint32_t* blocks = &dirty->tile_blocks[4U * tile];
+    const uint32_t* sum = dirty->changed_sum;
+    uint32_t stride = dirty->blocks_x + 1U;
+
+    if(DIRTY_REMAP_EMPTY == blocks[0])
+    {
+        return 0U;
+    }
+
+    return sum[(blocks[3] + 1U) * stride + blocks[2] + 1U] - sum[blocks[1] * stride +
+           blocks[2] + 1U] - sum[(blocks[3] + 1U) * stride + blocks[0]] +
+           sum[blocks[1] * stride + blocks[0]] > 0U;
+}
+
+/* ============================================================================================== */
+/*                                                                                                */
+/*                                       API Functions                                            */
+/*                                                                                                */
+/* ============================================================================================== */
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     DirtyRemap_Init
+ *
+ * \brief  Compute source block range of every output tile of plan map.
+ *
+ * \param  [Out] dirty        Created state. Has to be released with DirtyRemap_Deinit.
+ * \param  [In]  plan         Remap plan, that outlives state.
+ * \param  [In]  block_size   Source block in luma pixels, even, or 0 for default.
+ * \param  [In]  tile_size    Output tile in pixels, even, or 0 for default.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status DirtyRemap_Init(DirtyRemap* dirty, const Remap_Plan* const plan, uint32_t block_size,
+                           uint32_t tile_size)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    const LDC_Map* map;
+    uint32_t tiles_y;
+    uint32_t chroma_width;
+    uint32_t chroma_height;
+
+    memset(dirty, 0, sizeof(DirtyRemap));
+
+    block_size = (0U == block_size) ? DIRTY_REMAP_BLOCK_SIZE : block_size;
+    tile_size = (0U == tile_size) ? DIRTY_REMAP_TILE_SIZE : tile_size;
+
+    /* Even sizes keep chroma samples of block and of tile together. */
+    if(NULL == plan || NULL == plan->map || NULL == YuvFormat_Get(plan->yuv_type) ||
+       0U != block_size % 2U || 0U != tile_size % 2U)
+    {
+        LdcLog_Write(LDC_LOG_ERROR, LDC_STATUS_INVALID_ARGUMENT,
+                     "Invalid plan, block or tile size of incremental correction.");
+        return LDC_STATUS_INVALID_ARGUMENT;
+    }
+
+    map = plan->map;
+    dirty->plan = plan;
+    dirty->format = YuvFormat_Get(plan->yuv_type);
+    dirty->block_size = block_size;
+    dirty->blocks_x = (map->src_width + block_size - 1U) / block_size;
+    dirty->blocks_y = (map->src_height + block_size - 1U) / block_size;
+    dirty->tile_size = tile_size;
+    dirty->tiles_x = (map->width + tile_size - 1U) / tile_size;
+    dirty->full = 1U;
+    tiles_y = (map->height + tile_size - 1U) / tile_size;
+
+    chroma_width = YuvFormat_GetChromaWidth(map->src_width, plan->yuv_type);
+    chroma_height = YuvFormat_GetChromaHeight(map->src_height, plan->yuv_type);
+    dirty->luma_size = (size_t)map->src_width * map->src_height * dirty->format->bytes_per_sample;
+    dirty->chroma_size = (size_t)chroma_width * chroma_height * dirty->format->bytes_per_sample;
+
+    dirty->num_of_regions = DirtyRemap_SplitRegions(dirty, 0U);
+    dirty->changed = (uint8_t*)malloc(dirty->blocks_x * dirty->blocks_y);
+    dirty->changed_sum = (uint32_t*)calloc((dirty->blocks_x + 1U) * (dirty->blocks_y + 1U),
+                                           sizeof(uint32_t));
+    dirty->tile_blocks = (uint32_t*)malloc(sizeof(uint32_t) * 4U * dirty->tiles_x * tiles_y);
+    dirty->regions = (LDC_Roi*)malloc(sizeof(LDC_Roi) * LDC_MAX(dirty->num_of_regions, 1U));
+    dirty->region_tiles = (uint32_t*)malloc(sizeof(uint32_t) *
+                                            LDC_MAX(dirty->num_of_regions, 1U));
+    dirty->dirty = (LDC_Roi*)malloc(sizeof(LDC_Roi) * LDC_MAX(dirty->num_of_regions, 1U));
+
+    if(NULL == dirty->changed || NULL == dirty->changed_sum || NULL == dirty->tile_blocks ||
+       NULL == dirty->regions || NULL == dirty->region_tiles || NULL == dirty->dirty)
+    {
+        status = LDC_STATUS_OUT_OF_MEMORY;
+    }
+    else
+    {
+        DirtyRemap_SplitRegions(dirty, 1U);
+        status = DirtyRemap_ComputeTileBlocks(dirty, tiles_y);
+    }
+
+    if(LDC_STATUS_OK != status)
+    {
+        LdcLog_Write(LDC_LOG_ERROR, LDC_STATUS_OUT_OF_MEMORY,
+                     "Memory allocation of incremental correction failed.");
+        DirtyRemap_Deinit(dirty);
+        return LDC_STATUS_OUT_OF_MEMORY;
+    }
+
+    /* Comparison is selected once, as kernels of remap. */
+    dirty->compare = DirtyRemap_CompareRowScalar;
+#ifdef DIRTY_REMAP_X86
+    if(__builtin_cpu_supports("avx2"))
+    {
+        dirty->compare = DirtyRemap_CompareRowAVX2;
+    }
+    else if(__builtin_cpu_supports("sse2"))
+    {
+        dirty->compare = DirtyRemap_CompareRowSSE2;
+    }
+#endif
+
+    return status;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     DirtyRemap_Apply
+ *
+ * \brief  Correct frame incrementally. First frame, and frame after DirtyRemap_Reset, is
+ *         remapped whole. Later frames are compared with previous source frame, and only
+ *         output tiles whose source blocks changed are remapped. Output components have to
+ *         hold previous output of this state, and border colour has to be same as before.
+ *
+ * \param  [In]  dirty        State of incremental correction.
+ * \param  [Out] Y_out        Y component of output frame, with previous output.
+ * \param  [Out] U_out        U component of output frame, with previous output.
+ * \param  [Out] V_out        V component of output frame, with previous output.
+ * \param  [In]  Y            Y component of source frame.
+ * \param  [In]  U            U component of source frame.
+ * \param  [In]  V            V component of source frame.
+ * \param  [In]  Y_prev       Y component of previous source frame, or NULL, when state keeps
+ *                            copy of previous source frame.
+ * \param  [In]  U_prev       U component of previous source frame, or NULL.
+ * \param  [In]  V_prev       V component of previous source frame, or NULL.
+ * \param  [In]  border       Border colour, or NULL to leave pixels without source untouched.
+ * \param  [Out] num_of_dirty Number of remapped regions, or NULL.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status DirtyRemap_Apply(DirtyRemap* dirty, uint8_t* const Y_out, uint8_t* const U_out,
+                            uint8_t* const V_out, const uint8_t* const Y,
+                            const uint8_t* const U, const uint8_t* const V,
+                            const uint8_t* const Y_prev, const uint8_t* const U_prev,
+                            const uint8_t* const V_prev, const LDC_Color* const border,
+                            uint32_t* num_of_dirty)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    const LDC_Map* map;
+    uint32_t keep = (NULL == Y_prev);
+    uint32_t chroma_width;
+    uint32_t chroma_height;
+    uint32_t block_width;
+    uint32_t block_height;
+    uint32_t count = 0;
+    uint32_t r;
+
+    if(NULL == dirty || NULL == dirty->plan || NULL == Y || NULL == U || NULL == V ||
+       (!keep && (NULL == U_prev || NULL == V_prev)))
+    {
+        LdcLog_Write(LDC_LOG_ERROR, LDC_STATUS_INVALID_ARGUMENT,
+                     "Invalid arguments of incremental correction.");
+        return LDC_STATUS_INVALID_ARGUMENT;
+    }
+
+    map = dirty->plan->map;
+
+    /* Kept copy is stale, after frames with previous source frame of caller. */
+    if(!keep && NULL != dirty->Y_prev)
+    {
+        free(dirty->Y_prev);
+        dirty->Y_prev = NULL;
+        dirty->U_prev = NULL;
+        dirty->V_prev = NULL;
+    }
+
+    if(keep && NULL == dirty->Y_prev)
+    {
+        dirty->Y_prev = (uint8_t*)malloc(dirty->luma_size + 2U * dirty->chroma_size);
+        if(NULL == dirty->Y_prev)
+        {
+            LdcLog_Write(LDC_LOG_ERROR, LDC_STATUS_OUT_OF_MEMORY,
+                         "Memory allocation of incremental correction failed.");
+            return LDC_STATUS_OUT_OF_MEMORY;
+        }
+        dirty->U_prev = dirty->Y_prev + dirty->luma_size;
+        dirty->V_prev = dirty->U_prev + dirty->chroma_size;
+        dirty->full = 1U;
+    }
+
+    if(dirty->full)
+    {
+        status = Remap_ApplyPlan(dirty->plan, Y_out, U_out, V_out, Y, U, V, NULL, 0, border);
+        count = dirty->num_of_regions;
+
+        if(LDC_STATUS_OK == status && keep)
+        {
+            memcpy(dirty->Y_prev, Y, dirty->luma_size);
+            memcpy(dirty->U_prev, U, dirty->chroma_size);
+            memcpy(dirty->V_prev, V, dirty->chroma_size);
+        }
+        dirty->full = (LDC_STATUS_OK != status);
+    }
+    else
+    {
+        chroma_width = YuvFormat_GetChromaWidth(map->src_width, dirty->plan->yuv_type);
+        chroma_height = YuvFormat_GetChromaHeight(map->src_height, dirty->plan->yuv_type);
+        block_width = dirty->block_size >> dirty->format->chroma_shift_x;
+        block_height = dirty->block_size >> dirty->format->chroma_shift_y;
+
+        memset(dirty->changed, 0, dirty->blocks_x * dirty->blocks_y);
+        DirtyRemap_ComparePlane(dirty, Y, keep ? dirty->Y_prev : Y_prev, map->src_width,
+                                map->src_height, dirty->block_size, dirty->block_size);
+        DirtyRemap_ComparePlane(dirty, U, keep ? dirty->U_prev : U_prev, chroma_width,
+                                chroma_height, block_width, block_height);
+        DirtyRemap_ComparePlane(dirty, V, keep ? dirty->V_prev : V_prev, chroma_width,
+                                chroma_height, block_width, block_height);
+        DirtyRemap_SumChanged(dirty);
+
+        for(r = 0;r < dirty->num_of_regions;r++)
+        {
+            if(DirtyRemap_IsTileDirty(dirty, dirty->region_tiles[r]))
+            {
+                dirty->dirty[count++] = dirty->regions[r];
+            }
+        }
+
+        if(count > 0U)
+        {
+            status = Remap_ApplyPlan(dirty->plan, Y_out, U_out, V_out, Y, U, V, dirty->dirty,
+                                     count, border);
+        }
+
+        if(LDC_STATUS_OK == status && keep)
+        {
+            DirtyRemap_CopyPlane(dirty, dirty->Y_prev, Y, map->src_width, map->src_height,
+                                 dirty->block_size, dirty->block_size);
+            DirtyRemap_CopyPlane(dirty, dirty->U_prev, U, chroma_width, chroma_height,
+                                 block_width, block_height);
+            DirtyRemap_CopyPlane(dirty, dirty->V_prev, V, chroma_width, chroma_height,
+                                 block_width, block_height);
+        }
+    }
+
+    if(NULL != num_of_dirty)
+    {
+        *num_of_dirty = count;
+    }
+
+    return status;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     DirtyRemap_Reset
+ *
+ * \brief  Remap next frame whole, for example after output components or border are changed.
+ *
+ * \param  [In]  dirty        State of incremental correction.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void DirtyRemap_Reset(DirtyRemap* dirty)
+{
+    dirty->full = 1U;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     DirtyRemap_Deinit
+ *
+ * \brief  Release memory of state.
+ *
+ * \param  [In]  dirty        State of incremental correction.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void DirtyRemap_Deinit(DirtyRemap* dirty)
+{
+    free(dirty->changed);
+    free(dirty->changed_sum);
+    free(dirty->tile_blocks);
+    free(dirty->regions);
+    free(dirty->region_tiles);
+    free(dirty->dirty);
+    free(dirty->Y_prev);
+    memset(dirty, 0, sizeof(DirtyRemap));
+}
@@ -0,0 +1,177 @@
+/**
+ ***************************************************************************************************
+ *
+ * \file  dirty_remap.h
+ *
+ * \brief This file contains API of incremental correction of mostly static scenes. Source frame
+ *        is compared with previous source frame per block, and only output tiles whose source
+ *        area contains changed blocks are remapped again.
+ *
+ * \arg author:  Dejan Milojica
+ * \arg version: 1.2
+ * \arg date:    13.01.2021
+ *
+ ***************************************************************************************************
+ */
+
+#ifndef DIRTY_REMAP_H
+#define DIRTY_REMAP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================================== */
+/*                                       Include Files                                            */
+/* ============================================================================================== */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "../lib/ldc_types.h"
+#include "../lib/yuv_format.h"
+#include "../remap/remap.h"
+
+/* ============================================================================================== */
+/*                                     Macros & Typedefs                                          */
+/* ============================================================================================== */
+
+#define DIRTY_REMAP_BLOCK_SIZE (32U)            /* Default source block, in luma pixels.       */
+#define DIRTY_REMAP_TILE_SIZE (32U)             /* Default output tile, in pixels.             */
+#define DIRTY_REMAP_MARGIN (4U)                 /* Source pixels around positions of tile,     */
+                                                /* read by bilinear and chroma samples.        */
+
+/* Set changed flag of every block of row, whose bytes differ. */
+typedef void (*DirtyRemap_CompareRow)(const uint8_t* const a, const uint8_t* const b,
+                                      uint32_t size, uint32_t block_bytes, uint8_t* changed);
+
+/**
+ ***************************************************************************************************
+ *
+ * \typedef DirtyRemap
+ *
+ * \brief   Structure which represents state of incremental correction, for one remap plan.
+ *          Every output tile keeps range of source blocks, which contain source positions of
+ *          its pixels (with margin). Tile is remapped again only when one of its blocks has
+ *          changed, and other output pixels keep values of previous output frame.
+ *
+ ***************************************************************************************************
+ */
+typedef struct
+{
+    const Remap_Plan* plan;                     /* Remap plan, with its map.              */
+    const YuvFormat* format;                    /* Layout of components.                  */
+    uint32_t block_size;                        /* Source block, in luma pixels.          */
+    uint32_t blocks_x;                          /* Source blocks in row.                  */
+    uint32_t blocks_y;                          /* Source blocks in column.               */
+    uint8_t* changed;                           /* Changed flag of every source block.    */
+    uint32_t* changed_sum;                      /* Summed area table of changed flags.    */
+    uint32_t tile_size;                         /* Output tile, in pixels.                */
+    uint32_t tiles_x;                           /* Output tiles in row.                   */
+    uint32_t* tile_blocks;                      /* First and last block x, y of tiles.    */
+    LDC_Roi* regions;                           /* Tiles inside of map regions.           */
+    uint32_t* region_tiles;                     /* Tile of every region.                  */
+    uint32_t num_of_regions;                    /* Number of regions.                     */
+    LDC_Roi* dirty;                             /* Regions remapped in last frame.        */
+    uint8_t* Y_prev;                            /* Kept previous source components.       */
+    uint8_t* U_prev;
+    uint8_t* V_prev;
+    size_t luma_size;                           /* Bytes of source Y component.           */
+    size_t chroma_size;                         /* Bytes of source U or V component.      */
+    uint32_t full;                              /* Next frame is remapped whole.          */
+    DirtyRemap_CompareRow compare;              /* Row comparison, selected for CPU.      */
+}DirtyRemap;
+
+/* ============================================================================================== */
+/*                                     Function Declarations                                      */
+/* ============================================================================================== */
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     DirtyRemap_Init
+ *
+ * \brief  Compute source block range of every output tile of plan map.
+ *
+ * \param  [Out] dirty        Created state. Has to be released with DirtyRemap_Deinit.
+ * \param  [In]  plan         Remap plan, that outlives state.
+ * \param  [In]  block_size   Source block in luma pixels, even, or 0 for default.
+ * \param  [In]  tile_size    Output tile in pixels, even, or 0 for default.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status DirtyRemap_Init(DirtyRemap* dirty, const Remap_Plan* const plan, uint32_t block_size,
+                           uint32_t tile_size);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     DirtyRemap_Apply
+ *
+ * \brief  Correct frame incrementally. First frame, and frame after DirtyRemap_Reset, is
+ *         remapped whole. Later frames are compared with previous source frame, and only
+ *         output tiles whose source blocks changed are remapped. Output components have to
+ *         hold previous output of this state, and border colour has to be same as before.
+ *
+ * \param  [In]  dirty        State of incremental correction.
+ * \param  [Out] Y_out        Y component of output frame, with previous output.
+ * \param  [Out] U_out        U component of output frame, with previous output.
+ * \param  [Out] V_out        V component of output frame, with previous output.
+ * \param  [In]  Y            Y component of source frame.
+ * \param  [In]  U            U component of source frame.
+ * \param  [In]  V            V component of source frame.
+ * \param  [In]  Y_prev       Y component of previous source frame, or NULL, when state keeps
+ *                            copy of previous source frame.
+ * \param  [In]  U_prev       U component of previous source frame, or NULL.
+ * \param  [In]  V_prev       V component of previous source frame, or NULL.
+ * \param  [In]  border       Border colour, or NULL to leave pixels without source untouched.
+ * \param  [Out] num_of_dirty Number of remapped regions, or NULL.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status DirtyRemap_Apply(DirtyRemap* dirty, uint8_t* const Y_out, uint8_t* const U_out,
+                            uint8_t* const V_out, const uint8_t* const Y,
+                            const uint8_t* const U, const uint8_t* const V,
+                            const uint8_t* const Y_prev, const uint8_t* const U_prev,
+                            const uint8_t* const V_prev, const LDC_Color* const border,
+                            uint32_t* num_of_dirty);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     DirtyRemap_Reset
+ *
+ * \brief  Remap next frame whole, for example after output components or border are changed.
+ *
+ * \param  [In]  dirty        State of incremental correction.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void DirtyRemap_Reset(DirtyRemap* dirty);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     DirtyRemap_Deinit
+ *
+ * \brief  Release memory of state.
+ *
+ * \param  [In]  dirty        State of incremental correction.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void DirtyRemap_Deinit(DirtyRemap* dirty);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,717 @@
+/**
+ ***************************************************************************************************
+ *
+ * \file  fast_map.c
+ *
+ * \brief This file contains API for single precision map generation, with SIMD (AVX2/SSE2)
+ *        and scalar implementations.
+ *
+ * \arg author:  Dejan Milojica
+ * \arg version: 1.2
+ * \arg date:    13.01.2021
+ *
+ ***************************************************************************************************
+ */
+
+/* ============================================================================================== */
+/*                                       Include Files                                            */
+/* ============================================================================================== */
+
+#include "fast_map.h"
+#include <math.h>
+#include <stdint.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define FAST_MAP_X86 (1)
+#include <immintrin.h>
+#endif
+
+/* ============================================================================================== */
+/*                                       Global variables                                         */
+/* ============================================================================================== */
+
+/* Minimax polynomial of atan(a)/a, in a^2, for a from [0, 1]. Max error is about 1e-5 rad. */
+#define ATAN_C0 ( 0.99997726f)
+#define ATAN_C1 (-0.33262347f)
+#define ATAN_C2 ( 0.19354346f)
+#define ATAN_C3 (-0.11643287f)
+#define ATAN_C4 ( 0.05265332f)
+#define ATAN_C5 (-0.01172120f)
+
+#define HALF_PI_F (1.57079632679f)
+
+/* Last LUT position, so that both neighbouring samples always exist. */
+#define LUT_MAX_POSITION ((float)(FAST_MAP_NUM_OF_LUT_SAMPLES - 1U) - 1.0f / 512.0f)
+
+/* ============================================================================================== */
+/*                              Internal Helper Functions                                         */
+/* ============================================================================================== */
+
+static void FastMap_DistortRowScalar(const FastMap_RadialLut* const lut, uint32_t first,
+                                     uint32_t count, float xt0, float dx, float yt,
+                                     float* h_d, float* v_d)
+{
+    uint32_t j;
+
+    for(j = first;j < count;j++)
+    {
+        float xt = xt0 + (float)j * dx;
+        float r = sqrtf(xt * xt + yt * yt);
+        float num = (r < lut->z) ? r : lut->z;
+        float den = (r < lut->z) ? lut->z : r;
+        float a = num / den;
+        float a2 = a * a;
+        float theta;
+        float u;
+        float frac;
+        float r_d;
+        float k;
+        int32_t i;
+
+        /* atan(r / z), with range reduction atan(t) = PI/2 - atan(1/t) for t > 1. */
+        theta = a * (ATAN_C0 + a2 * (ATAN_C1 + a2 * (ATAN_C2 + a2 * (ATAN_C3 +
+                a2 * (ATAN_C4 + a2 * ATAN_C5)))));
+        if(r > lut->z)
+        {
+            theta = HALF_PI_F - theta;
+        }
+
+        /* Linear interpolation of distorted radius. */
+        u = theta * lut->theta_step_inv;
+        u = (u < LUT_MAX_POSITION) ? u : LUT_MAX_POSITION;
+        i = (int32_t)u;
+        frac = u - (float)i;
+        r_d = lut->r_d[i] + frac * (lut->r_d[i + 1] - lut->r_d[i]);
+
+        /* cos(phi) = xt / r and sin(phi) = yt / r. */
+        k = (r > 0.0f) ? r_d / r : 0.0f;
+        h_d[j] = lut->hc + k * xt;
+        v_d[j] = lut->vc + k * yt;
+    }
+}
+
+/* Ratio of distorted and undistorted radius, of analytic model. */
+static float FastMap_ModelRatio(const FastMap_RadialLut* const lut, float r2)
+{
+    float rho = sqrtf(r2 + lut->z * lut->z);
+    float ratio;
+
+    if(LENS_MODEL_EQUISOLID == lut->model)
+    {
+        /* 2 f sin(theta / 2) / r, without cancellation near optical axis. */
+        ratio = 2.0f * lut->f / sqrtf(2.0f * rho * (rho + lut->z));
+    }
+    else if(LENS_MODEL_STEREOGRAPHIC == lut->model)
+    {
+        /* 2 f tan(theta / 2) / r. */
+        ratio = 2.0f * lut->f / (rho + lut->z);
+    }
+    else
+    {
+        float r = sqrtf(r2);
+        float num = (r < lut->z) ? r : lut->z;
+        float den = (r < lut->z) ? lut->z : r;
+        float a = num / den;
+        float a2 = a * a;
+        float p = ATAN_C0 + a2 * (ATAN_C1 + a2 * (ATAN_C2 + a2 * (ATAN_C3 +
+                  a2 * (ATAN_C4 + a2 * ATAN_C5))));
+        float theta = (r > lut->z) ? HALF_PI_F - a * p : a * p;
+        float theta2 = theta * theta;
+
+        /* theta / r is p / z inside of unit cone, so it is defined on optical axis. */
+        ratio = (r > lut->z) ? theta / r : p / lut->z;
+        ratio *= lut->f * (1.0f + theta2 * (lut->k[0] + theta2 * (lut->k[1] + theta2 *
+                 (lut->k[2] + theta2 * lut->k[3]))));
+    }
+
+    return ratio;
+}
+
+static void FastMap_DistortRowModelScalar(const FastMap_RadialLut* const lut, uint32_t first,
+                                          uint32_t count, float xt0, float dx, float yt,
+                                          float* h_d, float* v_d)
+{
+    uint32_t j;
+
+    for(j = first;j < count;j++)
+    {
+        float xt = xt0 + (float)j * dx;
+        float k = FastMap_ModelRatio(lut, xt * xt + yt * yt);
+
+        h_d[j] = lut->hc + k * xt;
+        v_d[j] = lut->vc + k * yt;
+    }
+}
+
+static void FastMap_DistortRaysScalar(const FastMap_RadialLut* const lut, uint32_t first,
+                                      uint32_t count, const float* const ray,
+                                      const float* const step, float* h_d, float* v_d)
+{
+    uint32_t j;
+
+    for(j = first;j < count;j++)
+    {
+        float x = ray[0] + (float)j * step[0];
+        float y = ray[1] + (float)j * step[1];
+        float z = ray[2] + (float)j * step[2];
+        float k;
+
+        if(!(z > 0.0f))
+        {
+            h_d[j] = NAN;
+            v_d[j] = NAN;
+            continue;
+        }
+
+        if(LENS_MODEL_TABLE == lut->model)
+        {
+            float rho = sqrtf(x * x + y * y);
+            float a = ((rho < z) ? rho : z) / ((rho < z) ? z : rho);
+            float a2 = a * a;
+            float theta = a * (ATAN_C0 + a2 * (ATAN_C1 + a2 * (ATAN_C2 + a2 * (ATAN_C3 +
+                          a2 * (ATAN_C4 + a2 * ATAN_C5)))));
+            float u;
+            int32_t i;
+
+            theta = (rho > z) ? HALF_PI_F - theta : theta;
+            u = theta * lut->theta_step_inv;
+            u = (u < LUT_MAX_POSITION) ? u : LUT_MAX_POSITION;
+            i = (int32_t)u;
+            k = lut->r_d[i] + (u - (float)i) * (lut->r_d[i + 1] - lut->r_d[i]);
+            k = (rho > 0.0f) ? k / rho : 0.0f;
+        }
+        else
+        {
+            /* Ray is moved to image plane of lens, at distance z. */
+            float s = lut->z / z;
+
+            x *= s;
+            y *= s;
+            k = FastMap_ModelRatio(lut, x * x + y * y);
+        }
+
+        h_d[j] = lut->hc + k * x;
+        v_d[j] = lut->vc + k * y;
+    }
+}
+
+#ifdef FAST_MAP_X86
+
+__attribute__((target("sse2")))
+static uint32_t FastMap_DistortRowSSE2(const FastMap_RadialLut* const lut, uint32_t count,
+                                       float xt0, float dx, float yt, float* h_d, float* v_d)
+{
+    uint32_t j;
+    const __m128 z = _mm_set1_ps(lut->z);
+    const __m128 yt_v = _mm_set1_ps(yt);
+    const __m128 yt2 = _mm_mul_ps(yt_v, yt_v);
+    const __m128 step_inv = _mm_set1_ps(lut->theta_step_inv);
+    const __m128 max_position = _mm_set1_ps(LUT_MAX_POSITION);
+    const __m128 half_pi = _mm_set1_ps(HALF_PI_F);
+    const __m128 hc = _mm_set1_ps(lut->hc);
+    const __m128 vc = _mm_set1_ps(lut->vc);
+    const __m128 dx4 = _mm_set1_ps(dx);
+    const __m128 lanes = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+
+    for(j = 0;j + 4U <= count;j += 4U)
+    {
+        int32_t idx[4];
+        __m128 xt = _mm_add_ps(_mm_set1_ps(xt0),
+                               _mm_mul_ps(_mm_add_ps(_mm_set1_ps((float)j), lanes), dx4));
+        __m128 r = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(xt, xt), yt2));
+        __m128 a = _mm_div_ps(_mm_min_ps(r, z), _mm_max_ps(r, z));
+        __m128 a2 = _mm_mul_ps(a, a);
+        __m128 p = _mm_set1_ps(ATAN_C5);
+        __m128 outer = _mm_cmpgt_ps(r, z);
+        __m128 theta;
+        __m128 u;
+        __m128i i;
+        __m128 frac;
+        __m128 lo;
+        __m128 hi;
+        __m128 k;
+
+        p = _mm_add_ps(_mm_mul_ps(p, a2), _mm_set1_ps(ATAN_C4));
+        p = _mm_add_ps(_mm_mul_ps(p, a2), _mm_set1_ps(ATAN_C3));
+        p = _mm_add_ps(_mm_mul_ps(p, a2), _mm_set1_ps(ATAN_C2));
+        p = _mm_add_ps(_mm_mul_ps(p, a2), _mm_set1_ps(ATAN_C1));
+        p = _mm_add_ps(_mm_mul_ps(p, a2), _mm_set1_ps(ATAN_C0));
+        p = _mm_mul_ps(p, a);
+        theta = _mm_or_ps(_mm_and_ps(outer, _mm_sub_ps(half_pi, p)), _mm_andnot_ps(outer, p));
+
+        u = _mm_min_ps(_mm_mul_ps(theta, step_inv), max_position);
+        i = _mm_cvttps_epi32(u);
+        frac = _mm_sub_ps(u, _mm_cvtepi32_ps(i));
+
+        /* SSE2 has no gather, LUT samples are loaded one by one. */
+        _mm_storeu_si128((__m128i*)idx, i);
+        lo = _mm_setr_ps(lut->r_d[idx[0]], lut->r_d[idx[1]],
+                         lut->r_d[idx[2]], lut->r_d[idx[3]]);
+        hi = _mm_setr_ps(lut->r_d[idx[0] + 1], lut->r_d[idx[1] + 1],
+                         lut->r_d[idx[2] + 1], lut->r_d[idx[3] + 1]);
+
+        k = _mm_add_ps(lo, _mm_mul_ps(frac, _mm_sub_ps(hi, lo)));
+        k = _mm_and_ps(_mm_cmpgt_ps(r, _mm_setzero_ps()), _mm_div_ps(k, r));
+
+        _mm_storeu_ps(&h_d[j], _mm_add_ps(hc, _mm_mul_ps(k, xt)));
+        _mm_storeu_ps(&v_d[j], _mm_add_ps(vc, _mm_mul_ps(k, yt_v)));
+    }
+
+    return j;
+}
+
+__attribute__((target("avx2")))
+static uint32_t FastMap_DistortRowAVX2(const FastMap_RadialLut* const lut, uint32_t count,
+                                       float xt0, float dx, float yt, float* h_d, float* v_d)
+{
+    uint32_t j;
+    const __m256 z = _mm256_set1_ps(lut->z);
+    const __m256 yt_v = _mm256_set1_ps(yt);
+    const __m256 yt2 = _mm256_mul_ps(yt_v, yt_v);
+    const __m256 step_inv = _mm256_set1_ps(lut->theta_step_inv);
+    const __m256 max_position = _mm256_set1_ps(LUT_MAX_POSITION);
+    const __m256 half_pi = _mm256_set1_ps(HALF_PI_F);
+    const __m256 hc = _mm256_set1_ps(lut->hc);
+    const __m256 vc = _mm256_set1_ps(lut->vc);
+    const __m256 dx8 = _mm256_set1_ps(dx);
+    const __m256 lanes = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+
+    for(j = 0;j + 8U <= count;j += 8U)
+    {
+        __m256 xt = _mm256_add_ps(_mm256_set1_ps(xt0),
+                                  _mm256_mul_ps(_mm256_add_ps(_mm256_set1_ps((float)j), lanes),
+                                                dx8));
+        __m256 r = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(xt, xt), yt2));
+        __m256 a = _mm256_div_ps(_mm256_min_ps(r, z), _mm256_max_ps(r, z));
+        __m256 a2 = _mm256_mul_ps(a, a);
+        __m256 p = _mm256_set1_ps(ATAN_C5);
+        __m256 theta;
+        __m256 u;
+        __m256i i;
+        __m256 frac;
+        __m256 lo;
+        __m256 hi;
+        __m256 k;
+
+        p = _mm256_add_ps(_mm256_mul_ps(p, a2), _mm256_set1_ps(ATAN_C4));
+        p = _mm256_add_ps(_mm256_mul_ps(p, a2), _mm256_set1_ps(ATAN_C3));
+        p = _mm256_add_ps(_mm256_mul_ps(p, a2), _mm256_set1_ps(ATAN_C2));
+        p = _mm256_add_ps(_mm256_mul_ps(p, a2), _mm256_set1_ps(ATAN_C1));
+        p = _mm256_add_ps(_mm256_mul_ps(p, a2), _mm256_set1_ps(ATAN_C0));
+        p = _mm256_mul_ps(p, a);
+        theta = _mm256_blendv_ps(p, _mm256_sub_ps(half_pi, p), _mm256_cmp_ps(r, z, _CMP_GT_OQ));
+
+        u = _mm256_min_ps(_mm256_mul_ps(theta, step_inv), max_position);
+        i = _mm256_cvttps_epi32(u);
+        frac = _mm256_sub_ps(u, _mm256_cvtepi32_ps(i));
+
+        lo = _mm256_i32gather_ps(lut->r_d, i, 4);
+        hi = _mm256_i32gather_ps(lut->r_d + 1, i, 4);
+
+        k = _mm256_add_ps(lo, _mm256_mul_ps(frac, _mm256_sub_ps(hi, lo)));
+        k = _mm256_and_ps(_mm256_cmp_ps(r, _mm256_setzero_ps(), _CMP_GT_OQ),
+                          _mm256_div_ps(k, r));
+
+        _mm256_storeu_ps(&h_d[j], _mm256_add_ps(hc, _mm256_mul_ps(k, xt)));
+        _mm256_storeu_ps(&v_d[j], _mm256_add_ps(vc, _mm256_mul_ps(k, yt_v)));
+    }
+
+    return j;
+}
+
+
+__attribute__((target("sse2")))
+static uint32_t FastMap_DistortRowModelSSE2(const FastMap_RadialLut* const lut, uint32_t count,
+                                            float xt0, float dx, float yt, float* h_d,
+                                            float* v_d)
+{
+    uint32_t j;
+    const __m128 z = _mm_set1_ps(lut->z);
+    const __m128 z2 = _mm_mul_ps(z, z);
+    const __m128 two_f = _mm_set1_ps(2.0f * lut->f);
+    const __m128 f = _mm_set1_ps(lut->f);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 two = _mm_set1_ps(2.0f);
+    const __m128 yt_v = _mm_set1_ps(yt);
+    const __m128 yt2 = _mm_mul_ps(yt_v, yt_v);
+    const __m128 half_pi = _mm_set1_ps(HALF_PI_F);
+    const __m128 hc = _mm_set1_ps(lut->hc);
+    const __m128 vc = _mm_set1_ps(lut->vc);
+    const __m128 dx4 = _mm_set1_ps(dx);
+    const __m128 lanes = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+
+    for(j = 0;j + 4U <= count;j += 4U)
+    {
+        __m128 xt = _mm_add_ps(_mm_set1_ps(xt0),
+                               _mm_mul_ps(_mm_add_ps(_mm_set1_ps((float)j), lanes), dx4));
+        __m128 r2 = _mm_add_ps(_mm_mul_ps(xt, xt), yt2);
+        __m128 rho = _mm_sqrt_ps(_mm_add_ps(r2, z2));
+        __m128 k;
+
+        if(LENS_MODEL_EQUISOLID == lut->model)
+        {
+            k = _mm_div_ps(two_f, _mm_sqrt_ps(_mm_mul_ps(two, _mm_mul_ps(rho,
+                                                                       _mm_add_ps(rho, z)))));
+        }
+        else if(LENS_MODEL_STEREOGRAPHIC == lut->model)
+        {
+            k = _mm_div_ps(two_f, _mm_add_ps(rho, z));
+        }
+        else
+        {
+            __m128 r = _mm_sqrt_ps(r2);
+            __m128 a = _mm_div_ps(_mm_min_ps(r, z), _mm_max_ps(r, z));
+            __m128 a2 = _mm_mul_ps(a, a);
+            __m128 outer = _mm_cmpgt_ps(r, z);
+            __m128 p = _mm_set1_ps(ATAN_C5);
+            __m128 theta;
+            __m128 theta2;
+            __m128 poly;
+
+            p = _mm_add_ps(_mm_mul_ps(p, a2), _mm_set1_ps(ATAN_C4));
+            p = _mm_add_ps(_mm_mul_ps(p, a2), _mm_set1_ps(ATAN_C3));
+            p = _mm_add_ps(_mm_mul_ps(p, a2), _mm_set1_ps(ATAN_C2));
+            p = _mm_add_ps(_mm_mul_ps(p, a2), _mm_set1_ps(ATAN_C1));
+            p = _mm_add_ps(_mm_mul_ps(p, a2), _mm_set1_ps(ATAN_C0));
+            theta = _mm_or_ps(_mm_and_ps(outer, _mm_sub_ps(half_pi, _mm_mul_ps(a, p))),
+                              _mm_andnot_ps(outer, _mm_mul_ps(a, p)));
+            theta2 = _mm_mul_ps(theta, theta);
+
+            poly = _mm_set1_ps(lut->k[3]);
+            poly = _mm_add_ps(_mm_mul_ps(poly, theta2), _mm_set1_ps(lut->k[2]));
+            poly = _mm_add_ps(_mm_mul_ps(poly, theta2), _mm_set1_ps(lut->k[1]));
+            poly = _mm_add_ps(_mm_mul_ps(poly, theta2), _mm_set1_ps(lut->k[0]));
+            poly = _mm_add_ps(_mm_mul_ps(poly, theta2), one);
+
+            /* theta / r, and p / z inside of unit cone. */
+            k = _mm_or_ps(_mm_and_ps(outer, _mm_div_ps(theta, r)),
+                          _mm_andnot_ps(outer, _mm_div_ps(p, z)));
+            k = _mm_mul_ps(k, _mm_mul_ps(f, poly));
+        }
+
+        _mm_storeu_ps(&h_d[j], _mm_add_ps(hc, _mm_mul_ps(k, xt)));
+        _mm_storeu_ps(&v_d[j], _mm_add_ps(vc, _mm_mul_ps(k, yt_v)));
+    }
+
+    return j;
+}
+
+__attribute__((target("avx2")))
+static uint32_t FastMap_DistortRowModelAVX2(const FastMap_RadialLut* const lut, uint32_t count,
+                                            float xt0, float dx, float yt, float* h_d,
+                                            float* v_d)
+{
+    uint32_t j;
+    const __m256 z = _mm256_set1_ps(lut->z);
+    const __m256 z2 = _mm256_mul_ps(z, z);
+    const __m256 two_f = _mm256_set1_ps(2.0f * lut->f);
+    const __m256 f = _mm256_set1_ps(lut->f);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 two = _mm256_set1_ps(2.0f);
+    const __m256 yt_v = _mm256_set1_ps(yt);
+    const __m256 yt2 = _mm256_mul_ps(yt_v, yt_v);
+    const __m256 half_pi = _mm256_set1_ps(HALF_PI_F);
+    const __m256 hc = _mm256_set1_ps(lut->hc);
+    const __m256 vc = _mm256_set1_ps(lut->vc);
+    const __m256 dx8 = _mm256_set1_ps(dx);
+    const __m256 lanes = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+
+    for(j = 0;j + 8U <= count;j += 8U)
+    {
+        __m256 xt = _mm256_add_ps(_mm256_set1_ps(xt0),
+                                  _mm256_mul_ps(_mm256_add_ps(_mm256_set1_ps((float)j), lanes),
+                                                dx8));
+        __m256 r2 = _mm256_add_ps(_mm256_mul_ps(xt, xt), yt2);
+        __m256 rho = _mm256_sqrt_ps(_mm256_add_ps(r2, z2));
+        __m256 k;
+
+        if(LENS_MODEL_EQUISOLID == lut->model)
+        {
+            k = _mm256_div_ps(two_f, _mm256_sqrt_ps(_mm256_mul_ps(two, _mm256_mul_ps(rho,
+                                                                    _mm256_add_ps(rho, z)))));
+        }
+        else if(LENS_MODEL_STEREOGRAPHIC == lut->model)
+        {
+            k = _mm256_div_ps(two_f, _mm256_add_ps(rho, z));
+        }
+        else
+        {
+            __m256 r = _mm256_sqrt_ps(r2);
+            __m256 a = _mm256_div_ps(_mm256_min_ps(r, z), _mm256_max_ps(r, z));
+            __m256 a2 = _mm256_mul_ps(a, a);
+            __m256 outer = _mm256_cmp_ps(r, z, _CMP_GT_OQ);
+            __m256 p = _mm256_set1_ps(ATAN_C5);
+            __m256 theta;
+            __m256 theta2;
+            __m256 poly;
+
+            p = _mm256_add_ps(_mm256_mul_ps(p, a2), _mm256_set1_ps(ATAN_C4));
+            p = _mm256_add_ps(_mm256_mul_ps(p, a2), _mm256_set1_ps(ATAN_C3));
+            p = _mm256_add_ps(_mm256_mul_ps(p, a2), _mm256_set1_ps(ATAN_C2));
+            p = _mm256_add_ps(_mm256_mul_ps(p, a2), _mm256_set1_ps(ATAN_C1));
+            p = _mm256_add_ps(_mm256_mul_ps(p, a2), _mm256_set1_ps(ATAN_C0));
+            theta = _mm256_blendv_ps(_mm256_mul_ps(a, p),
+                                     _mm256_sub_ps(half_pi, _mm256_mul_ps(a, p)), outer);
+            theta2 = _mm256_mul_ps(theta, theta);
+
+            poly = _mm256_set1_ps(lut->k[3]);
+            poly = _mm256_add_ps(_mm256_mul_ps(poly, theta2), _mm256_set1_ps(lut->k[2]));
+            poly = _mm256_add_ps(_mm256_mul_ps(poly, theta2), _mm256_set1_ps(lut->k[1]));
+            poly = _mm256_add_ps(_mm256_mul_ps(poly, theta2), _mm256_set1_ps(lut->k[0]));
+            poly = _mm256_add_ps(_mm256_mul_ps(poly, theta2), one);
+
+            /* theta / r, and p / z inside of unit cone. */
+            k = _mm256_blendv_ps(_mm256_div_ps(p, z), _mm256_div_ps(theta, r), outer);
+            k = _mm256_mul_ps(k, _mm256_mul_ps(f, poly));
+        }
+
+        _mm256_storeu_ps(&h_d[j], _mm256_add_ps(hc, _mm256_mul_ps(k, xt)));
+        _mm256_storeu_ps(&v_d[j], _mm256_add_ps(vc, _mm256_mul_ps(k, yt_v)));
+    }
+
+    return j;
+}
+
+__attribute__((target("sse2")))
+static uint32_t FastMap_DistortRaysSSE2(const FastMap_RadialLut* const lut, uint32_t count,
+                                        const float* const ray, const float* const step,
+                                        float* h_d, float* v_d)
+{
+    uint32_t j;
+    const __m128 step_inv = _mm_set1_ps(lut->theta_step_inv);
+    const __m128 max_position = _mm_set1_ps(LUT_MAX_POSITION);
+    const __m128 half_pi = _mm_set1_ps(HALF_PI_F);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 nan = _mm_set1_ps(NAN);
+    const __m128 hc = _mm_set1_ps(lut->hc);
+    const __m128 vc = _mm_set1_ps(lut->vc);
+    const __m128 lanes = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+
+    for(j = 0;j + 4U <= count;j += 4U)
+    {
+        int32_t idx[4];
+        __m128 jj = _mm_add_ps(_mm_set1_ps((float)j), lanes);
+        __m128 x = _mm_add_ps(_mm_set1_ps(ray[0]), _mm_mul_ps(jj, _mm_set1_ps(step[0])));
+        __m128 y = _mm_add_ps(_mm_set1_ps(ray[1]), _mm_mul_ps(jj, _mm_set1_ps(step[1])));
+        __m128 z = _mm_add_ps(_mm_set1_ps(ray[2]), _mm_mul_ps(jj, _mm_set1_ps(step[2])));
+        __m128 rho = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)));
+        __m128 a = _mm_div_ps(_mm_min_ps(rho, z), _mm_max_ps(rho, z));
+        __m128 a2 = _mm_mul_ps(a, a);
+        __m128 p = _mm_set1_ps(ATAN_C5);
+        __m128 outer = _mm_cmpgt_ps(rho, z);
+        __m128 front = _mm_cmpgt_ps(z, zero);
+        __m128 theta;
+        __m128 u;
+        __m128i i;
+        __m128 frac;
+        __m128 lo;
+        __m128 hi;
+        __m128 k;
+
+        p = _mm_add_ps(_mm_mul_ps(p, a2), _mm_set1_ps(ATAN_C4));
+        p = _mm_add_ps(_mm_mul_ps(p, a2), _mm_set1_ps(ATAN_C3));
+        p = _mm_add_ps(_mm_mul_ps(p, a2), _mm_set1_ps(ATAN_C2));
+        p = _mm_add_ps(_mm_mul_ps(p, a2), _mm_set1_ps(ATAN_C1));
+        p = _mm_add_ps(_mm_mul_ps(p, a2), _mm_set1_ps(ATAN_C0));
+        p = _mm_mul_ps(p, a);
+        theta = _mm_or_ps(_mm_and_ps(outer, _mm_sub_ps(half_pi, p)), _mm_andnot_ps(outer, p));
+
+        /* Rays behind lens give NaN or negative angle, LUT position is kept inside of LUT. */
+        u = _mm_max_ps(_mm_min_ps(_mm_mul_ps(theta, step_inv), max_position), zero);
+        i = _mm_cvttps_epi32(u);
+        frac = _mm_sub_ps(u, _mm_cvtepi32_ps(i));
+
+        _mm_storeu_si128((__m128i*)idx, i);
+        lo = _mm_setr_ps(lut->r_d[idx[0]], lut->r_d[idx[1]],
+                         lut->r_d[idx[2]], lut->r_d[idx[3]]);
+        hi = _mm_setr_ps(lut->r_d[idx[0] + 1], lut->r_d[idx[1] + 1],
+                         lut->r_d[idx[2] + 1], lut->r_d[idx[3] + 1]);
+
+        k = _mm_add_ps(lo, _mm_mul_ps(frac, _mm_sub_ps(hi, lo)));
+        k = _mm_and_ps(_mm_cmpgt_ps(rho, zero), _mm_div_ps(k, rho));
+
+        _mm_storeu_ps(&h_d[j], _mm_or_ps(_mm_and_ps(front, _mm_add_ps(hc, _mm_mul_ps(k, x))),
+                                         _mm_andnot_ps(front, nan)));
+        _mm_storeu_ps(&v_d[j], _mm_or_ps(_mm_and_ps(front, _mm_add_ps(vc, _mm_mul_ps(k, y))),
+                                         _mm_andnot_ps(front, nan)));
+    }
+
+    return j;
+}
+
+__attribute__((target("avx2")))
+static uint32_t FastMap_DistortRaysAVX2(const FastMap_RadialLut* const lut, uint32_t count,
+                                        const float* const ray, const float* const step,
+                                        float* h_d, float* v_d)
+{
+    uint32_t j;
+    const __m256 step_inv = _mm256_set1_ps(lut->theta_step_inv);
+    const __m256 max_position = _mm256_set1_ps(LUT_MAX_POSITION);
+    const __m256 half_pi = _mm256_set1_ps(HALF_PI_F);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 nan = _mm256_set1_ps(NAN);
+    const __m256 hc = _mm256_set1_ps(lut->hc);
+    const __m256 vc = _mm256_set1_ps(lut->vc);
+    const __m256 lanes = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+
+    for(j = 0;j + 8U <= count;j += 8U)
+    {
+        __m256 jj = _mm256_add_ps(_mm256_set1_ps((float)j), lanes);
+        __m256 x = _mm256_add_ps(_mm256_set1_ps(ray[0]),
+                                 _mm256_mul_ps(jj, _mm256_set1_ps(step[0])));
+        __m256 y = _mm256_add_ps(_mm256_set1_ps(ray[1]),
+                                 _mm256_mul_ps(jj, _mm256_set1_ps(step[1])));
+        __m256 z = _mm256_add_ps(_mm256_set1_ps(ray[2]),
+                                 _mm256_mul_ps(jj, _mm256_set1_ps(step[2])));
+        __m256 rho = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)));
+        __m256 a = _mm256_div_ps(_mm256_min_ps(rho, z), _mm256_max_ps(rho, z));
+        __m256 a2 = _mm256_mul_ps(a, a);
+        __m256 p = _mm256_set1_ps(ATAN_C5);
+        __m256 front = _mm256_cmp_ps(z, zero, _CMP_GT_OQ);
+        __m256 theta;
+        __m256 u;
+        __m256i i;
+        __m256 frac;
+        __m256 lo;
+        __m256 hi;
+        __m256 k;
+
+        p = _mm256_add_ps(_mm256_mul_ps(p, a2), _mm256_set1_ps(ATAN_C4));
+        p = _mm256_add_ps(_mm256_mul_ps(p, a2), _mm256_set1_ps(ATAN_C3));
+        p = _mm256_add_ps(_mm256_mul_ps(p, a2), _mm256_set1_ps(ATAN_C2));
+        p = _mm256_add_ps(_mm256_mul_ps(p, a2), _mm256_set1_ps(ATAN_C1));
+        p = _mm256_add_ps(_mm256_mul_ps(p, a2), _mm256_set1_ps(ATAN_C0));
+        p = _mm256_mul_ps(p, a);
+        theta = _mm256_blendv_ps(p, _mm256_sub_ps(half_pi, p),
+                                 _mm256_cmp_ps(rho, z, _CMP_GT_OQ));
+
+        /* Rays behind lens give NaN or negative angle, LUT position is kept inside of LUT. */
+        u = _mm256_max_ps(_mm256_min_ps(_mm256_mul_ps(theta, step_inv), max_position), zero);
+        i = _mm256_cvttps_epi32(u);
+        frac = _mm256_sub_ps(u, _mm256_cvtepi32_ps(i));
+
+        lo = _mm256_i32gather_ps(lut->r_d, i, 4);
+        hi = _mm256_i32gather_ps(lut->r_d + 1, i, 4);
+
+        k = _mm256_add_ps(lo, _mm256_mul_ps(frac, _mm256_sub_ps(hi, lo)));
+        k = _mm256_and_ps(_mm256_cmp_ps(rho, zero, _CMP_GT_OQ), _mm256_div_ps(k, rho));
+
+        _mm256_storeu_ps(&h_d[j], _mm256_blendv_ps(nan, _mm256_add_ps(hc, _mm256_mul_ps(k, x)),
+                                                   front));
+        _mm256_storeu_ps(&v_d[j], _mm256_blendv_ps(nan, _mm256_add_ps(vc, _mm256_mul_ps(k, y)),
+                                                   front));
+    }
+
+    return j;
+}
+
+#endif
+
+/* ============================================================================================== */
+
+/*                                     API Functions                                              */
+
+/* ============================================================================================== */
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     FastMap_DistortRow
+ *
+ * \brief  Compute source positions of one output row, in single precision. Pixel j of row is at
+ *         (xt0 + j * dx, yt), relative to optical centre. Field angle is computed with polynomial
+ *         arctangent, and distorted radius is linearly interpolated from LUT. Analytic models
+ *         are evaluated in closed form, without LUT. Best of AVX2, SSE2 and scalar
+ *         implementation is selected at run time.
+ *
+ * \param  [In]  lut          Radial LUT of lens.
+ * \param  [In]  count        Number of pixels in row.
+ * \param  [In]  xt0          Horizontal position of first pixel, relative to optical centre.
+ * \param  [In]  dx           Horizontal distance between pixels.
+ * \param  [In]  yt           Vertical position of row, relative to optical centre.
+ * \param  [Out] h_d          Horizontal source positions.
+ * \param  [Out] v_d          Vertical source positions.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void FastMap_DistortRow(const FastMap_RadialLut* const lut, uint32_t count, float xt0, float dx,
+                        float yt, float* h_d, float* v_d)
+{
+    uint32_t done = 0;
+
+    if(LENS_MODEL_TABLE == lut->model)
+    {
+#ifdef FAST_MAP_X86
+        if(__builtin_cpu_supports("avx2"))
+        {
+            done = FastMap_DistortRowAVX2(lut, count, xt0, dx, yt, h_d, v_d);
+        }
+        else if(__builtin_cpu_supports("sse2"))
+        {
+            done = FastMap_DistortRowSSE2(lut, count, xt0, dx, yt, h_d, v_d);
+        }
+#endif
+
+        /* Rest of row, or whole row without SIMD. */
+        FastMap_DistortRowScalar(lut, done, count, xt0, dx, yt, h_d, v_d);
+    }
+    else
+    {
+#ifdef FAST_MAP_X86
+        if(__builtin_cpu_supports("avx2"))
+        {
+            done = FastMap_DistortRowModelAVX2(lut, count, xt0, dx, yt, h_d, v_d);
+        }
+        else if(__builtin_cpu_supports("sse2"))
+        {
+            done = FastMap_DistortRowModelSSE2(lut, count, xt0, dx, yt, h_d, v_d);
+        }
+#endif
+
+        FastMap_DistortRowModelScalar(lut, done, count, xt0, dx, yt, h_d, v_d);
+    }
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     FastMap_DistortRays
+ *
+ * \brief  Compute source positions of row of rays, in single precision. Ray j of row is
+ *         ray + j * step, in coordinates of lens (x to the right, y down, z along optical
+ *         axis), so rays of row of rotated pinhole camera cost only additions. Field angle is
+ *         angle of ray to optical axis, and rays at right angle, or behind lens, get NaN
+ *         positions. Table lenses use best of AVX2, SSE2 and scalar implementation, analytic
+ *         models scalar implementation.
+ *
+ * \param  [In]  lut          Radial LUT of lens.
+ * \param  [In]  count        Number of rays in row.
+ * \param  [In]  ray          First ray of row, 3 elements.
+ * \param  [In]  step         Difference of neighbouring rays, 3 elements.
+ * \param  [Out] h_d          Horizontal source positions.
+ * \param  [Out] v_d          Vertical source positions.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void FastMap_DistortRays(const FastMap_RadialLut* const lut, uint32_t count,
+                         const float* const ray, const float* const step, float* h_d, float* v_d)
+{
+    uint32_t done = 0;
+
+#ifdef FAST_MAP_X86
+    if(LENS_MODEL_TABLE == lut->model && __builtin_cpu_supports("avx2"))
+    {
+        done = FastMap_DistortRaysAVX2(lut, count, ray, step, h_d, v_d);
+    }
+    else if(LENS_MODEL_TABLE == lut->model && __builtin_cpu_supports("sse2"))
+    {
+        done = FastMap_DistortRaysSSE2(lut, count, ray, step, h_d, v_d);
+    }
+#endif
+
+    FastMap_DistortRaysScalar(lut, done, count, ray, step, h_d, v_d);
+}
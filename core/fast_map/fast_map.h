@@ -0,0 +1,122 @@
+/**
+ ***************************************************************************************************
+ *
+ * \file  fast_map.h
+ *
+ * \brief This file contains API for single precision map generation, with SIMD (AVX2/SSE2)
+ *        and scalar implementations.
+ *
+ * \arg author:  Dejan Milojica
+ * \arg version: 1.2
+ * \arg date:    13.01.2021
+ *
+ ***************************************************************************************************
+ */
+
+#ifndef FAST_MAP_H
+#define FAST_MAP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================================== */
+/*                                       Include Files                                            */
+/* ============================================================================================== */
+
+#include <stdint.h>
+
+#include "../lib/ldc_types.h"
+#include "../lens_model/lens_model.h"
+
+/* ============================================================================================== */
+/*                                     Macros & Typedefs                                          */
+/* ============================================================================================== */
+
+#define FAST_MAP_NUM_OF_LUT_SAMPLES (2049U)     /* Samples of radial LUT, on [0, PI/2].        */
+
+#define FAST_MAP_MAX_COORDINATE_ERROR (0.05)    /* Max error against double map, in pixels.    */
+
+/**
+ ***************************************************************************************************
+ *
+ * \typedef FastMap_RadialLut
+ *
+ * \brief   Structure which represents distorted radius as function of field angle, sampled
+ *          uniformly on [0, PI/2], or analytic lens model, and geometry of output row.
+ *
+ ***************************************************************************************************
+ */
+typedef struct
+{
+    float r_d[FAST_MAP_NUM_OF_LUT_SAMPLES];     /* Distorted radius in pixels, for every sample.  */
+    float theta_step_inv;                       /* Number of samples per radian.                  */
+    float z;                                    /* Distance of image plane, in pixels.            */
+    float hc;                                   /* Horizontal optical centre, in source frame.    */
+    float vc;                                   /* Vertical optical centre, in source frame.      */
+    LensModel_Type model;                       /* Lens function, LUT is used for table.          */
+    float f;                                    /* Focal length of analytic model, in pixels.     */
+    float k[LENS_MODEL_NUM_OF_COEFFICIENTS];    /* Polynomial coefficients of analytic model.     */
+}FastMap_RadialLut;
+
+/* ============================================================================================== */
+/*                                     Function Declarations                                      */
+/* ============================================================================================== */
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     FastMap_DistortRow
+ *
+ * \brief  Compute source positions of one output row, in single precision. Pixel j of row is at
+ *         (xt0 + j * dx, yt), relative to optical centre. Field angle is computed with polynomial
+ *         arctangent, and distorted radius is linearly interpolated from LUT. Analytic models
+ *         are evaluated in closed form, without LUT. Best of AVX2, SSE2 and scalar
+ *         implementation is selected at run time.
+ *
+ * \param  [In]  lut          Radial LUT of lens.
+ * \param  [In]  count        Number of pixels in row.
+ * \param  [In]  xt0          Horizontal position of first pixel, relative to optical centre.
+ * \param  [In]  dx           Horizontal distance between pixels.
+ * \param  [In]  yt           Vertical position of row, relative to optical centre.
+ * \param  [Out] h_d          Horizontal source positions.
+ * \param  [Out] v_d          Vertical source positions.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void FastMap_DistortRow(const FastMap_RadialLut* const lut, uint32_t count, float xt0, float dx,
+                        float yt, float* h_d, float* v_d);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     FastMap_DistortRays
+ *
+ * \brief  Compute source positions of row of rays, in single precision. Ray j of row is
+ *         ray + j * step, in coordinates of lens (x to the right, y down, z along optical
+ *         axis), so rays of row of rotated pinhole camera cost only additions. Field angle is
+ *         angle of ray to optical axis, and rays at right angle, or behind lens, get NaN
+ *         positions. Table lenses use best of AVX2, SSE2 and scalar implementation, analytic
+ *         models scalar implementation.
+ *
+ * \param  [In]  lut          Radial LUT of lens.
+ * \param  [In]  count        Number of rays in row.
+ * \param  [In]  ray          First ray of row, 3 elements.
+ * \param  [In]  step         Difference of neighbouring rays, 3 elements.
+ * \param  [Out] h_d          Horizontal source positions.
+ * \param  [Out] v_d          Vertical source positions.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void FastMap_DistortRays(const FastMap_RadialLut* const lut, uint32_t count,
+                         const float* const ray, const float* const step, float* h_d, float* v_d);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,565 @@
+/**
+ ***************************************************************************************************
+ *
+ * \file  frame_ring.c
+ *
+ * \brief This file contains API of ring buffer of frames in POSIX shared memory, used to exchange
+ *        frames with other processes (capture, display) without copies.
+ *
+ * \arg author:  Dejan Milojica
+ * \arg version: 1.2
+ * \arg date:    13.01.2021
+ *
+ ***************************************************************************************************
+ */
+
+/* ============================================================================================== */
+/*                                       Include Files                                            */
+/* ============================================================================================== */
+
+#include "frame_ring.h"
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+/* ============================================================================================== */
+/*                                     Macros & Typedefs                                          */
+/* ============================================================================================== */
+
+#define FRAME_RING_PAGE_SIZE (4096U)            /* Alignment of header and slots.              */
+
+/* ============================================================================================== */
+/*                              Internal Helper Functions                                         */
+/* ============================================================================================== */
+
+static uint64_t FrameRing_AlignUp(uint64_t size)
+{
+    return (size + FRAME_RING_PAGE_SIZE - 1U) & ~(uint64_t)(FRAME_RING_PAGE_SIZE - 1U);
+}
+
+static int64_t FrameRing_GetTimeMs(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (int64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+/* Sizes of planes of slot, from format of header. */
+static LDC_Status FrameRing_SetSizes(FrameRing* ring)
+{
+    const FrameRing_Header* header = ring->header;
+    const YuvFormat* format = YuvFormat_Get((YUV_Type)header->yuv_type);
+
+    if(NULL == format)
+    {
+        return LDC_STATUS_UNSUPPORTED_FORMAT;
+    }
+
+    ring->luma_size = (size_t)header->width * header->height * format->bytes_per_sample;
+    ring->chroma_size = (size_t)YuvFormat_GetChromaWidth(header->width, format->yuv_type) *
+                        YuvFormat_GetChromaHeight(header->height, format->yuv_type) *
+                        format->bytes_per_sample;
+
+    return LDC_STATUS_OK;
+}
+
+static void FrameRing_GetSlot(const FrameRing* const ring, uint32_t index, FrameRing_Slot* slot)
+{
+    uint8_t* base = (uint8_t*)ring->header + ring->header->slots_offset +
+                    ring->header->slot_size * index;
+
+    slot->Y = base;
+    slot->U = base + ring->luma_size;
+    slot->V = slot->U + ring->chroma_size;
+    slot->index = index;
+    slot->sequence = ring->header->info[index].sequence;
+    slot->timestamp_ns = ring->header->info[index].timestamp_ns;
+}
+
+/* Wake other side, if it sleeps on its futex word. */
+static void FrameRing_Wake(uint32_t* event, uint32_t* waiting, uint32_t force)
+{
+    if(force || __atomic_load_n(waiting, __ATOMIC_SEQ_CST))
+    {
+        __atomic_add_fetch(event, 1U, __ATOMIC_SEQ_CST);
+        syscall(SYS_futex, event, FUTEX_WAKE, 1, NULL, NULL, 0);
+    }
+}
+
+static uint32_t FrameRing_IsReadable(const FrameRing_Header* const header)
+{
+    return __atomic_load_n(&header->published, __ATOMIC_ACQUIRE) != header->released ||
+           __atomic_load_n(&header->closed, __ATOMIC_ACQUIRE);
+}
+
+static uint32_t FrameRing_IsWritable(const FrameRing_Header* const header)
+{
+    return header->published - __atomic_load_n(&header->released, __ATOMIC_ACQUIRE) <
+           header->num_of_slots;
+}
+
+/* Wait until condition of side holds. Flag is set before condition is checked again, so other
+   side either sees flag and bumps futex word, or this side sees moved counter. */
+static LDC_Status FrameRing_Wait(FrameRing_Header* header, uint32_t reader, int32_t timeout_ms)
+{
+    uint32_t* event = reader ? &header->consumer_event : &header->producer_event;
+    uint32_t* waiting = reader ? &header->consumer_waiting : &header->producer_waiting;
+    int64_t deadline = FrameRing_GetTimeMs() + timeout_ms;
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+
+    while(LDC_STATUS_OK == status &&
+          !(reader ? FrameRing_IsReadable(header) : FrameRing_IsWritable(header)))
+    {
+        int64_t remaining = deadline - FrameRing_GetTimeMs();
+        uint32_t seen;
+
+        if(timeout_ms >= 0 && remaining <= 0)
+        {
+            status = LDC_STATUS_TIMEOUT;
+            break;
+        }
+
+        __atomic_store_n(waiting, 1U, __ATOMIC_SEQ_CST);
+        seen = __atomic_load_n(event, __ATOMIC_SEQ_CST);
+
+        if(!(reader ? FrameRing_IsReadable(header) : FrameRing_IsWritable(header)))
+        {
+            struct timespec timeout;
+
+            timeout.tv_sec = remaining / 1000;
+            timeout.tv_nsec = (remaining % 1000) * 1000000;
+            syscall(SYS_futex, event, FUTEX_WAIT, seen, (timeout_ms >= 0) ? &timeout : NULL,
+                    NULL, 0);
+        }
+
+        __atomic_store_n(waiting, 0U, __ATOMIC_SEQ_CST);
+    }
+
+    return status;
+}
+
+/* ============================================================================================== */
+
+/*                                     API Functions                                              */
+
+/* ============================================================================================== */
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     FrameRing_Create
+ *
+ * \brief  Create shared memory of ring, with slots sized for frames of given resolution and
+ *         format. Existing shared memory with same name is not reused.
+ *
+ * \param  [Out] ring         Created ring. Has to be released with FrameRing_Close.
+ * \param  [In]  name         Name of shared memory, "/name".
+ * \param  [In]  width        Width of frames.
+ * \param  [In]  height       Height of frames.
+ * \param  [In]  yuv_type     Type of YUV frames.
+ * \param  [In]  num_of_slots Number of slots, from 2 to FRAME_RING_MAX_SLOTS.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status FrameRing_Create(FrameRing* ring, const char* const name, uint32_t width,
+                            uint32_t height, YUV_Type yuv_type, uint32_t num_of_slots)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    FrameRing_Header header;
+    uint64_t size = 0;
+
+    memset(ring, 0, sizeof(FrameRing));
+    ring->fd = -1;
+
+    if(NULL == name || strlen(name) >= FRAME_RING_MAX_NAME || 0U == width || 0U == height ||
+       num_of_slots < 2U || num_of_slots > FRAME_RING_MAX_SLOTS)
+    {
+        return LDC_STATUS_INVALID_ARGUMENT;
+    }
+
+    memset(&header, 0, sizeof(FrameRing_Header));
+    header.magic = FRAME_RING_MAGIC;
+    header.version = FRAME_RING_VERSION;
+    header.yuv_type = yuv_type;
+    header.width = width;
+    header.height = height;
+    header.num_of_slots = num_of_slots;
+    ring->header = &header;
+
+    status = FrameRing_SetSizes(ring);
+    if(LDC_STATUS_OK != status)
+    {
+        ring->header = NULL;
+        return status;
+    }
+
+    header.slot_size = FrameRing_AlignUp(ring->luma_size + 2U * ring->chroma_size);
+    header.slots_offset = FrameRing_AlignUp(sizeof(FrameRing_Header));
+    header.size = header.slots_offset + header.slot_size * num_of_slots;
+    size = header.size;
+    ring->header = NULL;
+
+    strcpy(ring->name, name);
+    ring->fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+    if(ring->fd < 0)
+    {
+        status = LDC_STATUS_ERROR;
+    }
+    else
+    {
+        ring->owner = 1U;
+
+        if(0 != ftruncate(ring->fd, (off_t)size))
+        {
+            status = LDC_STATUS_ERROR;
+        }
+        else
+        {
+            void* memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, ring->fd, 0);
+
+            if(MAP_FAILED == memory)
+            {
+                status = LDC_STATUS_ERROR;
+            }
+            else
+            {
+                ring->header = (FrameRing_Header*)memory;
+                memcpy(ring->header, &header, sizeof(FrameRing_Header));
+            }
+        }
+    }
+
+    if(LDC_STATUS_OK != status)
+    {
+        FrameRing_Close(ring);
+    }
+
+    return status;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     FrameRing_Open
+ *
+ * \brief  Map ring created by other process. Resolution and format are read from header.
+ *
+ * \param  [Out] ring         Opened ring. Has to be released with FrameRing_Close.
+ * \param  [In]  name         Name of shared memory, "/name".
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status FrameRing_Open(FrameRing* ring, const char* const name)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    struct stat info;
+
+    memset(ring, 0, sizeof(FrameRing));
+    ring->fd = -1;
+
+    if(NULL == name || strlen(name) >= FRAME_RING_MAX_NAME)
+    {
+        return LDC_STATUS_INVALID_ARGUMENT;
+    }
+
+    strcpy(ring->name, name);
+    ring->fd = shm_open(name, O_RDWR, 0);
+    if(ring->fd < 0 || 0 != fstat(ring->fd, &info) ||
+       (uint64_t)info.st_size < sizeof(FrameRing_Header))
+    {
+        status = LDC_STATUS_ERROR;
+    }
+    else
+    {
+        void* memory = mmap(NULL, (size_t)info.st_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                            ring->fd, 0);
+
+        if(MAP_FAILED == memory)
+        {
+            status = LDC_STATUS_ERROR;
+        }
+        else
+        {
+            FrameRing_Header* header = (FrameRing_Header*)memory;
+
+            ring->header = header;
+            if(FRAME_RING_MAGIC != header->magic || FRAME_RING_VERSION != header->version ||
+               header->size != (uint64_t)info.st_size || header->num_of_slots < 2U ||
+               header->num_of_slots > FRAME_RING_MAX_SLOTS || FrameRing_SetSizes(ring) ||
+               header->slot_size < ring->luma_size + 2U * ring->chroma_size ||
+               header->slots_offset + header->slot_size * header->num_of_slots > header->size)
+            {
+                munmap(memory, (size_t)info.st_size);
+                ring->header = NULL;
+                status = LDC_STATUS_ERROR;
+            }
+        }
+    }
+
+    if(LDC_STATUS_OK != status)
+    {
+        FrameRing_Close(ring);
+    }
+
+    return status;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     FrameRing_Close
+ *
+ * \brief  Unmap ring. Name of shared memory is removed by creator of ring, processes that have
+ *         ring opened keep using it.
+ *
+ * \param  [In]  ring         Ring.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void FrameRing_Close(FrameRing* ring)
+{
+    if(NULL != ring->header)
+    {
+        munmap(ring->header, ring->header->size);
+        ring->header = NULL;
+    }
+
+    if(ring->fd >= 0)
+    {
+        close(ring->fd);
+        ring->fd = -1;
+    }
+
+    if(ring->owner)
+    {
+        shm_unlink(ring->name);
+        ring->owner = 0U;
+    }
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     FrameRing_AcquireWrite
+ *
+ * \brief  Get next free slot for producer, and wait while ring is full.
+ *
+ * \param  [In]  ring         Ring.
+ * \param  [Out] slot         Free slot.
+ * \param  [In]  timeout_ms   Max wait in milliseconds, or FRAME_RING_WAIT_FOREVER.
+ *
+ * \return LDC_Status   Exit status, LDC_STATUS_TIMEOUT on timeout.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status FrameRing_AcquireWrite(FrameRing* ring, FrameRing_Slot* slot, int32_t timeout_ms)
+{
+    LDC_Status status = FrameRing_Wait(ring->header, 0U, timeout_ms); /* EXIT Status. */
+
+    if(LDC_STATUS_OK == status)
+    {
+        FrameRing_GetSlot(ring, (uint32_t)(ring->header->published % ring->header->num_of_slots),
+                          slot);
+    }
+
+    return status;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     FrameRing_Publish
+ *
+ * \brief  Publish slot acquired with FrameRing_AcquireWrite to consumer.
+ *
+ * \param  [In]  ring         Ring.
+ * \param  [In]  sequence     Frame number.
+ * \param  [In]  timestamp_ns CLOCK_MONOTONIC time of frame.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void FrameRing_Publish(FrameRing* ring, uint64_t sequence, uint64_t timestamp_ns)
+{
+    FrameRing_Header* header = ring->header;
+    FrameRing_SlotInfo* info = &header->info[header->published % header->num_of_slots];
+
+    info->sequence = sequence;
+    info->timestamp_ns = timestamp_ns;
+    __atomic_add_fetch(&header->published, 1U, __ATOMIC_SEQ_CST);
+    FrameRing_Wake(&header->consumer_event, &header->consumer_waiting, 0U);
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     FrameRing_AcquireRead
+ *
+ * \brief  Get oldest published slot for consumer, and wait while ring is empty.
+ *
+ * \param  [In]  ring         Ring.
+ * \param  [Out] slot         Published slot.
+ * \param  [In]  timeout_ms   Max wait in milliseconds, or FRAME_RING_WAIT_FOREVER.
+ *
+ * \return LDC_Status   Exit status, LDC_STATUS_TIMEOUT on timeout, error when ring is
+ *                      empty and closed.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status FrameRing_AcquireRead(FrameRing* ring, FrameRing_Slot* slot, int32_t timeout_ms)
+{
+    LDC_Status status = FrameRing_Wait(ring->header, 1U, timeout_ms); /* EXIT Status. */
+
+    if(LDC_STATUS_OK == status &&
+       __atomic_load_n(&ring->header->published, __ATOMIC_ACQUIRE) == ring->header->released)
+    {
+        /* Ring is closed, and all frames are read. */
+        status = LDC_STATUS_ERROR;
+    }
+
+    if(LDC_STATUS_OK == status)
+    {
+        FrameRing_GetSlot(ring, (uint32_t)(ring->header->released % ring->header->num_of_slots),
+                          slot);
+    }
+
+    return status;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     FrameRing_Release
+ *
+ * \brief  Return slot acquired with FrameRing_AcquireRead to producer.
+ *
+ * \param  [In]  ring         Ring.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void FrameRing_Release(FrameRing* ring)
+{
+    FrameRing_Header* header = ring->header;
+
+    __atomic_add_fetch(&header->released, 1U, __ATOMIC_SEQ_CST);
+    FrameRing_Wake(&header->producer_event, &header->producer_waiting, 0U);
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     FrameRing_Shutdown
+ *
+ * \brief  Mark that producer publishes no more frames. Consumer reads remaining frames, and
+ *         then FrameRing_AcquireRead fails without waiting.
+ *
+ * \param  [In]  ring         Ring.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void FrameRing_Shutdown(FrameRing* ring)
+{
+    FrameRing_Header* header = ring->header;
+
+    __atomic_store_n(&header->closed, 1U, __ATOMIC_SEQ_CST);
+    FrameRing_Wake(&header->consumer_event, &header->consumer_waiting, 1U);
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     FrameRing_IsDrained
+ *
+ * \brief  Check that ring is closed and all published frames are released.
+ *
+ * \param  [In]  ring         Ring.
+ *
+ * \return uint32_t     1 when ring is drained, else 0.
+ *
+ ***************************************************************************************************
+ */
+uint32_t FrameRing_IsDrained(const FrameRing* const ring)
+{
+    const FrameRing_Header* header = ring->header;
+
+    return __atomic_load_n(&header->closed, __ATOMIC_ACQUIRE) &&
+           __atomic_load_n(&header->published, __ATOMIC_ACQUIRE) ==
+           __atomic_load_n(&header->released, __ATOMIC_ACQUIRE);
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     FrameRing_CorrectFrame
+ *
+ * \brief  Correct oldest frame of input ring into free slot of output ring, with remap plan.
+ *         Source frame is read from its slot and corrected frame is written to its slot, so
+ *         frame is not copied. Sequence and timestamp of source frame are published with
+ *         output frame.
+ *
+ * \param  [In]  plan         Remap plan, with map of input and output resolution of rings.
+ * \param  [In]  in_ring      Ring of source frames, consumed.
+ * \param  [In]  out_ring     Ring of corrected frames, produced.
+ * \param  [In]  border       Border colour, or NULL to leave pixels without source untouched.
+ * \param  [In]  timeout_ms   Max wait for each ring, or FRAME_RING_WAIT_FOREVER.
+ *
+ * \return LDC_Status   Exit status, LDC_STATUS_TIMEOUT on timeout, error when input
+ *                      ring is drained.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status FrameRing_CorrectFrame(const Remap_Plan* const plan, FrameRing* in_ring,
+                                  FrameRing* out_ring, const LDC_Color* const border,
+                                  int32_t timeout_ms)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    const FrameRing_Header* in = in_ring->header;
+    const FrameRing_Header* out = out_ring->header;
+    FrameRing_Slot source;
+    FrameRing_Slot output;
+
+    if(NULL == plan || (uint32_t)plan->yuv_type != in->yuv_type ||
+       in->yuv_type != out->yuv_type || plan->map->src_width != in->width ||
+       plan->map->src_height != in->height || plan->map->width != out->width ||
+       plan->map->height != out->height)
+    {
+        status = LDC_STATUS_INVALID_ARGUMENT;
+    }
+    /* Output slot is taken first, so timeout of output ring does not drop source frame. */
+    else if(LDC_STATUS_OK != (status = FrameRing_AcquireWrite(out_ring, &output, timeout_ms)) ||
+            LDC_STATUS_OK != (status = FrameRing_AcquireRead(in_ring, &source, timeout_ms)))
+    {
+        /* Status of failed wait is returned. */
+    }
+    else
+    {
+        status = Remap_ApplyPlan(plan, output.Y, output.U, output.V, source.Y, source.U, source.V,
+                                 NULL, 0, border);
+        if(LDC_STATUS_OK == status)
+        {
+            FrameRing_Publish(out_ring, source.sequence, source.timestamp_ns);
+        }
+
+        FrameRing_Release(in_ring);
+    }
+
+    return status;
+}
@@ -0,0 +1,324 @@
+/**
+ ***************************************************************************************************
+ *
+ * \file  frame_ring.h
+ *
+ * \brief This file contains API of ring buffer of frames in POSIX shared memory, used to exchange
+ *        frames with other processes (capture, display) without copies.
+ *
+ * \arg author:  Dejan Milojica
+ * \arg version: 1.2
+ * \arg date:    13.01.2021
+ *
+ ***************************************************************************************************
+ */
+
+#ifndef FRAME_RING_H
+#define FRAME_RING_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================================== */
+/*                                       Include Files                                            */
+/* ============================================================================================== */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "../lib/ldc_types.h"
+#include "../lib/yuv_format.h"
+#include "../remap/remap.h"
+
+/* ============================================================================================== */
+/*                                     Macros & Typedefs                                          */
+/* ============================================================================================== */
+
+#define FRAME_RING_MAGIC (0x474E5246U)          /* "FRNG", first word of shared memory.        */
+#define FRAME_RING_VERSION (2U)                 /* Version of shared memory layout.            */
+#define FRAME_RING_MAX_SLOTS (64U)              /* Max number of slots of ring.                */
+#define FRAME_RING_MAX_NAME (64U)               /* Max length of shared memory name.           */
+#define FRAME_RING_WAIT_FOREVER (-1)            /* Timeout of blocking calls without limit.    */
+
+/**
+ ***************************************************************************************************
+ *
+ * \typedef FrameRing_SlotInfo
+ *
+ * \brief   Structure which represents frame metadata of slot, stored in shared memory.
+ *
+ ***************************************************************************************************
+ */
+typedef struct
+{
+    uint64_t sequence;                          /* Frame number, given by producer.       */
+    uint64_t timestamp_ns;                      /* CLOCK_MONOTONIC time of frame.         */
+}FrameRing_SlotInfo;
+
+/**
+ ***************************************************************************************************
+ *
+ * \typedef FrameRing_Header
+ *
+ * \brief   Structure which represents header of ring, at start of shared memory. Ring has one
+ *          producer and one consumer. Counters of published and released frames only grow, and
+ *          are 64-bit, so they never wrap and slot of frame is its counter modulo number of slots.
+ *          Side that has to wait sleeps in kernel on its futex word, which other side bumps
+ *          (only when waiting flag is set) after moving its counter or closing ring. Counters
+ *          of sides are on separate cache lines.
+ *
+ ***************************************************************************************************
+ */
+typedef struct
+{
+    uint32_t magic;                             /* FRAME_RING_MAGIC.                      */
+    uint32_t version;                           /* FRAME_RING_VERSION.                    */
+    uint32_t yuv_type;                          /* Type of YUV frames.                    */
+    uint32_t width;                             /* Width of frames.                       */
+    uint32_t height;                            /* Height of frames.                      */
+    uint32_t num_of_slots;                      /* Number of slots.                       */
+    uint64_t slot_size;                         /* Bytes of one slot, page aligned.       */
+    uint64_t slots_offset;                      /* Offset of first slot.                  */
+    uint64_t size;                              /* Bytes of shared memory.                */
+    uint32_t closed;                            /* Producer will publish no more frames.  */
+    uint8_t reserved0[12];
+    uint64_t published;                         /* Published frames.                      */
+    uint32_t consumer_event;                    /* Futex word of consumer.                */
+    uint32_t consumer_waiting;                  /* Consumer sleeps on its futex word.     */
+    uint8_t reserved1[48];
+    uint64_t released;                          /* Released frames.                       */
+    uint32_t producer_event;                    /* Futex word of producer.                */
+    uint32_t producer_waiting;                  /* Producer sleeps on its futex word.     */
+    uint8_t reserved2[48];
+    FrameRing_SlotInfo info[FRAME_RING_MAX_SLOTS];  /* Metadata of frames in slots.       */
+}FrameRing_Header;
+
+/**
+ ***************************************************************************************************
+ *
+ * \typedef FrameRing
+ *
+ * \brief   Structure which represents ring, mapped in this process. Every slot holds frame in
+ *          layout of components (Y, U and V planes, of YuvFormat_GetChromaWidth/Height chroma
+ *          resolution, and of bytes_per_sample samples), which is layout read and written by
+ *          remap, so frames in slots are corrected in place. For I420 and planar YUV444 it is
+ *          same as layout of frame, so such frames are captured directly into slots.
+ *
+ ***************************************************************************************************
+ */
+typedef struct
+{
+    char name[FRAME_RING_MAX_NAME];             /* Name of shared memory.                 */
+    int32_t fd;                                 /* Shared memory descriptor.              */
+    uint32_t owner;                             /* Created by this process, unlinked.     */
+    FrameRing_Header* header;                   /* Mapped shared memory.                  */
+    size_t luma_size;                           /* Bytes of Y plane of slot.              */
+    size_t chroma_size;                         /* Bytes of U or V plane of slot.         */
+}FrameRing;
+
+/**
+ ***************************************************************************************************
+ *
+ * \typedef FrameRing_Slot
+ *
+ * \brief   Structure which represents acquired slot, with pointers to its components.
+ *
+ ***************************************************************************************************
+ */
+typedef struct
+{
+    uint8_t* Y;                                 /* Y component.                           */
+    uint8_t* U;                                 /* U component.                           */
+    uint8_t* V;                                 /* V component.                           */
+    uint32_t index;                             /* Index of slot.                         */
+    uint64_t sequence;                          /* Frame number (read slots).             */
+    uint64_t timestamp_ns;                      /* Time of frame (read slots).            */
+}FrameRing_Slot;
+
+/* ============================================================================================== */
+/*                                     Function Declarations                                      */
+/* ============================================================================================== */
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     FrameRing_Create
+ *
+ * \brief  Create shared memory of ring, with slots sized for frames of given resolution and
+ *         format. Existing shared memory with same name is not reused.
+ *
+ * \param  [Out] ring         Created ring. Has to be released with FrameRing_Close.
+ * \param  [In]  name         Name of shared memory, "/name".
+ * \param  [In]  width        Width of frames.
+ * \param  [In]  height       Height of frames.
+ * \param  [In]  yuv_type     Type of YUV frames.
+ * \param  [In]  num_of_slots Number of slots, from 2 to FRAME_RING_MAX_SLOTS.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status FrameRing_Create(FrameRing* ring, const char* const name, uint32_t width,
+                            uint32_t height, YUV_Type yuv_type, uint32_t num_of_slots);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     FrameRing_Open
+ *
+ * \brief  Map ring created by other process. Resolution and format are read from header.
+ *
+ * \param  [Out] ring         Opened ring. Has to be released with FrameRing_Close.
+ * \param  [In]  name         Name of shared memory, "/name".
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status FrameRing_Open(FrameRing* ring, const char* const name);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     FrameRing_Close
+ *
+ * \brief  Unmap ring. Name of shared memory is removed by creator of ring, processes that have
+ *         ring opened keep using it.
+ *
+ * \param  [In]  ring         Ring.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void FrameRing_Close(FrameRing* ring);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     FrameRing_AcquireWrite
+ *
+ * \brief  Get next free slot for producer, and wait while ring is full.
+ *
+ * \param  [In]  ring         Ring.
+ * \param  [Out] slot         Free slot.
+ * \param  [In]  timeout_ms   Max wait in milliseconds, or FRAME_RING_WAIT_FOREVER.
+ *
+ * \return LDC_Status   Exit status, LDC_STATUS_TIMEOUT on timeout.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status FrameRing_AcquireWrite(FrameRing* ring, FrameRing_Slot* slot, int32_t timeout_ms);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     FrameRing_Publish
+ *
+ * \brief  Publish slot acquired with FrameRing_AcquireWrite to consumer.
+ *
+ * \param  [In]  ring         Ring.
+ * \param  [In]  sequence     Frame number.
+ * \param  [In]  timestamp_ns CLOCK_MONOTONIC time of frame.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void FrameRing_Publish(FrameRing* ring, uint64_t sequence, uint64_t timestamp_ns);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     FrameRing_AcquireRead
+ *
+ * \brief  Get oldest published slot for consumer, and wait while ring is empty.
+ *
+ * \param  [In]  ring         Ring.
+ * \param  [Out] slot         Published slot.
+ * \param  [In]  timeout_ms   Max wait in milliseconds, or FRAME_RING_WAIT_FOREVER.
+ *
+ * \return LDC_Status   Exit status, LDC_STATUS_TIMEOUT on timeout, error when ring is
+ *                      empty and closed.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status FrameRing_AcquireRead(FrameRing* ring, FrameRing_Slot* slot, int32_t timeout_ms);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     FrameRing_Release
+ *
+ * \brief  Return slot acquired with FrameRing_AcquireRead to producer.
+ *
+ * \param  [In]  ring         Ring.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void FrameRing_Release(FrameRing* ring);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     FrameRing_Shutdown
+ *
+ * \brief  Mark that producer publishes no more frames. Consumer reads remaining frames, and
+ *         then FrameRing_AcquireRead fails without waiting.
+ *
+ * \param  [In]  ring         Ring.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void FrameRing_Shutdown(FrameRing* ring);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     FrameRing_IsDrained
+ *
+ * \brief  Check that ring is closed and all published frames are released.
+ *
+ * \param  [In]  ring         Ring.
+ *
+ * \return uint32_t     1 when ring is drained, else 0.
+ *
+ ***************************************************************************************************
+ */
+uint32_t FrameRing_IsDrained(const FrameRing* const ring);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     FrameRing_CorrectFrame
+ *
+ * \brief  Correct oldest frame of input ring into free slot of output ring, with remap plan.
+ *         Source frame is read from its slot and corrected frame is written to its slot, so
+ *         frame is not copied. Sequence and timestamp of source frame are published with
+ *         output frame.
+ *
+ * \param  [In]  plan         Remap plan, with map of input and output resolution of rings.
+ * \param  [In]  in_ring      Ring of source frames, consumed.
+ * \param  [In]  out_ring     Ring of corrected frames, produced.
+ * \param  [In]  border       Border colour, or NULL to leave pixels without source untouched.
+ * \param  [In]  timeout_ms   Max wait for each ring, or FRAME_RING_WAIT_FOREVER.
+ *
+ * \return LDC_Status   Exit status, LDC_STATUS_TIMEOUT on timeout, error when input
+ *                      ring is drained.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status FrameRing_CorrectFrame(const Remap_Plan* const plan, FrameRing* in_ring,
+                                  FrameRing* out_ring, const LDC_Color* const border,
+                                  int32_t timeout_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
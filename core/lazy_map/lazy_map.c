@@ -0,0 +1,483 @@
+/**
+ ***************************************************************************************************
+ *
+ * \file  lazy_map.c
+ *
+ * \brief This file contains API for map, that is generated tile by tile, when correction
+ *        touches tile first time.
+ *
+ * \arg author:  Dejan Milojica
+ * \arg version: 1.2
+ * \arg date:    13.01.2021
+ *
+ ***************************************************************************************************
+ */
+
+/* ============================================================================================== */
+/*                                       Include Files                                            */
+/* ============================================================================================== */
+
+#include "lazy_map.h"
+#include "../lib/ldc_internal.h"
+#include "../lib/ldc_log.h"
+#include "../remap/remap.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* ============================================================================================== */
+/*                                       Global variables                                         */
+/* ============================================================================================== */
+
+#define LAZY_MAP_TILE_BYTES (2U * LAZY_MAP_TILE_SIZE * LAZY_MAP_TILE_SIZE * sizeof(float))
+
+/* ============================================================================================== */
+/*                              Internal Helper Functions                                         */
+/* ============================================================================================== */
+
+/* Map of tile, with positions of tile and spans of valid positions, in tile coordinates. */
+static LDC_Status LazyMap_ComputeTile(const LazyMap* const lazy, LazyMap_Tile* tile,
+                                      uint32_t tile_x, uint32_t tile_y)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    double hc = (lazy->src_width - 1)/2;    /* Optical centre, in source frame. */
+    double vc = (lazy->src_height - 1)/2;
+    double out_hc = (lazy->width - 1)/2;    /* Centre of output frame.          */
+    double out_vc = (lazy->height - 1)/2;
+    uint32_t x0 = tile_x * LAZY_MAP_TILE_SIZE;
+    uint32_t y0 = tile_y * LAZY_MAP_TILE_SIZE;
+    uint32_t tile_width = LDC_MIN(LAZY_MAP_TILE_SIZE, lazy->width - x0);
+    uint32_t tile_height = LDC_MIN(LAZY_MAP_TILE_SIZE, lazy->height - y0);
+    float xt0 = (float)(((double)x0 - out_hc) * lazy->scale + (lazy->centre_x - hc));
+    LDC_OutputSpec spec;
+    LDC_Roi roi;
+    uint32_t i;
+
+    /* Rows of map have stride of whole tile, only part inside of frame is computed. */
+    spec.width = LAZY_MAP_TILE_SIZE;
+    spec.height = tile_height;
+    spec.scale = lazy->scale;
+    spec.centre_x = lazy->centre_x;
+    spec.centre_y = lazy->centre_y;
+    spec.use_centre = 1U;
+    roi.x = 0;
+    roi.y = 0;
+    roi.width = tile_width;
+    roi.height = tile_height;
+
+    if(FrameCorrection_AllocateMap(&tile->map, lazy->src_width, lazy->src_height, &spec,
+                                   &roi, 1U))
+    {
+        status = LDC_STATUS_ERROR;
+    }
+    else
+    {
+        for(i = 0;i < tile_height;i++)
+        {
+            float yt = (float)(((double)(y0 + i) - out_vc) * lazy->scale +
+                               (lazy->centre_y - vc));
+
+            FastMap_DistortRow(&lazy->lut, tile_width, xt0, (float)lazy->scale, yt,
+                               tile->map.h_d + (size_t)i * LAZY_MAP_TILE_SIZE,
+                               tile->map.v_d + (size_t)i * LAZY_MAP_TILE_SIZE);
+        }
+
+        /* Spans of valid positions, same test as for generated map. */
+        status = FrameCorrection_UpdateSpans(&tile->map);
+
+        if(LDC_STATUS_OK != status)
+        {
+            FrameCorrection_FreeMap(&tile->map);
+        }
+    }
+
+    return status;
+}
+
+/* Free least recently used tiles, that are not in use, until new tile fits. Lock is held. */
+static void LazyMap_Evict(LazyMap* lazy)
+{
+    uint32_t num_of_tiles = lazy->tiles_x * lazy->tiles_y;
+
+    while(0U != lazy->memory_cap && lazy->memory_used + LAZY_MAP_TILE_BYTES > lazy->memory_cap)
+    {
+        LazyMap_Tile* oldest = NULL;
+        uint32_t i;
+
+        for(i = 0;i < num_of_tiles;i++)
+        {
+            LazyMap_Tile* tile = &lazy->tiles[i];
+
+            if(LAZY_MAP_TILE_READY == tile->state && 0U == tile->users &&
+               (NULL == oldest || tile->last_use < oldest->last_use))
+            {
+                oldest = tile;
+            }
+        }
+
+        /* Tiles in use are never evicted, so cap can be exceeded. */
+        if(NULL == oldest)
+        {
+            break;
+        }
+
+        FrameCorrection_FreeMap(&oldest->map);
+        oldest->state = LAZY_MAP_TILE_EMPTY;
+        lazy->memory_used -= LAZY_MAP_TILE_BYTES;
+    }
+}
+
+/* Get computed tile, computing it when it is empty. Tile has to be released after use. */
+static LazyMap_Tile* LazyMap_AcquireTile(LazyMap* lazy, uint32_t tile_x, uint32_t tile_y)
+{
+    LazyMap_Tile* tile = &lazy->tiles[(size_t)tile_y * lazy->tiles_x + tile_x];
+    LDC_Status status;
+
+    pthread_mutex_lock(&lazy->lock);
+
+    while(LAZY_MAP_TILE_COMPUTING == tile->state)
+    {
+        pthread_cond_wait(&lazy->ready_cond, &lazy->lock);
+    }
+
+    if(LAZY_MAP_TILE_EMPTY == tile->state)
+    {
+        /* This thread computes tile, others wait until it is ready. */
+        tile->state = LAZY_MAP_TILE_COMPUTING;
+        LazyMap_Evict(lazy);
+        lazy->memory_used += LAZY_MAP_TILE_BYTES;
+        pthread_mutex_unlock(&lazy->lock);
+
+        status = LazyMap_ComputeTile(lazy, tile, tile_x, tile_y);
+
+        pthread_mutex_lock(&lazy->lock);
+
+        if(LDC_STATUS_OK != status)
+        {
+            tile->state = LAZY_MAP_TILE_EMPTY;
+            lazy->memory_used -= LAZY_MAP_TILE_BYTES;
+            pthread_cond_broadcast(&lazy->ready_cond);
+            pthread_mutex_unlock(&lazy->lock);
+
+            return NULL;
+        }
+
+        tile->state = LAZY_MAP_TILE_READY;
+        pthread_cond_broadcast(&lazy->ready_cond);
+    }
+
+    tile->users++;
+    tile->last_use = ++lazy->clock;
+
+    pthread_mutex_unlock(&lazy->lock);
+
+    return tile;
+}
+
+static void LazyMap_ReleaseTile(LazyMap* lazy, LazyMap_Tile* tile)
+{
+    pthread_mutex_lock(&lazy->lock);
+    tile->users--;
+    pthread_mutex_unlock(&lazy->lock);
+}
+
+/* Remap part of region inside of tile. Kernels run in coordinates of tile, so output
+   components start at top left pixel of tile. Tile size is even, so chroma of tile starts at
+   chroma sample. */
+static void LazyMap_RemapTile(const LazyMap* const lazy, const LazyMap_Tile* const tile,
+                              const Remap_Frame* const base, const YuvFormat* const format,
+                              Remap_Kernel remap, Remap_FillKernel fill,
+                              const LDC_Roi* const region, uint32_t x0, uint32_t y0,
+                              const LDC_Color* const border)
+{
+    Remap_Frame frame = *base;
+    size_t bytes = format->bytes_per_sample;
+    size_t luma_offset = ((size_t)y0 * lazy->width + x0) * bytes;
+    size_t chroma_offset = ((size_t)(y0 >> format->chroma_shift_y) *
+                            (lazy->width >> format->chroma_shift_x) +
+                            (x0 >> format->chroma_shift_x)) * bytes;
+    LDC_Roi tile_region;
+
+    frame.Y_out = base->Y_out + luma_offset;
+    frame.U_out = base->U_out + chroma_offset;
+    frame.V_out = base->V_out + chroma_offset;
+    frame.map_width = LAZY_MAP_TILE_SIZE;
+    frame.h_d = tile->map.h_d;
+    frame.v_d = tile->map.v_d;
+
+    tile_region.x = region->x - x0;
+    tile_region.y = region->y - y0;
+    tile_region.width = region->width;
+    tile_region.height = region->height;
+
+    Remap_ApplyRois(&tile->map, &frame, remap, fill, &tile_region, 1U, border);
+}
+
+/* ============================================================================================== */
+
+/*                                     API Functions                                              */
+
+/* ============================================================================================== */
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LazyMap_Init
+ *
+ * \brief  Initialize map without computed tiles.
+ *
+ * \param  [Out] lazy         Lazy map. Has to be released with LazyMap_Deinit.
+ * \param  [In]  width        Width of source frame.
+ * \param  [In]  height       Height of source frame.
+ * \param  [In]  output       Output frame specification, or NULL for output same as source.
+ * \param  [In]  lens         Lens profile.
+ * \param  [In]  memory_cap   Max memory of computed tiles in bytes, or 0 for no cap.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status LazyMap_Init(LazyMap* lazy, uint32_t width, uint32_t height,
+                        const LDC_OutputSpec* const output, const LensProfile* const lens,
+                        size_t memory_cap)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    uint32_t out_width = (NULL == output) ? width : output->width;
+    uint32_t out_height = (NULL == output) ? height : output->height;
+
+    memset(lazy, 0, sizeof(LazyMap));
+
+    if(NULL == lens || 0U == width || 0U == height || 0U == out_width || 0U == out_height ||
+       (NULL != output && output->scale < 0.0))
+    {
+        return LDC_STATUS_ERROR;
+    }
+
+    lazy->width = out_width;
+    lazy->height = out_height;
+    lazy->src_width = width;
+    lazy->src_height = height;
+
+    /* Same defaults as FrameCorrection_GenerateMap. */
+    lazy->scale = (NULL == output || 0.0 == output->scale) ?
+                  (double)width / (double)out_width : output->scale;
+    lazy->centre_x = (NULL != output && output->use_centre) ?
+                     output->centre_x : (double)((width - 1)/2);
+    lazy->centre_y = (NULL != output && output->use_centre) ?
+                     output->centre_y : (double)((height - 1)/2);
+
+    memcpy(&lazy->lut, &lens->lut, sizeof(FastMap_RadialLut));
+    lazy->lut.hc = (float)((width - 1)/2);
+    lazy->lut.vc = (float)((height - 1)/2);
+
+    lazy->tiles_x = (out_width + LAZY_MAP_TILE_SIZE - 1U) / LAZY_MAP_TILE_SIZE;
+    lazy->tiles_y = (out_height + LAZY_MAP_TILE_SIZE - 1U) / LAZY_MAP_TILE_SIZE;
+    lazy->tiles = (LazyMap_Tile*)calloc(lazy->tiles_x * lazy->tiles_y, sizeof(LazyMap_Tile));
+    lazy->memory_cap = memory_cap;
+
+    if(NULL == lazy->tiles)
+    {
+        status = LDC_STATUS_ERROR;
+    }
+    else
+    {
+        pthread_mutex_init(&lazy->lock, NULL);
+        pthread_cond_init(&lazy->ready_cond, NULL);
+    }
+
+    return status;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LazyMap_Deinit
+ *
+ * \brief  Release memory of lazy map. Map must not be in use.
+ *
+ * \param  [In]  lazy         Lazy map.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void LazyMap_Deinit(LazyMap* lazy)
+{
+    uint32_t i;
+
+    if(NULL != lazy->tiles)
+    {
+        for(i = 0;i < lazy->tiles_x * lazy->tiles_y;i++)
+        {
+            FrameCorrection_FreeMap(&lazy->tiles[i].map);
+        }
+
+        free(lazy->tiles);
+        pthread_cond_destroy(&lazy->ready_cond);
+        pthread_mutex_destroy(&lazy->lock);
+    }
+
+    memset(lazy, 0, sizeof(LazyMap));
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LazyMap_ApplyMap
+ *
+ * \brief  Generate undistorted YUV components inside regions of interest, computing tiles that
+ *         regions touch first time. Function can be called from many threads at once.
+ *
+ * \param  [In]  lazy         Lazy map.
+ * \param  [Out] Y_out        Y component of output frame.
+ * \param  [Out] U_out        U component of output frame.
+ * \param  [Out] V_out        V component of output frame.
+ * \param  [In]  Y            Y component of source frame.
+ * \param  [In]  U            U component of source frame.
+ * \param  [In]  V            V component of source frame.
+ * \param  [In]  yuv_type     Type of YUV image.
+ * \param  [In]  interpolation  Sampling of source frame.
+ * \param  [In]  rois         Regions of interest, or NULL for whole frame.
+ * \param  [In]  num_of_rois  Number of regions of interest.
+ * \param  [In]  border       Colour of pixels without valid source pixel, or NULL to leave them
+ *                            untouched.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status LazyMap_ApplyMap(LazyMap* lazy, uint8_t* const Y_out, uint8_t* const U_out,
+                            uint8_t* const V_out, const uint8_t* const Y,
+                            const uint8_t* const U, const uint8_t* const V, YUV_Type yuv_type,
+                            LDC_Interpolation interpolation, const LDC_Roi* const rois,
+                            uint32_t num_of_rois, const LDC_Color* const border)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    const YuvFormat* format = YuvFormat_Get(yuv_type);
+    const Remap_Kernels* kernels = Remap_GetKernels(format);
+    Remap_Kernel remap;
+    Remap_Frame frame;
+    LDC_Roi frame_roi;
+    uint32_t i;
+
+    if(NULL == lazy || NULL == lazy->tiles || NULL == Y_out || NULL == U_out ||
+       NULL == V_out || NULL == Y || NULL == U || NULL == V || NULL == kernels ||
+       (LDC_INTERPOLATION_NEAREST != interpolation &&
+        LDC_INTERPOLATION_BILINEAR != interpolation))
+    {
+        return LDC_STATUS_ERROR;
+    }
+
+    /* Chroma components are sized by subsampling, so frames have to be its multiples. */
+    if(YuvFormat_ValidateSize(format, lazy->width, lazy->height) ||
+       YuvFormat_ValidateSize(format, lazy->src_width, lazy->src_height))
+    {
+        return LDC_STATUS_INVALID_ARGUMENT;
+    }
+
+    /* Kernels are selected once for frame, by layout of format and interpolation. */
+    remap = (LDC_INTERPOLATION_BILINEAR == interpolation) ? kernels->map_bilinear :
+                                                            kernels->map_nearest;
+    frame.Y_out = Y_out;
+    frame.U_out = U_out;
+    frame.V_out = V_out;
+    frame.Y = Y;
+    frame.U = U;
+    frame.V = V;
+    frame.width = lazy->width;
+    frame.src_width = lazy->src_width;
+    frame.src_height = lazy->src_height;
+    frame.map_width = LAZY_MAP_TILE_SIZE;
+    frame.h_d = NULL;
+    frame.v_d = NULL;
+    frame.plan = NULL;
+
+    if(NULL == rois)
+    {
+        frame_roi.x = 0;
+        frame_roi.y = 0;
+        frame_roi.width = lazy->width;
+        frame_roi.height = lazy->height;
+    }
+
+    for(i = 0;i < ((NULL == rois) ? 1U : num_of_rois) && LDC_STATUS_OK == status;i++)
+    {
+        const LDC_Roi* roi = (NULL == rois) ? &frame_roi : &rois[i];
+        uint32_t tile_x;
+        uint32_t tile_y;
+
+        /* Region must not be empty, and must be inside of frame. */
+        if(0U == roi->width || 0U == roi->height || roi->x >= lazy->width ||
+           roi->y >= lazy->height || roi->width > lazy->width - roi->x ||
+           roi->height > lazy->height - roi->y)
+        {
+            status = LDC_STATUS_INVALID_ARGUMENT;
+            LdcLog_Write(LDC_LOG_ERROR, status, INVALID_ROI_ERROR_MESSAGE);
+            break;
+        }
+
+        for(tile_y = roi->y / LAZY_MAP_TILE_SIZE;
+            tile_y <= (roi->y + roi->height - 1U) / LAZY_MAP_TILE_SIZE &&
+            LDC_STATUS_OK == status;tile_y++)
+        {
+            for(tile_x = roi->x / LAZY_MAP_TILE_SIZE;
+                tile_x <= (roi->x + roi->width - 1U) / LAZY_MAP_TILE_SIZE;tile_x++)
+            {
+                uint32_t x0 = tile_x * LAZY_MAP_TILE_SIZE;
+                uint32_t y0 = tile_y * LAZY_MAP_TILE_SIZE;
+                LazyMap_Tile* tile;
+                LDC_Roi region;
+
+                /* Part of region inside of tile. */
+                region.x = LDC_MAX(roi->x, x0);
+                region.y = LDC_MAX(roi->y, y0);
+                region.width = LDC_MIN(roi->x + roi->width, x0 + LAZY_MAP_TILE_SIZE) - region.x;
+                region.height = LDC_MIN(roi->y + roi->height, y0 + LAZY_MAP_TILE_SIZE) - region.y;
+
+                tile = LazyMap_AcquireTile(lazy, tile_x, tile_y);
+                if(NULL == tile)
+                {
+                    status = LDC_STATUS_ERROR;
+                    break;
+                }
+
+                LazyMap_RemapTile(lazy, tile, &frame, format, remap, kernels->fill, &region,
+                                  x0, y0, border);
+                LazyMap_ReleaseTile(lazy, tile);
+            }
+        }
+    }
+
+    return status;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LazyMap_GetMemoryUsage
+ *
+ * \brief  Get number and memory of computed tiles.
+ *
+ * \param  [In]  lazy            Lazy map.
+ * \param  [Out] num_of_tiles    Number of computed tiles, or NULL.
+ * \param  [Out] memory_used     Memory of computed tiles in bytes, or NULL.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void LazyMap_GetMemoryUsage(LazyMap* lazy, uint32_t* num_of_tiles, size_t* memory_used)
+{
+    pthread_mutex_lock(&lazy->lock);
+
+    if(NULL != num_of_tiles)
+    {
+        *num_of_tiles = (uint32_t)(lazy->memory_used / LAZY_MAP_TILE_BYTES);
+    }
+
+    if(NULL != memory_used)
+    {
+        *memory_used = lazy->memory_used;
+    }
+
+    pthread_mutex_unlock(&lazy->lock);
+}
@@ -0,0 +1,203 @@
+/**
+ ***************************************************************************************************
+ *
+ * \file  lazy_map.h
+ *
+ * \brief This file contains API for map, that is generated tile by tile, when correction
+ *        touches tile first time.
+ *
+ * \arg author:  Dejan Milojica
+ * \arg version: 1.2
+ * \arg date:    13.01.2021
+ *
+ ***************************************************************************************************
+ */
+
+#ifndef LAZY_MAP_H
+#define LAZY_MAP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================================== */
+/*                                       Include Files                                            */
+/* ============================================================================================== */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+
+#include "../lib/ldc_types.h"
+#include "../correction_distortion/correction_distortion.h"
+#include "../fast_map/fast_map.h"
+#include "../lens_registry/lens_registry.h"
+
+/* ============================================================================================== */
+/*                                     Macros & Typedefs                                          */
+/* ============================================================================================== */
+
+#define LAZY_MAP_TILE_SIZE (64U)        /* Width and height of tile, even so chroma of 2x2    */
+                                        /* pixels is never shared between tiles.              */
+
+/**
+ ***************************************************************************************************
+ *
+ * \typedef LazyMap_TileState
+ *
+ * \brief   Defines possible states of map tile.
+ *
+ ***************************************************************************************************
+ */
+typedef enum
+{
+    LAZY_MAP_TILE_EMPTY     = 0,  /* Positions are not computed, or tile is evicted. */
+    LAZY_MAP_TILE_COMPUTING = 1,  /* Positions are computed by one thread.            */
+    LAZY_MAP_TILE_READY     = 2   /* Positions can be used.                           */
+} LazyMap_TileState;
+
+/**
+ ***************************************************************************************************
+ *
+ * \typedef LazyMap_Tile
+ *
+ * \brief   Structure which represents source positions of one tile of output frame. Positions
+ *          and spans of valid positions are stored as map of tile, in coordinates of tile, so
+ *          tile is remapped with kernels of core/remap.
+ *
+ ***************************************************************************************************
+ */
+typedef struct
+{
+    LDC_Map map;                                /* Positions of tile, row stride tile size. */
+    LazyMap_TileState state;                    /* State of tile.                           */
+    uint32_t users;                             /* Number of threads, that use positions.   */
+    uint64_t last_use;                          /* Time of last use, for eviction.          */
+}LazyMap_Tile;
+
+/**
+ ***************************************************************************************************
+ *
+ * \typedef LazyMap
+ *
+ * \brief   Structure which represents map divided into tiles. Every tile is computed once, by
+ *          first thread that needs it, and other threads wait for it. With memory cap, least
+ *          recently used tiles, that are not in use, are evicted and computed again when needed.
+ *
+ ***************************************************************************************************
+ */
+typedef struct
+{
+    uint32_t width;                             /* Width of output frame.                 */
+    uint32_t height;                            /* Height of output frame.                */
+    uint32_t src_width;                         /* Width of source frame.                 */
+    uint32_t src_height;                        /* Height of source frame.                */
+    double scale;                               /* Source pixels per output pixel.        */
+    double centre_x;                            /* Horizontal output centre in source.    */
+    double centre_y;                            /* Vertical output centre in source.      */
+    FastMap_RadialLut lut;                      /* Radial LUT of lens.                    */
+    LazyMap_Tile* tiles;                        /* Tiles, row by row.                     */
+    uint32_t tiles_x;                           /* Number of tiles in row.                */
+    uint32_t tiles_y;                           /* Number of tiles in column.             */
+    size_t memory_cap;                          /* Max memory of positions, 0 for no cap. */
+    size_t memory_used;                         /* Memory of computed tiles.              */
+    uint64_t clock;                             /* Counter of tile uses.                  */
+    pthread_mutex_t lock;                       /* Protects state of tiles.               */
+    pthread_cond_t ready_cond;                  /* Signaled when tile is computed.        */
+}LazyMap;
+
+/* ============================================================================================== */
+/*                                     Function Declarations                                      */
+/* ============================================================================================== */
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LazyMap_Init
+ *
+ * \brief  Initialize map without computed tiles.
+ *
+ * \param  [Out] lazy         Lazy map. Has to be released with LazyMap_Deinit.
+ * \param  [In]  width        Width of source frame.
+ * \param  [In]  height       Height of source frame.
+ * \param  [In]  output       Output frame specification, or NULL for output same as source.
+ * \param  [In]  lens         Lens profile.
+ * \param  [In]  memory_cap   Max memory of computed tiles in bytes, or 0 for no cap.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status LazyMap_Init(LazyMap* lazy, uint32_t width, uint32_t height,
+                        const LDC_OutputSpec* const output, const LensProfile* const lens,
+                        size_t memory_cap);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LazyMap_Deinit
+ *
+ * \brief  Release memory of lazy map. Map must not be in use.
+ *
+ * \param  [In]  lazy         Lazy map.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void LazyMap_Deinit(LazyMap* lazy);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LazyMap_ApplyMap
+ *
+ * \brief  Generate undistorted YUV components inside regions of interest, computing tiles that
+ *         regions touch first time. Function can be called from many threads at once.
+ *
+ * \param  [In]  lazy         Lazy map.
+ * \param  [Out] Y_out        Y component of output frame.
+ * \param  [Out] U_out        U component of output frame.
+ * \param  [Out] V_out        V component of output frame.
+ * \param  [In]  Y            Y component of source frame.
+ * \param  [In]  U            U component of source frame.
+ * \param  [In]  V            V component of source frame.
+ * \param  [In]  yuv_type     Type of YUV image.
+ * \param  [In]  interpolation  Sampling of source frame.
+ * \param  [In]  rois         Regions of interest, or NULL for whole frame.
+ * \param  [In]  num_of_rois  Number of regions of interest.
+ * \param  [In]  border       Colour of pixels without valid source pixel, or NULL to leave them
+ *                            untouched.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status LazyMap_ApplyMap(LazyMap* lazy, uint8_t* const Y_out, uint8_t* const U_out,
+                            uint8_t* const V_out, const uint8_t* const Y,
+                            const uint8_t* const U, const uint8_t* const V, YUV_Type yuv_type,
+                            LDC_Interpolation interpolation, const LDC_Roi* const rois,
+                            uint32_t num_of_rois, const LDC_Color* const border);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LazyMap_GetMemoryUsage
+ *
+ * \brief  Get number and memory of computed tiles.
+ *
+ * \param  [In]  lazy            Lazy map.
+ * \param  [Out] num_of_tiles    Number of computed tiles, or NULL.
+ * \param  [Out] memory_used     Memory of computed tiles in bytes, or NULL.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void LazyMap_GetMemoryUsage(LazyMap* lazy, uint32_t* num_of_tiles, size_t* memory_used);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
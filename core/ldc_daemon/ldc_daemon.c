@@ -0,0 +1,1268 @@
+/**
+ ***************************************************************************************************
+ *
+ * \file  ldc_daemon.c
+ *
+ * \brief This file contains API of correction daemon, that keeps maps of lenses warm and
+ *        corrects frames for clients over Unix domain socket, and API of its clients.
+ *
+ * \arg author:  Dejan Milojica
+ * \arg version: 1.2
+ * \arg date:    13.01.2021
+ *
+ ***************************************************************************************************
+ */
+
+/* ============================================================================================== */
+/*                                       Include Files                                            */
+/* ============================================================================================== */
+
+/* Sealing of memory (memfd_create, F_ADD_SEALS) is Linux specific. */
+#define _GNU_SOURCE
+
+#include "ldc_daemon.h"
+#include "../lib/ldc_log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/inotify.h>
+
+/* ============================================================================================== */
+/*                                       Global variables                                         */
+/* ============================================================================================== */
+
+#define LDC_DAEMON_BACKLOG (16)                 /* Pending connections of listening socket.    */
+#define LDC_DAEMON_POLL_MS (200)                /* Period of stop checks of blocking loops.    */
+#define LDC_DAEMON_EVENTS_SIZE (4096U)          /* Buffer of inotify events.                   */
+#define LDC_DAEMON_MAX_FDS (16U)                /* Descriptors received with one request.      */
+
+/* Directory changes that end write of file, also by rename of temporary file. */
+#define LDC_DAEMON_WATCH_MASK (IN_CLOSE_WRITE | IN_MOVED_TO)
+
+/**
+ ***************************************************************************************************
+ *
+ * \typedef LdcDaemon_Client
+ *
+ * \brief   Structure which represents connected client, with component buffers reused between
+ *          its requests.
+ *
+ ***************************************************************************************************
+ */
+typedef struct
+{
+    LdcDaemon_Server* server;                   /* Daemon.                                */
+    int32_t fd;                                 /* Connected socket.                      */
+    uint8_t* components;                        /* Y, U, V of source and output frame.    */
+    size_t capacity;                            /* Size of components buffer.             */
+}LdcDaemon_Client;
+
+/* ============================================================================================== */
+/*                              Internal Helper Functions                                         */
+/* ============================================================================================== */
+
+static uint64_t LdcDaemon_GetTime(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+static void LdcDaemon_GetOutput(const LdcDaemon_Request* const request, LDC_OutputSpec* output)
+{
+    output->width = (0U == request->out_width) ? request->width : request->out_width;
+    output->height = (0U == request->out_height) ? request->height : request->out_height;
+    output->scale = request->scale;
+    output->centre_x = request->centre_x;
+    output->centre_y = request->centre_y;
+    output->use_centre = request->use_centre;
+}
+
+static int32_t LdcDaemon_IsSameMap(const LdcDaemon_Map* const map,
+                                   const LdcDaemon_Request* const request)
+{
+    LDC_OutputSpec output;
+
+    LdcDaemon_GetOutput(request, &output);
+
+    return map->lens_id == request->lens_id && map->yuv_type == (YUV_Type)request->yuv_type &&
+           map->interpolation == (LDC_Interpolation)request->interpolation &&
+           map->width == request->width && map->height == request->height &&
+           map->output.width == output.width && map->output.height == output.height &&
+           map->output.scale == output.scale && map->output.use_centre == output.use_centre &&
+           (!output.use_centre || (map->output.centre_x == output.centre_x &&
+                                   map->output.centre_y == output.centre_y));
+}
+
+static void LdcDaemon_ReleaseMap(LdcDaemon_Map* map)
+{
+    if(NULL != map && 0U == __atomic_sub_fetch(&map->ref_count, 1U, __ATOMIC_ACQ_REL))
+    {
+        Remap_FreePlan(&map->plan);
+        FrameCorrection_FreeMap(&map->map);
+        free(map);
+    }
+}
+
+/* Generation of current profile of lens. Lock is held. */
+static uint32_t LdcDaemon_GetGeneration(const LdcDaemon_Server* const server, uint32_t lens_id)
+{
+    uint32_t i;
+
+    for(i = 0;i < server->num_of_lenses;i++)
+    {
+        if(server->lenses[i].lens_id == lens_id)
+        {
+            return server->lenses[i].generation;
+        }
+    }
+
+    return 0;
+}
+
+/* Link of map of request in list of warm maps, or link of end of list. Lock is held. */
+static LdcDaemon_Map** LdcDaemon_FindMap(LdcDaemon_Server* server,
+                                         const LdcDaemon_Request* const request)
+{
+    LdcDaemon_Map** link;
+
+    for(link = &server->maps;NULL != *link && !LdcDaemon_IsSameMap(*link, request);)
+    {
+        link = &(*link)->next;
+    }
+
+    return link;
+}
+
+/* Unlink least recently used maps, until number of maps is in limit. Unlinked maps are chained
+   in returned list, and released by caller without lock. Lock is held. */
+static LdcDaemon_Map* LdcDaemon_EvictMaps(LdcDaemon_Server* server)
+{
+    LdcDaemon_Map* evicted = NULL;
+
+    while(server->num_of_maps > server->max_maps)
+    {
+        LdcDaemon_Map** oldest = &server->maps;
+        LdcDaemon_Map** link;
+        LdcDaemon_Map* map;
+
+        for(link = &server->maps;NULL != *link;link = &(*link)->next)
+        {
+            oldest = ((*link)->last_used < (*oldest)->last_used) ? link : oldest;
+        }
+
+        map = *oldest;
+        *oldest = map->next;
+        map->next = evicted;
+        evicted = map;
+        server->num_of_maps--;
+    }
+
+    return evicted;
+}
+
+static void LdcDaemon_ReleaseMaps(LdcDaemon_Map* maps)
+{
+    while(NULL != maps)
+    {
+        LdcDaemon_Map* map = maps;
+
+        maps = map->next;
+        LdcDaemon_ReleaseMap(map);
+    }
+}
+
+/* Map and plan with current profile of lens, with one reference owned by caller. */
+static LDC_Status LdcDaemon_CreateMap(LdcDaemon_Server* server,
+                                      const LdcDaemon_Request* const request,
+                                      LdcDaemon_Map** map)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    const LensProfile* lens;
+    LdcDaemon_Map* new_map = (LdcDaemon_Map*)calloc(1, sizeof(LdcDaemon_Map));
+    uint32_t generation;
+
+    /* Generation is read before profile, so profile replaced meanwhile makes map stale, and
+       map is never newer than its generation says. */
+    pthread_mutex_lock(&server->lock);
+    generation = LdcDaemon_GetGeneration(server, request->lens_id);
+    pthread_mutex_unlock(&server->lock);
+
+    lens = LensRegistry_Acquire(&server->registry, request->lens_id);
+
+    if(NULL == lens || NULL == new_map)
+    {
+        status = LDC_STATUS_ERROR;
+    }
+    else
+    {
+        new_map->lens_id = request->lens_id;
+        new_map->generation = generation;
+        new_map->yuv_type = (YUV_Type)request->yuv_type;
+        new_map->interpolation = (LDC_Interpolation)request->interpolation;
+        new_map->width = request->width;
+        new_map->height = request->height;
+        new_map->ref_count = 1U;
+        LdcDaemon_GetOutput(request, &new_map->output);
+
+        if(FrameCorrection_GenerateMap(&new_map->map, request->width, request->height,
+                                       &new_map->output, NULL, 0, lens, NULL))
+        {
+            status = LDC_STATUS_ERROR;
+        }
+        else if(Remap_CreatePlan(&new_map->plan, &new_map->map, new_map->yuv_type,
+                                 new_map->interpolation))
+        {
+            FrameCorrection_FreeMap(&new_map->map);
+            status = LDC_STATUS_ERROR;
+        }
+    }
+
+    if(LDC_STATUS_OK == status)
+    {
+        *map = new_map;
+    }
+    else
+    {
+        free(new_map);
+    }
+
+    LensProfile_Release(lens);
+
+    return status;
+}
+
+/* Warm map of request, generated on first use. Map of replaced lens profile is not used, and
+   it is generated again. */
+static LDC_Status LdcDaemon_AcquireMap(LdcDaemon_Server* server,
+                                       const LdcDaemon_Request* const request,
+                                       LdcDaemon_Map** map, uint32_t* generated)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    LdcDaemon_Map* found = NULL;
+
+    *generated = 0U;
+
+    while(LDC_STATUS_OK == status && NULL == found)
+    {
+        LdcDaemon_Map* new_map = NULL;
+        LdcDaemon_Map* evicted = NULL;
+        LdcDaemon_Map** link;
+        uint32_t generation;
+
+        pthread_mutex_lock(&server->lock);
+        link = LdcDaemon_FindMap(server, request);
+        generation = LdcDaemon_GetGeneration(server, request->lens_id);
+
+        if(NULL != *link && (*link)->generation == generation)
+        {
+            found = *link;
+            found->last_used = LdcDaemon_GetTime();
+            __atomic_add_fetch(&found->ref_count, 1U, __ATOMIC_RELAXED);
+        }
+        pthread_mutex_unlock(&server->lock);
+
+        /* Map is generated without lock, so other clients are not blocked. */
+        if(NULL != found)
+        {
+            break;
+        }
+        else if(LdcDaemon_CreateMap(server, request, &new_map))
+        {
+            status = LDC_STATUS_ERROR;
+            break;
+        }
+
+        /* Map of profile, that was replaced while map was generated, is dropped, and map is
+           generated again. */
+        pthread_mutex_lock(&server->lock);
+        link = LdcDaemon_FindMap(server, request);
+        generation = LdcDaemon_GetGeneration(server, request->lens_id);
+
+        if(NULL != *link && (*link)->generation == generation)
+        {
+            /* Other client generated same map first. */
+            found = *link;
+        }
+        else if(new_map->generation == generation)
+        {
+            /* Map of previous profile is replaced in list, requests in progress keep it. */
+            if(NULL != *link)
+            {
+                evicted = *link;
+                new_map->next = evicted->next;
+                evicted->next = NULL;
+            }
+            else
+            {
+                server->num_of_maps++;
+            }
+
+            new_map->last_used = LdcDaemon_GetTime();
+            *link = new_map;
+            found = new_map;
+            new_map = NULL;
+            *generated = 1U;
+
+            if(NULL == evicted)
+            {
+                evicted = LdcDaemon_EvictMaps(server);
+            }
+        }
+
+        if(NULL != found)
+        {
+            found->last_used = LdcDaemon_GetTime();
+            __atomic_add_fetch(&found->ref_count, 1U, __ATOMIC_RELAXED);
+        }
+        pthread_mutex_unlock(&server->lock);
+
+        LdcDaemon_ReleaseMap(new_map);
+        LdcDaemon_ReleaseMaps(evicted);
+    }
+
+    if(NULL != found)
+    {
+        *map = found;
+    }
+
+    return status;
+}
+
+/* Reload lens file, and replace every map of lens with map of new profile. */
+static void LdcDaemon_ReloadLens(LdcDaemon_Server* server, const LdcDaemon_Lens* const lens)
+{
+    LdcDaemon_Map** old_maps = NULL;
+    LdcDaemon_Map* map;
+    uint32_t num_of_maps = 0;
+    uint32_t i;
+
+    /* Profile is replaced only when new file is valid, so broken edit keeps old lens. */
+    if(LensRegistry_LoadFile(&server->registry, lens->lens_id, lens->filename))
+    {
+        LdcLog_Write(LDC_LOG_WARNING, LDC_STATUS_INVALID_LENS,
+                     "Reload of lens %u failed, previous lens is kept: %s", lens->lens_id,
+                     lens->filename);
+        return;
+    }
+
+    pthread_mutex_lock(&server->lock);
+    for(i = 0;i < server->num_of_lenses;i++)
+    {
+        server->lenses[i].generation += (server->lenses[i].lens_id == lens->lens_id) ? 1U : 0U;
+    }
+
+    for(map = server->maps;NULL != map;map = map->next)
+    {
+        num_of_maps += (map->lens_id == lens->lens_id) ? 1U : 0U;
+    }
+
+    old_maps = (LdcDaemon_Map**)calloc(num_of_maps + 1U, sizeof(LdcDaemon_Map*));
+    num_of_maps = 0;
+
+    for(map = server->maps;NULL != map && NULL != old_maps;map = map->next)
+    {
+        if(map->lens_id == lens->lens_id)
+        {
+            __atomic_add_fetch(&map->ref_count, 1U, __ATOMIC_RELAXED);
+            old_maps[num_of_maps++] = map;
+        }
+    }
+    pthread_mutex_unlock(&server->lock);
+
+    for(i = 0;i < num_of_maps;i++)
+    {
+        LdcDaemon_Request request;
+        LdcDaemon_Map* new_map = NULL;
+        LdcDaemon_Map** link;
+
+        memset(&request, 0, sizeof(request));
+        request.lens_id = old_maps[i]->lens_id;
+        request.yuv_type = (uint32_t)old_maps[i]->yuv_type;
+        request.interpolation = (uint32_t)old_maps[i]->interpolation;
+        request.width = old_maps[i]->width;
+        request.height = old_maps[i]->height;
+        request.out_width = old_maps[i]->output.width;
+        request.out_height = old_maps[i]->output.height;
+        request.scale = old_maps[i]->output.scale;
+        request.centre_x = old_maps[i]->output.centre_x;
+        request.centre_y = old_maps[i]->output.centre_y;
+        request.use_centre = old_maps[i]->output.use_centre;
+
+        /* New map is built in background, and swapped with old one in list. */
+        if(!LdcDaemon_CreateMap(server, &request, &new_map))
+        {
+            pthread_mutex_lock(&server->lock);
+            for(link = &server->maps;NULL != *link && *link != old_maps[i];)
+            {
+                link = &(*link)->next;
+            }
+
+            /* Map evicted or replaced meanwhile, or of profile replaced by next reload, is
+               not swapped. */
+            if(NULL != *link &&
+               new_map->generation == LdcDaemon_GetGeneration(server, new_map->lens_id))
+            {
+                new_map->last_used = old_maps[i]->last_used;
+                new_map->next = old_maps[i]->next;
+                old_maps[i]->next = NULL;
+                *link = new_map;
+                new_map = old_maps[i];
+            }
+            pthread_mutex_unlock(&server->lock);
+
+            /* Reference of list, requests in progress keep their own references. */
+            LdcDaemon_ReleaseMap(new_map);
+        }
+
+        LdcDaemon_ReleaseMap(old_maps[i]);
+    }
+
+    LdcLog_Write(LDC_LOG_INFO, LDC_STATUS_OK, "Lens %u reloaded, %u maps regenerated: %s",
+                 lens->lens_id, num_of_maps, lens->filename);
+    free(old_maps);
+}
+
+static void* LdcDaemon_ReloadThread(void* arg)
+{
+    LdcDaemon_Server* server = (LdcDaemon_Server*)arg;
+    char events[LDC_DAEMON_EVENTS_SIZE]
+        __attribute__((aligned(__alignof__(struct inotify_event))));
+
+    while(!__atomic_load_n(&server->stop, __ATOMIC_ACQUIRE))
+    {
+        struct pollfd pfd = {server->inotify_fd, POLLIN, 0};
+        ssize_t size;
+        ssize_t offset;
+
+        if(poll(&pfd, 1, LDC_DAEMON_POLL_MS) <= 0)
+        {
+            continue;
+        }
+
+        size = read(server->inotify_fd, events, sizeof(events));
+
+        for(offset = 0;offset < size;)
+        {
+            const struct inotify_event* event = (const struct inotify_event*)&events[offset];
+            uint32_t i;
+
+            for(i = 0;event->len > 0U;i++)
+            {
+                LdcDaemon_Lens lens;
+                int32_t found = 0;
+
+                /* Lens is copied, array can grow while lens is reloaded. */
+                pthread_mutex_lock(&server->lock);
+                if(i < server->num_of_lenses)
+                {
+                    lens = server->lenses[i];
+                    found = 1;
+                }
+                pthread_mutex_unlock(&server->lock);
+
+                if(!found)
+                {
+                    break;
+                }
+
+                if(event->wd == lens.watch && 0 == strcmp(event->name, lens.basename))
+                {
+                    LdcDaemon_ReloadLens(server, &lens);
+                }
+            }
+
+            offset += (ssize_t)(sizeof(struct inotify_event) + event->len);
+        }
+    }
+
+    return NULL;
+}
+
+/* Memory of frame can not be shrunk, so mapping of checked size stays valid. */
+static int32_t LdcDaemon_IsSealed(int32_t fd)
+{
+    int32_t seals = fcntl(fd, F_GET_SEALS);
+
+    return (seals >= 0) && (0 != (seals & F_SEAL_SHRINK));
+}
+
+static LDC_Status LdcDaemon_EnsureCapacity(LdcDaemon_Client* client, size_t size)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+
+    if(size > client->capacity)
+    {
+        uint8_t* components = (uint8_t*)realloc(client->components, size);
+
+        if(NULL == components)
+        {
+            status = LDC_STATUS_ERROR;
+        }
+        else
+        {
+            client->components = components;
+            client->capacity = size;
+        }
+    }
+
+    return status;
+}
+
+/* Correct frame of shared memory, with warm map of request. */
+static LDC_Status LdcDaemon_Process(LdcDaemon_Client* client,
+                                    const LdcDaemon_Request* const request, int32_t in_fd,
+                                    int32_t out_fd, LdcDaemon_Response* response)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    const YuvFormat* format = YuvFormat_Get((YUV_Type)request->yuv_type);
+    LDC_OutputSpec output;
+    LdcDaemon_Map* map = NULL;
+    uint8_t* in = MAP_FAILED;
+    uint8_t* out = MAP_FAILED;
+    size_t in_size = 0;
+    size_t out_size = 0;
+    struct stat in_stat;
+    struct stat out_stat;
+
+    LdcDaemon_GetOutput(request, &output);
+
+    if(NULL != format)
+    {
+        in_size = YuvFormat_GetFrameSize(request->width, request->height, format->yuv_type);
+        out_size = YuvFormat_GetFrameSize(output.width, output.height, format->yuv_type);
+    }
+
+    if(LDC_DAEMON_MAGIC != request->magic || LDC_DAEMON_VERSION != request->version ||
+       NULL == format || 0U == in_size || 0U == out_size ||
+       request->interpolation > (uint32_t)LDC_INTERPOLATION_BILINEAR)
+    {
+        status = LDC_STATUS_ERROR;
+    }
+    /* Components are sized by chroma subsampling, so frames have to be its multiples. */
+    else if(YuvFormat_ValidateSize(format, request->width, request->height) ||
+            YuvFormat_ValidateSize(format, output.width, output.height))
+    {
+        status = LDC_STATUS_INVALID_ARGUMENT;
+    }
+    /* Memory, that client could truncate after it is checked, would raise SIGBUS in daemon. */
+    else if(!LdcDaemon_IsSealed(in_fd) || !LdcDaemon_IsSealed(out_fd))
+    {
+        status = LDC_STATUS_INVALID_ARGUMENT;
+        LdcLog_Write(LDC_LOG_WARNING, status, "Request with memory not sealed against shrinking.");
+    }
+    /* Shared memory has to hold whole frames. */
+    else if(0 != fstat(in_fd, &in_stat) || 0 != fstat(out_fd, &out_stat) ||
+            (size_t)in_stat.st_size < in_size || (size_t)out_stat.st_size < out_size)
+    {
+        status = LDC_STATUS_ERROR;
+    }
+    else
+    {
+        in = (uint8_t*)mmap(NULL, in_size, PROT_READ, MAP_SHARED, in_fd, 0);
+        out = (uint8_t*)mmap(NULL, out_size, PROT_READ | PROT_WRITE, MAP_SHARED, out_fd, 0);
+
+        if(MAP_FAILED == in || MAP_FAILED == out ||
+           LdcDaemon_AcquireMap(client->server, request, &map, &response->map_generated))
+        {
+            status = LDC_STATUS_ERROR;
+        }
+    }
+
+    if(LDC_STATUS_OK == status)
+    {
+        uint32_t bytes = format->bytes_per_sample;
+        size_t luma_size = (size_t)request->width * request->height * bytes;
+        size_t chroma_size = (size_t)YuvFormat_GetChromaWidth(request->width, format->yuv_type) *
+                             YuvFormat_GetChromaHeight(request->height, format->yuv_type) *
+                             bytes;
+        size_t out_luma_size = (size_t)output.width * output.height * bytes;
+        size_t out_chroma_size = (size_t)YuvFormat_GetChromaWidth(output.width,
+                                                                  format->yuv_type) *
+                                 YuvFormat_GetChromaHeight(output.height, format->yuv_type) *
+                                 bytes;
+        LDC_Color border = {request->border_y, request->border_u, request->border_v};
+        uint64_t start = LdcDaemon_GetTime();
+
+        if(LdcDaemon_EnsureCapacity(client, luma_size + 2U * chroma_size + out_luma_size +
+                                            2U * out_chroma_size))
+        {
+            status = LDC_STATUS_ERROR;
+        }
+        else
+        {
+            uint8_t* Y = client->components;
+            uint8_t* U = Y + luma_size;
+            uint8_t* V = U + chroma_size;
+            uint8_t* Y_out = V + chroma_size;
+            uint8_t* U_out = Y_out + out_luma_size;
+            uint8_t* V_out = U_out + out_chroma_size;
+
+            /* Pixels without source keep zero, as in FrameCorrection_CorrectLensDistortion. */
+            if(!request->use_border)
+            {
+                memset(Y_out, 0, out_luma_size + 2U * out_chroma_size);
+            }
+
+            YuvFormat_Split(format, in, Y, U, V, request->width, request->height);
+            status = Remap_ApplyPlan(&map->plan, Y_out, U_out, V_out, Y, U, V, NULL, 0,
+                                     request->use_border ? &border : NULL);
+            YuvFormat_Combine(format, out, Y_out, U_out, V_out, output.width, output.height);
+        }
+
+        response->remap_time_ns = LdcDaemon_GetTime() - start;
+    }
+
+    LdcDaemon_ReleaseMap(map);
+
+    if(MAP_FAILED != in)
+    {
+        munmap(in, in_size);
+    }
+
+    if(MAP_FAILED != out)
+    {
+        munmap(out, out_size);
+    }
+
+    return status;
+}
+
+static void* LdcDaemon_ClientThread(void* arg)
+{
+    LdcDaemon_Client* client = (LdcDaemon_Client*)arg;
+    LdcDaemon_Server* server = client->server;
+    int32_t connected = 1;
+
+    while(connected && !__atomic_load_n(&server->stop, __ATOMIC_ACQUIRE))
+    {
+        struct pollfd pfd = {client->fd, POLLIN, 0};
+        LdcDaemon_Request request;
+        LdcDaemon_Response response;
+        union
+        {
+            char buffer[CMSG_SPACE(LDC_DAEMON_MAX_FDS * sizeof(int32_t))];
+            struct cmsghdr align;
+        }control;
+        struct iovec iov = {&request, sizeof(request)};
+        struct msghdr msg;
+        struct cmsghdr* cmsg;
+        int32_t fds[LDC_DAEMON_MAX_FDS];
+        uint32_t num_of_fds = 0;
+        uint32_t i;
+        ssize_t size;
+
+        if(poll(&pfd, 1, LDC_DAEMON_POLL_MS) <= 0)
+        {
+            continue;
+        }
+
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control.buffer;
+        msg.msg_controllen = sizeof(control.buffer);
+
+        size = recvmsg(client->fd, &msg, 0);
+        if(size <= 0)
+        {
+            connected = 0;
+            continue;
+        }
+
+        /* Every received descriptor is owned by daemon, also of malformed requests. */
+        for(cmsg = CMSG_FIRSTHDR(&msg);NULL != cmsg;cmsg = CMSG_NXTHDR(&msg, cmsg))
+        {
+            if(SOL_SOCKET == cmsg->cmsg_level && SCM_RIGHTS == cmsg->cmsg_type)
+            {
+                size_t count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int32_t);
+
+                for(i = 0;i < count;i++)
+                {
+                    int32_t fd;
+
+                    memcpy(&fd, CMSG_DATA(cmsg) + i * sizeof(int32_t), sizeof(int32_t));
+
+                    if(num_of_fds < LDC_DAEMON_MAX_FDS)
+                    {
+                        fds[num_of_fds++] = fd;
+                    }
+                    else
+                    {
+                        close(fd);
+                    }
+                }
+            }
+        }
+
+        memset(&response, 0, sizeof(response));
+        response.magic = LDC_DAEMON_MAGIC;
+        response.status = (uint32_t)LDC_STATUS_ERROR;
+
+        /* Request carries exactly source and output descriptor. */
+        if(sizeof(request) == (size_t)size && 0 == (msg.msg_flags & (MSG_TRUNC | MSG_CTRUNC)) &&
+           2U == num_of_fds)
+        {
+            response.status = (uint32_t)LdcDaemon_Process(client, &request, fds[0], fds[1],
+                                                          &response);
+        }
+
+        for(i = 0;i < num_of_fds;i++)
+        {
+            close(fds[i]);
+        }
+
+        if(send(client->fd, &response, sizeof(response), MSG_NOSIGNAL) != sizeof(response))
+        {
+            connected = 0;
+        }
+    }
+
+    close(client->fd);
+    free(client->components);
+    free(client);
+
+    pthread_mutex_lock(&server->lock);
+    server->num_of_clients--;
+    pthread_cond_broadcast(&server->clients_cond);
+    pthread_mutex_unlock(&server->lock);
+
+    return NULL;
+}
+
+/* ============================================================================================== */
+
+/*                                     API Functions                                              */
+
+/* ============================================================================================== */
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LdcDaemon_Init
+ *
+ * \brief  Create listening socket of daemon. Stale socket file on same path is removed.
+ *
+ * \param  [Out] server       Daemon.
+ * \param  [In]  socket_path  Path of Unix domain socket.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status LdcDaemon_Init(LdcDaemon_Server* server, const char* const socket_path)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    struct sockaddr_un address;
+
+    memset(server, 0, sizeof(LdcDaemon_Server));
+    server->listen_fd = -1;
+    server->inotify_fd = -1;
+
+    if(NULL == socket_path || strlen(socket_path) >= sizeof(address.sun_path))
+    {
+        return LDC_STATUS_ERROR;
+    }
+
+    if(LensRegistry_Init(&server->registry))
+    {
+        return LDC_STATUS_ERROR;
+    }
+
+    pthread_mutex_init(&server->lock, NULL);
+    pthread_cond_init(&server->clients_cond, NULL);
+    strcpy(server->socket_path, socket_path);
+    server->max_maps = LDC_DAEMON_MAX_MAPS;
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, socket_path);
+
+    /* Sequenced packets keep boundaries of requests, together with their descriptors. */
+    server->listen_fd = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+    server->inotify_fd = inotify_init();
+    unlink(socket_path);
+
+    if(server->listen_fd < 0 || server->inotify_fd < 0 ||
+       0 != bind(server->listen_fd, (const struct sockaddr*)&address, sizeof(address)) ||
+       0 != listen(server->listen_fd, LDC_DAEMON_BACKLOG))
+    {
+        status = LDC_STATUS_ERROR;
+        LdcLog_Write(LDC_LOG_ERROR, status, "Error creating daemon socket %s: %m", socket_path);
+    }
+    else if(0 != pthread_create(&server->reload_thread, NULL, LdcDaemon_ReloadThread, server))
+    {
+        status = LDC_STATUS_ERROR;
+    }
+    else
+    {
+        server->reload_started = 1U;
+    }
+
+    if(LDC_STATUS_OK != status)
+    {
+        LdcDaemon_Deinit(server);
+    }
+
+    return status;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LdcDaemon_Deinit
+ *
+ * \brief  Wait for clients and reload thread, remove socket file and release maps and lenses.
+ *
+ * \param  [In]  server       Daemon.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void LdcDaemon_Deinit(LdcDaemon_Server* server)
+{
+    uint32_t i;
+
+    LdcDaemon_Stop(server);
+
+    pthread_mutex_lock(&server->lock);
+    while(server->num_of_clients > 0U)
+    {
+        pthread_cond_wait(&server->clients_cond, &server->lock);
+    }
+    pthread_mutex_unlock(&server->lock);
+
+    if(server->reload_started)
+    {
+        pthread_join(server->reload_thread, NULL);
+        server->reload_started = 0U;
+    }
+
+    if(server->listen_fd >= 0)
+    {
+        close(server->listen_fd);
+        unlink(server->socket_path);
+    }
+
+    if(server->inotify_fd >= 0)
+    {
+        close(server->inotify_fd);
+    }
+
+    LdcDaemon_ReleaseMaps(server->maps);
+    server->maps = NULL;
+    server->num_of_maps = 0;
+
+    for(i = 0;i < server->num_of_lenses;i++)
+    {
+        free(server->lenses[i].filename);
+    }
+
+    free(server->lenses);
+    LensRegistry_Deinit(&server->registry);
+    pthread_cond_destroy(&server->clients_cond);
+    pthread_mutex_destroy(&server->lock);
+    server->listen_fd = -1;
+    server->inotify_fd = -1;
+    server->lenses = NULL;
+    server->num_of_lenses = 0;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LdcDaemon_AddLens
+ *
+ * \brief  Load lens parameter CSV file under lens ID, and watch it for changes. Changed file is
+ *         reloaded, and maps of lens are regenerated and swapped in background.
+ *
+ * \param  [In]  server       Daemon.
+ * \param  [In]  lens_id      Lens ID, used by requests.
+ * \param  [In]  filename     Lens parameter CSV filename.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status LdcDaemon_AddLens(LdcDaemon_Server* server, uint32_t lens_id,
+                             const char* const filename)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    LdcDaemon_Lens lens;
+    LdcDaemon_Lens* lenses;
+    const char* separator;
+    char* directory;
+    uint32_t i;
+
+    if(NULL == filename || LensRegistry_LoadFile(&server->registry, lens_id, filename))
+    {
+        return LDC_STATUS_ERROR;
+    }
+
+    separator = strrchr(filename, '/');
+    lens.lens_id = lens_id;
+    lens.filename = (char*)malloc(strlen(filename) + 1U);
+    directory = (char*)malloc(strlen(filename) + 2U);
+
+    if(NULL == lens.filename || NULL == directory)
+    {
+        free(lens.filename);
+        free(directory);
+        return LDC_STATUS_ERROR;
+    }
+
+    strcpy(lens.filename, filename);
+    lens.basename = (NULL == separator) ? lens.filename : &lens.filename[separator - filename + 1];
+
+    if(NULL == separator)
+    {
+        strcpy(directory, ".");
+    }
+    else
+    {
+        /* Root directory keeps its separator. */
+        memcpy(directory, filename, (size_t)(separator - filename) + 1U);
+        directory[(separator == filename) ? 1 : separator - filename] = '\0';
+    }
+
+    /* Directory is watched, so file replaced by rename is also seen. */
+    lens.watch = inotify_add_watch(server->inotify_fd, directory, LDC_DAEMON_WATCH_MASK);
+    free(directory);
+
+    pthread_mutex_lock(&server->lock);
+    lenses = (LdcDaemon_Lens*)realloc(server->lenses,
+                                      (server->num_of_lenses + 1U) * sizeof(LdcDaemon_Lens));
+    if(lens.watch < 0 || NULL == lenses)
+    {
+        free(lens.filename);
+        status = LDC_STATUS_ERROR;
+    }
+    else
+    {
+        /* Profile of lens ID is replaced, so maps of its previous profile are stale. */
+        lens.generation = 0;
+        for(i = 0;i < server->num_of_lenses;i++)
+        {
+            if(lenses[i].lens_id == lens_id)
+            {
+                lens.generation = ++lenses[i].generation;
+            }
+        }
+
+        lenses[server->num_of_lenses++] = lens;
+    }
+
+    server->lenses = (NULL == lenses) ? server->lenses : lenses;
+    pthread_mutex_unlock(&server->lock);
+
+    return status;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LdcDaemon_SetMaxMaps
+ *
+ * \brief  Set number of warm maps. When there are more maps, least recently used maps are
+ *         evicted, requests that use evicted map keep it until they are done.
+ *
+ * \param  [In]  server       Daemon.
+ * \param  [In]  max_maps     Number of warm maps, at least one.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status LdcDaemon_SetMaxMaps(LdcDaemon_Server* server, uint32_t max_maps)
+{
+    LdcDaemon_Map* evicted;
+
+    if(0U == max_maps)
+    {
+        return LDC_STATUS_ERROR;
+    }
+
+    pthread_mutex_lock(&server->lock);
+    server->max_maps = max_maps;
+    evicted = LdcDaemon_EvictMaps(server);
+    pthread_mutex_unlock(&server->lock);
+
+    LdcDaemon_ReleaseMaps(evicted);
+
+    return LDC_STATUS_OK;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LdcDaemon_Warm
+ *
+ * \brief  Generate map and remap plan for request parameters, before first request.
+ *
+ * \param  [In]  server       Daemon.
+ * \param  [In]  request      Request parameters.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status LdcDaemon_Warm(LdcDaemon_Server* server, const LdcDaemon_Request* const request)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    LdcDaemon_Map* map;
+    uint32_t generated;
+
+    if(NULL == YuvFormat_Get((YUV_Type)request->yuv_type) ||
+       LdcDaemon_AcquireMap(server, request, &map, &generated))
+    {
+        status = LDC_STATUS_ERROR;
+    }
+    else
+    {
+        LdcDaemon_ReleaseMap(map);
+    }
+
+    return status;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LdcDaemon_Run
+ *
+ * \brief  Accept clients until LdcDaemon_Stop is called.
+ *
+ * \param  [In]  server       Daemon.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status LdcDaemon_Run(LdcDaemon_Server* server)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+
+    while(LDC_STATUS_OK == status && !__atomic_load_n(&server->stop, __ATOMIC_ACQUIRE))
+    {
+        struct pollfd pfd = {server->listen_fd, POLLIN, 0};
+        LdcDaemon_Client* client;
+        pthread_attr_t attr;
+        pthread_t thread;
+        int32_t fd;
+
+        if(poll(&pfd, 1, LDC_DAEMON_POLL_MS) <= 0)
+        {
+            continue;
+        }
+
+        fd = accept(server->listen_fd, NULL, NULL);
+        if(fd < 0)
+        {
+            status = (EINTR == errno || ECONNABORTED == errno) ? LDC_STATUS_OK :
+                                                                  LDC_STATUS_ERROR;
+            continue;
+        }
+
+        client = (LdcDaemon_Client*)calloc(1, sizeof(LdcDaemon_Client));
+        if(NULL == client)
+        {
+            close(fd);
+            continue;
+        }
+
+        client->server = server;
+        client->fd = fd;
+
+        pthread_mutex_lock(&server->lock);
+        server->num_of_clients++;
+        pthread_mutex_unlock(&server->lock);
+
+        /* Client thread is detached, Deinit waits for count of clients. */
+        pthread_attr_init(&attr);
+        pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+        if(0 != pthread_create(&thread, &attr, LdcDaemon_ClientThread, client))
+        {
+            close(fd);
+            free(client);
+
+            pthread_mutex_lock(&server->lock);
+            server->num_of_clients--;
+            pthread_mutex_unlock(&server->lock);
+        }
+        pthread_attr_destroy(&attr);
+    }
+
+    return status;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LdcDaemon_Stop
+ *
+ * \brief  Request stop of LdcDaemon_Run. It is safe to call from signal handler.
+ *
+ * \param  [In]  server       Daemon.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void LdcDaemon_Stop(LdcDaemon_Server* server)
+{
+    __atomic_store_n(&server->stop, 1U, __ATOMIC_RELEASE);
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LdcDaemon_Connect
+ *
+ * \brief  Connect client to daemon.
+ *
+ * \param  [In]  socket_path  Path of Unix domain socket of daemon.
+ * \param  [Out] fd           Connected socket, closed by caller.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status LdcDaemon_Connect(const char* const socket_path, int32_t* fd)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    struct sockaddr_un address;
+
+    if(NULL == socket_path || NULL == fd || strlen(socket_path) >= sizeof(address.sun_path))
+    {
+        return LDC_STATUS_ERROR;
+    }
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, socket_path);
+
+    *fd = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+    if(*fd < 0 || 0 != connect(*fd, (const struct sockaddr*)&address, sizeof(address)))
+    {
+        LdcLog_Write(LDC_LOG_ERROR, LDC_STATUS_ERROR, "Error connecting to daemon %s: %m",
+                     socket_path);
+
+        if(*fd >= 0)
+        {
+            close(*fd);
+            *fd = -1;
+        }
+
+        status = LDC_STATUS_ERROR;
+    }
+
+    return status;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LdcDaemon_CreateFrameMemory
+ *
+ * \brief  Create shared memory for frame of request, sealed against shrinking, as daemon
+ *         requires.
+ *
+ * \param  [In]  size         Size of memory, at least size of frame.
+ * \param  [Out] fd           Shared memory. Has to be closed by caller.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status LdcDaemon_CreateFrameMemory(size_t size, int32_t* fd)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+
+    *fd = memfd_create("ldc_frame", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+
+    if(*fd < 0)
+    {
+        status = LDC_STATUS_ERROR;
+    }
+    /* Seals can not be removed, size is fixed before memory is sealed. */
+    else if(0 != ftruncate(*fd, (off_t)size) || 0 != fcntl(*fd, F_ADD_SEALS, F_SEAL_SHRINK))
+    {
+        close(*fd);
+        *fd = -1;
+        status = LDC_STATUS_ERROR;
+    }
+
+    return status;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LdcDaemon_Correct
+ *
+ * \brief  Send correction request with shared memory of frames, and wait for response. Memory of
+ *         source frame has to hold whole source frame, and memory of output frame whole output
+ *         frame, in format of request.
+ *
+ * \param  [In]  fd           Socket connected with LdcDaemon_Connect.
+ * \param  [In]  request      Request parameters. Magic and version are set by function.
+ * \param  [In]  in_fd        Shared memory with source frame.
+ * \param  [In]  out_fd       Shared memory for output frame.
+ * \param  [Out] response     Response of daemon.
+ *
+ * \return LDC_Status   Exit status of request and of correction.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status LdcDaemon_Correct(int32_t fd, const LdcDaemon_Request* const request, int32_t in_fd,
+                             int32_t out_fd, LdcDaemon_Response* response)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    LdcDaemon_Request message = *request;
+    union
+    {
+        char buffer[CMSG_SPACE(2U * sizeof(int32_t))];
+        struct cmsghdr align;
+    }control;
+    struct iovec iov = {&message, sizeof(message)};
+    struct msghdr msg;
+    struct cmsghdr* cmsg;
+    int32_t fds[2] = {in_fd, out_fd};
+
+    message.magic = LDC_DAEMON_MAGIC;
+    message.version = LDC_DAEMON_VERSION;
+
+    memset(&msg, 0, sizeof(msg));
+    memset(&control, 0, sizeof(control));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buffer;
+    msg.msg_controllen = sizeof(control.buffer);
+
+    cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+
+    if(sendmsg(fd, &msg, MSG_NOSIGNAL) != (ssize_t)sizeof(message) ||
+       recv(fd, response, sizeof(LdcDaemon_Response), 0) != (ssize_t)sizeof(LdcDaemon_Response) ||
+       LDC_DAEMON_MAGIC != response->magic || LDC_STATUS_OK != response->status)
+    {
+        status = LDC_STATUS_ERROR;
+    }
+
+    return status;
+}
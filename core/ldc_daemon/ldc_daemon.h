@@ -0,0 +1,348 @@
+/**
+ ***************************************************************************************************
+ *
+ * \file  ldc_daemon.h
+ *
+ * \brief This file contains API of correction daemon, that keeps maps of lenses warm and
+ *        corrects frames for clients over Unix domain socket, and API of its clients.
+ *
+ * \arg author:  Dejan Milojica
+ * \arg version: 1.2
+ * \arg date:    13.01.2021
+ *
+ ***************************************************************************************************
+ */
+
+#ifndef LDC_DAEMON_H
+#define LDC_DAEMON_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================================== */
+/*                                       Include Files                                            */
+/* ============================================================================================== */
+
+#include <stdint.h>
+#include <pthread.h>
+
+#include "../lib/ldc_types.h"
+#include "../correction_distortion/correction_distortion.h"
+#include "../lens_registry/lens_registry.h"
+#include "../remap/remap.h"
+
+/* ============================================================================================== */
+/*                                     Macros & Typedefs                                          */
+/* ============================================================================================== */
+
+#define LDC_DAEMON_MAGIC (0x4443444CU)          /* "LDCD", first word of every message.        */
+#define LDC_DAEMON_VERSION (1U)                 /* Version of messages.                        */
+#define LDC_DAEMON_MAX_PATH (108U)              /* Size of sun_path of Unix socket address.    */
+#define LDC_DAEMON_MAX_MAPS (32U)               /* Default number of warm maps.                */
+
+/**
+ ***************************************************************************************************
+ *
+ * \typedef LdcDaemon_Request
+ *
+ * \brief   Structure which represents correction request. It is sent with two file descriptors
+ *          (SCM_RIGHTS), of shared memory with source frame and of shared memory for output
+ *          frame, from LdcDaemon_CreateFrameMemory. Frame data is not copied over socket.
+ *          Memory has to be sealed against shrinking (F_SEAL_SHRINK), so client can not
+ *          truncate it while daemon accesses it.
+ *
+ ***************************************************************************************************
+ */
+typedef struct
+{
+    uint32_t magic;                             /* LDC_DAEMON_MAGIC.                      */
+    uint32_t version;                           /* LDC_DAEMON_VERSION.                    */
+    uint32_t lens_id;                           /* Lens ID, registered in daemon.         */
+    uint32_t yuv_type;                          /* Type of YUV frames.                    */
+    uint32_t width;                             /* Width of source frame.                 */
+    uint32_t height;                            /* Height of source frame.                */
+    uint32_t out_width;                         /* Width of output frame, 0 for source.   */
+    uint32_t out_height;                        /* Height of output frame, 0 for source.  */
+    double scale;                               /* Source pixels per output pixel, or 0.  */
+    double centre_x;                            /* Output centre in source frame.         */
+    double centre_y;
+    uint32_t use_centre;                        /* Use centre_x/centre_y.                 */
+    uint32_t interpolation;                     /* LDC_Interpolation.                     */
+    uint8_t border_y;                           /* Border colour.                         */
+    uint8_t border_u;
+    uint8_t border_v;
+    uint8_t use_border;                         /* Fill pixels without source pixel.      */
+    uint32_t reserved;                          /* Zero.                                  */
+}LdcDaemon_Request;
+
+/**
+ ***************************************************************************************************
+ *
+ * \typedef LdcDaemon_Response
+ *
+ * \brief   Structure which represents response of daemon, sent when output frame is written.
+ *
+ ***************************************************************************************************
+ */
+typedef struct
+{
+    uint32_t magic;                             /* LDC_DAEMON_MAGIC.                      */
+    uint32_t status;                            /* LDC_Status of correction.              */
+    uint64_t remap_time_ns;                     /* Time of correction inside of daemon.   */
+    uint32_t map_generated;                     /* 1 when map was not warm.               */
+    uint32_t reserved;                          /* Zero.                                  */
+}LdcDaemon_Response;
+
+/**
+ ***************************************************************************************************
+ *
+ * \typedef LdcDaemon_Map
+ *
+ * \brief   Structure which represents warm map of one lens and frame geometry, with remap plan.
+ *          Map is replaced atomically on lens reload, requests that use old map keep their
+ *          reference until they are done. Map records generation of lens profile it was
+ *          generated from, so map of replaced profile is never kept in list of warm maps.
+ *
+ ***************************************************************************************************
+ */
+typedef struct LdcDaemon_Map
+{
+    uint32_t lens_id;                           /* Lens of map.                           */
+    YUV_Type yuv_type;                          /* Type of YUV frames.                    */
+    LDC_Interpolation interpolation;            /* Sampling of source frame.              */
+    uint32_t width;                             /* Width of source frame.                 */
+    uint32_t height;                            /* Height of source frame.                */
+    LDC_OutputSpec output;                      /* Output frame specification.            */
+    LDC_Map map;                                /* Map of lens.                           */
+    Remap_Plan plan;                            /* Remap plan of map.                     */
+    uint32_t generation;                        /* Generation of lens profile.            */
+    uint64_t last_used;                         /* Time of last request, for eviction.    */
+    uint32_t ref_count;                         /* Number of references, atomic.          */
+    struct LdcDaemon_Map* next;                 /* Next map of daemon.                    */
+}LdcDaemon_Map;
+
+/**
+ ***************************************************************************************************
+ *
+ * \typedef LdcDaemon_Lens
+ *
+ * \brief   Structure which represents lens file, watched for changes.
+ *
+ ***************************************************************************************************
+ */
+typedef struct
+{
+    uint32_t lens_id;                           /* Lens ID.                               */
+    char* filename;                             /* Lens parameter CSV filename.           */
+    const char* basename;                       /* Name of file inside of its directory.  */
+    int32_t watch;                              /* Inotify watch of directory.            */
+    uint32_t generation;                        /* Incremented on every reload.           */
+}LdcDaemon_Lens;
+
+/**
+ ***************************************************************************************************
+ *
+ * \typedef LdcDaemon_Server
+ *
+ * \brief   Structure which represents correction daemon. Every client connection is served by
+ *          its own thread, and lens files are watched by reload thread.
+ *
+ ***************************************************************************************************
+ */
+typedef struct
+{
+    char socket_path[LDC_DAEMON_MAX_PATH];      /* Path of listening socket.              */
+    int32_t listen_fd;                          /* Listening socket.                      */
+    int32_t inotify_fd;                         /* Inotify instance of lens files.        */
+    LensRegistry registry;                      /* Loaded lens profiles.                  */
+    LdcDaemon_Lens* lenses;                     /* Watched lens files.                    */
+    uint32_t num_of_lenses;                     /* Number of lens files.                  */
+    LdcDaemon_Map* maps;                        /* Warm maps.                             */
+    uint32_t num_of_maps;                       /* Number of warm maps.                   */
+    uint32_t max_maps;                          /* Least recently used maps are evicted.  */
+    uint32_t num_of_clients;                    /* Number of connected clients.           */
+    uint32_t stop;                              /* Set by LdcDaemon_Stop, atomic.         */
+    pthread_t reload_thread;                    /* Thread of lens reload.                 */
+    uint32_t reload_started;                    /* Reload thread is running.              */
+    pthread_mutex_t lock;                       /* Protects lenses, maps and clients.     */
+    pthread_cond_t clients_cond;                /* Signaled when client disconnects.      */
+}LdcDaemon_Server;
+
+/* ============================================================================================== */
+/*                                     Function Declarations                                      */
+/* ============================================================================================== */
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LdcDaemon_Init
+ *
+ * \brief  Create listening socket of daemon. Stale socket file on same path is removed.
+ *
+ * \param  [Out] server       Daemon.
+ * \param  [In]  socket_path  Path of Unix domain socket.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status LdcDaemon_Init(LdcDaemon_Server* server, const char* const socket_path);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LdcDaemon_Deinit
+ *
+ * \brief  Wait for clients and reload thread, remove socket file and release maps and lenses.
+ *
+ * \param  [In]  server       Daemon.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void LdcDaemon_Deinit(LdcDaemon_Server* server);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LdcDaemon_AddLens
+ *
+ * \brief  Load lens parameter CSV file under lens ID, and watch it for changes. Changed file is
+ *         reloaded, and maps of lens are regenerated and swapped in background.
+ *
+ * \param  [In]  server       Daemon.
+ * \param  [In]  lens_id      Lens ID, used by requests.
+ * \param  [In]  filename     Lens parameter CSV filename.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status LdcDaemon_AddLens(LdcDaemon_Server* server, uint32_t lens_id,
+                             const char* const filename);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LdcDaemon_SetMaxMaps
+ *
+ * \brief  Set number of warm maps. When there are more maps, least recently used maps are
+ *         evicted, requests that use evicted map keep it until they are done.
+ *
+ * \param  [In]  server       Daemon.
+ * \param  [In]  max_maps     Number of warm maps, at least one.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status LdcDaemon_SetMaxMaps(LdcDaemon_Server* server, uint32_t max_maps);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LdcDaemon_Warm
+ *
+ * \brief  Generate map and remap plan for request parameters, before first request.
+ *
+ * \param  [In]  server       Daemon.
+ * \param  [In]  request      Request parameters.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status LdcDaemon_Warm(LdcDaemon_Server* server, const LdcDaemon_Request* const request);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LdcDaemon_Run
+ *
+ * \brief  Accept clients until LdcDaemon_Stop is called.
+ *
+ * \param  [In]  server       Daemon.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status LdcDaemon_Run(LdcDaemon_Server* server);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LdcDaemon_Stop
+ *
+ * \brief  Request stop of LdcDaemon_Run. It is safe to call from signal handler.
+ *
+ * \param  [In]  server       Daemon.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void LdcDaemon_Stop(LdcDaemon_Server* server);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LdcDaemon_Connect
+ *
+ * \brief  Connect client to daemon.
+ *
+ * \param  [In]  socket_path  Path of Unix domain socket of daemon.
+ * \param  [Out] fd           Connected socket, closed by caller.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status LdcDaemon_Connect(const char* const socket_path, int32_t* fd);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LdcDaemon_CreateFrameMemory
+ *
+ * \brief  Create shared memory for frame of request, sealed against shrinking, as daemon
+ *         requires.
+ *
+ * \param  [In]  size         Size of memory, at least size of frame.
+ * \param  [Out] fd           Shared memory. Has to be closed by caller.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status LdcDaemon_CreateFrameMemory(size_t size, int32_t* fd);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LdcDaemon_Correct
+ *
+ * \brief  Send correction request with shared memory of frames, and wait for response. Memory of
+ *         source frame has to hold whole source frame, and memory of output frame whole output
+ *         frame, in format of request.
+ *
+ * \param  [In]  fd           Socket connected with LdcDaemon_Connect.
+ * \param  [In]  request      Request parameters. Magic and version are set by function.
+ * \param  [In]  in_fd        Shared memory with source frame.
+ * \param  [In]  out_fd       Shared memory for output frame.
+ * \param  [Out] response     Response of daemon.
+ *
+ * \return LDC_Status   Exit status of request and of correction.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status LdcDaemon_Correct(int32_t fd, const LdcDaemon_Request* const request, int32_t in_fd,
+                             int32_t out_fd, LdcDaemon_Response* response);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
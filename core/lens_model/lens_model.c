@@ -0,0 +1,289 @@
+/**
+ ***************************************************************************************************
+ *
+ * \file  lens_model.c
+ *
+ * \brief This file contains API for analytic lens models, evaluated in closed form, and for
+ *        fitting them to lens specification table.
+ *
+ * \arg author:  Dejan Milojica
+ * \arg version: 1.2
+ * \arg date:    13.01.2021
+ *
+ ***************************************************************************************************
+ */
+
+/* ============================================================================================== */
+/*                                       Include Files                                            */
+/* ============================================================================================== */
+
+#include "lens_model.h"
+#include <math.h>
+#include <string.h>
+#include <stdint.h>
+
+/* ============================================================================================== */
+/*                              Internal Helper Functions                                         */
+/* ============================================================================================== */
+
+static double LensModel_GetHeightOfAngle(const LensModel* const model, double theta)
+{
+    double r_d;
+
+    switch(model->type)
+    {
+        case LENS_MODEL_EQUISOLID:
+            r_d = 2.0 * model->focal_length * sin(theta / 2.0);
+            break;
+        case LENS_MODEL_EQUIDISTANT:
+            r_d = model->focal_length * theta;
+            break;
+        case LENS_MODEL_STEREOGRAPHIC:
+            r_d = 2.0 * model->focal_length * tan(theta / 2.0);
+            break;
+        default:
+        {
+            double theta2 = theta * theta;
+
+            r_d = model->focal_length * theta * (1.0 + theta2 * (model->k[0] + theta2 *
+                  (model->k[1] + theta2 * (model->k[2] + theta2 * model->k[3]))));
+            break;
+        }
+    }
+
+    return r_d;
+}
+
+/* Solve n x n system in place, with Gaussian elimination and partial pivoting. */
+static LDC_Status LensModel_Solve(double a[LENS_MODEL_NUM_OF_COEFFICIENTS]
+                                          [LENS_MODEL_NUM_OF_COEFFICIENTS],
+                                  double b[LENS_MODEL_NUM_OF_COEFFICIENTS], uint32_t n)
+{
+    uint32_t i;
+    uint32_t j;
+    uint32_t l;
+
+    for(i = 0;i < n;i++)
+    {
+        uint32_t pivot = i;
+
+        for(j = i + 1U;j < n;j++)
+        {
+            pivot = (fabs(a[j][i]) > fabs(a[pivot][i])) ? j : pivot;
+        }
+
+        if(!(fabs(a[pivot][i]) > 0.0))
+        {
+            return LDC_STATUS_ERROR;
+        }
+
+        for(l = 0;l < n;l++)
+        {
+            double t = a[i][l];
+            a[i][l] = a[pivot][l];
+            a[pivot][l] = t;
+        }
+
+        {
+            double t = b[i];
+            b[i] = b[pivot];
+            b[pivot] = t;
+        }
+
+        for(j = i + 1U;j < n;j++)
+        {
+            double factor = a[j][i] / a[i][i];
+
+            for(l = i;l < n;l++)
+            {
+                a[j][l] -= factor * a[i][l];
+            }
+
+            b[j] -= factor * b[i];
+        }
+    }
+
+    for(i = n;i-- > 0U;)
+    {
+        for(l = i + 1U;l < n;l++)
+        {
+            b[i] -= a[i][l] * b[l];
+        }
+
+        b[i] /= a[i][i];
+    }
+
+    return LDC_STATUS_OK;
+}
+
+/* ============================================================================================== */
+
+/*                                     API Functions                                              */
+
+/* ============================================================================================== */
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LensModel_Validate
+ *
+ * \brief  Check that model is analytic, with positive focal length and finite coefficients.
+ *
+ * \param  [In]  model        Lens model.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status LensModel_Validate(const LensModel* const model)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    uint32_t i;
+
+    if(NULL == model || model->type < LENS_MODEL_EQUISOLID ||
+       model->type > LENS_MODEL_POLYNOMIAL || !(model->focal_length > 0.0) ||
+       !isfinite(model->focal_length))
+    {
+        status = LDC_STATUS_ERROR;
+    }
+
+    for(i = 0;i < LENS_MODEL_NUM_OF_COEFFICIENTS && LDC_STATUS_OK == status;i++)
+    {
+        if(!isfinite(model->k[i]))
+        {
+            status = LDC_STATUS_ERROR;
+        }
+    }
+
+    return status;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LensModel_GetHeight
+ *
+ * \brief  Get image height of field angles, in double precision. This is reference function of
+ *         analytic model.
+ *
+ * \param  [In]  model        Analytic lens model.
+ * \param  [In]  theta        Field angles in radian.
+ * \param  [Out] r_d          Image heights in pixels.
+ * \param  [In]  count        Number of angles.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void LensModel_GetHeight(const LensModel* const model, const double* const theta, double* r_d,
+                         uint32_t count)
+{
+    uint32_t i;
+
+    for(i = 0;i < count;i++)
+    {
+        r_d[i] = LensModel_GetHeightOfAngle(model, theta[i]);
+    }
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LensModel_Fit
+ *
+ * \brief  Fit analytic model to lens specification table. Polynomial coefficients are fitted
+ *         with least squares, other models have no free parameters, so only their error is
+ *         measured.
+ *
+ * \param  [In]  type           Analytic lens function.
+ * \param  [In]  focal_length   Focal length in pixels.
+ * \param  [In]  angle          Field angles of table, in radian.
+ * \param  [In]  height         Image heights of table, in pixels.
+ * \param  [In]  count          Number of table rows.
+ * \param  [Out] model          Fitted model.
+ * \param  [Out] max_error      Max difference of model and table heights in pixels, or NULL.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status LensModel_Fit(LensModel_Type type, double focal_length, const double* const angle,
+                         const double* const height, uint32_t count, LensModel* model,
+                         double* max_error)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    LensModel fitted;
+    uint32_t i;
+
+    memset(&fitted, 0, sizeof(LensModel));
+    fitted.type = type;
+    fitted.focal_length = focal_length;
+
+    if(NULL == angle || NULL == height || NULL == model || LensModel_Validate(&fitted))
+    {
+        status = LDC_STATUS_ERROR;
+    }
+    else if(LENS_MODEL_POLYNOMIAL == type)
+    {
+        double a[LENS_MODEL_NUM_OF_COEFFICIENTS][LENS_MODEL_NUM_OF_COEFFICIENTS];
+        double b[LENS_MODEL_NUM_OF_COEFFICIENTS];
+
+        memset(a, 0, sizeof(a));
+        memset(b, 0, sizeof(b));
+
+        /* Normal equations of h / f - theta = k1 theta^3 + ... + k4 theta^9. */
+        for(i = 0;i < count;i++)
+        {
+            double basis[LENS_MODEL_NUM_OF_COEFFICIENTS];
+            double theta2 = angle[i] * angle[i];
+            double residual = height[i] / focal_length - angle[i];
+            uint32_t j;
+            uint32_t l;
+
+            basis[0] = angle[i] * theta2;
+            for(j = 1;j < LENS_MODEL_NUM_OF_COEFFICIENTS;j++)
+            {
+                basis[j] = basis[j - 1] * theta2;
+            }
+
+            for(j = 0;j < LENS_MODEL_NUM_OF_COEFFICIENTS;j++)
+            {
+                for(l = 0;l < LENS_MODEL_NUM_OF_COEFFICIENTS;l++)
+                {
+                    a[j][l] += basis[j] * basis[l];
+                }
+
+                b[j] += basis[j] * residual;
+            }
+        }
+
+        if(count < LENS_MODEL_NUM_OF_COEFFICIENTS ||
+           LensModel_Solve(a, b, LENS_MODEL_NUM_OF_COEFFICIENTS))
+        {
+            status = LDC_STATUS_ERROR;
+        }
+        else
+        {
+            memcpy(fitted.k, b, sizeof(b));
+            status = LensModel_Validate(&fitted);
+        }
+    }
+
+    if(LDC_STATUS_OK == status)
+    {
+        if(NULL != max_error)
+        {
+            *max_error = 0.0;
+
+            for(i = 0;i < count;i++)
+            {
+                double error = fabs(LensModel_GetHeightOfAngle(&fitted, angle[i]) - height[i]);
+                *max_error = (error > *max_error) ? error : *max_error;
+            }
+        }
+
+        *model = fitted;
+    }
+
+    return status;
+}
@@ -0,0 +1,140 @@
+/**
+ ***************************************************************************************************
+ *
+ * \file  lens_model.h
+ *
+ * \brief This file contains API for analytic lens models, evaluated in closed form, and for
+ *        fitting them to lens specification table.
+ *
+ * \arg author:  Dejan Milojica
+ * \arg version: 1.2
+ * \arg date:    13.01.2021
+ *
+ ***************************************************************************************************
+ */
+
+#ifndef LENS_MODEL_H
+#define LENS_MODEL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================================== */
+/*                                       Include Files                                            */
+/* ============================================================================================== */
+
+#include <stdint.h>
+
+#include "../lib/ldc_types.h"
+
+/* ============================================================================================== */
+/*                                     Macros & Typedefs                                          */
+/* ============================================================================================== */
+
+#define LENS_MODEL_NUM_OF_COEFFICIENTS (4U)     /* Coefficients of theta^3 ... theta^9.        */
+
+/**
+ ***************************************************************************************************
+ *
+ * \typedef LensModel_Type
+ *
+ * \brief   Defines possible lens functions, that give image height r_d of field angle theta.
+ *
+ ***************************************************************************************************
+ */
+typedef enum
+{
+    LENS_MODEL_TABLE         = 0,   /* Lens specification table, interpolated.                 */
+    LENS_MODEL_EQUISOLID     = 1,   /* r_d = 2 f sin(theta / 2).                               */
+    LENS_MODEL_EQUIDISTANT   = 2,   /* r_d = f theta.                                          */
+    LENS_MODEL_STEREOGRAPHIC = 3,   /* r_d = 2 f tan(theta / 2).                               */
+    LENS_MODEL_POLYNOMIAL    = 4    /* r_d = f (theta + k1 theta^3 + ... + k4 theta^9).        */
+} LensModel_Type;
+
+/**
+ ***************************************************************************************************
+ *
+ * \typedef LensModel
+ *
+ * \brief   Structure which represents analytic lens function. Coefficients are used only by
+ *          polynomial (Kannala-Brandt) model.
+ *
+ ***************************************************************************************************
+ */
+typedef struct
+{
+    LensModel_Type type;                        /* Lens function.                         */
+    double focal_length;                        /* Focal length in pixels.                */
+    double k[LENS_MODEL_NUM_OF_COEFFICIENTS];   /* Coefficients of theta^3 ... theta^9.   */
+}LensModel;
+
+/* ============================================================================================== */
+/*                                     Function Declarations                                      */
+/* ============================================================================================== */
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LensModel_Validate
+ *
+ * \brief  Check that model is analytic, with positive focal length and finite coefficients.
+ *
+ * \param  [In]  model        Lens model.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status LensModel_Validate(const LensModel* const model);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LensModel_GetHeight
+ *
+ * \brief  Get image height of field angles, in double precision. This is reference function of
+ *         analytic model.
+ *
+ * \param  [In]  model        Analytic lens model.
+ * \param  [In]  theta        Field angles in radian.
+ * \param  [Out] r_d          Image heights in pixels.
+ * \param  [In]  count        Number of angles.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void LensModel_GetHeight(const LensModel* const model, const double* const theta, double* r_d,
+                         uint32_t count);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LensModel_Fit
+ *
+ * \brief  Fit analytic model to lens specification table. Polynomial coefficients are fitted
+ *         with least squares, other models have no free parameters, so only their error is
+ *         measured.
+ *
+ * \param  [In]  type           Analytic lens function.
+ * \param  [In]  focal_length   Focal length in pixels.
+ * \param  [In]  angle          Field angles of table, in radian.
+ * \param  [In]  height         Image heights of table, in pixels.
+ * \param  [In]  count          Number of table rows.
+ * \param  [Out] model          Fitted model.
+ * \param  [Out] max_error      Max difference of model and table heights in pixels, or NULL.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status LensModel_Fit(LensModel_Type type, double focal_length, const double* const angle,
+                         const double* const height, uint32_t count, LensModel* model,
+                         double* max_error);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,884 @@
+/**
+ ***************************************************************************************************
+ *
+ * \file  lens_registry.c
+ *
+ * \brief This file contains API for parsing lens specification files once, and sharing
+ *        preprocessed lens profiles between map builders.
+ *
+ * \arg author:  Dejan Milojica
+ * \arg version: 1.2
+ * \arg date:    13.01.2021
+ *
+ ***************************************************************************************************
+ */
+
+/* ============================================================================================== */
+/*                                       Include Files                                            */
+/* ============================================================================================== */
+
+#include "lens_registry.h"
+#include "../lib/ldc_log.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <float.h>
+
+/* ============================================================================================== */
+/*                                       Global variables                                         */
+/* ============================================================================================== */
+
+#define FNV_OFFSET_BASIS (14695981039346656037ULL)  /* FNV-1a 64 bit parameters. */
+#define FNV_PRIME        (1099511628211ULL)
+
+/* ============================================================================================== */
+/*                              Internal Helper Functions                                         */
+/* ============================================================================================== */
+
+static const char* ParamOperation_SkipSpaces(const char* text)
+{
+    while(' ' == *text || '\t' == *text || '\r' == *text || '\n' == *text)
+    {
+        text++;
+    }
+
+    return text;
+}
+
+static LDC_Status ParamOperation_AppendRow(LensProfile* profile, uint32_t* capacity,
+                                           uint32_t num_of_rows, double angle, double height)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+
+    if(num_of_rows == *capacity)
+    {
+        uint32_t new_capacity = (0U == *capacity) ? 128U : 2U * (*capacity);
+        double* new_angle = (double*)realloc(profile->angle, new_capacity * sizeof(double));
+        double* new_height;
+
+        if(NULL != new_angle)
+        {
+            profile->angle = new_angle;
+        }
+
+        new_height = (double*)realloc(profile->height, new_capacity * sizeof(double));
+        if(NULL != new_height)
+        {
+            profile->height = new_height;
+        }
+
+        if(NULL == new_angle || NULL == new_height)
+        {
+            status = LDC_STATUS_OUT_OF_MEMORY;
+        }
+        else
+        {
+            *capacity = new_capacity;
+        }
+    }
+
+    if(LDC_STATUS_OK == status)
+    {
+        profile->angle[num_of_rows] = angle;
+        profile->height[num_of_rows] = height;
+    }
+
+    return status;
+}
+
+static LDC_Status ParamOperation_ReadParametersOfCorrection(LensProfile* profile,
+                                                            const char* text)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    double header[3];
+    uint32_t capacity = 0;
+    uint32_t i;
+    char* end;
+
+    /* Read Focal length/ Pixel pitch/ Scaling factor, every value in its own row. */
+    for(i = 0;i < 3U && LDC_STATUS_OK == status;i++)
+    {
+        header[i] = strtod(text, &end);
+        if(end == text)
+        {
+            status = LDC_STATUS_INVALID_LENS;
+            LdcLog_Write(LDC_LOG_ERROR, status, LENS_PARAMETERS_FILE_READING_ERROR_MESSAGE);
+        }
+        else
+        {
+            text = end;
+            text = (',' == *text) ? text + 1 : text;
+            text = ParamOperation_SkipSpaces(text);
+            text = (',' == *text) ? text + 1 : text;
+        }
+    }
+
+    if(LDC_STATUS_OK == status)
+    {
+        profile->focal_length_in_mm = header[0];
+        profile->sensor_pixel_pitch_in_mm = header[1];
+        profile->scaling_factor = header[2];
+
+        i = 0;
+
+        /* Read Angle / Height of Lens Camera. */
+        text = ParamOperation_SkipSpaces(text);
+        while('\0' != *text && LDC_STATUS_OK == status)
+        {
+            double angle;
+            double imageHeightInmm;
+
+            angle = strtod(text, &end);
+            if(end == text || ',' != *end)
+            {
+                status = LDC_STATUS_INVALID_LENS;
+                LdcLog_Write(LDC_LOG_ERROR, status, LENS_PARAMETERS_FILE_READING_ERROR_MESSAGE);
+                break;
+            }
+
+            text = end + 1;
+            imageHeightInmm = strtod(text, &end);
+            if(end == text)
+            {
+                status = LDC_STATUS_INVALID_LENS;
+                LdcLog_Write(LDC_LOG_ERROR, status, LENS_PARAMETERS_FILE_READING_ERROR_MESSAGE);
+                break;
+            }
+
+            text = ParamOperation_SkipSpaces(end);
+
+            status = ParamOperation_AppendRow(profile, &capacity, i++,
+                                              angle / 180 * M_PI, /* Degree to Radian. */
+                                              imageHeightInmm / profile->sensor_pixel_pitch_in_mm);
+        }
+
+        /* Last row is not used, same as in original CSV reader. */
+        profile->num_of_useful_elements = (i > 0U) ? i - 1U : 0U;
+    }
+
+    return status;
+}
+
+static LDC_Status ParamOperation_ValidateParameters(const LensProfile* const profile)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    uint32_t i;
+
+    /* Every table segment needs two points, and increasing angles. */
+    if(!(profile->focal_length_in_mm > 0.0) || !(profile->sensor_pixel_pitch_in_mm > 0.0) ||
+       !(profile->scaling_factor > 0.0) || !isfinite(profile->focal_length_in_mm) ||
+       !isfinite(profile->sensor_pixel_pitch_in_mm) || !isfinite(profile->scaling_factor) ||
+       profile->num_of_useful_elements < 2U)
+    {
+        status = LDC_STATUS_ERROR;
+    }
+
+    for(i = 0;i < profile->num_of_useful_elements && LDC_STATUS_OK == status;i++)
+    {
+        if(!isfinite(profile->angle[i]) || !isfinite(profile->height[i]) ||
+           (i > 0U && !(profile->angle[i] > profile->angle[i - 1])))
+        {
+            status = LDC_STATUS_ERROR;
+        }
+    }
+
+    if(LDC_STATUS_OK != status)
+    {
+        status = LDC_STATUS_INVALID_LENS;
+        LdcLog_Write(LDC_LOG_ERROR, status, LENS_PARAMETERS_VALIDATION_ERROR_MESSAGE);
+    }
+
+    return status;
+}
+
+static uint64_t ParamOperation_HashBytes(uint64_t hash, const void* const data, size_t size)
+{
+    const uint8_t* bytes = (const uint8_t*)data;
+    size_t i;
+
+    for(i = 0;i < size;i++)
+    {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+
+    return hash;
+}
+
+static int32_t findNearestNeighbourIndex(double value, const double* const x, int32_t len)
+{
+    double dist;
+    int32_t idx;
+    int32_t i;
+
+    idx = -1;
+    dist = DBL_MAX;
+
+    for(i = 0;i < len;i++)
+    {
+        double new_dist = fabs(value - x[i]); /* New distance. */
+        if(new_dist <= dist)
+        {
+            dist = new_dist;
+            idx = i;
+        }
+    }
+
+    return idx;
+}
+
+static LDC_Status LensProfile_Preprocess(LensProfile* profile)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    uint32_t n = profile->num_of_useful_elements;
+    uint32_t i;
+    double* theta;
+    double* r_d;
+
+    /* Analytic model has no lens table. */
+    if(LENS_MODEL_TABLE == profile->model.type)
+    {
+        profile->slope     = (double*)malloc(n * sizeof(double));
+        profile->intercept = (double*)malloc(n * sizeof(double));
+    }
+
+    theta              = (double*)malloc(FAST_MAP_NUM_OF_LUT_SAMPLES * sizeof(double));
+    r_d                = (double*)malloc(FAST_MAP_NUM_OF_LUT_SAMPLES * sizeof(double));
+
+    if(NULL == theta || NULL == r_d || (LENS_MODEL_TABLE == profile->model.type &&
+                                        (NULL == profile->slope || NULL == profile->intercept)))
+    {
+        status = LDC_STATUS_OUT_OF_MEMORY;
+    }
+    else
+    {
+        double f = profile->focal_length_in_mm / profile->sensor_pixel_pitch_in_mm;
+
+        for(i = 0;i < n;i++)
+        {
+            if(i < n - 1U)
+            {
+                double dx;
+                double dy;
+
+                dx = profile->angle[i + 1] - profile->angle[i];
+                dy = profile->height[i + 1] - profile->height[i];
+                profile->slope[i] = dy / dx;    /* Define slope of function. */
+                profile->intercept[i] = profile->height[i] - profile->angle[i] * profile->slope[i];
+            }
+            else
+            {
+                profile->slope[i] = profile->slope[i - 1];
+                profile->intercept[i] = profile->intercept[i - 1];
+            }
+        }
+
+        /* Lens function, sampled uniformly from optical axis to 90 degrees. */
+        for(i = 0;i < FAST_MAP_NUM_OF_LUT_SAMPLES;i++)
+        {
+            theta[i] = (M_PI / 2) * i / (FAST_MAP_NUM_OF_LUT_SAMPLES - 1U);
+        }
+
+        LensProfile_InterpolateHeight(profile, theta, r_d, FAST_MAP_NUM_OF_LUT_SAMPLES);
+
+        for(i = 0;i < FAST_MAP_NUM_OF_LUT_SAMPLES;i++)
+        {
+            profile->lut.r_d[i] = (float)r_d[i];
+        }
+
+        profile->lut.theta_step_inv = (float)((FAST_MAP_NUM_OF_LUT_SAMPLES - 1U) / (M_PI / 2));
+        profile->lut.z = (float)(f / profile->scaling_factor);
+        profile->lut.hc = 0.0f;
+        profile->lut.vc = 0.0f;
+        profile->lut.model = profile->model.type;
+        profile->lut.f = (float)profile->model.focal_length;
+
+        for(i = 0;i < LENS_MODEL_NUM_OF_COEFFICIENTS;i++)
+        {
+            profile->lut.k[i] = (float)profile->model.k[i];
+        }
+
+        /* Hash of values that define lens function. */
+        profile->hash = ParamOperation_HashBytes(FNV_OFFSET_BASIS, &profile->focal_length_in_mm,
+                                                 sizeof(double));
+        profile->hash = ParamOperation_HashBytes(profile->hash,
+                                                 &profile->sensor_pixel_pitch_in_mm,
+                                                 sizeof(double));
+        profile->hash = ParamOperation_HashBytes(profile->hash, &profile->scaling_factor,
+                                                 sizeof(double));
+        profile->hash = ParamOperation_HashBytes(profile->hash, profile->angle,
+                                                 n * sizeof(double));
+        profile->hash = ParamOperation_HashBytes(profile->hash, profile->height,
+                                                 n * sizeof(double));
+
+        if(LENS_MODEL_TABLE != profile->model.type)
+        {
+            profile->hash = ParamOperation_HashBytes(profile->hash, &profile->model,
+                                                     sizeof(LensModel));
+        }
+    }
+
+    free(theta);
+    free(r_d);
+
+    return status;
+}
+
+static void LensProfile_Free(LensProfile* profile)
+{
+    free(profile->angle);
+    free(profile->height);
+    free(profile->slope);
+    free(profile->intercept);
+    free(profile);
+}
+
+/* ============================================================================================== */
+
+/*                                     API Functions                                              */
+
+/* ============================================================================================== */
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LensProfile_LoadBuffer
+ *
+ * \brief  Parse and validate lens specification from memory, and preprocess its lookup tables.
+ *         Buffer has same content as lens specification CSV file.
+ *
+ * \param  [In]  lens_id      Lens ID of profile.
+ * \param  [In]  buffer       Lens specification.
+ * \param  [In]  size         Size of buffer in bytes.
+ * \param  [Out] profile      Loaded profile, with one reference owned by caller.
+ *
+ * \return LDC_Status   Exit status, LDC_STATUS_INVALID_LENS for invalid specification.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status LensProfile_LoadBuffer(uint32_t lens_id, const char* const buffer, size_t size,
+                                  const LensProfile** profile)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    LensProfile* new_profile = NULL;
+    char* text = NULL;
+
+    if(NULL == buffer || NULL == profile)
+    {
+        status = LDC_STATUS_INVALID_ARGUMENT;
+    }
+    else
+    {
+        /* Parser needs terminated text. */
+        text = (char*)malloc(size + 1U);
+        new_profile = (LensProfile*)calloc(1, sizeof(LensProfile));
+
+        if(NULL == text || NULL == new_profile)
+        {
+            status = LDC_STATUS_OUT_OF_MEMORY;
+        }
+        else
+        {
+            memcpy(text, buffer, size);
+            text[size] = '\0';
+
+            new_profile->lens_id = lens_id;
+            new_profile->ref_count = 1U;
+
+            /* Parsing and validation fail with LDC_STATUS_INVALID_LENS. */
+            status = ParamOperation_ReadParametersOfCorrection(new_profile, text);
+            if(LDC_STATUS_OK == status)
+            {
+                status = ParamOperation_ValidateParameters(new_profile);
+            }
+
+            if(LDC_STATUS_OK == status)
+            {
+                status = LensProfile_Preprocess(new_profile);
+            }
+        }
+    }
+
+    if(LDC_STATUS_OK == status)
+    {
+        *profile = new_profile;
+    }
+    else if(NULL != new_profile)
+    {
+        LensProfile_Free(new_profile);
+    }
+
+    free(text);
+
+    return status;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LensProfile_LoadFile
+ *
+ * \brief  Parse and validate lens specification CSV file, and preprocess its lookup tables.
+ *
+ * \param  [In]  lens_id      Lens ID of profile.
+ * \param  [In]  filename     Lens parameter CSV filename.
+ * \param  [Out] profile      Loaded profile, with one reference owned by caller.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status LensProfile_LoadFile(uint32_t lens_id, const char* const filename,
+                                const LensProfile** profile)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+
+    FILE* fp = (NULL == filename) ? NULL : fopen(filename, "rb");
+    if (NULL == fp)
+    {
+        status = LDC_STATUS_FILE_ERROR;
+        LdcLog_Write(LDC_LOG_ERROR, status, PARAMETERS_FILE_OPENING_ERROR_MESSAGE);
+    }
+    else
+    {
+        long size;
+        char* buffer = NULL;
+
+        /* Whole file is read at once, and parsed from memory. */
+        fseek(fp, 0, SEEK_END);
+        size = ftell(fp);
+        fseek(fp, 0, SEEK_SET);
+
+        if(size < 0 || NULL == (buffer = (char*)malloc((size_t)size + 1U)) ||
+           fread(buffer, 1, (size_t)size, fp) != (size_t)size)
+        {
+            status = LDC_STATUS_FILE_ERROR;
+            LdcLog_Write(LDC_LOG_ERROR, status, LENS_PARAMETERS_FILE_READING_ERROR_MESSAGE);
+        }
+        else
+        {
+            status = LensProfile_LoadBuffer(lens_id, buffer, (size_t)size, profile);
+        }
+
+        free(buffer);
+        fclose(fp);
+    }
+
+    return status;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LensProfile_LoadModel
+ *
+ * \brief  Create profile of analytic lens model. Profile has no lens table, and its lens
+ *         function is evaluated in closed form, by both fast and reference map.
+ *
+ * \param  [In]  lens_id      Lens ID of profile.
+ * \param  [In]  model        Analytic lens model, see LensModel_Fit.
+ * \param  [In]  sensor_pixel_pitch_in_mm  Sensor pixel pitch in mm.
+ * \param  [In]  scaling_factor            Image scaling factor.
+ * \param  [Out] profile      Created profile, with one reference owned by caller.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status LensProfile_LoadModel(uint32_t lens_id, const LensModel* const model,
+                                 double sensor_pixel_pitch_in_mm, double scaling_factor,
+                                 const LensProfile** profile)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    LensProfile* new_profile = NULL;
+
+    if(NULL == profile || LensModel_Validate(model) || !(sensor_pixel_pitch_in_mm > 0.0) ||
+       !(scaling_factor > 0.0) || !isfinite(sensor_pixel_pitch_in_mm) ||
+       !isfinite(scaling_factor))
+    {
+        status = LDC_STATUS_INVALID_LENS;
+        LdcLog_Write(LDC_LOG_ERROR, status, LENS_PARAMETERS_VALIDATION_ERROR_MESSAGE);
+    }
+    else if(NULL == (new_profile = (LensProfile*)calloc(1, sizeof(LensProfile))))
+    {
+        status = LDC_STATUS_OUT_OF_MEMORY;
+    }
+    else
+    {
+        new_profile->lens_id = lens_id;
+        new_profile->ref_count = 1U;
+        new_profile->model = *model;
+        new_profile->focal_length_in_mm = model->focal_length * sensor_pixel_pitch_in_mm;
+        new_profile->sensor_pixel_pitch_in_mm = sensor_pixel_pitch_in_mm;
+        new_profile->scaling_factor = scaling_factor;
+
+        status = LensProfile_Preprocess(new_profile);
+    }
+
+    if(LDC_STATUS_OK == status)
+    {
+        *profile = new_profile;
+    }
+    else if(NULL != new_profile)
+    {
+        LensProfile_Free(new_profile);
+    }
+
+    return status;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LensProfile_Retain
+ *
+ * \brief  Take one more reference of profile. Static profile (see BakedTables) is not counted.
+ *
+ * \param  [In]  profile      Lens profile.
+ *
+ * \return const LensProfile*   Same profile.
+ *
+ ***************************************************************************************************
+ */
+const LensProfile* LensProfile_Retain(const LensProfile* const profile)
+{
+    /* Reference count is only mutable part of profile, and static profile is read only. */
+    if(LENS_PROFILE_STATIC != __atomic_load_n(&profile->ref_count, __ATOMIC_RELAXED))
+    {
+        __atomic_add_fetch(&((LensProfile*)profile)->ref_count, 1U, __ATOMIC_RELAXED);
+    }
+
+    return profile;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LensProfile_Release
+ *
+ * \brief  Release one reference of profile. Profile is freed with its last reference, and
+ *         static profile is never freed.
+ *
+ * \param  [In]  profile      Lens profile, or NULL.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void LensProfile_Release(const LensProfile* const profile)
+{
+    if(NULL != profile &&
+       LENS_PROFILE_STATIC != __atomic_load_n(&profile->ref_count, __ATOMIC_RELAXED) &&
+       0U == __atomic_sub_fetch(&((LensProfile*)profile)->ref_count, 1U, __ATOMIC_ACQ_REL))
+    {
+        LensProfile_Free((LensProfile*)profile);
+    }
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LensProfile_InterpolateHeight
+ *
+ * \brief  Get image height of field angles, by linear interpolation of lens table segment of
+ *         nearest table angle, or by analytic lens model. This is reference lens function.
+ *
+ * \param  [In]  profile      Lens profile.
+ * \param  [In]  theta        Field angles in radian.
+ * \param  [Out] r_d          Image heights in pixels.
+ * \param  [In]  count        Number of angles.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void LensProfile_InterpolateHeight(const LensProfile* const profile, const double* const theta,
+                                   double* r_d, uint32_t count)
+{
+    uint32_t i;
+
+    if(LENS_MODEL_TABLE != profile->model.type)
+    {
+        LensModel_GetHeight(&profile->model, theta, r_d, count);
+        return;
+    }
+
+    for(i = 0;i < count;i++)
+    {
+        int32_t index_of_nearest_number;
+
+        index_of_nearest_number = findNearestNeighbourIndex(theta[i], profile->angle,
+                                                            profile->num_of_useful_elements);
+        if(index_of_nearest_number != -1)
+        {
+            r_d[i] = profile->slope[index_of_nearest_number] * theta[i]
+                     + profile->intercept[index_of_nearest_number];
+        }
+        else
+        {
+            r_d[i] = DBL_MAX;
+        }
+    }
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LensRegistry_Init
+ *
+ * \brief  Initialize empty lens registry.
+ *
+ * \param  [Out] registry     Lens registry.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status LensRegistry_Init(LensRegistry* registry)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+
+    memset(registry, 0, sizeof(LensRegistry));
+
+    if(0 != pthread_mutex_init(&registry->lock, NULL))
+    {
+        status = LDC_STATUS_ERROR;
+    }
+
+    return status;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LensRegistry_Deinit
+ *
+ * \brief  Release references of all registered profiles. Profiles acquired from registry stay
+ *         valid, until they are released.
+ *
+ * \param  [In]  registry     Lens registry.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void LensRegistry_Deinit(LensRegistry* registry)
+{
+    uint32_t i;
+
+    for(i = 0;i < registry->num_of_profiles;i++)
+    {
+        LensProfile_Release(registry->profiles[i]);
+    }
+
+    free(registry->profiles);
+    pthread_mutex_destroy(&registry->lock);
+    memset(registry, 0, sizeof(LensRegistry));
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LensRegistry_Add
+ *
+ * \brief  Register profile under its lens ID. Profile previously registered with same lens ID is
+ *         replaced, and holders of old profile keep using it until they release it.
+ *
+ * \param  [In]  registry     Lens registry.
+ * \param  [In]  profile      Lens profile. Registry takes its own reference.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status LensRegistry_Add(LensRegistry* registry, const LensProfile* const profile)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    const LensProfile* old_profile = NULL;
+    uint32_t i;
+
+    if(NULL == registry || NULL == profile)
+    {
+        return LDC_STATUS_ERROR;
+    }
+
+    pthread_mutex_lock(&registry->lock);
+
+    for(i = 0;i < registry->num_of_profiles;i++)
+    {
+        if(registry->profiles[i]->lens_id == profile->lens_id)
+        {
+            old_profile = registry->profiles[i];
+            registry->profiles[i] = (LensProfile*)LensProfile_Retain(profile);
+            break;
+        }
+    }
+
+    if(i == registry->num_of_profiles)
+    {
+        if(registry->num_of_profiles == registry->capacity)
+        {
+            uint32_t new_capacity = (0U == registry->capacity) ? 8U : 2U * registry->capacity;
+            LensProfile** profiles = (LensProfile**)realloc(registry->profiles,
+                                                            new_capacity * sizeof(LensProfile*));
+            if(NULL == profiles)
+            {
+                status = LDC_STATUS_ERROR;
+            }
+            else
+            {
+                registry->profiles = profiles;
+                registry->capacity = new_capacity;
+            }
+        }
+
+        if(LDC_STATUS_OK == status)
+        {
+            registry->profiles[registry->num_of_profiles++] =
+                (LensProfile*)LensProfile_Retain(profile);
+        }
+    }
+
+    pthread_mutex_unlock(&registry->lock);
+
+    LensProfile_Release(old_profile);
+
+    return status;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LensRegistry_LoadFile
+ *
+ * \brief  Load lens specification CSV file, and register it under lens ID.
+ *
+ * \param  [In]  registry     Lens registry.
+ * \param  [In]  lens_id      Lens ID.
+ * \param  [In]  filename     Lens parameter CSV filename.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status LensRegistry_LoadFile(LensRegistry* registry, uint32_t lens_id,
+                                 const char* const filename)
+{
+    LDC_Status status;
+    const LensProfile* profile;
+
+    status = LensProfile_LoadFile(lens_id, filename, &profile);
+    if(LDC_STATUS_OK == status)
+    {
+        status = LensRegistry_Add(registry, profile);
+        LensProfile_Release(profile);
+    }
+
+    return status;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LensRegistry_LoadBuffer
+ *
+ * \brief  Load lens specification from memory, and register it under lens ID.
+ *
+ * \param  [In]  registry     Lens registry.
+ * \param  [In]  lens_id      Lens ID.
+ * \param  [In]  buffer       Lens specification, with same content as CSV file.
+ * \param  [In]  size         Size of buffer in bytes.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status LensRegistry_LoadBuffer(LensRegistry* registry, uint32_t lens_id,
+                                   const char* const buffer, size_t size)
+{
+    LDC_Status status;
+    const LensProfile* profile;
+
+    status = LensProfile_LoadBuffer(lens_id, buffer, size, &profile);
+    if(LDC_STATUS_OK == status)
+    {
+        status = LensRegistry_Add(registry, profile);
+        LensProfile_Release(profile);
+    }
+
+    return status;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LensRegistry_Acquire
+ *
+ * \brief  Get shared reference of profile registered under lens ID.
+ *
+ * \param  [In]  registry     Lens registry.
+ * \param  [In]  lens_id      Lens ID.
+ *
+ * \return const LensProfile*   Profile that has to be released with LensProfile_Release,
+ *                              or NULL when lens ID is not registered.
+ *
+ ***************************************************************************************************
+ */
+const LensProfile* LensRegistry_Acquire(LensRegistry* registry, uint32_t lens_id)
+{
+    const LensProfile* profile = NULL;
+    uint32_t i;
+
+    pthread_mutex_lock(&registry->lock);
+
+    for(i = 0;i < registry->num_of_profiles;i++)
+    {
+        if(registry->profiles[i]->lens_id == lens_id)
+        {
+            profile = LensProfile_Retain(registry->profiles[i]);
+            break;
+        }
+    }
+
+    pthread_mutex_unlock(&registry->lock);
+
+    return profile;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LensRegistry_AcquireByHash
+ *
+ * \brief  Get shared reference of registered profile with given hash of lens specification.
+ *
+ * \param  [In]  registry     Lens registry.
+ * \param  [In]  hash         Hash of lens specification.
+ *
+ * \return const LensProfile*   Profile that has to be released with LensProfile_Release,
+ *                              or NULL when there is no such profile.
+ *
+ ***************************************************************************************************
+ */
+const LensProfile* LensRegistry_AcquireByHash(LensRegistry* registry, uint64_t hash)
+{
+    const LensProfile* profile = NULL;
+    uint32_t i;
+
+    pthread_mutex_lock(&registry->lock);
+
+    for(i = 0;i < registry->num_of_profiles;i++)
+    {
+        if(registry->profiles[i]->hash == hash)
+        {
+            profile = LensProfile_Retain(registry->profiles[i]);
+            break;
+        }
+    }
+
+    pthread_mutex_unlock(&registry->lock);
+
+    return profile;
+}
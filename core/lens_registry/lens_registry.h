@@ -0,0 +1,334 @@
+/**
+ ***************************************************************************************************
+ *
+ * \file  lens_registry.h
+ *
+ * \brief This file contains API for parsing lens specification files once, and sharing
+ *        preprocessed lens profiles between map builders.
+ *
+ * \arg author:  Dejan Milojica
+ * \arg version: 1.2
+ * \arg date:    13.01.2021
+ *
+ ***************************************************************************************************
+ */
+
+#ifndef LENS_REGISTRY_H
+#define LENS_REGISTRY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================================== */
+/*                                       Include Files                                            */
+/* ============================================================================================== */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+
+#include "../lib/ldc_types.h"
+#include "../fast_map/fast_map.h"
+#include "../lens_model/lens_model.h"
+
+/* ============================================================================================== */
+/*                                     Macros & Typedefs                                          */
+/* ============================================================================================== */
+
+#define PARAMETERS_FILE_OPENING_ERROR_MESSAGE (\
+    "Error opening parameters file.")
+
+#define LENS_PARAMETERS_FILE_READING_ERROR_MESSAGE (\
+    "Error while reading LENS cameara parameters, from parameters file.")
+
+#define LENS_PARAMETERS_VALIDATION_ERROR_MESSAGE (\
+    "Error, LENS camera parameters are not valid. Angles have to be increasing.")
+
+#define LENS_PROFILE_STATIC (0xFFFFFFFFU)      /* Reference count of profile in read only     */
+                                                /* memory, that is never freed.                */
+
+/**
+ ***************************************************************************************************
+ *
+ * \typedef LensProfile
+ *
+ * \brief   Structure which represents parsed and validated specification of lens, with
+ *          preprocessed lookup tables, or analytic lens model. Profile is immutable after loading,
+ *          and it is shared by reference counting, so it can be used from any thread.
+ *
+ ***************************************************************************************************
+ */
+typedef struct
+{
+    uint32_t lens_id;                           /* Lens ID, given when profile is loaded. */
+    uint64_t hash;                              /* Hash of lens specification values.     */
+    double* angle;                              /* Array of field angle view in radian.   */
+    double* height;                             /* Array of image height in pixels.       */
+    double* slope;                              /* Slope of every table segment.          */
+    double* intercept;                          /* Intercept of every table segment.      */
+    uint32_t num_of_useful_elements;            /* Number of elements previous arrays.    */
+    double focal_length_in_mm;                  /* Camera focal length in mm.             */
+    double sensor_pixel_pitch_in_mm;            /* Sensor pixel pitch in mm.              */
+    double scaling_factor;                      /* Image scaling factor.                  */
+    LensModel model;                            /* Lens function, table for CSV profile.  */
+    FastMap_RadialLut lut;                      /* Radial LUT, with optical centre at 0.  */
+    uint32_t ref_count;                         /* Number of references, atomic.          */
+}LensProfile;
+
+/**
+ ***************************************************************************************************
+ *
+ * \typedef LensRegistry
+ *
+ * \brief   Structure which represents set of lens profiles, keyed by lens ID.
+ *
+ ***************************************************************************************************
+ */
+typedef struct
+{
+    LensProfile** profiles;                     /* Registered profiles.                   */
+    uint32_t num_of_profiles;                   /* Number of registered profiles.         */
+    uint32_t capacity;                          /* Capacity of profiles array.            */
+    pthread_mutex_t lock;                       /* Protects profiles array.               */
+}LensRegistry;
+
+/* ============================================================================================== */
+/*                                     Function Declarations                                      */
+/* ============================================================================================== */
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LensProfile_LoadBuffer
+ *
+ * \brief  Parse and validate lens specification from memory, and preprocess its lookup tables.
+ *         Buffer has same content as lens specification CSV file.
+ *
+ * \param  [In]  lens_id      Lens ID of profile.
+ * \param  [In]  buffer       Lens specification.
+ * \param  [In]  size         Size of buffer in bytes.
+ * \param  [Out] profile      Loaded profile, with one reference owned by caller.
+ *
+ * \return LDC_Status   Exit status, LDC_STATUS_INVALID_LENS for invalid specification.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status LensProfile_LoadBuffer(uint32_t lens_id, const char* const buffer, size_t size,
+                                  const LensProfile** profile);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LensProfile_LoadFile
+ *
+ * \brief  Parse and validate lens specification CSV file, and preprocess its lookup tables.
+ *
+ * \param  [In]  lens_id      Lens ID of profile.
+ * \param  [In]  filename     Lens parameter CSV filename.
+ * \param  [Out] profile      Loaded profile, with one reference owned by caller.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status LensProfile_LoadFile(uint32_t lens_id, const char* const filename,
+                                const LensProfile** profile);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LensProfile_LoadModel
+ *
+ * \brief  Create profile of analytic lens model. Profile has no lens table, and its lens
+ *         function is evaluated in closed form, by both fast and reference map.
+ *
+ * \param  [In]  lens_id      Lens ID of profile.
+ * \param  [In]  model        Analytic lens model, see LensModel_Fit.
+ * \param  [In]  sensor_pixel_pitch_in_mm  Sensor pixel pitch in mm.
+ * \param  [In]  scaling_factor            Image scaling factor.
+ * \param  [Out] profile      Created profile, with one reference owned by caller.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status LensProfile_LoadModel(uint32_t lens_id, const LensModel* const model,
+                                 double sensor_pixel_pitch_in_mm, double scaling_factor,
+                                 const LensProfile** profile);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LensProfile_Retain
+ *
+ * \brief  Take one more reference of profile. Static profile (see BakedTables) is not counted.
+ *
+ * \param  [In]  profile      Lens profile.
+ *
+ * \return const LensProfile*   Same profile.
+ *
+ ***************************************************************************************************
+ */
+const LensProfile* LensProfile_Retain(const LensProfile* const profile);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LensProfile_Release
+ *
+ * \brief  Release one reference of profile. Profile is freed with its last reference, and
+ *         static profile is never freed.
+ *
+ * \param  [In]  profile      Lens profile, or NULL.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void LensProfile_Release(const LensProfile* const profile);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LensProfile_InterpolateHeight
+ *
+ * \brief  Get image height of field angles, by linear interpolation of lens table segment of
+ *         nearest table angle, or by analytic lens model. This is reference lens function.
+ *
+ * \param  [In]  profile      Lens profile.
+ * \param  [In]  theta        Field angles in radian.
+ * \param  [Out] r_d          Image heights in pixels.
+ * \param  [In]  count        Number of angles.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void LensProfile_InterpolateHeight(const LensProfile* const profile, const double* const theta,
+                                   double* r_d, uint32_t count);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LensRegistry_Init
+ *
+ * \brief  Initialize empty lens registry.
+ *
+ * \param  [Out] registry     Lens registry.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status LensRegistry_Init(LensRegistry* registry);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LensRegistry_Deinit
+ *
+ * \brief  Release references of all registered profiles. Profiles acquired from registry stay
+ *         valid, until they are released.
+ *
+ * \param  [In]  registry     Lens registry.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void LensRegistry_Deinit(LensRegistry* registry);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LensRegistry_Add
+ *
+ * \brief  Register profile under its lens ID. Profile previously registered with same lens ID is
+ *         replaced, and holders of old profile keep using it until they release it.
+ *
+ * \param  [In]  registry     Lens registry.
+ * \param  [In]  profile      Lens profile. Registry takes its own reference.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status LensRegistry_Add(LensRegistry* registry, const LensProfile* const profile);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LensRegistry_LoadFile
+ *
+ * \brief  Load lens specification CSV file, and register it under lens ID.
+ *
+ * \param  [In]  registry     Lens registry.
+ * \param  [In]  lens_id      Lens ID.
+ * \param  [In]  filename     Lens parameter CSV filename.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status LensRegistry_LoadFile(LensRegistry* registry, uint32_t lens_id,
+                                 const char* const filename);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LensRegistry_LoadBuffer
+ *
+ * \brief  Load lens specification from memory, and register it under lens ID.
+ *
+ * \param  [In]  registry     Lens registry.
+ * \param  [In]  lens_id      Lens ID.
+ * \param  [In]  buffer       Lens specification, with same content as CSV file.
+ * \param  [In]  size         Size of buffer in bytes.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status LensRegistry_LoadBuffer(LensRegistry* registry, uint32_t lens_id,
+                                   const char* const buffer, size_t size);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LensRegistry_Acquire
+ *
+ * \brief  Get shared reference of profile registered under lens ID.
+ *
+ * \param  [In]  registry     Lens registry.
+ * \param  [In]  lens_id      Lens ID.
+ *
+ * \return const LensProfile*   Profile that has to be released with LensProfile_Release,
+ *                              or NULL when lens ID is not registered.
+ *
+ ***************************************************************************************************
+ */
+const LensProfile* LensRegistry_Acquire(LensRegistry* registry, uint32_t lens_id);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LensRegistry_AcquireByHash
+ *
+ * \brief  Get shared reference of registered profile with given hash of lens specification.
+ *
+ * \param  [In]  registry     Lens registry.
+ * \param  [In]  hash         Hash of lens specification.
+ *
+ * \return const LensProfile*   Profile that has to be released with LensProfile_Release,
+ *                              or NULL when there is no such profile.
+ *
+ ***************************************************************************************************
+ */
+const LensProfile* LensRegistry_AcquireByHash(LensRegistry* registry, uint64_t hash);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,27 @@
+/**
+ ***************************************************************************************************
+ *
+ * \file  ldc_internal.h
+ *
+ * \brief This file contains helper macros of library sources. It is not included by public
+ *        headers, so macros do not leak into code of library users.
+ *
+ * \arg author:  Dejan Milojica
+ * \arg version: 1.2
+ * \arg date:    13.01.2021
+ *
+ ***************************************************************************************************
+ */
+
+#ifndef LDC_INTERNAL_H
+#define LDC_INTERNAL_H
+
+/* ============================================================================================== */
+/*                                     Macros & Typedefs                                          */
+/* ============================================================================================== */
+
+#define LDC_MIN(X,Y) ((X) < (Y) ? (X) : (Y))    /* min/max macros. */
+#define LDC_MAX(X,Y) ((X) > (Y) ? (X) : (Y))
+#define LDC_ABS(x) ((x) < 0 ? -(x) : (x))       /* Double abs function.  */
+
+#endif
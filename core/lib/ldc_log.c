@@ -0,0 +1,122 @@
+/**
+ ***************************************************************************************************
+ *
+ * \file  ldc_log.c
+ *
+ * \brief This file contains API for reporting of library errors and events through optional
+ *        logging callback. Library does not print to stdout or stderr.
+ *
+ * \arg author:  Dejan Milojica
+ * \arg version: 1.2
+ * \arg date:    13.01.2021
+ *
+ ***************************************************************************************************
+ */
+
+/* ============================================================================================== */
+/*                                       Include Files                                            */
+/* ============================================================================================== */
+
+#include "ldc_log.h"
+#include <stdio.h>
+#include <stdarg.h>
+#include <stddef.h>
+
+/* ============================================================================================== */
+/*                                       Global variables                                         */
+/* ============================================================================================== */
+
+static LDC_LogCallback log_callback = NULL;     /* Logging callback of process.                */
+static void* log_user_data = NULL;              /* User data of logging callback.              */
+
+static const char* const status_names[] =
+{
+    "success",
+    "error",
+    "invalid argument",
+    "out of memory",
+    "file error",
+    "invalid lens specification",
+    "unsupported YUV format",
+    "timeout"
+};
+
+/* ============================================================================================== */
+
+/*                                     API Functions                                              */
+
+/* ============================================================================================== */
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LdcLog_SetCallback
+ *
+ * \brief  Set logging callback of process. Without callback messages are dropped. Callback may
+ *         be called from many threads at same time, so it has to be thread safe. Callback is
+ *         set before threads use library, and it is not changed while they use it.
+ *
+ * \param  [In]  callback     Logging callback, or NULL.
+ * \param  [In]  user_data    Given to callback.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void LdcLog_SetCallback(LDC_LogCallback callback, void* user_data)
+{
+    __atomic_store_n(&log_user_data, user_data, __ATOMIC_RELAXED);
+    __atomic_store_n(&log_callback, callback, __ATOMIC_RELEASE);
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LdcLog_Write
+ *
+ * \brief  Format message and give it to logging callback. Message is not formatted, when
+ *         there is no callback.
+ *
+ * \param  [In]  level        Level of message.
+ * \param  [In]  status       Status that is reported, or LDC_STATUS_OK for events.
+ * \param  [In]  format       printf format of message.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void LdcLog_Write(LDC_LogLevel level, LDC_Status status, const char* const format, ...)
+{
+    LDC_LogCallback callback = __atomic_load_n(&log_callback, __ATOMIC_ACQUIRE);
+
+    if(NULL != callback)
+    {
+        char message[LDC_LOG_MAX_MESSAGE];
+        va_list args;
+
+        va_start(args, format);
+        vsnprintf(message, sizeof(message), format, args);
+        va_end(args);
+
+        callback(level, status, message, __atomic_load_n(&log_user_data, __ATOMIC_RELAXED));
+    }
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LdcLog_GetStatusName
+ *
+ * \brief  Get description of status.
+ *
+ * \param  [In]  status       Exit status.
+ *
+ * \return const char*  Constant description of status.
+ *
+ ***************************************************************************************************
+ */
+const char* LdcLog_GetStatusName(LDC_Status status)
+{
+    return ((uint32_t)status < sizeof(status_names) / sizeof(status_names[0])) ?
+           status_names[status] : "unknown status";
+}
@@ -0,0 +1,117 @@
+/**
+ ***************************************************************************************************
+ *
+ * \file  ldc_log.h
+ *
+ * \brief This file contains API for reporting of library errors and events through optional
+ *        logging callback. Library does not print to stdout or stderr.
+ *
+ * \arg author:  Dejan Milojica
+ * \arg version: 1.2
+ * \arg date:    13.01.2021
+ *
+ ***************************************************************************************************
+ */
+
+#ifndef LDC_LOG_H
+#define LDC_LOG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================================== */
+/*                                       Include Files                                            */
+/* ============================================================================================== */
+
+#include <stdint.h>
+
+#include "ldc_types.h"
+
+/* ============================================================================================== */
+/*                                     Macros & Typedefs                                          */
+/* ============================================================================================== */
+
+#define LDC_LOG_MAX_MESSAGE (256U)              /* Max length of formatted message.            */
+
+/**
+ ***************************************************************************************************
+ *
+ * \typedef LDC_LogLevel
+ *
+ * \brief   Defines possible levels of log messages.
+ *
+ ***************************************************************************************************
+ */
+typedef enum
+{
+    LDC_LOG_ERROR   = 0,    /* Operation failed, status is returned to caller too.     */
+    LDC_LOG_WARNING = 1,    /* Operation recovered, for example previous lens is kept. */
+    LDC_LOG_INFO    = 2     /* Event, for example lens reload.                         */
+} LDC_LogLevel;
+
+/* Receives message, without trailing newline. Called from thread that reports message. */
+typedef void (*LDC_LogCallback)(LDC_LogLevel level, LDC_Status status, const char* message,
+                                void* user_data);
+
+/* ============================================================================================== */
+/*                                     Function Declarations                                      */
+/* ============================================================================================== */
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LdcLog_SetCallback
+ *
+ * \brief  Set logging callback of process. Without callback messages are dropped. Callback may
+ *         be called from many threads at same time, so it has to be thread safe. Callback is
+ *         set before threads use library, and it is not changed while they use it.
+ *
+ * \param  [In]  callback     Logging callback, or NULL.
+ * \param  [In]  user_data    Given to callback.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void LdcLog_SetCallback(LDC_LogCallback callback, void* user_data);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LdcLog_Write
+ *
+ * \brief  Format message and give it to logging callback. Message is not formatted, when
+ *         there is no callback.
+ *
+ * \param  [In]  level        Level of message.
+ * \param  [In]  status       Status that is reported, or LDC_STATUS_OK for events.
+ * \param  [In]  format       printf format of message.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void LdcLog_Write(LDC_LogLevel level, LDC_Status status, const char* const format, ...)
+    __attribute__((format(printf, 3, 4)));
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     LdcLog_GetStatusName
+ *
+ * \brief  Get description of status.
+ *
+ * \param  [In]  status       Exit status.
+ *
+ * \return const char*  Constant description of status.
+ *
+ ***************************************************************************************************
+ */
+const char* LdcLog_GetStatusName(LDC_Status status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -3,7 +3,8 @@
  *
  * \file  ldc_types.h
  *
- * \brief This file contains the enumerations, that defines type of YUV image, and exit status.
+ * \brief This file contains the enumerations, that defines type of YUV image, and exit status,
+ *        and structures that defines region of interest and border colour.
  *
  * \arg author:  Dejan Milojica
  * \arg version: 1.2
@@ -15,6 +16,12 @@
 #ifndef LDC_TYPES_H
 #define LDC_TYPES_H
 
+/* ============================================================================================== */
+/*                                       Include Files                                            */
+/* ============================================================================================== */
+
+#include <stdint.h>
+
 /* ============================================================================================== */
 /*                                     Macros & Typedefs                                          */
 /* ============================================================================================== */
@@ -32,22 +39,84 @@
 typedef enum
 {
     YUV420_NV12     = 1, /* First image YUV type YUV420 nv12 */
-    YUV422I_UYVY    = 2  /* Second image YUV type YUV422 UYVY */
+    YUV422I_UYVY    = 2, /* Second image YUV type YUV422 UYVY */
+    YUV420_P010     = 3, /* YUV420 semi-planar, 10 bit samples in high bits of 16 bit words */
+    YUV420_P016     = 4, /* YUV420 semi-planar, 16 bit samples */
+    YUV422I_Y210    = 5, /* YUV422 interleaved Y0 U Y1 V, 10 bit samples in high bits */
+    YUV420_I420     = 6, /* YUV420 planar, Y, U and V planes */
+    YUV420_NV21     = 7, /* YUV420 semi-planar, V and U components are interleaved */
+    YUV422I_YUYV    = 8, /* YUV422 interleaved Y0 U Y1 V */
+    YUV444_PLANAR   = 9  /* YUV444 planar, Y, U and V planes of full resolution */
 } YUV_Type;
 
+/**
+ ***************************************************************************************************
+ *
+ * \typedef LDC_Interpolation
+ *
+ * \brief   Defines possible ways of sampling source frame at mapped positions.
+ *
+ ***************************************************************************************************
+ */
+typedef enum
+{
+    LDC_INTERPOLATION_NEAREST  = 0, /* Nearest source pixel.                  */
+    LDC_INTERPOLATION_BILINEAR = 1  /* Bilinear interpolation of 2x2 pixels.  */
+} LDC_Interpolation;
+
 /**
  ***************************************************************************************************
  *
  * \typedef LDC_Status
  *
- * \brief   Defines possible types of function exit status.
+ * \brief   Defines possible types of function exit status. Every status other than
+ *          LDC_STATUS_OK is failure, so status can be tested as boolean.
  *
  ***************************************************************************************************
  */
 typedef enum
 {
-    LDC_STATUS_OK    = 0,  /* Success exit   */
-    LDC_STATUS_ERROR = 1,  /* Unsuccess exit */
+    LDC_STATUS_OK                 = 0,  /* Success exit                                        */
+    LDC_STATUS_ERROR              = 1,  /* Unsuccess exit                                      */
+    LDC_STATUS_INVALID_ARGUMENT   = 2,  /* Argument is NULL, zero or out of range.             */
+    LDC_STATUS_OUT_OF_MEMORY      = 3,  /* Allocation failed.                                  */
+    LDC_STATUS_FILE_ERROR         = 4,  /* File can not be opened, read or written.            */
+    LDC_STATUS_INVALID_LENS       = 5,  /* Lens specification can not be parsed, or invalid.   */
+    LDC_STATUS_UNSUPPORTED_FORMAT = 6,  /* YUV type is not supported.                          */
+    LDC_STATUS_TIMEOUT            = 7   /* Wait timed out.                                     */
 } LDC_Status;
 
+/**
+ ***************************************************************************************************
+ *
+ * \typedef LDC_Roi
+ *
+ * \brief   Defines rectangular region of interest, in output frame space.
+ *
+ ***************************************************************************************************
+ */
+typedef struct
+{
+    uint32_t x;         /* Horizontal position of top left corner. */
+    uint32_t y;         /* Vertical position of top left corner.   */
+    uint32_t width;     /* Width of region.                        */
+    uint32_t height;    /* Height of region.                       */
+} LDC_Roi;
+
+/**
+ ***************************************************************************************************
+ *
+ * \typedef LDC_Color
+ *
+ * \brief   Defines constant colour, used for output pixels without valid source pixel.
+ *
+ ***************************************************************************************************
+ */
+typedef struct
+{
+    uint8_t y;          /* Y component of colour. */
+    uint8_t u;          /* U component of colour. */
+    uint8_t v;          /* V component of colour. */
+} LDC_Color;
+
 #endif
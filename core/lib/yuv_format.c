@@ -0,0 +1,436 @@
+/**
+ ***************************************************************************************************
+ *
+ * \file  yuv_format.c
+ *
+ * \brief This file contains table of supported YUV formats, with layout of their components,
+ *        and API for splitting frames to components and combining them back.
+ *
+ * \arg author:  Dejan Milojica
+ * \arg version: 1.2
+ * \arg date:    13.01.2021
+ *
+ ***************************************************************************************************
+ */
+
+/* ============================================================================================== */
+/*                                       Include Files                                            */
+/* ============================================================================================== */
+
+#include "yuv_format.h"
+#include <stddef.h>
+#include <string.h>
+
+/* ============================================================================================== */
+/*                                       Global variables                                         */
+/* ============================================================================================== */
+
+static const YuvFormat yuv_formats[] =
+{
+    /* Type          Name            Layout                  Planes Bytes Shift X/Y  Y0 Y1  U   V */
+    {YUV420_NV12,   "YUV420_NV12",  YUV_LAYOUT_SEMI_PLANAR, 2U,    1U,   1U, 1U, {0U, 0U}, 0U, 1U},
+    {YUV422I_UYVY,  "YUV422I_UYVY", YUV_LAYOUT_PACKED,      1U,    1U,   1U, 0U, {1U, 3U}, 0U, 2U},
+    {YUV420_P010,   "YUV420_P010",  YUV_LAYOUT_SEMI_PLANAR, 2U,    2U,   1U, 1U, {0U, 0U}, 0U, 1U},
+    {YUV420_P016,   "YUV420_P016",  YUV_LAYOUT_SEMI_PLANAR, 2U,    2U,   1U, 1U, {0U, 0U}, 0U, 1U},
+    {YUV422I_Y210,  "YUV422I_Y210", YUV_LAYOUT_PACKED,      1U,    2U,   1U, 0U, {0U, 2U}, 1U, 3U},
+    {YUV420_I420,   "YUV420_I420",  YUV_LAYOUT_PLANAR,      3U,    1U,   1U, 1U, {0U, 0U}, 0U, 0U},
+    {YUV420_NV21,   "YUV420_NV21",  YUV_LAYOUT_SEMI_PLANAR, 2U,    1U,   1U, 1U, {0U, 0U}, 1U, 0U},
+    {YUV422I_YUYV,  "YUV422I_YUYV", YUV_LAYOUT_PACKED,      1U,    1U,   1U, 0U, {0U, 2U}, 1U, 3U},
+    {YUV444_PLANAR, "YUV444_PLANAR",YUV_LAYOUT_PLANAR,      3U,    1U,   0U, 0U, {0U, 0U}, 0U, 0U},
+};
+
+/* ============================================================================================== */
+/*                              Internal Helper Functions                                         */
+/* ============================================================================================== */
+
+/* Sample of frame, 16 bit samples are little endian. */
+static uint32_t YuvFormat_LoadSample(const uint8_t* const frame, size_t index, uint32_t bytes)
+{
+    return (1U == bytes) ? frame[index] :
+           (uint32_t)frame[2 * index] | ((uint32_t)frame[2 * index + 1] << 8);
+}
+
+static void YuvFormat_StoreSample(uint8_t* const frame, size_t index, uint32_t value,
+                                  uint32_t bytes)
+{
+    if(1U == bytes)
+    {
+        frame[index] = (uint8_t)value;
+    }
+    else
+    {
+        frame[2 * index] = (uint8_t)(value & 0xFFU);
+        frame[2 * index + 1] = (uint8_t)(value >> 8);
+    }
+}
+
+/* Sample of component, 16 bit samples are in native byte order. */
+static uint32_t YuvFormat_LoadComponent(const uint8_t* const component, size_t index,
+                                        uint32_t bytes)
+{
+    return (1U == bytes) ? component[index] : ((const uint16_t*)component)[index];
+}
+
+static void YuvFormat_StoreComponent(uint8_t* const component, size_t index, uint32_t value,
+                                     uint32_t bytes)
+{
+    if(1U == bytes)
+    {
+        component[index] = (uint8_t)value;
+    }
+    else
+    {
+        ((uint16_t*)component)[index] = (uint16_t)value;
+    }
+}
+
+static void YuvFormat_SplitPlane(const uint8_t* const plane, uint8_t* const component,
+                                 size_t count, uint32_t bytes)
+{
+    size_t i;
+
+    if(1U == bytes)
+    {
+        memcpy(component, plane, count);
+    }
+    else
+    {
+        for(i = 0;i < count;i++)
+        {
+            YuvFormat_StoreComponent(component, i, YuvFormat_LoadSample(plane, i, bytes), bytes);
+        }
+    }
+}
+
+static void YuvFormat_CombinePlane(uint8_t* const plane, const uint8_t* const component,
+                                   size_t count, uint32_t bytes)
+{
+    size_t i;
+
+    if(1U == bytes)
+    {
+        memcpy(plane, component, count);
+    }
+    else
+    {
+        for(i = 0;i < count;i++)
+        {
+            YuvFormat_StoreSample(plane, i, YuvFormat_LoadComponent(component, i, bytes), bytes);
+        }
+    }
+}
+
+/* ============================================================================================== */
+
+/*                                     API Functions                                              */
+
+/* ============================================================================================== */
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     YuvFormat_Get
+ *
+ * \brief  Get layout of YUV format.
+ *
+ * \param  [In]  yuv_type     Type of YUV image.
+ *
+ * \return const YuvFormat*   Layout of format, or NULL when format is not supported.
+ *
+ ***************************************************************************************************
+ */
+const YuvFormat* YuvFormat_Get(YUV_Type yuv_type)
+{
+    const YuvFormat* format = NULL;
+    uint32_t i;
+
+    for(i = 0;i < sizeof(yuv_formats) / sizeof(yuv_formats[0]);i++)
+    {
+        if(yuv_formats[i].yuv_type == yuv_type)
+        {
+            format = &yuv_formats[i];
+            break;
+        }
+    }
+
+    return format;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     YuvFormat_ValidateSize
+ *
+ * \brief  Check that frame size is valid for format. Width and height have to be multiples of
+ *         chroma subsampling, so chroma components cover whole frame.
+ *
+ * \param  [In]  format       Layout of frame, or NULL.
+ * \param  [In]  width        Width of image.
+ * \param  [In]  height       Height of image.
+ *
+ * \return LDC_Status   LDC_STATUS_UNSUPPORTED_FORMAT when format is NULL,
+ *                      LDC_STATUS_INVALID_ARGUMENT when size is zero or not multiple of chroma
+ *                      subsampling.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status YuvFormat_ValidateSize(const YuvFormat* const format, uint32_t width, uint32_t height)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+
+    if(NULL == format)
+    {
+        status = LDC_STATUS_UNSUPPORTED_FORMAT;
+    }
+    /* Odd column or row of subsampled format has no chroma sample, and kernels and packed
+       groups would read past chroma components. */
+    else if(0U == width || 0U == height || 0U != width % (1U << format->chroma_shift_x) ||
+            0U != height % (1U << format->chroma_shift_y))
+    {
+        status = LDC_STATUS_INVALID_ARGUMENT;
+    }
+
+    return status;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     YuvFormat_GetFrameSize
+ *
+ * \brief  Get size of YUV frame in bytes.
+ *
+ * \param  [In]  width        Width of image.
+ * \param  [In]  height       Height of image.
+ * \param  [In]  yuv_type     Type of YUV image.
+ *
+ * \return size_t       Size of frame, or 0 when format is not supported.
+ *
+ ***************************************************************************************************
+ */
+size_t YuvFormat_GetFrameSize(uint32_t width, uint32_t height, YUV_Type yuv_type)
+{
+    const YuvFormat* format = YuvFormat_Get(yuv_type);
+    size_t size = 0;
+
+    if(NULL != format)
+    {
+        size = ((size_t)width * height + 2U * (size_t)(width >> format->chroma_shift_x) *
+                (height >> format->chroma_shift_y)) * format->bytes_per_sample;
+    }
+
+    return size;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     YuvFormat_GetChromaWidth
+ *
+ * \brief  Get number of columns of U and V components.
+ *
+ * \param  [In]  width        Width of image.
+ * \param  [In]  yuv_type     Type of YUV image.
+ *
+ * \return uint32_t     Columns of chroma components.
+ *
+ ***************************************************************************************************
+ */
+uint32_t YuvFormat_GetChromaWidth(uint32_t width, YUV_Type yuv_type)
+{
+    const YuvFormat* format = YuvFormat_Get(yuv_type);
+
+    return (NULL == format) ? 0U : width >> format->chroma_shift_x;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     YuvFormat_GetChromaHeight
+ *
+ * \brief  Get number of rows of U and V components.
+ *
+ * \param  [In]  height       Height of image.
+ * \param  [In]  yuv_type     Type of YUV image.
+ *
+ * \return uint32_t     Rows of chroma components.
+ *
+ ***************************************************************************************************
+ */
+uint32_t YuvFormat_GetChromaHeight(uint32_t height, YUV_Type yuv_type)
+{
+    const YuvFormat* format = YuvFormat_Get(yuv_type);
+
+    return (NULL == format) ? 0U : height >> format->chroma_shift_y;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     YuvFormat_Split
+ *
+ * \brief  Split YUV frame to separate Y, U and V components.
+ *
+ * \param  [In]  format       Layout of frame.
+ * \param  [In]  YUV          YUV frame, of YuvFormat_GetFrameSize bytes.
+ * \param  [Out] Y            Y component, of width * height samples.
+ * \param  [Out] U            U component, of chroma width * chroma height samples.
+ * \param  [Out] V            V component, of chroma width * chroma height samples.
+ * \param  [In]  width        Width of image.
+ * \param  [In]  height       Height of image.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void YuvFormat_Split(const YuvFormat* const format, const uint8_t* const YUV, uint8_t* const Y,
+                     uint8_t* const U, uint8_t* const V, uint32_t width, uint32_t height)
+{
+    uint32_t bytes = format->bytes_per_sample;
+    size_t luma_size = (size_t)width * height;
+    size_t chroma_size = (size_t)(width >> format->chroma_shift_x) *
+                         (height >> format->chroma_shift_y);
+    const uint8_t* chroma = &YUV[luma_size * bytes];
+    size_t i;
+
+    if(YUV_LAYOUT_PLANAR == format->layout)
+    {
+        YuvFormat_SplitPlane(YUV, Y, luma_size, bytes);
+        YuvFormat_SplitPlane(chroma, U, chroma_size, bytes);
+        YuvFormat_SplitPlane(&chroma[chroma_size * bytes], V, chroma_size, bytes);
+    }
+    else if(YUV_LAYOUT_SEMI_PLANAR == format->layout)
+    {
+        YuvFormat_SplitPlane(YUV, Y, luma_size, bytes);
+
+        for(i = 0;i < chroma_size;i++)
+        {
+            YuvFormat_StoreComponent(U, i, YuvFormat_LoadSample(chroma, 2 * i + format->u_offset,
+                                                                bytes), bytes);
+            YuvFormat_StoreComponent(V, i, YuvFormat_LoadSample(chroma, 2 * i + format->v_offset,
+                                                                bytes), bytes);
+        }
+    }
+    else
+    {
+        /* Every group of 4 samples has two Y samples, and one U and V sample. */
+        for(i = 0;i < chroma_size;i++)
+        {
+            const uint8_t* group = &YUV[4 * i * bytes];
+
+            YuvFormat_StoreComponent(Y, 2 * i, YuvFormat_LoadSample(group, format->y_offset[0],
+                                                                    bytes), bytes);
+            YuvFormat_StoreComponent(Y, 2 * i + 1, YuvFormat_LoadSample(group, format->y_offset[1],
+                                                                        bytes), bytes);
+            YuvFormat_StoreComponent(U, i, YuvFormat_LoadSample(group, format->u_offset, bytes),
+                                     bytes);
+            YuvFormat_StoreComponent(V, i, YuvFormat_LoadSample(group, format->v_offset, bytes),
+                                     bytes);
+        }
+    }
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     YuvFormat_Combine
+ *
+ * \brief  Combine separate Y, U and V components to YUV frame.
+ *
+ * \param  [In]  format       Layout of frame.
+ * \param  [Out] YUV          YUV frame, of YuvFormat_GetFrameSize bytes.
+ * \param  [In]  Y            Y component, of width * height samples.
+ * \param  [In]  U            U component, of chroma width * chroma height samples.
+ * \param  [In]  V            V component, of chroma width * chroma height samples.
+ * \param  [In]  width        Width of image.
+ * \param  [In]  height       Height of image.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void YuvFormat_Combine(const YuvFormat* const format, uint8_t* const YUV, const uint8_t* const Y,
+                       const uint8_t* const U, const uint8_t* const V, uint32_t width,
+                       uint32_t height)
+{
+    YuvFormat_CombineRows(format, YUV, Y, U, V, width, height, 0, height);
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     YuvFormat_CombineRows
+ *
+ * \brief  Combine rows [y_begin, y_end) of separate Y, U and V components into their place in
+ *         YUV frame, so frame can be written band by band. Band has to start and end at chroma
+ *         row.
+ *
+ * \param  [In]  format       Layout of frame.
+ * \param  [Out] YUV          YUV frame, of YuvFormat_GetFrameSize bytes.
+ * \param  [In]  Y            Y component of band, of width * (y_end - y_begin) samples.
+ * \param  [In]  U            U component of band, of chroma rows of band.
+ * \param  [In]  V            V component of band, of chroma rows of band.
+ * \param  [In]  width        Width of image.
+ * \param  [In]  height       Height of image.
+ * \param  [In]  y_begin      First row of band.
+ * \param  [In]  y_end        One past last row of band.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void YuvFormat_CombineRows(const YuvFormat* const format, uint8_t* const YUV,
+                           const uint8_t* const Y, const uint8_t* const U, const uint8_t* const V,
+                           uint32_t width, uint32_t height, uint32_t y_begin, uint32_t y_end)
+{
+    uint32_t bytes = format->bytes_per_sample;
+    uint32_t chroma_width = width >> format->chroma_shift_x;
+    size_t chroma_begin = (size_t)(y_begin >> format->chroma_shift_y) * chroma_width;
+    size_t luma_size = (size_t)(y_end - y_begin) * width;
+    size_t chroma_size = (size_t)((y_end - y_begin) >> format->chroma_shift_y) * chroma_width;
+    size_t frame_chroma_size = (size_t)chroma_width * (height >> format->chroma_shift_y);
+    uint8_t* chroma = &YUV[(size_t)width * height * bytes];
+    uint8_t* luma = &YUV[(size_t)y_begin * width * bytes];
+    size_t i;
+
+    if(YUV_LAYOUT_PLANAR == format->layout)
+    {
+        YuvFormat_CombinePlane(luma, Y, luma_size, bytes);
+        YuvFormat_CombinePlane(&chroma[chroma_begin * bytes], U, chroma_size, bytes);
+        YuvFormat_CombinePlane(&chroma[(frame_chroma_size + chroma_begin) * bytes], V,
+                               chroma_size, bytes);
+    }
+    else if(YUV_LAYOUT_SEMI_PLANAR == format->layout)
+    {
+        uint8_t* pairs = &chroma[2 * chroma_begin * bytes];
+
+        YuvFormat_CombinePlane(luma, Y, luma_size, bytes);
+
+        for(i = 0;i < chroma_size;i++)
+        {
+            YuvFormat_StoreSample(pairs, 2 * i + format->u_offset,
+                                  YuvFormat_LoadComponent(U, i, bytes), bytes);
+            YuvFormat_StoreSample(pairs, 2 * i + format->v_offset,
+                                  YuvFormat_LoadComponent(V, i, bytes), bytes);
+        }
+    }
+    else
+    {
+        /* Packed groups follow rows of frame, group i of band is chroma sample i. */
+        uint8_t* groups = &YUV[4 * chroma_begin * bytes];
+
+        for(i = 0;i < chroma_size;i++)
+        {
+            uint8_t* group = &groups[4 * i * bytes];
+
+            YuvFormat_StoreSample(group, format->y_offset[0],
+                                  YuvFormat_LoadComponent(Y, 2 * i, bytes), bytes);
+            YuvFormat_StoreSample(group, format->y_offset[1],
+                                  YuvFormat_LoadComponent(Y, 2 * i + 1, bytes), bytes);
+            YuvFormat_StoreSample(group, format->u_offset,
+                                  YuvFormat_LoadComponent(U, i, bytes), bytes);
+            YuvFormat_StoreSample(group, format->v_offset,
+                                  YuvFormat_LoadComponent(V, i, bytes), bytes);
+        }
+    }
+}
@@ -0,0 +1,242 @@
+/**
+ ***************************************************************************************************
+ *
+ * \file  yuv_format.h
+ *
+ * \brief This file contains table of supported YUV formats, with layout of their components,
+ *        and API for splitting frames to components and combining them back.
+ *
+ * \arg author:  Dejan Milojica
+ * \arg version: 1.2
+ * \arg date:    13.01.2021
+ *
+ ***************************************************************************************************
+ */
+
+#ifndef YUV_FORMAT_H
+#define YUV_FORMAT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================================== */
+/*                                       Include Files                                            */
+/* ============================================================================================== */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "ldc_types.h"
+
+/* ============================================================================================== */
+/*                                     Macros & Typedefs                                          */
+/* ============================================================================================== */
+
+/**
+ ***************************************************************************************************
+ *
+ * \typedef YuvLayout
+ *
+ * \brief   Defines how components of YUV frame are stored.
+ *
+ ***************************************************************************************************
+ */
+typedef enum
+{
+    YUV_LAYOUT_PLANAR      = 0, /* Y, U and V planes.                            */
+    YUV_LAYOUT_SEMI_PLANAR = 1, /* Y plane, and plane of interleaved U V pairs.  */
+    YUV_LAYOUT_PACKED      = 2  /* One plane of interleaved Y0 Y1 U V groups.    */
+} YuvLayout;
+
+/**
+ ***************************************************************************************************
+ *
+ * \typedef YuvFormat
+ *
+ * \brief   Structure which represents layout of YUV format. Frames are corrected as separate Y,
+ *          U and V components, chroma components have width >> chroma_shift_x columns and
+ *          height >> chroma_shift_y rows. Samples of 16 bit formats are stored as uint16_t in
+ *          components, in native byte order, and they are little endian in frames.
+ *
+ ***************************************************************************************************
+ */
+typedef struct
+{
+    YUV_Type yuv_type;                          /* Type of YUV image.                     */
+    const char* name;                           /* Name of format.                        */
+    YuvLayout layout;                           /* Storage of components in frame.        */
+    uint32_t num_of_planes;                     /* Number of planes in frame.             */
+    uint32_t bytes_per_sample;                  /* 1 for 8 bit, 2 for 16 bit containers.  */
+    uint32_t chroma_shift_x;                    /* 1 for 4:2:x, 0 for 4:4:4.              */
+    uint32_t chroma_shift_y;                    /* 1 for 4:2:0, 0 for 4:2:2 and 4:4:4.    */
+    uint8_t y_offset[2];                        /* Y0, Y1 sample in packed group.         */
+    uint8_t u_offset;                           /* U sample in packed group or UV pair.   */
+    uint8_t v_offset;                           /* V sample in packed group or UV pair.   */
+}YuvFormat;
+
+/* ============================================================================================== */
+/*                                     Function Declarations                                      */
+/* ============================================================================================== */
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     YuvFormat_Get
+ *
+ * \brief  Get layout of YUV format.
+ *
+ * \param  [In]  yuv_type     Type of YUV image.
+ *
+ * \return const YuvFormat*   Layout of format, or NULL when format is not supported.
+ *
+ ***************************************************************************************************
+ */
+const YuvFormat* YuvFormat_Get(YUV_Type yuv_type);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     YuvFormat_ValidateSize
+ *
+ * \brief  Check that frame size is valid for format. Width and height have to be multiples of
+ *         chroma subsampling, so chroma components cover whole frame.
+ *
+ * \param  [In]  format       Layout of frame, or NULL.
+ * \param  [In]  width        Width of image.
+ * \param  [In]  height       Height of image.
+ *
+ * \return LDC_Status   LDC_STATUS_UNSUPPORTED_FORMAT when format is NULL,
+ *                      LDC_STATUS_INVALID_ARGUMENT when size is zero or not multiple of chroma
+ *                      subsampling.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status YuvFormat_ValidateSize(const YuvFormat* const format, uint32_t width, uint32_t height);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     YuvFormat_GetFrameSize
+ *
+ * \brief  Get size of YUV frame in bytes.
+ *
+ * \param  [In]  width        Width of image.
+ * \param  [In]  height       Height of image.
+ * \param  [In]  yuv_type     Type of YUV image.
+ *
+ * \return size_t       Size of frame, or 0 when format is not supported.
+ *
+ ***************************************************************************************************
+ */
+size_t YuvFormat_GetFrameSize(uint32_t width, uint32_t height, YUV_Type yuv_type);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     YuvFormat_GetChromaWidth
+ *
+ * \brief  Get number of columns of U and V components.
+ *
+ * \param  [In]  width        Width of image.
+ * \param  [In]  yuv_type     Type of YUV image.
+ *
+ * \return uint32_t     Columns of chroma components.
+ *
+ ***************************************************************************************************
+ */
+uint32_t YuvFormat_GetChromaWidth(uint32_t width, YUV_Type yuv_type);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     YuvFormat_GetChromaHeight
+ *
+ * \brief  Get number of rows of U and V components.
+ *
+ * \param  [In]  height       Height of image.
+ * \param  [In]  yuv_type     Type of YUV image.
+ *
+ * \return uint32_t     Rows of chroma components.
+ *
+ ***************************************************************************************************
+ */
+uint32_t YuvFormat_GetChromaHeight(uint32_t height, YUV_Type yuv_type);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     YuvFormat_Split
+ *
+ * \brief  Split YUV frame to separate Y, U and V components.
+ *
+ * \param  [In]  format       Layout of frame.
+ * \param  [In]  YUV          YUV frame, of YuvFormat_GetFrameSize bytes.
+ * \param  [Out] Y            Y component, of width * height samples.
+ * \param  [Out] U            U component, of chroma width * chroma height samples.
+ * \param  [Out] V            V component, of chroma width * chroma height samples.
+ * \param  [In]  width        Width of image.
+ * \param  [In]  height       Height of image.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void YuvFormat_Split(const YuvFormat* const format, const uint8_t* const YUV, uint8_t* const Y,
+                     uint8_t* const U, uint8_t* const V, uint32_t width, uint32_t height);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     YuvFormat_Combine
+ *
+ * \brief  Combine separate Y, U and V components to YUV frame.
+ *
+ * \param  [In]  format       Layout of frame.
+ * \param  [Out] YUV          YUV frame, of YuvFormat_GetFrameSize bytes.
+ * \param  [In]  Y            Y component, of width * height samples.
+ * \param  [In]  U            U component, of chroma width * chroma height samples.
+ * \param  [In]  V            V component, of chroma width * chroma height samples.
+ * \param  [In]  width        Width of image.
+ * \param  [In]  height       Height of image.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void YuvFormat_Combine(const YuvFormat* const format, uint8_t* const YUV, const uint8_t* const Y,
+                       const uint8_t* const U, const uint8_t* const V, uint32_t width,
+                       uint32_t height);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     YuvFormat_CombineRows
+ *
+ * \brief  Combine rows [y_begin, y_end) of separate Y, U and V components into their place in
+ *         YUV frame, so frame can be written band by band. Band has to start and end at chroma
+ *         row.
+ *
+ * \param  [In]  format       Layout of frame.
+ * \param  [Out] YUV          YUV frame, of YuvFormat_GetFrameSize bytes.
+ * \param  [In]  Y            Y component of band, of width * (y_end - y_begin) samples.
+ * \param  [In]  U            U component of band, of chroma rows of band.
+ * \param  [In]  V            V component of band, of chroma rows of band.
+ * \param  [In]  width        Width of image.
+ * \param  [In]  height       Height of image.
+ * \param  [In]  y_begin      First row of band.
+ * \param  [In]  y_end        One past last row of band.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void YuvFormat_CombineRows(const YuvFormat* const format, uint8_t* const YUV,
+                           const uint8_t* const Y, const uint8_t* const U, const uint8_t* const V,
+                           uint32_t width, uint32_t height, uint32_t y_begin, uint32_t y_end);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
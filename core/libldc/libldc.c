@@ -0,0 +1,481 @@
+/**
+ ***************************************************************************************************
+ *
+ * \file  libldc.c
+ *
+ * \brief This file contains reentrant API of lens distortion correction library. Correction is
+ *        configured once into opaque context, which holds lens, map and remap plan.
+ *
+ * \arg author:  Dejan Milojica
+ * \arg version: 1.2
+ * \arg date:    13.01.2021
+ *
+ ***************************************************************************************************
+ */
+
+/* ============================================================================================== */
+/*                                       Include Files                                            */
+/* ============================================================================================== */
+
+#include "libldc.h"
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "../lib/yuv_format.h"
+#include "../remap/remap.h"
+
+/* ============================================================================================== */
+/*                                     Macros & Typedefs                                          */
+/* ============================================================================================== */
+
+/* Scratch components of one call, kept in free list of context. */
+typedef struct Ldc_Scratch
+{
+    uint8_t* memory;                            /* Source and output components.          */
+    struct Ldc_Scratch* next;                   /* Next free scratch.                     */
+}Ldc_Scratch;
+
+struct Ldc_Context
+{
+    const LensProfile* lens;                    /* Lens, one reference.                   */
+    const YuvFormat* format;                    /* Layout of frames.                      */
+    LDC_Map map;                                /* Map of configuration.                  */
+    Remap_Plan plan;                            /* Remap plan of map.                     */
+    uint32_t baked_map;                         /* Map is baked, and not released.        */
+    uint32_t baked_plan;                        /* Plan is baked, and not released.       */
+    LDC_Color border;                           /* Border colour.                         */
+    uint32_t use_border;                        /* Fill pixels without source pixel.      */
+    size_t in_size;                             /* Size of source frame.                  */
+    size_t out_size;                            /* Size of output frame.                  */
+    size_t in_luma;                             /* Bytes of source Y component.           */
+    size_t in_chroma;                           /* Bytes of source U or V component.      */
+    size_t out_luma;                            /* Bytes of output Y component.           */
+    size_t out_chroma;                          /* Bytes of output U or V component.      */
+    pthread_mutex_t lock;                       /* Protects free scratch list.            */
+    Ldc_Scratch* scratch;                       /* Free scratch components.               */
+};
+
+/* ============================================================================================== */
+/*                              Internal Helper Functions                                         */
+/* ============================================================================================== */
+
+static void Ldc_GetComponentSizes(const YuvFormat* const format, uint32_t width,
+                                  uint32_t height, size_t* luma, size_t* chroma)
+{
+    *luma = (size_t)width * height * format->bytes_per_sample;
+    *chroma = (size_t)YuvFormat_GetChromaWidth(width, format->yuv_type) *
+              YuvFormat_GetChromaHeight(height, format->yuv_type) * format->bytes_per_sample;
+}
+
+/* Baked tables of configuration, or tables linked with build option. */
+static const BakedTables* Ldc_GetBakedTables(const Ldc_Config* const config)
+{
+    if(NULL != config->baked)
+    {
+        return config->baked;
+    }
+
+#ifdef LDC_BAKED_TABLES
+    if(NULL == config->lens && NULL == config->lens_buffer && NULL == config->lens_filename)
+    {
+        return &BakedTables_Linked;
+    }
+#endif
+
+    return NULL;
+}
+
+static LDC_Status Ldc_LoadLens(const Ldc_Config* const config, const LensProfile** lens)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    const BakedTables* baked = Ldc_GetBakedTables(config);
+
+    if(NULL != baked)
+    {
+        *lens = LensProfile_Retain(baked->lens);
+    }
+    else if(NULL != config->lens)
+    {
+        *lens = LensProfile_Retain(config->lens);
+    }
+    else if(NULL != config->lens_buffer)
+    {
+        status = LensProfile_LoadBuffer(0U, config->lens_buffer, config->lens_buffer_size, lens);
+    }
+    else if(NULL != config->lens_filename)
+    {
+        status = LensProfile_LoadFile(0U, config->lens_filename, lens);
+    }
+    else
+    {
+        status = LDC_STATUS_INVALID_ARGUMENT;
+        LdcLog_Write(LDC_LOG_ERROR, status, "Lens of context is not given");
+    }
+
+    return status;
+}
+
+/* Take free scratch, or allocate new one when all are used by other calls. */
+static Ldc_Scratch* Ldc_AcquireScratch(Ldc_Context* context)
+{
+    Ldc_Scratch* scratch;
+
+    pthread_mutex_lock(&context->lock);
+    scratch = context->scratch;
+    if(NULL != scratch)
+    {
+        context->scratch = scratch->next;
+    }
+    pthread_mutex_unlock(&context->lock);
+
+    if(NULL == scratch)
+    {
+        scratch = (Ldc_Scratch*)malloc(sizeof(Ldc_Scratch));
+        if(NULL != scratch)
+        {
+            scratch->memory = (uint8_t*)malloc(context->in_luma + 2U * context->in_chroma +
+                                               context->out_luma + 2U * context->out_chroma);
+            if(NULL == scratch->memory)
+            {
+                free(scratch);
+                scratch = NULL;
+            }
+        }
+    }
+
+    return scratch;
+}
+
+static void Ldc_ReleaseScratch(Ldc_Context* context, Ldc_Scratch* scratch)
+{
+    pthread_mutex_lock(&context->lock);
+    scratch->next = context->scratch;
+    context->scratch = scratch;
+    pthread_mutex_unlock(&context->lock);
+}
+
+/* ============================================================================================== */
+
+/*                                     API Functions                                              */
+
+/* ============================================================================================== */
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     Ldc_Create
+ *
+ * \brief  Load lens, and generate map and remap plan of configuration, or take them from
+ *         baked tables.
+ *
+ * \param  [In]  config       Configuration of correction.
+ * \param  [Out] context      Created context. Has to be released with Ldc_Destroy.
+ *
+ * \return LDC_Status   Exit status, LDC_STATUS_INVALID_ARGUMENT for sizes that are not
+ *                      multiples of chroma subsampling, LDC_STATUS_INVALID_LENS for invalid
+ *                      lens specification.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status Ldc_Create(const Ldc_Config* const config, Ldc_Context** context)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    Ldc_Context* new_context = NULL;
+    uint32_t map_generated = 0;
+    uint32_t plan_created = 0;
+
+    if(NULL == config || NULL == context || 0U == config->width || 0U == config->height)
+    {
+        status = LDC_STATUS_INVALID_ARGUMENT;
+        LdcLog_Write(LDC_LOG_ERROR, status, "Invalid configuration of context");
+    }
+    else if(NULL == YuvFormat_Get(config->yuv_type))
+    {
+        status = LDC_STATUS_UNSUPPORTED_FORMAT;
+        LdcLog_Write(LDC_LOG_ERROR, status, "Unsupported yuv image type : %d",
+                     (int32_t)config->yuv_type);
+    }
+    /* Components of source and output frames are sized by chroma subsampling of format. */
+    else if(YuvFormat_ValidateSize(YuvFormat_Get(config->yuv_type), config->width,
+                                   config->height) ||
+            (0U != config->output.width && 0U != config->output.height &&
+             YuvFormat_ValidateSize(YuvFormat_Get(config->yuv_type), config->output.width,
+                                    config->output.height)))
+    {
+        status = LDC_STATUS_INVALID_ARGUMENT;
+        LdcLog_Write(LDC_LOG_ERROR, status, "Size of frames is not multiple of subsampling");
+    }
+    else if(NULL == (new_context = (Ldc_Context*)calloc(1, sizeof(Ldc_Context))))
+    {
+        status = LDC_STATUS_OUT_OF_MEMORY;
+    }
+    else
+    {
+        pthread_mutex_init(&new_context->lock, NULL);
+        new_context->format = YuvFormat_Get(config->yuv_type);
+        new_context->border = config->border;
+        new_context->use_border = config->use_border;
+
+        status = Ldc_LoadLens(config, &new_context->lens);
+    }
+
+    if(LDC_STATUS_OK == status)
+    {
+        const LDC_OutputSpec* output = (0U == config->output.width ||
+                                        0U == config->output.height) ? NULL : &config->output;
+        const BakedTables* baked = Ldc_GetBakedTables(config);
+
+        /* Baked map is generated without output specification. */
+        if(NULL != baked && NULL != baked->map && NULL == output &&
+           baked->map->src_width == config->width && baked->map->src_height == config->height &&
+           baked->map->width == config->width && baked->map->height == config->height)
+        {
+            new_context->map = *baked->map;
+            new_context->baked_map = 1U;
+
+            if(NULL != baked->plan && baked->plan->yuv_type == config->yuv_type &&
+               baked->plan->interpolation == config->interpolation)
+            {
+                new_context->plan = *baked->plan;
+                new_context->plan.map = &new_context->map;
+                new_context->baked_plan = 1U;
+            }
+        }
+        else
+        {
+            status = FrameCorrection_GenerateMap(&new_context->map, config->width,
+                                                 config->height, output, NULL, 0,
+                                                 new_context->lens, NULL);
+            map_generated = (LDC_STATUS_OK == status);
+        }
+    }
+
+    if(LDC_STATUS_OK == status && !new_context->baked_plan)
+    {
+        status = Remap_CreatePlan(&new_context->plan, &new_context->map, config->yuv_type,
+                                  config->interpolation);
+        plan_created = (LDC_STATUS_OK == status);
+    }
+
+    if(LDC_STATUS_OK == status)
+    {
+        const LDC_Map* map = &new_context->map;
+
+        new_context->in_size = YuvFormat_GetFrameSize(map->src_width, map->src_height,
+                                                      config->yuv_type);
+        new_context->out_size = YuvFormat_GetFrameSize(map->width, map->height,
+                                                       config->yuv_type);
+        Ldc_GetComponentSizes(new_context->format, map->src_width, map->src_height,
+                              &new_context->in_luma, &new_context->in_chroma);
+        Ldc_GetComponentSizes(new_context->format, map->width, map->height,
+                              &new_context->out_luma, &new_context->out_chroma);
+        *context = new_context;
+    }
+    else if(NULL != new_context)
+    {
+        if(plan_created)
+        {
+            Remap_FreePlan(&new_context->plan);
+        }
+
+        if(map_generated)
+        {
+            FrameCorrection_FreeMap(&new_context->map);
+        }
+
+        LensProfile_Release(new_context->lens);
+        pthread_mutex_destroy(&new_context->lock);
+        free(new_context);
+    }
+
+    return status;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     Ldc_Destroy
+ *
+ * \brief  Release context, with its lens reference, map, plan and scratch components.
+ *
+ * \param  [In]  context      Context, or NULL.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void Ldc_Destroy(Ldc_Context* context)
+{
+    if(NULL != context)
+    {
+        while(NULL != context->scratch)
+        {
+            Ldc_Scratch* next = context->scratch->next;
+
+            free(context->scratch->memory);
+            free(context->scratch);
+            context->scratch = next;
+        }
+
+        if(!context->baked_plan)
+        {
+            Remap_FreePlan(&context->plan);
+        }
+
+        if(!context->baked_map)
+        {
+            FrameCorrection_FreeMap(&context->map);
+        }
+
+        LensProfile_Release(context->lens);
+        pthread_mutex_destroy(&context->lock);
+        free(context);
+    }
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     Ldc_GetFrameSizes
+ *
+ * \brief  Get sizes of source and output frames of context, in bytes.
+ *
+ * \param  [In]  context      Context.
+ * \param  [Out] in_size      Size of source frame, or NULL.
+ * \param  [Out] out_size     Size of output frame, or NULL.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status Ldc_GetFrameSizes(const Ldc_Context* const context, size_t* in_size,
+                             size_t* out_size)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+
+    if(NULL == context)
+    {
+        status = LDC_STATUS_INVALID_ARGUMENT;
+    }
+    else
+    {
+        if(NULL != in_size)
+        {
+            *in_size = context->in_size;
+        }
+
+        if(NULL != out_size)
+        {
+            *out_size = context->out_size;
+        }
+    }
+
+    return status;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     Ldc_CorrectFrame
+ *
+ * \brief  Correct YUV frame of context format. Frame is split into scratch components, which
+ *         are reused by later calls, remapped, and combined into output frame.
+ *
+ * \param  [In]  context      Context.
+ * \param  [In]  in           Source frame.
+ * \param  [In]  in_size      Size of source frame, see Ldc_GetFrameSizes.
+ * \param  [Out] out          Output frame.
+ * \param  [In]  out_size     Size of output frame, see Ldc_GetFrameSizes.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status Ldc_CorrectFrame(Ldc_Context* context, const uint8_t* const in, size_t in_size,
+                            uint8_t* out, size_t out_size)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    Ldc_Scratch* scratch = NULL;
+
+    if(NULL == context || NULL == in || NULL == out || in_size != context->in_size ||
+       out_size != context->out_size)
+    {
+        status = LDC_STATUS_INVALID_ARGUMENT;
+        LdcLog_Write(LDC_LOG_ERROR, status, "Invalid frame of context");
+    }
+    else if(NULL == (scratch = Ldc_AcquireScratch(context)))
+    {
+        status = LDC_STATUS_OUT_OF_MEMORY;
+    }
+    else
+    {
+        const LDC_Map* map = &context->map;
+        uint8_t* Y = scratch->memory;
+        uint8_t* U = Y + context->in_luma;
+        uint8_t* V = U + context->in_chroma;
+        uint8_t* Y_out = V + context->in_chroma;
+        uint8_t* U_out = Y_out + context->out_luma;
+        uint8_t* V_out = U_out + context->out_chroma;
+
+        YuvFormat_Split(context->format, in, Y, U, V, map->src_width, map->src_height);
+
+        /* Pixels without source pixel are not written, so they are cleared. */
+        if(!context->use_border)
+        {
+            memset(Y_out, 0, context->out_luma + 2U * context->out_chroma);
+        }
+
+        status = Ldc_CorrectComponents(context, Y_out, U_out, V_out, Y, U, V);
+        if(LDC_STATUS_OK == status)
+        {
+            YuvFormat_Combine(context->format, out, Y_out, U_out, V_out, map->width,
+                              map->height);
+        }
+
+        Ldc_ReleaseScratch(context, scratch);
+    }
+
+    return status;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     Ldc_CorrectComponents
+ *
+ * \brief  Correct frame given as separate Y, U and V components (see YuvFormat_Split), without
+ *         scratch memory.
+ *
+ * \param  [In]  context      Context.
+ * \param  [Out] Y_out        Y component of output frame.
+ * \param  [Out] U_out        U component of output frame.
+ * \param  [Out] V_out        V component of output frame.
+ * \param  [In]  Y            Y component of source frame.
+ * \param  [In]  U            U component of source frame.
+ * \param  [In]  V            V component of source frame.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status Ldc_CorrectComponents(const Ldc_Context* const context, uint8_t* const Y_out,
+                                 uint8_t* const U_out, uint8_t* const V_out,
+                                 const uint8_t* const Y, const uint8_t* const U,
+                                 const uint8_t* const V)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+
+    if(NULL == context || NULL == Y_out || NULL == U_out || NULL == V_out || NULL == Y ||
+       NULL == U || NULL == V)
+    {
+        status = LDC_STATUS_INVALID_ARGUMENT;
+    }
+    else
+    {
+        status = Remap_ApplyPlan(&context->plan, Y_out, U_out, V_out, Y, U, V, NULL, 0,
+                                 context->use_border ? &context->border : NULL);
+    }
+
+    return status;
+}
@@ -0,0 +1,187 @@
+/**
+ ***************************************************************************************************
+ *
+ * \file  libldc.h
+ *
+ * \brief This file contains reentrant API of lens distortion correction library. Correction is
+ *        configured once into opaque context, which holds lens, map and remap plan.
+ *
+ *        Thread safety:
+ *        - Context is not changed after Ldc_Create, so Ldc_CorrectFrame, Ldc_CorrectComponents
+ *          and Ldc_GetFrameSizes can be called from many threads at same time, with same or
+ *          with different contexts. Scratch components of frames are kept per call.
+ *        - Ldc_Destroy must not run at same time as other calls with same context.
+ *        - Library does not print. Errors are returned as LDC_Status, and reported to logging
+ *          callback of LdcLog_SetCallback, from thread of failed call.
+ *
+ * \arg author:  Dejan Milojica
+ * \arg version: 1.2
+ * \arg date:    13.01.2021
+ *
+ ***************************************************************************************************
+ */
+
+#ifndef LIBLDC_H
+#define LIBLDC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================================== */
+/*                                       Include Files                                            */
+/* ============================================================================================== */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "../lib/ldc_types.h"
+#include "../lib/ldc_log.h"
+#include "../correction_distortion/correction_distortion.h"
+#include "../lens_registry/lens_registry.h"
+#include "../baked_tables/baked_tables.h"
+
+/* ============================================================================================== */
+/*                                     Macros & Typedefs                                          */
+/* ============================================================================================== */
+
+/* Opaque correction context. */
+typedef struct Ldc_Context Ldc_Context;
+
+/**
+ ***************************************************************************************************
+ *
+ * \typedef Ldc_Config
+ *
+ * \brief   Structure which represents configuration of correction context. Lens is given as
+ *          baked tables, loaded profile (shared by contexts, retained by context), as CSV text
+ *          in memory, or as CSV filename, checked in that order. Library built with option
+ *          LDC_BAKED_TABLES uses linked BakedTables_Linked, when lens is not given. Baked map
+ *          and plan are used without generation, when they match resolution, format and
+ *          interpolation of configuration, with output same as source.
+ *
+ ***************************************************************************************************
+ */
+typedef struct
+{
+    const BakedTables* baked;                   /* Baked tables, or NULL.                 */
+    const LensProfile* lens;                    /* Loaded lens profile, or NULL.          */
+    const char* lens_buffer;                    /* Lens specification CSV text, or NULL.  */
+    size_t lens_buffer_size;                    /* Size of CSV text.                      */
+    const char* lens_filename;                  /* Lens specification CSV file, or NULL.  */
+    uint32_t width;                             /* Width of source frames.                */
+    uint32_t height;                            /* Height of source frames.               */
+    YUV_Type yuv_type;                          /* Type of YUV frames.                    */
+    LDC_OutputSpec output;                      /* Output frames, zero size for source.   */
+    LDC_Interpolation interpolation;            /* Sampling of source frame.              */
+    LDC_Color border;                           /* Border colour.                         */
+    uint32_t use_border;                        /* Fill pixels without source pixel.      */
+}Ldc_Config;
+
+/* ============================================================================================== */
+/*                                     Function Declarations                                      */
+/* ============================================================================================== */
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     Ldc_Create
+ *
+ * \brief  Load lens, and generate map and remap plan of configuration, or take them from
+ *         baked tables.
+ *
+ * \param  [In]  config       Configuration of correction.
+ * \param  [Out] context      Created context. Has to be released with Ldc_Destroy.
+ *
+ * \return LDC_Status   Exit status, LDC_STATUS_INVALID_ARGUMENT for sizes that are not
+ *                      multiples of chroma subsampling, LDC_STATUS_INVALID_LENS for invalid
+ *                      lens specification.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status Ldc_Create(const Ldc_Config* const config, Ldc_Context** context);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     Ldc_Destroy
+ *
+ * \brief  Release context, with its lens reference, map, plan and scratch components.
+ *
+ * \param  [In]  context      Context, or NULL.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void Ldc_Destroy(Ldc_Context* context);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     Ldc_GetFrameSizes
+ *
+ * \brief  Get sizes of source and output frames of context, in bytes.
+ *
+ * \param  [In]  context      Context.
+ * \param  [Out] in_size      Size of source frame, or NULL.
+ * \param  [Out] out_size     Size of output frame, or NULL.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status Ldc_GetFrameSizes(const Ldc_Context* const context, size_t* in_size,
+                             size_t* out_size);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     Ldc_CorrectFrame
+ *
+ * \brief  Correct YUV frame of context format. Frame is split into scratch components, which
+ *         are reused by later calls, remapped, and combined into output frame.
+ *
+ * \param  [In]  context      Context.
+ * \param  [In]  in           Source frame.
+ * \param  [In]  in_size      Size of source frame, see Ldc_GetFrameSizes.
+ * \param  [Out] out          Output frame.
+ * \param  [In]  out_size     Size of output frame, see Ldc_GetFrameSizes.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status Ldc_CorrectFrame(Ldc_Context* context, const uint8_t* const in, size_t in_size,
+                            uint8_t* out, size_t out_size);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     Ldc_CorrectComponents
+ *
+ * \brief  Correct frame given as separate Y, U and V components (see YuvFormat_Split), without
+ *         scratch memory.
+ *
+ * \param  [In]  context      Context.
+ * \param  [Out] Y_out        Y component of output frame.
+ * \param  [Out] U_out        U component of output frame.
+ * \param  [Out] V_out        V component of output frame.
+ * \param  [In]  Y            Y component of source frame.
+ * \param  [In]  U            U component of source frame.
+ * \param  [In]  V            V component of source frame.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status Ldc_CorrectComponents(const Ldc_Context* const context, uint8_t* const Y_out,
+                                 uint8_t* const U_out, uint8_t* const V_out,
+                                 const uint8_t* const Y, const uint8_t* const U,
+                                 const uint8_t* const V);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,458 @@
+/**
+ ***************************************************************************************************
+ *
+ * \file  map_compose.c
+ *
+ * \brief This file contains API for composition of map with transforms of its output frame,
+ *        and with other maps, into one map.
+ *
+ * \arg author:  Dejan Milojica
+ * \arg version: 1.2
+ * \arg date:    13.01.2021
+ *
+ ***************************************************************************************************
+ */
+
+/* ============================================================================================== */
+/*                                       Include Files                                            */
+/* ============================================================================================== */
+
+#include "map_compose.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "../lib/ldc_log.h"
+
+/* ============================================================================================== */
+/*                              Internal Helper Functions                                         */
+/* ============================================================================================== */
+
+static int32_t MapCompose_IsValid(const uint8_t* const mask, uint32_t stride, uint32_t x,
+                                  uint32_t y)
+{
+    return (mask[y * stride + x / 8U] >> (x % 8U)) & 1U;
+}
+
+/* Position of map at (x, y), interpolated from valid pixels, with non zero weights. */
+static int32_t MapCompose_Sample(const LDC_Map* const map, const uint8_t* const mask,
+                                 double x, double y, float* h_d, float* v_d)
+{
+    uint32_t stride = VALIDITY_MASK_STRIDE(map->width);
+    uint32_t x0;
+    uint32_t y0;
+    uint32_t x1;
+    uint32_t y1;
+    double fx;
+    double fy;
+    size_t k00;
+    size_t k01;
+    size_t k10;
+    size_t k11;
+
+    /* Same range as valid positions of map, which are rounded or clamped into frame.
+       Comparisons are false for NaN. */
+    if(!(x > -1.5 && y > -1.5 && x < (double)map->width - 0.5 &&
+         y < (double)map->height - 0.5))
+    {
+        return 0;
+    }
+
+    x = (x < 0.0) ? 0.0 : (x > (double)(map->width - 1U)) ? (double)(map->width - 1U) : x;
+    y = (y < 0.0) ? 0.0 : (y > (double)(map->height - 1U)) ? (double)(map->height - 1U) : y;
+
+    x0 = (uint32_t)x;
+    y0 = (uint32_t)y;
+    fx = x - (double)x0;
+    fy = y - (double)y0;
+    x1 = (fx > 0.0) ? x0 + 1U : x0;
+    y1 = (fy > 0.0) ? y0 + 1U : y0;
+
+    if(!MapCompose_IsValid(mask, stride, x0, y0) || !MapCompose_IsValid(mask, stride, x1, y0) ||
+       !MapCompose_IsValid(mask, stride, x0, y1) || !MapCompose_IsValid(mask, stride, x1, y1))
+    {
+        return 0;
+    }
+
+    k00 = (size_t)y0 * map->width + x0;
+    k01 = (size_t)y0 * map->width + x1;
+    k10 = (size_t)y1 * map->width + x0;
+    k11 = (size_t)y1 * map->width + x1;
+
+    /* Position at whole pixel is copied exactly. */
+    *h_d = (float)((1.0 - fy) * ((1.0 - fx) * map->h_d[k00] + fx * map->h_d[k01]) +
+                   fy * ((1.0 - fx) * map->h_d[k10] + fx * map->h_d[k11]));
+    *v_d = (float)((1.0 - fy) * ((1.0 - fx) * map->v_d[k00] + fx * map->v_d[k01]) +
+                   fy * ((1.0 - fx) * map->v_d[k10] + fx * map->v_d[k11]));
+
+    return 1;
+}
+
+/* Allocate composed map over source frame of map, and validity mask of map. */
+static LDC_Status MapCompose_Begin(LDC_Map* composed, const LDC_Map* const map, uint32_t width,
+                                   uint32_t height, uint8_t** mask)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    LDC_OutputSpec output;
+
+    memset(&output, 0, sizeof(LDC_OutputSpec));
+    output.width = width;
+    output.height = height;
+
+    *mask = (uint8_t*)malloc((size_t)map->height * VALIDITY_MASK_STRIDE(map->width));
+
+    if(NULL == *mask)
+    {
+        memset(composed, 0, sizeof(LDC_Map));
+        status = LDC_STATUS_OUT_OF_MEMORY;
+    }
+    else if(FrameCorrection_AllocateMap(composed, map->src_width, map->src_height, &output,
+                                        NULL, 0))
+    {
+        status = LDC_STATUS_OUT_OF_MEMORY;
+    }
+    else
+    {
+        FrameCorrection_GetValidityMask(map, *mask);
+        composed->scale = map->scale;
+        composed->centre_x = map->centre_x;
+        composed->centre_y = map->centre_y;
+    }
+
+    if(LDC_STATUS_OK != status)
+    {
+        LdcLog_Write(LDC_LOG_ERROR, status, "Memory allocation of composed map failed");
+        free(*mask);
+        *mask = NULL;
+    }
+
+    return status;
+}
+
+static LDC_Status MapCompose_End(LDC_Map* composed, uint8_t* mask)
+{
+    LDC_Status status = FrameCorrection_UpdateSpans(composed);
+
+    free(mask);
+
+    if(LDC_STATUS_OK != status)
+    {
+        LdcLog_Write(LDC_LOG_ERROR, LDC_STATUS_OUT_OF_MEMORY,
+                     "Memory allocation of composed map failed");
+        FrameCorrection_FreeMap(composed);
+        status = LDC_STATUS_OUT_OF_MEMORY;
+    }
+
+    return status;
+}
+
+/* ============================================================================================== */
+/*                                                                                                */
+/*                                       API Functions                                            */
+/*                                                                                                */
+/* ============================================================================================== */
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     MapCompose_GetRotation
+ *
+ * \brief  Get transform of clockwise rotation of frame by quarter turns.
+ *
+ * \param  [In]  quarter_turns  Number of clockwise quarter turns, 0 to 3.
+ * \param  [In]  width        Width of rotated frame.
+ * \param  [In]  height       Height of rotated frame.
+ * \param  [Out] transform    Transform, of MAP_COMPOSE_TRANSFORM_SIZE elements.
+ * \param  [Out] out_width    Width of frame after rotation.
+ * \param  [Out] out_height   Height of frame after rotation.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status MapCompose_GetRotation(uint32_t quarter_turns, uint32_t width, uint32_t height,
+                                  double* const transform, uint32_t* out_width,
+                                  uint32_t* out_height)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    double w = (double)width - 1.0;
+    double h = (double)height - 1.0;
+
+    if(quarter_turns > 3U || NULL == transform || NULL == out_width || NULL == out_height)
+    {
+        status = LDC_STATUS_INVALID_ARGUMENT;
+        LdcLog_Write(LDC_LOG_ERROR, status, "Invalid rotation of map");
+        return status;
+    }
+
+    memset(transform, 0, MAP_COMPOSE_TRANSFORM_SIZE * sizeof(double));
+    transform[8] = 1.0;
+
+    /* Rotated pixel (u, v) shows pixel (x, y) of frame. */
+    switch(quarter_turns)
+    {
+        case 1U:    /* x = v, y = h - u */
+            transform[1] = 1.0;
+            transform[3] = -1.0;
+            transform[5] = h;
+            break;
+        case 2U:    /* x = w - u, y = h - v */
+            transform[0] = -1.0;
+            transform[2] = w;
+            transform[4] = -1.0;
+            transform[5] = h;
+            break;
+        case 3U:    /* x = w - v, y = u */
+            transform[1] = -1.0;
+            transform[2] = w;
+            transform[3] = 1.0;
+            break;
+        default:
+            transform[0] = 1.0;
+            transform[4] = 1.0;
+            break;
+    }
+
+    *out_width = (quarter_turns % 2U) ? height : width;
+    *out_height = (quarter_turns % 2U) ? width : height;
+
+    return status;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     MapCompose_GetFlip
+ *
+ * \brief  Get transform of horizontal (mirror) and/or vertical flip of frame.
+ *
+ * \param  [In]  horizontal   Flip columns.
+ * \param  [In]  vertical     Flip rows.
+ * \param  [In]  width        Width of frame.
+ * \param  [In]  height       Height of frame.
+ * \param  [Out] transform    Transform, of MAP_COMPOSE_TRANSFORM_SIZE elements.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void MapCompose_GetFlip(uint32_t horizontal, uint32_t vertical, uint32_t width, uint32_t height,
+                        double* const transform)
+{
+    memset(transform, 0, MAP_COMPOSE_TRANSFORM_SIZE * sizeof(double));
+    transform[0] = horizontal ? -1.0 : 1.0;
+    transform[2] = horizontal ? (double)width - 1.0 : 0.0;
+    transform[4] = vertical ? -1.0 : 1.0;
+    transform[5] = vertical ? (double)height - 1.0 : 0.0;
+    transform[8] = 1.0;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     MapCompose_MultiplyTransforms
+ *
+ * \brief  Get transform of two transforms applied one after other, first and then second.
+ *         Second transform is defined on output frame of first transform.
+ *
+ * \param  [In]  first        Transform applied first.
+ * \param  [In]  second       Transform applied second.
+ * \param  [Out] transform    Transform of both, can be same as first or second.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void MapCompose_MultiplyTransforms(const double* const first, const double* const second,
+                                   double* const transform)
+{
+    double product[MAP_COMPOSE_TRANSFORM_SIZE];
+    uint32_t i;
+    uint32_t j;
+
+    /* Output pixel is mapped by second, and then by first. */
+    for(i = 0;i < 3U;i++)
+    {
+        for(j = 0;j < 3U;j++)
+        {
+            product[3U * i + j] = first[3U * i] * second[j] +
+                                  first[3U * i + 1U] * second[3U + j] +
+                                  first[3U * i + 2U] * second[6U + j];
+        }
+    }
+
+    memcpy(transform, product, sizeof(product));
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     MapCompose_CreateIdentity
+ *
+ * \brief  Create map that copies frame, with every position at its own pixel. Identity map
+ *         composed with transform, or other map, is standalone warp of frame.
+ *
+ * \param  [Out] map          Created map. Has to be released with FrameCorrection_FreeMap.
+ * \param  [In]  width        Width of frame.
+ * \param  [In]  height       Height of frame.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status MapCompose_CreateIdentity(LDC_Map* map, uint32_t width, uint32_t height)
+{
+    LDC_Status status = FrameCorrection_AllocateMap(map, width, height, NULL, NULL, 0);
+    uint32_t x;
+    uint32_t y;
+
+    if(LDC_STATUS_OK != status)
+    {
+        status = LDC_STATUS_INVALID_ARGUMENT;
+        LdcLog_Write(LDC_LOG_ERROR, status, "Invalid size of identity map");
+        return status;
+    }
+
+    for(y = 0;y < height;y++)
+    {
+        for(x = 0;x < width;x++)
+        {
+            map->h_d[(size_t)y * width + x] = (float)x;
+            map->v_d[(size_t)y * width + x] = (float)y;
+        }
+    }
+
+    if(FrameCorrection_UpdateSpans(map))
+    {
+        FrameCorrection_FreeMap(map);
+        status = LDC_STATUS_OUT_OF_MEMORY;
+        LdcLog_Write(LDC_LOG_ERROR, status, "Memory allocation of identity map failed");
+    }
+
+    return status;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     MapCompose_Transform
+ *
+ * \brief  Compose map with transform of its output frame. Pixel of composed map is valid,
+ *         when its position in output frame of map is inside of frame, and pixels of map used
+ *         for interpolation are valid.
+ *
+ * \param  [Out] composed     Composed map, with source frame of map. Has to be released with
+ *                            FrameCorrection_FreeMap.
+ * \param  [In]  map          Map, for example lens distortion map.
+ * \param  [In]  transform    Transform from composed output frame to output frame of map.
+ * \param  [In]  width        Width of composed output frame.
+ * \param  [In]  height       Height of composed output frame.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status MapCompose_Transform(LDC_Map* composed, const LDC_Map* const map,
+                                const double* const transform, uint32_t width, uint32_t height)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    uint8_t* mask = NULL;
+    uint32_t u;
+    uint32_t v;
+
+    if(NULL == composed || NULL == map || NULL == map->h_d || NULL == map->row_spans ||
+       NULL == transform || 0U == width || 0U == height)
+    {
+        status = LDC_STATUS_INVALID_ARGUMENT;
+        LdcLog_Write(LDC_LOG_ERROR, status, "Invalid arguments of map composition");
+        return status;
+    }
+
+    status = MapCompose_Begin(composed, map, width, height, &mask);
+
+    for(v = 0;LDC_STATUS_OK == status && v < height;v++)
+    {
+        for(u = 0;u < width;u++)
+        {
+            size_t k = (size_t)v * width + u;
+            double w = transform[6] * u + transform[7] * v + transform[8];
+            double x = (transform[0] * u + transform[1] * v + transform[2]) / w;
+            double y = (transform[3] * u + transform[4] * v + transform[5]) / w;
+
+            if(!MapCompose_Sample(map, mask, x, y, &composed->h_d[k], &composed->v_d[k]))
+            {
+                composed->h_d[k] = NAN;
+                composed->v_d[k] = NAN;
+            }
+        }
+    }
+
+    return (LDC_STATUS_OK == status) ? MapCompose_End(composed, mask) : status;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     MapCompose_Maps
+ *
+ * \brief  Compose two maps, where source frame of second map is output frame of first map, for
+ *         example lens distortion map and rectification map of stereo pair.
+ *
+ * \param  [Out] composed     Composed map, with source frame of first map and output frame of
+ *                            second map. Has to be released with FrameCorrection_FreeMap.
+ * \param  [In]  first        Map applied first.
+ * \param  [In]  second       Map applied to output of first map.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status MapCompose_Maps(LDC_Map* composed, const LDC_Map* const first,
+                           const LDC_Map* const second)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    uint8_t* mask = NULL;
+    uint32_t y;
+    uint32_t i;
+    uint32_t x;
+
+    if(NULL == composed || NULL == first || NULL == first->h_d || NULL == first->row_spans ||
+       NULL == second || NULL == second->h_d || NULL == second->row_spans ||
+       second->src_width != first->width || second->src_height != first->height)
+    {
+        status = LDC_STATUS_INVALID_ARGUMENT;
+        LdcLog_Write(LDC_LOG_ERROR, status, "Invalid arguments of map composition");
+        return status;
+    }
+
+    status = MapCompose_Begin(composed, first, second->width, second->height, &mask);
+
+    for(y = 0;LDC_STATUS_OK == status && y < second->height;y++)
+    {
+        float* h_d = &composed->h_d[(size_t)y * second->width];
+        float* v_d = &composed->v_d[(size_t)y * second->width];
+
+        for(x = 0;x < second->width;x++)
+        {
+            h_d[x] = NAN;
+            v_d[x] = NAN;
+        }
+
+        /* Only valid positions of second map are sampled on first map. */
+        for(i = second->row_spans[y];i < second->row_spans[y + 1];i++)
+        {
+            for(x = second->spans[i].start;x < second->spans[i].end;x++)
+            {
+                size_t k = (size_t)y * second->width + x;
+
+                if(!MapCompose_Sample(first, mask, second->h_d[k], second->v_d[k], &h_d[x],
+                                      &v_d[x]))
+                {
+                    h_d[x] = NAN;
+                    v_d[x] = NAN;
+                }
+            }
+        }
+    }
+
+    return (LDC_STATUS_OK == status) ? MapCompose_End(composed, mask) : status;
+}
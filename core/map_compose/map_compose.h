@@ -0,0 +1,175 @@
+/**
+ ***************************************************************************************************
+ *
+ * \file  map_compose.h
+ *
+ * \brief This file contains API for composition of map with transforms of its output frame
+ *        (rotations by 90 degrees, flips, affine transforms and homographies), and with other
+ *        maps, into one map, so whole chain of warps costs one remap.
+ *
+ *        Transform is 3x3 matrix, stored by rows, which maps pixel (u, v, 1) of composed
+ *        output frame to position (x, y, w) in output frame of map, divided by w. Position of
+ *        composed map is position of map at (x, y), bilinearly interpolated from valid
+ *        positions of map. Position at whole pixel is copied exactly, so rotations and flips
+ *        give same frame as remap with map, followed by rotation or flip.
+ *
+ * \arg author:  Dejan Milojica
+ * \arg version: 1.2
+ * \arg date:    13.01.2021
+ *
+ ***************************************************************************************************
+ */
+
+#ifndef MAP_COMPOSE_H
+#define MAP_COMPOSE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================================== */
+/*                                       Include Files                                            */
+/* ============================================================================================== */
+
+#include <stdint.h>
+
+#include "../lib/ldc_types.h"
+#include "../correction_distortion/correction_distortion.h"
+
+/* ============================================================================================== */
+/*                                     Macros & Typedefs                                          */
+/* ============================================================================================== */
+
+#define MAP_COMPOSE_TRANSFORM_SIZE (9U)         /* Elements of 3x3 transform.                  */
+
+/* ============================================================================================== */
+/*                                     Function Declarations                                      */
+/* ============================================================================================== */
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     MapCompose_GetRotation
+ *
+ * \brief  Get transform of clockwise rotation of frame by quarter turns.
+ *
+ * \param  [In]  quarter_turns  Number of clockwise quarter turns, 0 to 3.
+ * \param  [In]  width        Width of rotated frame.
+ * \param  [In]  height       Height of rotated frame.
+ * \param  [Out] transform    Transform, of MAP_COMPOSE_TRANSFORM_SIZE elements.
+ * \param  [Out] out_width    Width of frame after rotation.
+ * \param  [Out] out_height   Height of frame after rotation.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status MapCompose_GetRotation(uint32_t quarter_turns, uint32_t width, uint32_t height,
+                                  double* const transform, uint32_t* out_width,
+                                  uint32_t* out_height);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     MapCompose_GetFlip
+ *
+ * \brief  Get transform of horizontal (mirror) and/or vertical flip of frame.
+ *
+ * \param  [In]  horizontal   Flip columns.
+ * \param  [In]  vertical     Flip rows.
+ * \param  [In]  width        Width of frame.
+ * \param  [In]  height       Height of frame.
+ * \param  [Out] transform    Transform, of MAP_COMPOSE_TRANSFORM_SIZE elements.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void MapCompose_GetFlip(uint32_t horizontal, uint32_t vertical, uint32_t width, uint32_t height,
+                        double* const transform);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     MapCompose_MultiplyTransforms
+ *
+ * \brief  Get transform of two transforms applied one after other, first and then second.
+ *         Second transform is defined on output frame of first transform.
+ *
+ * \param  [In]  first        Transform applied first.
+ * \param  [In]  second       Transform applied second.
+ * \param  [Out] transform    Transform of both, can be same as first or second.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void MapCompose_MultiplyTransforms(const double* const first, const double* const second,
+                                   double* const transform);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     MapCompose_CreateIdentity
+ *
+ * \brief  Create map that copies frame, with every position at its own pixel. Identity map
+ *         composed with transform, or other map, is standalone warp of frame.
+ *
+ * \param  [Out] map          Created map. Has to be released with FrameCorrection_FreeMap.
+ * \param  [In]  width        Width of frame.
+ * \param  [In]  height       Height of frame.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status MapCompose_CreateIdentity(LDC_Map* map, uint32_t width, uint32_t height);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     MapCompose_Transform
+ *
+ * \brief  Compose map with transform of its output frame. Pixel of composed map is valid,
+ *         when its position in output frame of map is inside of frame, and pixels of map used
+ *         for interpolation are valid.
+ *
+ * \param  [Out] composed     Composed map, with source frame of map. Has to be released with
+ *                            FrameCorrection_FreeMap.
+ * \param  [In]  map          Map, for example lens distortion map.
+ * \param  [In]  transform    Transform from composed output frame to output frame of map.
+ * \param  [In]  width        Width of composed output frame.
+ * \param  [In]  height       Height of composed output frame.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status MapCompose_Transform(LDC_Map* composed, const LDC_Map* const map,
+                                const double* const transform, uint32_t width, uint32_t height);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     MapCompose_Maps
+ *
+ * \brief  Compose two maps, where source frame of second map is output frame of first map, for
+ *         example lens distortion map and rectification map of stereo pair.
+ *
+ * \param  [Out] composed     Composed map, with source frame of first map and output frame of
+ *                            second map. Has to be released with FrameCorrection_FreeMap.
+ * \param  [In]  first        Map applied first.
+ * \param  [In]  second       Map applied to output of first map.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status MapCompose_Maps(LDC_Map* composed, const LDC_Map* const first,
+                           const LDC_Map* const second);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
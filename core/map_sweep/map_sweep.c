@@ -0,0 +1,373 @@
+/**
+ ***************************************************************************************************
+ *
+ * \file  map_sweep.c
+ *
+ * \brief This file contains API for fast re-derivation of map, when focal length, pixel pitch
+ *        or scaling factor of lens change.
+ *
+ * \arg author:  Dejan Milojica
+ * \arg version: 1.2
+ * \arg date:    13.01.2021
+ *
+ ***************************************************************************************************
+ */
+
+/* ============================================================================================== */
+/*                                       Include Files                                            */
+/* ============================================================================================== */
+
+#include "map_sweep.h"
+#include "../lib/ldc_internal.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/* ============================================================================================== */
+/*                                       Global variables                                         */
+/* ============================================================================================== */
+
+/* Arguments of geometry computation and map derivation, shared by all bands of rows. */
+typedef struct
+{
+    MapSweep* sweep;
+    float* band_r_max;
+    float hc;
+    float vc;
+}MapSweep_Task;
+
+/* ============================================================================================== */
+/*                              Internal Helper Functions                                         */
+/* ============================================================================================== */
+
+static void MapSweep_GeometryBand(void* arg, uint32_t index)
+{
+    MapSweep_Task* task = (MapSweep_Task*)arg;
+    MapSweep* sweep = task->sweep;
+    const LDC_Map* map = &sweep->map;
+    double hc = (map->src_width - 1)/2;     /* Optical centre, in source frame. */
+    double vc = (map->src_height - 1)/2;
+    double out_hc = (map->width - 1)/2;     /* Centre of output frame.          */
+    double out_vc = (map->height - 1)/2;
+    uint32_t y_begin = index * MAP_ROWS_PER_TASK;
+    uint32_t y_end = LDC_MIN(y_begin + MAP_ROWS_PER_TASK, map->height);
+    float r_max = 0.0f;
+    uint32_t i;
+
+    for(i = 0;i < map->num_of_rois;i++)
+    {
+        const LDC_Roi* roi = &map->rois[i];
+        uint32_t y;
+        uint32_t x;
+
+        for(y = LDC_MAX(roi->y, y_begin);y < LDC_MIN(roi->y + roi->height, y_end);y++)
+        {
+            double yt = ((double)y - out_vc) * map->scale + (map->centre_y - vc);
+
+            for(x = roi->x;x < roi->x + roi->width;x++)
+            {
+                double xt = ((double)x - out_hc) * map->scale + (map->centre_x - hc);
+                double r = sqrt(xt * xt + yt * yt);
+                size_t index_of_pixel = (size_t)y * map->width + x;
+
+                sweep->r[index_of_pixel] = (float)r;
+                sweep->dir_x[index_of_pixel] = (r > 0.0) ? (float)(xt / r) : 0.0f;
+                sweep->dir_y[index_of_pixel] = (r > 0.0) ? (float)(yt / r) : 0.0f;
+                r_max = LDC_MAX(r_max, (float)r);
+            }
+        }
+    }
+
+    task->band_r_max[index] = r_max;
+}
+
+static void MapSweep_DeriveBand(void* arg, uint32_t index)
+{
+    MapSweep_Task* task = (MapSweep_Task*)arg;
+    MapSweep* sweep = task->sweep;
+    LDC_Map* map = &sweep->map;
+    uint32_t y_begin = index * MAP_ROWS_PER_TASK;
+    uint32_t y_end = LDC_MIN(y_begin + MAP_ROWS_PER_TASK, map->height);
+    uint32_t i;
+
+    for(i = 0;i < map->num_of_rois;i++)
+    {
+        const LDC_Roi* roi = &map->rois[i];
+        uint32_t y;
+        uint32_t x;
+
+        for(y = LDC_MAX(roi->y, y_begin);y < LDC_MIN(roi->y + roi->height, y_end);y++)
+        {
+            for(x = roi->x;x < roi->x + roi->width;x++)
+            {
+                size_t index_of_pixel = (size_t)y * map->width + x;
+                float position = sweep->r[index_of_pixel] * (float)MAP_SWEEP_SAMPLES_PER_PIXEL;
+                uint32_t k = (uint32_t)position;
+                float t = position - (float)k;
+                float r_d;
+
+                /* Radial function, linearly interpolated between samples. */
+                k = LDC_MIN(k, sweep->num_of_samples - 2U);
+                r_d = sweep->r_d[k] + t * (sweep->r_d[k + 1] - sweep->r_d[k]);
+
+                map->h_d[index_of_pixel] = task->hc + sweep->dir_x[index_of_pixel] * r_d;
+                map->v_d[index_of_pixel] = task->vc + sweep->dir_y[index_of_pixel] * r_d;
+            }
+        }
+    }
+}
+
+/* ============================================================================================== */
+
+/*                                     API Functions                                              */
+
+/* ============================================================================================== */
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     MapSweep_Init
+ *
+ * \brief  Allocate map, and compute radius and direction of every pixel inside regions.
+ *
+ * \param  [Out] sweep        Map sweep. Has to be released with MapSweep_Deinit.
+ * \param  [In]  width        Width of source frame.
+ * \param  [In]  height       Height of source frame.
+ * \param  [In]  output       Output frame specification, or NULL for output same as source.
+ * \param  [In]  rois         Regions of interest in output frame, or NULL for whole frame.
+ * \param  [In]  num_of_rois  Number of regions of interest.
+ * \param  [In]  pool         Worker pool, or NULL.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status MapSweep_Init(MapSweep* sweep, uint32_t width, uint32_t height,
+                         const LDC_OutputSpec* const output, const LDC_Roi* const rois,
+                         uint32_t num_of_rois, WorkerPool* pool)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+
+    memset(sweep, 0, sizeof(MapSweep));
+
+    if(FrameCorrection_AllocateMap(&sweep->map, width, height, output, rois, num_of_rois))
+    {
+        status = LDC_STATUS_ERROR;
+    }
+    else
+    {
+        size_t num_of_pixels = (size_t)sweep->map.width * sweep->map.height;
+        uint32_t num_of_bands = (sweep->map.height + MAP_ROWS_PER_TASK - 1U) / MAP_ROWS_PER_TASK;
+        MapSweep_Task task;
+        uint32_t i;
+
+        sweep->r     = (float*)malloc(num_of_pixels * sizeof(float));
+        sweep->dir_x = (float*)malloc(num_of_pixels * sizeof(float));
+        sweep->dir_y = (float*)malloc(num_of_pixels * sizeof(float));
+        task.band_r_max = (float*)malloc(num_of_bands * sizeof(float));
+        task.sweep = sweep;
+
+        if(NULL == sweep->r || NULL == sweep->dir_x || NULL == sweep->dir_y ||
+           NULL == task.band_r_max)
+        {
+            status = LDC_STATUS_ERROR;
+        }
+        else
+        {
+            WorkerPool_Run(pool, MapSweep_GeometryBand, &task, num_of_bands);
+
+            for(i = 0;i < num_of_bands;i++)
+            {
+                sweep->r_max = LDC_MAX(sweep->r_max, task.band_r_max[i]);
+            }
+        }
+
+        free(task.band_r_max);
+    }
+
+    if(LDC_STATUS_OK != status)
+    {
+        MapSweep_Deinit(sweep);
+    }
+
+    return status;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     MapSweep_Deinit
+ *
+ * \brief  Release memory of map sweep.
+ *
+ * \param  [In]  sweep        Map sweep.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void MapSweep_Deinit(MapSweep* sweep)
+{
+    FrameCorrection_FreeMap(&sweep->map);
+    free(sweep->r);
+    free(sweep->dir_x);
+    free(sweep->dir_y);
+    free(sweep->r_d);
+    memset(sweep, 0, sizeof(MapSweep));
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     MapSweep_Derive
+ *
+ * \brief  Derive sweep->map for lens table of profile, with other lens parameters. Positions
+ *         are within FAST_MAP_MAX_COORDINATE_ERROR of reference map of same parameters.
+ *
+ * \param  [In]  sweep        Map sweep.
+ * \param  [In]  lens         Lens profile, that gives lens table.
+ * \param  [In]  params       Lens parameters, or NULL for parameters of profile.
+ * \param  [In]  pool         Worker pool, or NULL.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status MapSweep_Derive(MapSweep* sweep, const LensProfile* const lens,
+                           const MapSweep_LensParameters* const params, WorkerPool* pool)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    MapSweep_LensParameters lens_params;
+    uint32_t num_of_samples;
+    double* theta = NULL;
+    double* r_d = NULL;
+
+    if(NULL == sweep || NULL == sweep->r || NULL == lens)
+    {
+        return LDC_STATUS_ERROR;
+    }
+
+    if(NULL == params)
+    {
+        lens_params.focal_length_in_mm = lens->focal_length_in_mm;
+        lens_params.sensor_pixel_pitch_in_mm = lens->sensor_pixel_pitch_in_mm;
+        lens_params.scaling_factor = lens->scaling_factor;
+    }
+    else
+    {
+        lens_params = *params;
+    }
+
+    if(!(lens_params.focal_length_in_mm > 0.0) || !(lens_params.sensor_pixel_pitch_in_mm > 0.0) ||
+       !(lens_params.scaling_factor > 0.0) || !isfinite(lens_params.focal_length_in_mm) ||
+       !isfinite(lens_params.sensor_pixel_pitch_in_mm) || !isfinite(lens_params.scaling_factor))
+    {
+        return LDC_STATUS_ERROR;
+    }
+
+    /* Samples cover every radius inside of regions, plus one for interpolation. */
+    num_of_samples = (uint32_t)ceilf(sweep->r_max * (float)MAP_SWEEP_SAMPLES_PER_PIXEL) + 2U;
+
+    if(num_of_samples > sweep->num_of_samples)
+    {
+        float* samples = (float*)realloc(sweep->r_d, num_of_samples * sizeof(float));
+
+        if(NULL == samples)
+        {
+            return LDC_STATUS_ERROR;
+        }
+
+        sweep->r_d = samples;
+    }
+
+    sweep->num_of_samples = num_of_samples;
+
+    theta = (double*)malloc(num_of_samples * sizeof(double));
+    r_d   = (double*)malloc(num_of_samples * sizeof(double));
+
+    if(NULL == theta || NULL == r_d)
+    {
+        status = LDC_STATUS_ERROR;
+    }
+    else
+    {
+        double f = lens_params.focal_length_in_mm / lens_params.sensor_pixel_pitch_in_mm;
+        double z = f / lens_params.scaling_factor;
+        /* Lens table heights are in pixels of profile pitch. */
+        double height_scale = lens->sensor_pixel_pitch_in_mm /
+                              lens_params.sensor_pixel_pitch_in_mm;
+        MapSweep_Task task;
+        uint32_t i;
+
+        for(i = 0;i < num_of_samples;i++)
+        {
+            theta[i] = atan2((double)i / MAP_SWEEP_SAMPLES_PER_PIXEL, z);
+        }
+
+        LensProfile_InterpolateHeight(lens, theta, r_d, num_of_samples);
+
+        for(i = 0;i < num_of_samples;i++)
+        {
+            sweep->r_d[i] = (float)(r_d[i] * height_scale);
+        }
+
+        task.sweep = sweep;
+        task.hc = (float)((sweep->map.src_width - 1)/2);
+        task.vc = (float)((sweep->map.src_height - 1)/2);
+
+        WorkerPool_Run(pool, MapSweep_DeriveBand, &task,
+                       (sweep->map.height + MAP_ROWS_PER_TASK - 1U) / MAP_ROWS_PER_TASK);
+
+        status = FrameCorrection_UpdateSpans(&sweep->map);
+    }
+
+    free(theta);
+    free(r_d);
+
+    return status;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     MapSweep_Run
+ *
+ * \brief  Derive map for every lens parameters, and pass it to callback. Sweep stops at first
+ *         error of callback.
+ *
+ * \param  [In]  sweep          Map sweep.
+ * \param  [In]  lens           Lens profile, that gives lens table.
+ * \param  [In]  params         Array of lens parameters.
+ * \param  [In]  num_of_params  Number of lens parameters.
+ * \param  [In]  callback       Function called for every derived map.
+ * \param  [In]  user_data      Passed to callback.
+ * \param  [In]  pool           Worker pool, or NULL.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status MapSweep_Run(MapSweep* sweep, const LensProfile* const lens,
+                        const MapSweep_LensParameters* const params, uint32_t num_of_params,
+                        MapSweep_Callback callback, void* user_data, WorkerPool* pool)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    uint32_t i;
+
+    if(NULL == params || NULL == callback)
+    {
+        status = LDC_STATUS_ERROR;
+    }
+
+    for(i = 0;i < num_of_params && LDC_STATUS_OK == status;i++)
+    {
+        status = MapSweep_Derive(sweep, lens, &params[i], pool);
+
+        if(LDC_STATUS_OK == status)
+        {
+            status = callback(user_data, i, &sweep->map);
+        }
+    }
+
+    return status;
+}
@@ -0,0 +1,179 @@
+/**
+ ***************************************************************************************************
+ *
+ * \file  map_sweep.h
+ *
+ * \brief This file contains API for fast re-derivation of map, when focal length, pixel pitch
+ *        or scaling factor of lens change.
+ *
+ * \arg author:  Dejan Milojica
+ * \arg version: 1.2
+ * \arg date:    13.01.2021
+ *
+ ***************************************************************************************************
+ */
+
+#ifndef MAP_SWEEP_H
+#define MAP_SWEEP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================================== */
+/*                                       Include Files                                            */
+/* ============================================================================================== */
+
+#include <stdint.h>
+
+#include "../lib/ldc_types.h"
+#include "../correction_distortion/correction_distortion.h"
+#include "../lens_registry/lens_registry.h"
+#include "../worker_pool/worker_pool.h"
+
+/* ============================================================================================== */
+/*                                     Macros & Typedefs                                          */
+/* ============================================================================================== */
+
+#define MAP_SWEEP_SAMPLES_PER_PIXEL (4U)        /* Samples of radial function per pixel.  */
+
+/**
+ ***************************************************************************************************
+ *
+ * \typedef MapSweep_LensParameters
+ *
+ * \brief   Structure which represents lens parameters, that can change without new lens table.
+ *
+ ***************************************************************************************************
+ */
+typedef struct
+{
+    double focal_length_in_mm;                  /* Camera focal length in mm.             */
+    double sensor_pixel_pitch_in_mm;            /* Sensor pixel pitch in mm.              */
+    double scaling_factor;                      /* Image scaling factor.                  */
+}MapSweep_LensParameters;
+
+/**
+ ***************************************************************************************************
+ *
+ * \typedef MapSweep
+ *
+ * \brief   Structure which represents map, with cached geometry of every output pixel. Radius
+ *          and direction of pixel from optical centre do not depend on lens parameters, so new
+ *          map needs only new radial function, sampled in 1D.
+ *
+ ***************************************************************************************************
+ */
+typedef struct
+{
+    LDC_Map map;                                /* Map, derived for last parameters.      */
+    float* r;                                   /* Radius of every pixel, in source.      */
+    float* dir_x;                               /* Horizontal direction of every pixel.   */
+    float* dir_y;                               /* Vertical direction of every pixel.     */
+    float r_max;                                /* Max radius, inside of regions.         */
+    float* r_d;                                 /* Distorted radius, for every sample.    */
+    uint32_t num_of_samples;                    /* Number of samples of radial function.  */
+}MapSweep;
+
+/**
+ ***************************************************************************************************
+ *
+ * \typedef MapSweep_Callback
+ *
+ * \brief   Function called with map, derived for params[index] of sweep.
+ *
+ ***************************************************************************************************
+ */
+typedef LDC_Status (*MapSweep_Callback)(void* user_data, uint32_t index, const LDC_Map* map);
+
+/* ============================================================================================== */
+/*                                     Function Declarations                                      */
+/* ============================================================================================== */
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     MapSweep_Init
+ *
+ * \brief  Allocate map, and compute radius and direction of every pixel inside regions.
+ *
+ * \param  [Out] sweep        Map sweep. Has to be released with MapSweep_Deinit.
+ * \param  [In]  width        Width of source frame.
+ * \param  [In]  height       Height of source frame.
+ * \param  [In]  output       Output frame specification, or NULL for output same as source.
+ * \param  [In]  rois         Regions of interest in output frame, or NULL for whole frame.
+ * \param  [In]  num_of_rois  Number of regions of interest.
+ * \param  [In]  pool         Worker pool, or NULL.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status MapSweep_Init(MapSweep* sweep, uint32_t width, uint32_t height,
+                         const LDC_OutputSpec* const output, const LDC_Roi* const rois,
+                         uint32_t num_of_rois, WorkerPool* pool);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     MapSweep_Deinit
+ *
+ * \brief  Release memory of map sweep.
+ *
+ * \param  [In]  sweep        Map sweep.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void MapSweep_Deinit(MapSweep* sweep);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     MapSweep_Derive
+ *
+ * \brief  Derive sweep->map for lens table of profile, with other lens parameters. Positions
+ *         are within FAST_MAP_MAX_COORDINATE_ERROR of reference map of same parameters.
+ *
+ * \param  [In]  sweep        Map sweep.
+ * \param  [In]  lens         Lens profile, that gives lens table.
+ * \param  [In]  params       Lens parameters, or NULL for parameters of profile.
+ * \param  [In]  pool         Worker pool, or NULL.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status MapSweep_Derive(MapSweep* sweep, const LensProfile* const lens,
+                           const MapSweep_LensParameters* const params, WorkerPool* pool);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     MapSweep_Run
+ *
+ * \brief  Derive map for every lens parameters, and pass it to callback. Sweep stops at first
+ *         error of callback.
+ *
+ * \param  [In]  sweep          Map sweep.
+ * \param  [In]  lens           Lens profile, that gives lens table.
+ * \param  [In]  params         Array of lens parameters.
+ * \param  [In]  num_of_params  Number of lens parameters.
+ * \param  [In]  callback       Function called for every derived map.
+ * \param  [In]  user_data      Passed to callback.
+ * \param  [In]  pool           Worker pool, or NULL.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status MapSweep_Run(MapSweep* sweep, const LensProfile* const lens,
+                        const MapSweep_LensParameters* const params, uint32_t num_of_params,
+                        MapSweep_Callback callback, void* user_data, WorkerPool* pool);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
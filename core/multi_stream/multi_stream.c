@@ -0,0 +1,426 @@
+/**
+ ***************************************************************************************************
+ *
+ * \file  multi_stream.c
+ *
+ * \brief This file contains API for concurrent correction of frames from many cameras, on
+ *        shared worker pool.
+ *
+ * \arg author:  Dejan Milojica
+ * \arg version: 1.2
+ * \arg date:    13.01.2021
+ *
+ ***************************************************************************************************
+ */
+
+/* ============================================================================================== */
+/*                                       Include Files                                            */
+/* ============================================================================================== */
+
+#include "multi_stream.h"
+#include "../lib/ldc_internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* ============================================================================================== */
+/*                              Internal Helper Functions                                         */
+/* ============================================================================================== */
+
+static void MultiStream_RunTile(void* arg, uint32_t index);
+
+/* Start first queued frame of idle stream. Lock is held. Error is returned, when frame is
+   started but its tiles can not be scheduled, so it has to be completed by caller. */
+static LDC_Status MultiStream_StartFrame(MultiStream_Scheduler* scheduler,
+                                         MultiStream_Stream* stream)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+
+    if(NULL == stream->current && NULL != stream->head)
+    {
+        stream->current = stream->head;
+        stream->head = stream->head->next;
+        if(NULL == stream->head)
+        {
+            stream->tail = NULL;
+        }
+
+        stream->current_status = LDC_STATUS_OK;
+        stream->next_tile = 0;
+        stream->remaining_tiles = stream->num_of_tiles;
+
+        /* One pool task per tile, but every task takes tile of next stream in round robin. */
+        if(WorkerPool_Submit(scheduler->pool, MultiStream_RunTile, scheduler,
+                             stream->num_of_tiles))
+        {
+            stream->current_status = LDC_STATUS_ERROR;
+            stream->next_tile = stream->num_of_tiles;
+            stream->remaining_tiles = 0;
+            status = LDC_STATUS_ERROR;
+        }
+    }
+
+    return status;
+}
+
+/* Report finished frames of stream, and start next ones. Lock is held. */
+static void MultiStream_CompleteFrames(MultiStream_Scheduler* scheduler,
+                                       MultiStream_Stream* stream)
+{
+    /* Only one thread reports frames of stream, other threads leave finished frame to it. */
+    while(!stream->reporting && NULL != stream->current && 0U == stream->remaining_tiles)
+    {
+        MultiStream_QueuedFrame* frame = stream->current;
+        LDC_Status status = stream->current_status;
+
+        /* Stream stays busy during report, so next frame can not overtake it. */
+        stream->reporting = 1;
+        pthread_mutex_unlock(&scheduler->lock);
+        if(NULL != stream->done)
+        {
+            stream->done(stream->user_data, stream->stream_id, frame->frame.frame_data, status);
+        }
+        free(frame);
+        pthread_mutex_lock(&scheduler->lock);
+
+        stream->reporting = 0;
+        stream->current = NULL;
+        if(0U == --scheduler->num_of_frames)
+        {
+            pthread_cond_broadcast(&scheduler->idle_cond);
+        }
+
+        (void)MultiStream_StartFrame(scheduler, stream);
+    }
+}
+
+static void MultiStream_RunTile(void* arg, uint32_t index)
+{
+    MultiStream_Scheduler* scheduler = (MultiStream_Scheduler*)arg;
+    MultiStream_Stream* stream = NULL;
+    const MultiStream_Frame* frame;
+    const LDC_Map* map;
+    LDC_Status status = LDC_STATUS_OK;
+    uint32_t tile;
+    uint32_t y_begin;
+    uint32_t y_end;
+    uint32_t i;
+
+    (void)index;
+
+    pthread_mutex_lock(&scheduler->lock);
+
+    for(i = 0;i < scheduler->num_of_streams;i++)
+    {
+        MultiStream_Stream* candidate =
+            scheduler->streams[(scheduler->cursor + i) % scheduler->num_of_streams];
+
+        if(NULL != candidate->current && candidate->next_tile < candidate->num_of_tiles)
+        {
+            stream = candidate;
+            scheduler->cursor = (scheduler->cursor + i + 1U) % scheduler->num_of_streams;
+            break;
+        }
+    }
+
+    if(NULL == stream)
+    {
+        pthread_mutex_unlock(&scheduler->lock);
+        return;
+    }
+
+    tile = stream->next_tile++;
+    frame = &stream->current->frame;
+    map = stream->map;
+
+    pthread_mutex_unlock(&scheduler->lock);
+
+    /* Band of output rows, intersected with every region of map. */
+    y_begin = tile * MULTI_STREAM_TILE_ROWS;
+    y_end = LDC_MIN(y_begin + MULTI_STREAM_TILE_ROWS, map->height);
+
+    for(i = 0;i < map->num_of_rois && LDC_STATUS_OK == status;i++)
+    {
+        LDC_Roi band = map->rois[i];
+        uint32_t roi_begin = LDC_MAX(band.y, y_begin);
+        uint32_t roi_end = LDC_MIN(band.y + band.height, y_end);
+
+        if(roi_begin < roi_end)
+        {
+            band.y = roi_begin;
+            band.height = roi_end - roi_begin;
+
+            status = FrameCorrection_ApplyMap(map, frame->Y_out, frame->U_out, frame->V_out,
+                                              frame->Y, frame->U, frame->V, stream->yuv_type,
+                                              &band, 1U,
+                                              stream->use_border ? &stream->border : NULL);
+        }
+    }
+
+    pthread_mutex_lock(&scheduler->lock);
+
+    if(LDC_STATUS_OK != status)
+    {
+        stream->current_status = status;
+    }
+
+    stream->remaining_tiles--;
+    MultiStream_CompleteFrames(scheduler, stream);
+
+    pthread_mutex_unlock(&scheduler->lock);
+}
+
+/* ============================================================================================== */
+
+/*                                     API Functions                                              */
+
+/* ============================================================================================== */
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     MultiStream_Init
+ *
+ * \brief  Initialize scheduler without streams.
+ *
+ * \param  [Out] scheduler    Scheduler.
+ * \param  [In]  pool         Worker pool, that executes tiles of all streams.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status MultiStream_Init(MultiStream_Scheduler* scheduler, WorkerPool* pool)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+
+    memset(scheduler, 0, sizeof(MultiStream_Scheduler));
+
+    if(NULL == pool)
+    {
+        status = LDC_STATUS_ERROR;
+    }
+    else
+    {
+        scheduler->pool = pool;
+        pthread_mutex_init(&scheduler->lock, NULL);
+        pthread_cond_init(&scheduler->idle_cond, NULL);
+    }
+
+    return status;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     MultiStream_Deinit
+ *
+ * \brief  Wait until all submitted frames are reported, and release streams.
+ *
+ * \param  [In]  scheduler    Scheduler.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void MultiStream_Deinit(MultiStream_Scheduler* scheduler)
+{
+    uint32_t i;
+
+    MultiStream_WaitIdle(scheduler);
+
+    for(i = 0;i < scheduler->num_of_streams;i++)
+    {
+        free(scheduler->streams[i]);
+    }
+
+    free(scheduler->streams);
+    pthread_cond_destroy(&scheduler->idle_cond);
+    pthread_mutex_destroy(&scheduler->lock);
+    memset(scheduler, 0, sizeof(MultiStream_Scheduler));
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     MultiStream_AddStream
+ *
+ * \brief  Register camera stream.
+ *
+ * \param  [In]  scheduler    Scheduler.
+ * \param  [In]  map          Map generated with FrameCorrection_GenerateMap. It has to stay
+ *                            valid, until scheduler is deinitialized.
+ * \param  [In]  yuv_type     Type of YUV frames.
+ * \param  [In]  border       Colour of pixels without valid source pixel, or NULL to leave them
+ *                            untouched.
+ * \param  [In]  done         Function called for every corrected frame, or NULL.
+ * \param  [In]  user_data    Passed to done function.
+ * \param  [Out] stream_id    ID of registered stream.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status MultiStream_AddStream(MultiStream_Scheduler* scheduler, const LDC_Map* const map,
+                                 YUV_Type yuv_type, const LDC_Color* const border,
+                                 MultiStream_FrameDone done, void* user_data,
+                                 uint32_t* stream_id)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    MultiStream_Stream* stream;
+
+    if(NULL == map || NULL == map->row_spans || NULL == stream_id)
+    {
+        return LDC_STATUS_ERROR;
+    }
+
+    stream = (MultiStream_Stream*)calloc(1, sizeof(MultiStream_Stream));
+    if(NULL == stream)
+    {
+        return LDC_STATUS_ERROR;
+    }
+
+    stream->map = map;
+    stream->yuv_type = yuv_type;
+    stream->use_border = (NULL != border);
+    if(NULL != border)
+    {
+        stream->border = *border;
+    }
+    stream->done = done;
+    stream->user_data = user_data;
+    stream->num_of_tiles = (map->height + MULTI_STREAM_TILE_ROWS - 1U) / MULTI_STREAM_TILE_ROWS;
+
+    pthread_mutex_lock(&scheduler->lock);
+
+    if(scheduler->num_of_streams == scheduler->capacity)
+    {
+        uint32_t new_capacity = (0U == scheduler->capacity) ? 8U : 2U * scheduler->capacity;
+        MultiStream_Stream** streams =
+            (MultiStream_Stream**)realloc(scheduler->streams,
+                                          new_capacity * sizeof(MultiStream_Stream*));
+        if(NULL == streams)
+        {
+            status = LDC_STATUS_ERROR;
+        }
+        else
+        {
+            scheduler->streams = streams;
+            scheduler->capacity = new_capacity;
+        }
+    }
+
+    if(LDC_STATUS_OK == status)
+    {
+        stream->stream_id = scheduler->num_of_streams;
+        scheduler->streams[scheduler->num_of_streams++] = stream;
+        *stream_id = stream->stream_id;
+    }
+
+    pthread_mutex_unlock(&scheduler->lock);
+
+    if(LDC_STATUS_OK != status)
+    {
+        free(stream);
+    }
+
+    return status;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     MultiStream_SubmitFrame
+ *
+ * \brief  Queue frame for correction, and return without waiting for it.
+ *
+ * \param  [In]  scheduler    Scheduler.
+ * \param  [In]  stream_id    ID of stream.
+ * \param  [In]  frame        Source and output buffers of frame.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status MultiStream_SubmitFrame(MultiStream_Scheduler* scheduler, uint32_t stream_id,
+                                   const MultiStream_Frame* const frame)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    MultiStream_QueuedFrame* queued;
+
+    if(NULL == frame || NULL == frame->Y_out || NULL == frame->U_out || NULL == frame->V_out ||
+       NULL == frame->Y || NULL == frame->U || NULL == frame->V)
+    {
+        return LDC_STATUS_ERROR;
+    }
+
+    queued = (MultiStream_QueuedFrame*)malloc(sizeof(MultiStream_QueuedFrame));
+    if(NULL == queued)
+    {
+        return LDC_STATUS_ERROR;
+    }
+
+    queued->frame = *frame;
+    queued->next = NULL;
+
+    pthread_mutex_lock(&scheduler->lock);
+
+    if(stream_id >= scheduler->num_of_streams)
+    {
+        status = LDC_STATUS_ERROR;
+    }
+    else
+    {
+        MultiStream_Stream* stream = scheduler->streams[stream_id];
+
+        if(NULL == stream->tail)
+        {
+            stream->head = queued;
+        }
+        else
+        {
+            stream->tail->next = queued;
+        }
+        stream->tail = queued;
+        scheduler->num_of_frames++;
+
+        /* Frame is completed here only when its tiles could not be scheduled. */
+        if(MultiStream_StartFrame(scheduler, stream))
+        {
+            MultiStream_CompleteFrames(scheduler, stream);
+        }
+    }
+
+    pthread_mutex_unlock(&scheduler->lock);
+
+    if(LDC_STATUS_OK != status)
+    {
+        free(queued);
+    }
+
+    return status;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     MultiStream_WaitIdle
+ *
+ * \brief  Wait until all submitted frames are reported.
+ *
+ * \param  [In]  scheduler    Scheduler.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void MultiStream_WaitIdle(MultiStream_Scheduler* scheduler)
+{
+    pthread_mutex_lock(&scheduler->lock);
+
+    while(0U < scheduler->num_of_frames)
+    {
+        pthread_cond_wait(&scheduler->idle_cond, &scheduler->lock);
+    }
+
+    pthread_mutex_unlock(&scheduler->lock);
+}
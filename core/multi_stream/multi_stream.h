@@ -0,0 +1,240 @@
+/**
+ ***************************************************************************************************
+ *
+ * \file  multi_stream.h
+ *
+ * \brief This file contains API for concurrent correction of frames from many cameras, on
+ *        shared worker pool.
+ *
+ * \arg author:  Dejan Milojica
+ * \arg version: 1.2
+ * \arg date:    13.01.2021
+ *
+ ***************************************************************************************************
+ */
+
+#ifndef MULTI_STREAM_H
+#define MULTI_STREAM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================================== */
+/*                                       Include Files                                            */
+/* ============================================================================================== */
+
+#include <stdint.h>
+#include <pthread.h>
+
+#include "../lib/ldc_types.h"
+#include "../correction_distortion/correction_distortion.h"
+#include "../worker_pool/worker_pool.h"
+
+/* ============================================================================================== */
+/*                                     Macros & Typedefs                                          */
+/* ============================================================================================== */
+
+#define MULTI_STREAM_TILE_ROWS (32U)    /* Output rows per tile, even so NV12 chroma rows of    */
+                                        /* tile are not shared with other tiles.                */
+
+/**
+ ***************************************************************************************************
+ *
+ * \typedef MultiStream_FrameDone
+ *
+ * \brief   Function called when frame of stream is corrected. Frames of one stream are reported
+ *          in order of submission, and next frame of stream is not started until function
+ *          returns.
+ *
+ ***************************************************************************************************
+ */
+typedef void (*MultiStream_FrameDone)(void* user_data, uint32_t stream_id, void* frame_data,
+                                      LDC_Status status);
+
+/**
+ ***************************************************************************************************
+ *
+ * \typedef MultiStream_Frame
+ *
+ * \brief   Structure which represents frame submitted for correction. Buffers have to stay valid
+ *          until frame is reported as done.
+ *
+ ***************************************************************************************************
+ */
+typedef struct
+{
+    uint8_t* Y_out;                             /* Y component of output frame.           */
+    uint8_t* U_out;                             /* U component of output frame.           */
+    uint8_t* V_out;                             /* V component of output frame.           */
+    const uint8_t* Y;                           /* Y component of source frame.           */
+    const uint8_t* U;                           /* U component of source frame.           */
+    const uint8_t* V;                           /* V component of source frame.           */
+    void* frame_data;                           /* Passed to MultiStream_FrameDone.       */
+}MultiStream_Frame;
+
+/**
+ ***************************************************************************************************
+ *
+ * \typedef MultiStream_QueuedFrame
+ *
+ * \brief   Structure which represents frame in queue of stream.
+ *
+ ***************************************************************************************************
+ */
+typedef struct MultiStream_QueuedFrame
+{
+    MultiStream_Frame frame;                    /* Submitted frame.                       */
+    struct MultiStream_QueuedFrame* next;       /* Next frame of stream.                  */
+}MultiStream_QueuedFrame;
+
+/**
+ ***************************************************************************************************
+ *
+ * \typedef MultiStream_Stream
+ *
+ * \brief   Structure which represents one camera, with its map and queue of frames.
+ *
+ ***************************************************************************************************
+ */
+typedef struct
+{
+    uint32_t stream_id;                         /* Index of stream in scheduler.          */
+    const LDC_Map* map;                         /* Map of camera, owned by caller.        */
+    YUV_Type yuv_type;                          /* Type of YUV frames.                    */
+    LDC_Color border;                           /* Colour of invalid output pixels.       */
+    uint32_t use_border;                        /* Fill invalid output pixels.            */
+    MultiStream_FrameDone done;                 /* Called for every corrected frame.      */
+    void* user_data;                            /* Passed to done function.               */
+    MultiStream_QueuedFrame* head;              /* First frame waiting for correction.    */
+    MultiStream_QueuedFrame* tail;              /* Last frame waiting for correction.     */
+    MultiStream_QueuedFrame* current;           /* Frame in correction, or NULL.          */
+    LDC_Status current_status;                  /* Status of frame in correction.         */
+    uint32_t num_of_tiles;                      /* Number of tiles of every frame.        */
+    uint32_t next_tile;                         /* Next tile of current frame.            */
+    uint32_t remaining_tiles;                   /* Tiles of current frame, not done.      */
+    uint32_t reporting;                         /* Current frame is reported by a thread. */
+}MultiStream_Stream;
+
+/**
+ ***************************************************************************************************
+ *
+ * \typedef MultiStream_Scheduler
+ *
+ * \brief   Structure which represents set of streams, that share one worker pool. Every worker
+ *          takes next tile from streams in round robin order, so busy stream can not starve
+ *          other streams.
+ *
+ ***************************************************************************************************
+ */
+typedef struct
+{
+    WorkerPool* pool;                           /* Worker pool, owned by caller.          */
+    MultiStream_Stream** streams;               /* Registered streams.                    */
+    uint32_t num_of_streams;                    /* Number of registered streams.          */
+    uint32_t capacity;                          /* Capacity of streams array.             */
+    uint32_t cursor;                            /* Stream with next tile, in round robin. */
+    uint32_t num_of_frames;                     /* Number of frames, not reported.        */
+    pthread_mutex_t lock;                       /* Protects streams and their queues.     */
+    pthread_cond_t idle_cond;                   /* Signaled when all frames are reported. */
+}MultiStream_Scheduler;
+
+/* ============================================================================================== */
+/*                                     Function Declarations                                      */
+/* ============================================================================================== */
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     MultiStream_Init
+ *
+ * \brief  Initialize scheduler without streams.
+ *
+ * \param  [Out] scheduler    Scheduler.
+ * \param  [In]  pool         Worker pool, that executes tiles of all streams.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status MultiStream_Init(MultiStream_Scheduler* scheduler, WorkerPool* pool);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     MultiStream_Deinit
+ *
+ * \brief  Wait until all submitted frames are reported, and release streams.
+ *
+ * \param  [In]  scheduler    Scheduler.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void MultiStream_Deinit(MultiStream_Scheduler* scheduler);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     MultiStream_AddStream
+ *
+ * \brief  Register camera stream.
+ *
+ * \param  [In]  scheduler    Scheduler.
+ * \param  [In]  map          Map generated with FrameCorrection_GenerateMap. It has to stay
+ *                            valid, until scheduler is deinitialized.
+ * \param  [In]  yuv_type     Type of YUV frames.
+ * \param  [In]  border       Colour of pixels without valid source pixel, or NULL to leave them
+ *                            untouched.
+ * \param  [In]  done         Function called for every corrected frame, or NULL.
+ * \param  [In]  user_data    Passed to done function.
+ * \param  [Out] stream_id    ID of registered stream.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status MultiStream_AddStream(MultiStream_Scheduler* scheduler, const LDC_Map* const map,
+                                 YUV_Type yuv_type, const LDC_Color* const border,
+                                 MultiStream_FrameDone done, void* user_data,
+                                 uint32_t* stream_id);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     MultiStream_SubmitFrame
+ *
+ * \brief  Queue frame for correction, and return without waiting for it.
+ *
+ * \param  [In]  scheduler    Scheduler.
+ * \param  [In]  stream_id    ID of stream.
+ * \param  [In]  frame        Source and output buffers of frame.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status MultiStream_SubmitFrame(MultiStream_Scheduler* scheduler, uint32_t stream_id,
+                                   const MultiStream_Frame* const frame);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     MultiStream_WaitIdle
+ *
+ * \brief  Wait until all submitted frames are reported.
+ *
+ * \param  [In]  scheduler    Scheduler.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void MultiStream_WaitIdle(MultiStream_Scheduler* scheduler);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
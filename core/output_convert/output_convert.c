@@ -0,0 +1,659 @@
+/**
+ ***************************************************************************************************
+ *
+ * \file  output_convert.c
+ *
+ * \brief This file contains API for correction with fused conversion of output format. Output
+ *        is remapped in bands of rows into components, that stay in cache, and every band is
+ *        converted into final format (RGB24, BGR24, planar float RGB or other YUV layout) and
+ *        stored into output frame, so output frame is written once.
+ *
+ * \arg author:  Dejan Milojica
+ * \arg version: 1.2
+ * \arg date:    13.01.2021
+ *
+ ***************************************************************************************************
+ */
+
+/* ============================================================================================== */
+/*                                       Include Files                                            */
+/* ============================================================================================== */
+
+#include "output_convert.h"
+#include "../lib/ldc_internal.h"
+#include "../lib/ldc_log.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define OUTPUT_CONVERT_X86 (1)
+#include <immintrin.h>
+#endif
+
+/* ============================================================================================== */
+/*                                     Macros & Typedefs                                          */
+/* ============================================================================================== */
+
+#define OUTPUT_CONVERT_SHIFT (13)               /* Fixed point of integer coefficients.        */
+
+/* YUV to RGB coefficients, of (Y - 16), (U - 128) and (V - 128). */
+typedef struct
+{
+    int16_t y;                                  /* Y, of all components.                  */
+    int16_t rv;                                 /* V, of R.                               */
+    int16_t gu;                                 /* U, of G, subtracted.                   */
+    int16_t gv;                                 /* V, of G, subtracted.                   */
+    int16_t bu;                                 /* U, of B.                               */
+    float fy;                                   /* Same coefficients, scaled to [0, 1].   */
+    float frv;
+    float fgu;
+    float fgv;
+    float fbu;
+}OutputConvert_Coefficients;
+
+/* Buffers of one task, for one band. */
+typedef struct
+{
+    uint8_t* Y;                                 /* Remapped components of band.           */
+    uint8_t* U;
+    uint8_t* V;
+    uint8_t* Y_out;                             /* Components of band, in output YUV type.*/
+    uint8_t* U_out;
+    uint8_t* V_out;
+    int16_t* row;                               /* Y, U and V of row, centred, 3 * width. */
+    uint8_t* rgb;                               /* R, G and B of row, 3 * width.          */
+}OutputConvert_Buffers;
+
+typedef struct
+{
+    const Remap_Plan* plan;
+    const OutputConvert_Spec* spec;
+    const YuvFormat* format;
+    const YuvFormat* out_format;
+    const OutputConvert_Coefficients* coefficients;
+    uint8_t* output;
+    const uint8_t* Y;
+    const uint8_t* U;
+    const uint8_t* V;
+    LDC_Color border;
+    uint32_t num_of_bands;
+    uint32_t num_of_tasks;
+    LDC_Status status;
+}OutputConvert_Task;
+
+/* ============================================================================================== */
+/*                                       Global variables                                         */
+/* ============================================================================================== */
+
+static const OutputConvert_Coefficients g_coefficients[2] =
+{
+    /* BT.601. */
+    {9539, 13075, 3209, 6660, 16525,
+     1.164384f / 255.0f, 1.596027f / 255.0f, 0.391762f / 255.0f, 0.812968f / 255.0f,
+     2.017232f / 255.0f},
+    /* BT.709. */
+    {9539, 14686, 1747, 4366, 17305,
+     1.164384f / 255.0f, 1.792741f / 255.0f, 0.213249f / 255.0f, 0.532909f / 255.0f,
+     2.112402f / 255.0f}
+};
+
+/* ============================================================================================== */
+/*                              Internal Helper Functions                                         */
+/* ============================================================================================== */
+
+static uint32_t OutputConvert_LoadSample(const uint8_t* const component, size_t index,
+                                         uint32_t bytes_per_sample)
+{
+    return (1U == bytes_per_sample) ? component[index] : ((const uint16_t*)component)[index];
+}
+
+static void OutputConvert_StoreSample(uint8_t* const component, size_t index, uint32_t value,
+                                      uint32_t bytes_per_sample)
+{
+    if(1U == bytes_per_sample)
+    {
+        component[index] = (uint8_t)value;
+    }
+    else
+    {
+        ((uint16_t*)component)[index] = (uint16_t)value;
+    }
+}
+
+/* Y, U and V of row of band, as 8 bit values around 16 and 128, for every pixel. */
+static void OutputConvert_PrepareRow(const OutputConvert_Task* const task,
+                                     const OutputConvert_Buffers* const buffers, uint32_t row)
+{
+    const YuvFormat* format = task->format;
+    uint32_t width = task->plan->map->width;
+    uint32_t chroma_width = width >> format->chroma_shift_x;
+    uint32_t bytes = format->bytes_per_sample;
+    uint32_t shift = 8U * (bytes - 1U);
+    size_t luma = (size_t)row * width;
+    size_t chroma = (size_t)(row >> format->chroma_shift_y) * chroma_width;
+    int16_t* y = buffers->row;
+    int16_t* u = y + width;
+    int16_t* v = u + width;
+    uint32_t x;
+
+    for(x = 0;x < width;x++)
+    {
+        size_t c = chroma + (x >> format->chroma_shift_x);
+
+        y[x] = (int16_t)((OutputConvert_LoadSample(buffers->Y, luma + x, bytes) >> shift) - 16);
+        u[x] = (int16_t)((OutputConvert_LoadSample(buffers->U, c, bytes) >> shift) - 128);
+        v[x] = (int16_t)((OutputConvert_LoadSample(buffers->V, c, bytes) >> shift) - 128);
+    }
+}
+
+static uint8_t OutputConvert_Clamp(int32_t value)
+{
+    return (uint8_t)((value < 0) ? 0 : ((value > 255) ? 255 : value));
+}
+
+static void OutputConvert_RgbRowScalar(const OutputConvert_Coefficients* const k, uint32_t first,
+                                       uint32_t width, const int16_t* const y,
+                                       uint8_t* const rgb)
+{
+    const int16_t* u = y + width;
+    const int16_t* v = u + width;
+    int32_t round = 1 << (OUTPUT_CONVERT_SHIFT - 1);
+    uint32_t x;
+
+    for(x = first;x < width;x++)
+    {
+        int32_t luma = k->y * y[x] + round;
+
+        rgb[x] = OutputConvert_Clamp((luma + k->rv * v[x]) >> OUTPUT_CONVERT_SHIFT);
+        rgb[width + x] = OutputConvert_Clamp((luma - k->gu * u[x] - k->gv * v[x]) >>
+                                             OUTPUT_CONVERT_SHIFT);
+        rgb[2U * width + x] = OutputConvert_Clamp((luma + k->bu * u[x]) >> OUTPUT_CONVERT_SHIFT);
+    }
+}
+
+static void OutputConvert_FloatRowScalar(const OutputConvert_Coefficients* const k,
+                                         uint32_t first, uint32_t width, const int16_t* const y,
+                                         float* const r, float* const g, float* const b)
+{
+    const int16_t* u = y + width;
+    const int16_t* v = u + width;
+    uint32_t x;
+
+    for(x = first;x < width;x++)
+    {
+        float luma = k->fy * (float)y[x];
+        float red = luma + k->frv * (float)v[x];
+        float green = (luma - k->fgu * (float)u[x]) - k->fgv * (float)v[x];
+        float blue = luma + k->fbu * (float)u[x];
+
+        r[x] = (red < 0.0f) ? 0.0f : ((red > 1.0f) ? 1.0f : red);
+        g[x] = (green < 0.0f) ? 0.0f : ((green > 1.0f) ? 1.0f : green);
+        b[x] = (blue < 0.0f) ? 0.0f : ((blue > 1.0f) ? 1.0f : blue);
+    }
+}
+
+#ifdef OUTPUT_CONVERT_X86
+
+/* Pair of 16 bit coefficients, for _mm_madd_epi16 of interleaved components. */
+#define OUTPUT_CONVERT_PAIR(a, b) (_mm_set1_epi32((int32_t)(((uint32_t)(uint16_t)(b) << 16) | \
+                                                            (uint16_t)(a))))
+
+/* R, G and B of 8 pixels, as 32 bit sums, shifted and saturated to bytes. */
+__attribute__((target("sse2")))
+static uint32_t OutputConvert_RgbRowSSE2(const OutputConvert_Coefficients* const k,
+                                         uint32_t width, const int16_t* const y,
+                                         uint8_t* const rgb)
+{
+    const int16_t* u = y + width;
+    const int16_t* v = u + width;
+    const __m128i round = _mm_set1_epi32(1 << (OUTPUT_CONVERT_SHIFT - 1));
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i y_rv = OUTPUT_CONVERT_PAIR(k->y, k->rv);
+    const __m128i y_gu = OUTPUT_CONVERT_PAIR(k->y, -k->gu);
+    const __m128i gv = OUTPUT_CONVERT_PAIR(-k->gv, 0);
+    const __m128i y_bu = OUTPUT_CONVERT_PAIR(k->y, k->bu);
+    uint32_t x;
+
+    for(x = 0;x + 8U <= width;x += 8U)
+    {
+        __m128i y8 = _mm_loadu_si128((const __m128i*)&y[x]);
+        __m128i u8 = _mm_loadu_si128((const __m128i*)&u[x]);
+        __m128i v8 = _mm_loadu_si128((const __m128i*)&v[x]);
+        __m128i yv_lo = _mm_unpacklo_epi16(y8, v8);
+        __m128i yv_hi = _mm_unpackhi_epi16(y8, v8);
+        __m128i yu_lo = _mm_unpacklo_epi16(y8, u8);
+        __m128i yu_hi = _mm_unpackhi_epi16(y8, u8);
+        __m128i v_lo = _mm_unpacklo_epi16(v8, zero);
+        __m128i v_hi = _mm_unpackhi_epi16(v8, zero);
+        __m128i lo;
+        __m128i hi;
+        __m128i c;
+
+        lo = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yv_lo, y_rv), round),
+                            OUTPUT_CONVERT_SHIFT);
+        hi = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yv_hi, y_rv), round),
+                            OUTPUT_CONVERT_SHIFT);
+        c = _mm_packs_epi32(lo, hi);
+        _mm_storel_epi64((__m128i*)&rgb[x], _mm_packus_epi16(c, c));
+
+        lo = _mm_add_epi32(_mm_madd_epi16(yu_lo, y_gu), _mm_madd_epi16(v_lo, gv));
+        hi = _mm_add_epi32(_mm_madd_epi16(yu_hi, y_gu), _mm_madd_epi16(v_hi, gv));
+        lo = _mm_srai_epi32(_mm_add_epi32(lo, round), OUTPUT_CONVERT_SHIFT);
+        hi = _mm_srai_epi32(_mm_add_epi32(hi, round), OUTPUT_CONVERT_SHIFT);
+        c = _mm_packs_epi32(lo, hi);
+        _mm_storel_epi64((__m128i*)&rgb[width + x], _mm_packus_epi16(c, c));
+
+        lo = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yu_lo, y_bu), round),
+                            OUTPUT_CONVERT_SHIFT);
+        hi = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yu_hi, y_bu), round),
+                            OUTPUT_CONVERT_SHIFT);
+        c = _mm_packs_epi32(lo, hi);
+        _mm_storel_epi64((__m128i*)&rgb[2U * width + x], _mm_packus_epi16(c, c));
+    }
+
+    return x;
+}
+
+__attribute__((target("sse2")))
+static uint32_t OutputConvert_FloatRowSSE2(const OutputConvert_Coefficients* const k,
+                                           uint32_t width, const int16_t* const y,
+                                           float* const r, float* const g, float* const b)
+{
+    const int16_t* u = y + width;
+    const int16_t* v = u + width;
+    const __m128 fy = _mm_set1_ps(k->fy);
+    const __m128 frv = _mm_set1_ps(k->frv);
+    const __m128 fgu = _mm_set1_ps(k->fgu);
+    const __m128 fgv = _mm_set1_ps(k->fgv);
+    const __m128 fbu = _mm_set1_ps(k->fbu);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    uint32_t x;
+
+    for(x = 0;x + 4U <= width;x += 4U)
+    {
+        /* Sign extension of 4 samples, by arithmetic shift of duplicated samples. */
+        __m128i y4 = _mm_loadl_epi64((const __m128i*)&y[x]);
+        __m128i u4 = _mm_loadl_epi64((const __m128i*)&u[x]);
+        __m128i v4 = _mm_loadl_epi64((const __m128i*)&v[x]);
+        __m128 yf = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(y4, y4), 16));
+        __m128 uf = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(u4, u4), 16));
+        __m128 vf = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v4, v4), 16));
+        __m128 luma = _mm_mul_ps(fy, yf);
+        __m128 red = _mm_add_ps(luma, _mm_mul_ps(frv, vf));
+        __m128 green = _mm_sub_ps(_mm_sub_ps(luma, _mm_mul_ps(fgu, uf)), _mm_mul_ps(fgv, vf));
+        __m128 blue = _mm_add_ps(luma, _mm_mul_ps(fbu, uf));
+
+        _mm_storeu_ps(&r[x], _mm_min_ps(_mm_max_ps(red, zero), one));
+        _mm_storeu_ps(&g[x], _mm_min_ps(_mm_max_ps(green, zero), one));
+        _mm_storeu_ps(&b[x], _mm_min_ps(_mm_max_ps(blue, zero), one));
+    }
+
+    return x;
+}
+
+#endif
+
+/* Convert and store rows [y_begin, y_end) of band. */
+static void OutputConvert_StoreBand(const OutputConvert_Task* const task,
+                                    const OutputConvert_Buffers* const buffers,
+                                    uint32_t y_begin, uint32_t y_end)
+{
+    const OutputConvert_Spec* spec = task->spec;
+    const OutputConvert_Coefficients* k = task->coefficients;
+    uint32_t width = task->plan->map->width;
+    uint32_t height = task->plan->map->height;
+    uint32_t y;
+    uint32_t x;
+
+    for(y = y_begin;y < y_end && OUTPUT_CONVERT_YUV != spec->type;y++)
+    {
+        uint32_t done = 0;
+
+        OutputConvert_PrepareRow(task, buffers, y - y_begin);
+
+        if(OUTPUT_CONVERT_RGB_PLANAR_F32 == spec->type)
+        {
+            float* r = (float*)task->output + (size_t)y * width;
+            float* g = r + (size_t)width * height;
+            float* b = g + (size_t)width * height;
+
+#ifdef OUTPUT_CONVERT_X86
+            if(__builtin_cpu_supports("sse2"))
+            {
+                done = OutputConvert_FloatRowSSE2(k, width, buffers->row, r, g, b);
+            }
+#endif
+            OutputConvert_FloatRowScalar(k, done, width, buffers->row, r, g, b);
+        }
+        else
+        {
+            uint8_t* out = task->output + (size_t)y * width * 3U;
+            const uint8_t* first = buffers->rgb;
+            const uint8_t* last = buffers->rgb + 2U * width;
+
+#ifdef OUTPUT_CONVERT_X86
+            if(__builtin_cpu_supports("sse2"))
+            {
+                done = OutputConvert_RgbRowSSE2(k, width, buffers->row, buffers->rgb);
+            }
+#endif
+            OutputConvert_RgbRowScalar(k, done, width, buffers->row, buffers->rgb);
+
+            if(OUTPUT_CONVERT_BGR24 == spec->type)
+            {
+                first = buffers->rgb + 2U * width;
+                last = buffers->rgb;
+            }
+
+            for(x = 0;x < width;x++)
+            {
+                out[3U * x] = first[x];
+                out[3U * x + 1U] = buffers->rgb[width + x];
+                out[3U * x + 2U] = last[x];
+            }
+        }
+    }
+
+    if(OUTPUT_CONVERT_YUV == spec->type)
+    {
+        const YuvFormat* in = task->format;
+        const YuvFormat* out = task->out_format;
+        const uint8_t* Y = buffers->Y;
+        const uint8_t* U = buffers->U;
+        const uint8_t* V = buffers->V;
+
+        /* Other bit depth or chroma subsampling, converted in band. */
+        if(NULL != buffers->Y_out)
+        {
+            uint32_t rows = y_end - y_begin;
+            uint32_t chroma_width = width >> out->chroma_shift_x;
+            uint32_t in_chroma_width = width >> in->chroma_shift_x;
+            uint32_t up = (out->bytes_per_sample > in->bytes_per_sample) ? 8U : 0U;
+            uint32_t down = (out->bytes_per_sample < in->bytes_per_sample) ? 8U : 0U;
+            size_t i;
+
+            for(i = 0;i < (size_t)rows * width;i++)
+            {
+                OutputConvert_StoreSample(buffers->Y_out, i,
+                                          (OutputConvert_LoadSample(Y, i, in->bytes_per_sample) <<
+                                           up) >> down, out->bytes_per_sample);
+            }
+
+            for(y = 0;y < (rows >> out->chroma_shift_y);y++)
+            {
+                uint32_t in_row = (y << out->chroma_shift_y) >> in->chroma_shift_y;
+
+                for(x = 0;x < chroma_width;x++)
+                {
+                    size_t src = (size_t)in_row * in_chroma_width +
+                                 ((x << out->chroma_shift_x) >> in->chroma_shift_x);
+                    size_t dst = (size_t)y * chroma_width + x;
+
+                    OutputConvert_StoreSample(buffers->U_out, dst,
+                                              (OutputConvert_LoadSample(U, src,
+                                                                        in->bytes_per_sample) <<
+                                               up) >> down, out->bytes_per_sample);
+                    OutputConvert_StoreSample(buffers->V_out, dst,
+                                              (OutputConvert_LoadSample(V, src,
+                                                                        in->bytes_per_sample) <<
+                                               up) >> down, out->bytes_per_sample);
+                }
+            }
+
+            Y = buffers->Y_out;
+            U = buffers->U_out;
+            V = buffers->V_out;
+        }
+
+        YuvFormat_CombineRows(out, task->output, Y, U, V, width, height, y_begin, y_end);
+    }
+}
+
+static void OutputConvert_FreeBuffers(OutputConvert_Buffers* buffers)
+{
+    free(buffers->Y);
+    free(buffers->U);
+    free(buffers->V);
+    free(buffers->Y_out);
+    free(buffers->U_out);
+    free(buffers->V_out);
+    free(buffers->row);
+    free(buffers->rgb);
+    memset(buffers, 0, sizeof(OutputConvert_Buffers));
+}
+
+static LDC_Status OutputConvert_AllocateBuffers(const OutputConvert_Task* const task,
+                                                OutputConvert_Buffers* buffers)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    const YuvFormat* in = task->format;
+    const YuvFormat* out = task->out_format;
+    uint32_t width = task->plan->map->width;
+    size_t luma = (size_t)width * OUTPUT_CONVERT_BAND_ROWS;
+
+    memset(buffers, 0, sizeof(OutputConvert_Buffers));
+    buffers->Y = (uint8_t*)malloc(luma * in->bytes_per_sample);
+    buffers->U = (uint8_t*)malloc((luma >> (in->chroma_shift_x + in->chroma_shift_y)) *
+                                  in->bytes_per_sample);
+    buffers->V = (uint8_t*)malloc((luma >> (in->chroma_shift_x + in->chroma_shift_y)) *
+                                  in->bytes_per_sample);
+
+    if(NULL == buffers->Y || NULL == buffers->U || NULL == buffers->V)
+    {
+        status = LDC_STATUS_OUT_OF_MEMORY;
+    }
+    else if(OUTPUT_CONVERT_YUV != task->spec->type)
+    {
+        buffers->row = (int16_t*)malloc(3U * width * sizeof(int16_t));
+        buffers->rgb = (uint8_t*)malloc(3U * width);
+        status = (NULL == buffers->row || NULL == buffers->rgb) ?
+                 LDC_STATUS_OUT_OF_MEMORY : LDC_STATUS_OK;
+    }
+    else if(in->bytes_per_sample != out->bytes_per_sample ||
+            in->chroma_shift_x != out->chroma_shift_x || in->chroma_shift_y != out->chroma_shift_y)
+    {
+        size_t chroma = luma >> (out->chroma_shift_x + out->chroma_shift_y);
+
+        buffers->Y_out = (uint8_t*)malloc(luma * out->bytes_per_sample);
+        buffers->U_out = (uint8_t*)malloc(chroma * out->bytes_per_sample);
+        buffers->V_out = (uint8_t*)malloc(chroma * out->bytes_per_sample);
+        status = (NULL == buffers->Y_out || NULL == buffers->U_out || NULL == buffers->V_out) ?
+                 LDC_STATUS_OUT_OF_MEMORY : LDC_STATUS_OK;
+    }
+
+    if(LDC_STATUS_OK != status)
+    {
+        OutputConvert_FreeBuffers(buffers);
+    }
+
+    return status;
+}
+
+/* Every task has own buffers, and processes every num_of_tasks-th band. */
+static void OutputConvert_ApplyTask(void* arg, uint32_t index)
+{
+    OutputConvert_Task* task = (OutputConvert_Task*)arg;
+    const Remap_Plan* plan = task->plan;
+    const LDC_Map* map = plan->map;
+    OutputConvert_Buffers buffers;
+    uint32_t band;
+
+    if(OutputConvert_AllocateBuffers(task, &buffers))
+    {
+        __atomic_store_n(&task->status, LDC_STATUS_OUT_OF_MEMORY, __ATOMIC_RELAXED);
+        return;
+    }
+
+    for(band = index;band < task->num_of_bands;band += task->num_of_tasks)
+    {
+        uint32_t y_begin = band * OUTPUT_CONVERT_BAND_ROWS;
+        uint32_t y_end = LDC_MIN(y_begin + OUTPUT_CONVERT_BAND_ROWS, map->height);
+        size_t offset = (size_t)y_begin * map->width;
+        LDC_Map band_map = *map;
+        Remap_Plan band_plan = *plan;
+        LDC_Roi roi;
+
+        /* Plan and map of rows of band, with output rows starting at band buffers. */
+        band_map.height = y_end - y_begin;
+        band_map.h_d = map->h_d + offset;
+        band_map.v_d = map->v_d + offset;
+        band_map.row_spans = map->row_spans + y_begin;
+        band_plan.map = &band_map;
+        band_plan.luma_offset = plan->luma_offset + offset;
+        band_plan.chroma_offset = plan->chroma_offset + offset;
+        band_plan.luma_weight = (NULL == plan->luma_weight) ? NULL : plan->luma_weight + offset;
+        band_plan.chroma_weight = (NULL == plan->chroma_weight) ?
+                                  NULL : plan->chroma_weight + offset;
+
+        roi.x = 0;
+        roi.y = 0;
+        roi.width = map->width;
+        roi.height = band_map.height;
+
+        (void)Remap_ApplyPlan(&band_plan, buffers.Y, buffers.U, buffers.V, task->Y, task->U,
+                              task->V, &roi, 1U, &task->border);
+        OutputConvert_StoreBand(task, &buffers, y_begin, y_end);
+    }
+
+    OutputConvert_FreeBuffers(&buffers);
+}
+
+/* ============================================================================================== */
+
+/*                                     API Functions                                              */
+
+/* ============================================================================================== */
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     OutputConvert_GetFrameSize
+ *
+ * \brief  Get size of output frame in bytes.
+ *
+ * \param  [In]  spec         Format of output.
+ * \param  [In]  width        Width of output frame.
+ * \param  [In]  height       Height of output frame.
+ *
+ * \return size_t   Size of frame, or 0 for invalid format.
+ *
+ ***************************************************************************************************
+ */
+size_t OutputConvert_GetFrameSize(const OutputConvert_Spec* const spec, uint32_t width,
+                                  uint32_t height)
+{
+    size_t size = 0;
+
+    if(NULL == spec)
+    {
+        size = 0;
+    }
+    else if(OUTPUT_CONVERT_YUV == spec->type)
+    {
+        size = (NULL == YuvFormat_Get(spec->yuv_type)) ?
+               0U : YuvFormat_GetFrameSize(width, height, spec->yuv_type);
+    }
+    else if(OUTPUT_CONVERT_RGB24 == spec->type || OUTPUT_CONVERT_BGR24 == spec->type)
+    {
+        size = (size_t)width * height * 3U;
+    }
+    else if(OUTPUT_CONVERT_RGB_PLANAR_F32 == spec->type)
+    {
+        size = (size_t)width * height * 3U * sizeof(float);
+    }
+
+    return size;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     OutputConvert_ApplyPlan
+ *
+ * \brief  Remap frame with plan, and store it in output format. Bands of rows are remapped into
+ *         components same as with Remap_ApplyPlan for one region of whole frame, so output
+ *         pixels without source pixel, or outside of regions of map, have border colour. Band
+ *         is then converted, with SSE2 for RGB, and stored.
+ *
+ * \param  [In]  plan         Plan created with Remap_CreatePlan.
+ * \param  [In]  spec         Format of output.
+ * \param  [Out] output       Output frame, of OutputConvert_GetFrameSize bytes.
+ * \param  [In]  Y            Y component of YUV frame, with resolution of map source.
+ * \param  [In]  U            U component of YUV frame, with resolution of map source.
+ * \param  [In]  V            V component of YUV frame, with resolution of map source.
+ * \param  [In]  border       Border colour, or NULL for black.
+ * \param  [In]  pool         Worker pool that processes bands in parallel, or NULL.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status OutputConvert_ApplyPlan(const Remap_Plan* const plan,
+                                   const OutputConvert_Spec* const spec, uint8_t* const output,
+                                   const uint8_t* const Y, const uint8_t* const U,
+                                   const uint8_t* const V, const LDC_Color* const border,
+                                   WorkerPool* pool)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    OutputConvert_Task task;
+    uint32_t shift_x;
+    uint32_t shift_y;
+
+    memset(&task, 0, sizeof(OutputConvert_Task));
+
+    if(NULL == plan || NULL == plan->map || NULL == plan->luma_offset || NULL == output ||
+       NULL == Y || NULL == U || NULL == V || 0U == OutputConvert_GetFrameSize(spec, 1U, 1U) ||
+       spec->matrix > OUTPUT_CONVERT_BT709)
+    {
+        status = LDC_STATUS_INVALID_ARGUMENT;
+        LdcLog_Write(LDC_LOG_ERROR, status, "Invalid plan, frames or output format.");
+    }
+    else
+    {
+        task.format = YuvFormat_Get(plan->yuv_type);
+        task.out_format = (OUTPUT_CONVERT_YUV == spec->type) ?
+                          YuvFormat_Get(spec->yuv_type) : task.format;
+        shift_x = LDC_MAX(task.format->chroma_shift_x, task.out_format->chroma_shift_x);
+        shift_y = LDC_MAX(task.format->chroma_shift_y, task.out_format->chroma_shift_y);
+
+        if(0U != plan->map->width % (1U << shift_x) || 0U != plan->map->height % (1U << shift_y))
+        {
+            status = LDC_STATUS_UNSUPPORTED_FORMAT;
+            LdcLog_Write(LDC_LOG_ERROR, status, "Output %ux%u does not fit chroma of formats.",
+                         plan->map->width, plan->map->height);
+        }
+    }
+
+    if(LDC_STATUS_OK == status)
+    {
+        task.plan = plan;
+        task.spec = spec;
+        task.coefficients = &g_coefficients[spec->matrix];
+        task.output = output;
+        task.Y = Y;
+        task.U = U;
+        task.V = V;
+        task.status = LDC_STATUS_OK;
+
+        if(NULL != border)
+        {
+            task.border = *border;
+        }
+        else
+        {
+            task.border.y = 16;
+            task.border.u = 128;
+            task.border.v = 128;
+        }
+
+        task.num_of_bands = (plan->map->height + OUTPUT_CONVERT_BAND_ROWS - 1U) /
+                            OUTPUT_CONVERT_BAND_ROWS;
+        task.num_of_tasks = LDC_MIN(task.num_of_bands, OUTPUT_CONVERT_MAX_TASKS);
+
+        WorkerPool_Run(pool, OutputConvert_ApplyTask, &task, task.num_of_tasks);
+        status = task.status;
+    }
+
+    return status;
+}
@@ -0,0 +1,148 @@
+/**
+ ***************************************************************************************************
+ *
+ * \file  output_convert.h
+ *
+ * \brief This file contains API for correction with fused conversion of output format. Output
+ *        is remapped in bands of rows into components, that stay in cache, and every band is
+ *        converted into final format (RGB24, BGR24, planar float RGB or other YUV layout) and
+ *        stored into output frame, so output frame is written once.
+ *
+ * \arg author:  Dejan Milojica
+ * \arg version: 1.2
+ * \arg date:    13.01.2021
+ *
+ ***************************************************************************************************
+ */
+
+#ifndef OUTPUT_CONVERT_H
+#define OUTPUT_CONVERT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================================== */
+/*                                       Include Files                                            */
+/* ============================================================================================== */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "../lib/ldc_types.h"
+#include "../remap/remap.h"
+#include "../worker_pool/worker_pool.h"
+
+/* ============================================================================================== */
+/*                                     Macros & Typedefs                                          */
+/* ============================================================================================== */
+
+#define OUTPUT_CONVERT_BAND_ROWS (16U)          /* Rows remapped and converted together.       */
+#define OUTPUT_CONVERT_MAX_TASKS (16U)          /* Tasks, every task has its own band buffers. */
+
+/**
+ ***************************************************************************************************
+ *
+ * \typedef OutputConvert_Type
+ *
+ * \brief   Defines format of output frame.
+ *
+ ***************************************************************************************************
+ */
+typedef enum
+{
+    OUTPUT_CONVERT_YUV             = 0, /* YUV frame of yuv_type of specification.        */
+    OUTPUT_CONVERT_RGB24           = 1, /* Packed R G B bytes.                            */
+    OUTPUT_CONVERT_BGR24           = 2, /* Packed B G R bytes.                            */
+    OUTPUT_CONVERT_RGB_PLANAR_F32  = 3  /* R, G and B planes of float, in [0, 1].         */
+} OutputConvert_Type;
+
+/**
+ ***************************************************************************************************
+ *
+ * \typedef OutputConvert_Matrix
+ *
+ * \brief   Defines YUV to RGB matrix, of limited (video) range YUV.
+ *
+ ***************************************************************************************************
+ */
+typedef enum
+{
+    OUTPUT_CONVERT_BT601 = 0,           /* SD video.                                      */
+    OUTPUT_CONVERT_BT709 = 1            /* HD video.                                      */
+} OutputConvert_Matrix;
+
+/**
+ ***************************************************************************************************
+ *
+ * \typedef OutputConvert_Spec
+ *
+ * \brief   Structure which represents format of output frame. Samples of 16 bit formats are
+ *          converted to RGB by their upper 8 bits. YUV output of other bit depth is shifted by
+ *          8 bits, and chroma of other subsampling is taken from nearest chroma sample.
+ *
+ ***************************************************************************************************
+ */
+typedef struct
+{
+    OutputConvert_Type type;            /* Format of output.                              */
+    YUV_Type yuv_type;                  /* YUV type of output, for OUTPUT_CONVERT_YUV.    */
+    OutputConvert_Matrix matrix;        /* Matrix of RGB output.                          */
+}OutputConvert_Spec;
+
+/* ============================================================================================== */
+/*                                     Function Declarations                                      */
+/* ============================================================================================== */
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     OutputConvert_GetFrameSize
+ *
+ * \brief  Get size of output frame in bytes.
+ *
+ * \param  [In]  spec         Format of output.
+ * \param  [In]  width        Width of output frame.
+ * \param  [In]  height       Height of output frame.
+ *
+ * \return size_t   Size of frame, or 0 for invalid format.
+ *
+ ***************************************************************************************************
+ */
+size_t OutputConvert_GetFrameSize(const OutputConvert_Spec* const spec, uint32_t width,
+                                  uint32_t height);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     OutputConvert_ApplyPlan
+ *
+ * \brief  Remap frame with plan, and store it in output format. Bands of rows are remapped into
+ *         components same as with Remap_ApplyPlan for one region of whole frame, so output
+ *         pixels without source pixel, or outside of regions of map, have border colour. Band
+ *         is then converted, with SSE2 for RGB, and stored.
+ *
+ * \param  [In]  plan         Plan created with Remap_CreatePlan.
+ * \param  [In]  spec         Format of output.
+ * \param  [Out] output       Output frame, of OutputConvert_GetFrameSize bytes.
+ * \param  [In]  Y            Y component of YUV frame, with resolution of map source.
+ * \param  [In]  U            U component of YUV frame, with resolution of map source.
+ * \param  [In]  V            V component of YUV frame, with resolution of map source.
+ * \param  [In]  border       Border colour, or NULL for black.
+ * \param  [In]  pool         Worker pool that processes bands in parallel, or NULL.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status OutputConvert_ApplyPlan(const Remap_Plan* const plan,
+                                   const OutputConvert_Spec* const spec, uint8_t* const output,
+                                   const uint8_t* const Y, const uint8_t* const U,
+                                   const uint8_t* const V, const LDC_Color* const border,
+                                   WorkerPool* pool);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
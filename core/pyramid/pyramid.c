@@ -0,0 +1,261 @@
+/**
+ ***************************************************************************************************
+ *
+ * \file  pyramid.c
+ *
+ * \brief This file contains API for multi-resolution output of correction. Corrected frame is
+ *        remapped in bands of rows, and every band is reduced by 2x2 box filter into lower
+ *        levels while it is in cache, so full, 1/2, 1/4 ... resolution frames are written in
+ *        one pass, without reading back of full frame.
+ *
+ * \arg author:  Dejan Milojica
+ * \arg version: 1.2
+ * \arg date:    13.01.2021
+ *
+ ***************************************************************************************************
+ */
+
+/* ============================================================================================== */
+/*                                       Include Files                                            */
+/* ============================================================================================== */
+
+#include "pyramid.h"
+#include "../lib/ldc_internal.h"
+#include "../lib/ldc_log.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* ============================================================================================== */
+/*                                     Macros & Typedefs                                          */
+/* ============================================================================================== */
+
+typedef struct
+{
+    const Remap_Plan* plan;
+    const YuvFormat* format;
+    const Pyramid_Level* levels;
+    uint32_t num_of_levels;
+    uint32_t band_rows;
+    const uint8_t* Y;
+    const uint8_t* U;
+    const uint8_t* V;
+    const LDC_Color* border;
+}Pyramid_Task;
+
+/* ============================================================================================== */
+/*                              Internal Helper Functions                                         */
+/* ============================================================================================== */
+
+/* Rows [y_begin, y_end) of plane of width columns, as 2x2 averages of plane above. */
+static void Pyramid_ReducePlane(const uint8_t* const src, uint8_t* const dst, uint32_t width,
+                                uint32_t y_begin, uint32_t y_end, uint32_t bytes_per_sample)
+{
+    uint32_t x;
+    uint32_t y;
+
+    for(y = y_begin;y < y_end;y++)
+    {
+        if(1U == bytes_per_sample)
+        {
+            const uint8_t* top = src + (size_t)(2U * y) * (2U * width);
+            const uint8_t* bottom = top + 2U * width;
+            uint8_t* out = dst + (size_t)y * width;
+
+            for(x = 0;x < width;x++)
+            {
+                out[x] = (uint8_t)((top[2U * x] + top[2U * x + 1U] + bottom[2U * x] +
+                                    bottom[2U * x + 1U] + 2U) >> 2);
+            }
+        }
+        else
+        {
+            const uint16_t* top = (const uint16_t*)src + (size_t)(2U * y) * (2U * width);
+            const uint16_t* bottom = top + 2U * width;
+            uint16_t* out = (uint16_t*)dst + (size_t)y * width;
+
+            for(x = 0;x < width;x++)
+            {
+                out[x] = (uint16_t)((top[2U * x] + top[2U * x + 1U] + bottom[2U * x] +
+                                     bottom[2U * x + 1U] + 2U) >> 2);
+            }
+        }
+    }
+}
+
+static void Pyramid_ApplyBand(void* arg, uint32_t index)
+{
+    const Pyramid_Task* task = (const Pyramid_Task*)arg;
+    const LDC_Map* map = task->plan->map;
+    const YuvFormat* format = task->format;
+    uint32_t y_begin = index * task->band_rows;
+    uint32_t y_end = LDC_MIN(y_begin + task->band_rows, map->height);
+    uint32_t level;
+    uint32_t i;
+
+    /* Regions in same order as in Remap_ApplyPlan. Band has even rows, so chroma row is
+       written by same regions in same order. */
+    for(i = 0;i < map->num_of_rois;i++)
+    {
+        LDC_Roi roi = map->rois[i];
+        uint32_t roi_begin = LDC_MAX(roi.y, y_begin);
+        uint32_t roi_end = LDC_MIN(roi.y + roi.height, y_end);
+
+        if(roi_begin < roi_end)
+        {
+            roi.y = roi_begin;
+            roi.height = roi_end - roi_begin;
+            (void)Remap_ApplyPlan(task->plan, task->levels[0].Y, task->levels[0].U,
+                                  task->levels[0].V, task->Y, task->U, task->V, &roi, 1U,
+                                  task->border);
+        }
+    }
+
+    /* Band of every level, from band of level above, while it is in cache. */
+    for(level = 1;level < task->num_of_levels;level++)
+    {
+        const Pyramid_Level* above = &task->levels[level - 1U];
+        const Pyramid_Level* current = &task->levels[level];
+        uint32_t width = map->width >> level;
+        uint32_t begin = y_begin >> level;
+        uint32_t end = y_end >> level;
+
+        Pyramid_ReducePlane(above->Y, current->Y, width, begin, end, format->bytes_per_sample);
+        Pyramid_ReducePlane(above->U, current->U, width >> format->chroma_shift_x,
+                            begin >> format->chroma_shift_y, end >> format->chroma_shift_y,
+                            format->bytes_per_sample);
+        Pyramid_ReducePlane(above->V, current->V, width >> format->chroma_shift_x,
+                            begin >> format->chroma_shift_y, end >> format->chroma_shift_y,
+                            format->bytes_per_sample);
+    }
+}
+
+/* ============================================================================================== */
+
+/*                                     API Functions                                              */
+
+/* ============================================================================================== */
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     Pyramid_GetLevelSize
+ *
+ * \brief  Get resolution of level of pyramid. Width and height of output have to be divisible
+ *         so, that chroma of every level is exactly half of chroma of level above.
+ *
+ * \param  [In]  width          Width of output frame of map.
+ * \param  [In]  height         Height of output frame of map.
+ * \param  [In]  yuv_type       Type of YUV image.
+ * \param  [In]  num_of_levels  Number of levels, 1 to PYRAMID_MAX_LEVELS.
+ * \param  [In]  level          Level, 0 for full resolution.
+ * \param  [Out] level_width    Width of level.
+ * \param  [Out] level_height   Height of level.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status Pyramid_GetLevelSize(uint32_t width, uint32_t height, YUV_Type yuv_type,
+                                uint32_t num_of_levels, uint32_t level, uint32_t* level_width,
+                                uint32_t* level_height)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    const YuvFormat* format = YuvFormat_Get(yuv_type);
+
+    if(NULL == format)
+    {
+        status = LDC_STATUS_UNSUPPORTED_FORMAT;
+    }
+    else if(0U == num_of_levels || num_of_levels > PYRAMID_MAX_LEVELS || level >= num_of_levels ||
+            0U == width || 0U == height ||
+            0U != width % (1U << (num_of_levels - 1U + format->chroma_shift_x)) ||
+            0U != height % (1U << (num_of_levels - 1U + format->chroma_shift_y)))
+    {
+        status = LDC_STATUS_INVALID_ARGUMENT;
+    }
+    else
+    {
+        *level_width = width >> level;
+        *level_height = height >> level;
+    }
+
+    return status;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     Pyramid_ApplyPlan
+ *
+ * \brief  Remap frame with plan into level 0, and reduce it into other levels. Level 0 is same
+ *         as output of Remap_ApplyPlan for all regions of map, and every other level is 2x2
+ *         average of level above, rounded to nearest. Pixels outside of regions of map are
+ *         not written in level 0, and they are averaged into other levels as they are.
+ *
+ * \param  [In]  plan           Plan created with Remap_CreatePlan.
+ * \param  [Out] levels         Components of levels.
+ * \param  [In]  num_of_levels  Number of levels, 1 to PYRAMID_MAX_LEVELS.
+ * \param  [In]  Y              Y component of YUV frame, with resolution of map source.
+ * \param  [In]  U              U component of YUV frame, with resolution of map source.
+ * \param  [In]  V              V component of YUV frame, with resolution of map source.
+ * \param  [In]  border         Border colour, or NULL to leave pixels without source untouched.
+ * \param  [In]  pool           Worker pool that processes bands in parallel, or NULL.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status Pyramid_ApplyPlan(const Remap_Plan* const plan, const Pyramid_Level* const levels,
+                             uint32_t num_of_levels, const uint8_t* const Y,
+                             const uint8_t* const U, const uint8_t* const V,
+                             const LDC_Color* const border, WorkerPool* pool)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    Pyramid_Task task;
+    uint32_t width;
+    uint32_t height;
+    uint32_t level;
+
+    if(NULL == plan || NULL == plan->map || NULL == plan->luma_offset || NULL == levels ||
+       NULL == Y || NULL == U || NULL == V)
+    {
+        status = LDC_STATUS_INVALID_ARGUMENT;
+    }
+    else
+    {
+        status = Pyramid_GetLevelSize(plan->map->width, plan->map->height, plan->yuv_type,
+                                      num_of_levels, 0U, &width, &height);
+    }
+
+    for(level = 0;LDC_STATUS_OK == status && level < num_of_levels;level++)
+    {
+        if(NULL == levels[level].Y || NULL == levels[level].U || NULL == levels[level].V)
+        {
+            status = LDC_STATUS_INVALID_ARGUMENT;
+        }
+    }
+
+    if(LDC_STATUS_OK != status)
+    {
+        LdcLog_Write(LDC_LOG_ERROR, status, "Invalid plan, levels or %u levels of pyramid.",
+                     num_of_levels);
+    }
+    else
+    {
+        task.plan = plan;
+        task.format = YuvFormat_Get(plan->yuv_type);
+        task.levels = levels;
+        task.num_of_levels = num_of_levels;
+        task.band_rows = PYRAMID_BAND_ROWS << (num_of_levels - 1U);
+        task.Y = Y;
+        task.U = U;
+        task.V = V;
+        task.border = border;
+
+        /* Bands are independent, every band of level is reduced from same band above. */
+        WorkerPool_Run(pool, Pyramid_ApplyBand, &task,
+                       (height + task.band_rows - 1U) / task.band_rows);
+    }
+
+    return status;
+}
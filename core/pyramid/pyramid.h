@@ -0,0 +1,119 @@
+/**
+ ***************************************************************************************************
+ *
+ * \file  pyramid.h
+ *
+ * \brief This file contains API for multi-resolution output of correction. Corrected frame is
+ *        remapped in bands of rows, and every band is reduced by 2x2 box filter into lower
+ *        levels while it is in cache, so full, 1/2, 1/4 ... resolution frames are written in
+ *        one pass, without reading back of full frame.
+ *
+ * \arg author:  Dejan Milojica
+ * \arg version: 1.2
+ * \arg date:    13.01.2021
+ *
+ ***************************************************************************************************
+ */
+
+#ifndef PYRAMID_H
+#define PYRAMID_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================================== */
+/*                                       Include Files                                            */
+/* ============================================================================================== */
+
+#include <stdint.h>
+
+#include "../lib/ldc_types.h"
+#include "../remap/remap.h"
+#include "../worker_pool/worker_pool.h"
+
+/* ============================================================================================== */
+/*                                     Macros & Typedefs                                          */
+/* ============================================================================================== */
+
+#define PYRAMID_MAX_LEVELS (8U)                 /* Max levels, with full resolution level.     */
+#define PYRAMID_BAND_ROWS (16U)                 /* Rows of lowest level, reduced per band.     */
+
+/**
+ ***************************************************************************************************
+ *
+ * \typedef Pyramid_Level
+ *
+ * \brief   Structure which represents components of one level of output, provided by caller.
+ *          Level n has width >> n columns and height >> n rows, in YUV format of plan.
+ *
+ ***************************************************************************************************
+ */
+typedef struct
+{
+    uint8_t* Y;                                 /* Y component of level.                  */
+    uint8_t* U;                                 /* U component of level.                  */
+    uint8_t* V;                                 /* V component of level.                  */
+}Pyramid_Level;
+
+/* ============================================================================================== */
+/*                                     Function Declarations                                      */
+/* ============================================================================================== */
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     Pyramid_GetLevelSize
+ *
+ * \brief  Get resolution of level of pyramid. Width and height of output have to be divisible
+ *         so, that chroma of every level is exactly half of chroma of level above.
+ *
+ * \param  [In]  width          Width of output frame of map.
+ * \param  [In]  height         Height of output frame of map.
+ * \param  [In]  yuv_type       Type of YUV image.
+ * \param  [In]  num_of_levels  Number of levels, 1 to PYRAMID_MAX_LEVELS.
+ * \param  [In]  level          Level, 0 for full resolution.
+ * \param  [Out] level_width    Width of level.
+ * \param  [Out] level_height   Height of level.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status Pyramid_GetLevelSize(uint32_t width, uint32_t height, YUV_Type yuv_type,
+                                uint32_t num_of_levels, uint32_t level, uint32_t* level_width,
+                                uint32_t* level_height);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     Pyramid_ApplyPlan
+ *
+ * \brief  Remap frame with plan into level 0, and reduce it into other levels. Level 0 is same
+ *         as output of Remap_ApplyPlan for all regions of map, and every other level is 2x2
+ *         average of level above, rounded to nearest. Pixels outside of regions of map are
+ *         not written in level 0, and they are averaged into other levels as they are.
+ *
+ * \param  [In]  plan           Plan created with Remap_CreatePlan.
+ * \param  [Out] levels         Components of levels.
+ * \param  [In]  num_of_levels  Number of levels, 1 to PYRAMID_MAX_LEVELS.
+ * \param  [In]  Y              Y component of YUV frame, with resolution of map source.
+ * \param  [In]  U              U component of YUV frame, with resolution of map source.
+ * \param  [In]  V              V component of YUV frame, with resolution of map source.
+ * \param  [In]  border         Border colour, or NULL to leave pixels without source untouched.
+ * \param  [In]  pool           Worker pool that processes bands in parallel, or NULL.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status Pyramid_ApplyPlan(const Remap_Plan* const plan, const Pyramid_Level* const levels,
+                             uint32_t num_of_levels, const uint8_t* const Y,
+                             const uint8_t* const U, const uint8_t* const V,
+                             const LDC_Color* const border, WorkerPool* pool);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
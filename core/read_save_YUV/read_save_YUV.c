@@ -16,11 +16,17 @@
 /*                                       Include Files                                            */
 /* ============================================================================================== */
 
+/* 64 bit file offsets, for frames larger than 2 GB also on 32 bit systems. */
+#define _FILE_OFFSET_BITS 64
+
 #include "read_save_YUV.h"
+#include "../lib/ldc_log.h"
+#include <stdio.h>
 #include <string.h>
 #include <math.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <sys/types.h>
 
 /* ============================================================================================== */
 /*                                       Global variables                                         */
@@ -30,6 +36,44 @@
 /*                              Internal Helper Functions                                         */
 /* ============================================================================================== */
 
+/* Offset of plane in frame, bytes of its row, and subsampling of its rows. Returns 0, when
+   format has no such plane. */
+static uint32_t FileOperation_GetPlane(const YuvFormat* const format, uint32_t width,
+                                       uint32_t height, uint32_t plane, off_t* offset,
+                                       size_t* row_size, uint32_t* row_shift)
+{
+    size_t bytes = format->bytes_per_sample;
+    size_t chroma_row = (size_t)(width >> format->chroma_shift_x) * bytes;
+
+    if(plane >= format->num_of_planes)
+    {
+        return 0U;
+    }
+
+    if(YUV_LAYOUT_PACKED == format->layout)
+    {
+        *offset = 0;
+        *row_size = YuvFormat_GetFrameSize(width, 1U, format->yuv_type);
+        *row_shift = 0;
+    }
+    else if(0U == plane)
+    {
+        *offset = 0;
+        *row_size = (size_t)width * bytes;
+        *row_shift = 0;
+    }
+    else
+    {
+        /* Semi-planar plane has U V pairs, planar V plane follows U plane. */
+        *row_size = (YUV_LAYOUT_SEMI_PLANAR == format->layout) ? 2U * chroma_row : chroma_row;
+        *row_shift = format->chroma_shift_y;
+        *offset = (off_t)((size_t)width * height * bytes +
+                          (size_t)(plane - 1U) * chroma_row * (height >> format->chroma_shift_y));
+    }
+
+    return 1U;
+}
+
 /* ============================================================================================== */
 
 /*                                     API Functions                                              */
@@ -55,48 +99,64 @@
  ***************************************************************************************************
  */
 LDC_Status FileOperation_ReadRawYUV(const char* const filename, uint8_t** YUV, uint32_t width,
-                                    uint32_t height, uint32_t* img_size, YUV_Type yuv_type)
+                                    uint32_t height, size_t* img_size, YUV_Type yuv_type)
 {
-    uint32_t expected_size = width * height + 2 * (width / 2) * ((int32_t)yuv_type * height / 2);
-    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    size_t expected_size = YuvFormat_GetFrameSize(width, height, yuv_type);
+    LDC_Status status = YuvFormat_ValidateSize(YuvFormat_Get(yuv_type), width, height);
 
-    FILE* fp = fopen(filename, "rb");
+    /* File of unsupported format, or of invalid size, is not opened. */
+    FILE* fp = (LDC_STATUS_OK != status) ? NULL : fopen(filename, "rb");
 
-    if (NULL == fp)
+    if (LDC_STATUS_OK != status)
+    {
+        LdcLog_Write(LDC_LOG_ERROR, status, "Invalid yuv image type %d or size %u x %u",
+                     (int32_t)yuv_type, width, height);
+    }
+    else if (NULL == fp)
     {
-        printf(INPUT_FILE_HANDLING_ERROR_MESSAGE);
-        status = LDC_STATUS_ERROR;
+        status = LDC_STATUS_FILE_ERROR;
+        LdcLog_Write(LDC_LOG_ERROR, status, INPUT_FILE_HANDLING_ERROR_MESSAGE);
     }
     else
     {
-        /* Check file size. */
-        fseek(fp, 0, SEEK_END);
+        off_t file_size;
+
+        /* Check file size, with 64 bit offset. */
+        fseeko(fp, 0, SEEK_END);
+        file_size = ftello(fp);
 
         /* Set file size. */
-        *img_size = ftell(fp);
+        *img_size = (file_size < 0) ? 0U : (size_t)file_size;
 
-        if(*img_size != expected_size)
+        if(file_size < 0 || *img_size != expected_size)
         {
-            fprintf(stderr, "Wrong size of yuv image : %d bytes, expected %d bytes\n",
-            *img_size, expected_size);
-
-            status = LDC_STATUS_ERROR;
+            status = LDC_STATUS_FILE_ERROR;
+            LdcLog_Write(LDC_LOG_ERROR, status,
+                         "Wrong size of yuv image : %llu bytes, expected %llu bytes",
+                         (unsigned long long)*img_size, (unsigned long long)expected_size);
         }
         else
         {
             size_t result;
 
             /* Back to file begining. */
-            fseek(fp, 0, SEEK_SET);
+            fseeko(fp, 0, SEEK_SET);
 
             *YUV = malloc(*img_size * sizeof(uint8_t));
 
-            result = fread(*YUV, 1, *img_size, fp);
-
-            if(result != *img_size)
+            if(NULL == *YUV)
+            {
+                status = LDC_STATUS_OUT_OF_MEMORY;
+            }
+            else
             {
-                printf(READING_INPUT_FILE_ERROR_MESSAGE);
-                status = LDC_STATUS_ERROR;
+                result = fread(*YUV, 1, *img_size, fp);
+
+                if(result != *img_size)
+                {
+                    status = LDC_STATUS_FILE_ERROR;
+                    LdcLog_Write(LDC_LOG_ERROR, status, READING_INPUT_FILE_ERROR_MESSAGE);
+                }
             }
 
         }
@@ -125,15 +185,15 @@ LDC_Status FileOperation_ReadRawYUV(const char* const filename, uint8_t** YUV, u
  ***************************************************************************************************
  */
 LDC_Status FileOperation_SaveRawYUV(const char* const filename, const uint8_t* const yuv_image,
-                                    uint32_t img_size, uint32_t width, uint32_t height)
+                                    size_t img_size, uint32_t width, uint32_t height)
 {
     LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
     FILE* fp = fopen(filename, "wb");
 
     if (NULL == fp)
     {
-        printf(OUTPUT_FILE_HANDLING_ERROR_MESSAGE);
-        status = LDC_STATUS_ERROR;
+        status = LDC_STATUS_FILE_ERROR;
+        LdcLog_Write(LDC_LOG_ERROR, status, OUTPUT_FILE_HANDLING_ERROR_MESSAGE);
     }
     else
     {
@@ -144,3 +204,125 @@ LDC_Status FileOperation_SaveRawYUV(const char* const filename, const uint8_t* c
     return status;
 }
 
+/**
+ ***************************************************************************************************
+ *
+ * \fn     FileOperation_ReadRawYUVRows
+ *
+ * \brief  Read rows [y_begin, y_end) of raw yuv image file, from every plane of frame. Rows are
+ *         stored as YUV frame of width x (y_end - y_begin) pixels, with layout of format, so
+ *         they can be split with YuvFormat_Split. Rows have to start and end at chroma row.
+ *
+ * \param  [In]  fp           Opened raw yuv image file.
+ * \param  [In]  format       Layout of frame.
+ * \param  [In]  width        Width of image.
+ * \param  [In]  height       Height of image.
+ * \param  [In]  y_begin      First row.
+ * \param  [In]  y_end        One past last row.
+ * \param  [Out] YUV_rows     Rows, of YuvFormat_GetFrameSize(width, y_end - y_begin) bytes.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status FileOperation_ReadRawYUVRows(FILE* fp, const YuvFormat* const format, uint32_t width,
+                                        uint32_t height, uint32_t y_begin, uint32_t y_end,
+                                        uint8_t* const YUV_rows)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    uint8_t* rows = YUV_rows;
+    size_t row_size;
+    uint32_t row_shift;
+    uint32_t plane;
+    off_t offset;
+
+    if(NULL == fp || NULL == YUV_rows || YuvFormat_ValidateSize(format, width, height) ||
+       y_begin > y_end || y_end > height ||
+       0U != (y_begin | y_end) % (1U << format->chroma_shift_y))
+    {
+        status = LDC_STATUS_INVALID_ARGUMENT;
+        LdcLog_Write(LDC_LOG_ERROR, status, "Invalid rows %u to %u of yuv image.", y_begin,
+                     y_end);
+    }
+
+    /* Rows of every plane are contiguous in file, and they are stored one after another. */
+    for(plane = 0;LDC_STATUS_OK == status &&
+        FileOperation_GetPlane(format, width, height, plane, &offset, &row_size, &row_shift);
+        plane++)
+    {
+        size_t size = (size_t)((y_end - y_begin) >> row_shift) * row_size;
+
+        offset += (off_t)((size_t)(y_begin >> row_shift) * row_size);
+
+        if(0 != fseeko(fp, offset, SEEK_SET) || size != fread(rows, 1, size, fp))
+        {
+            status = LDC_STATUS_FILE_ERROR;
+            LdcLog_Write(LDC_LOG_ERROR, status, READING_INPUT_FILE_ERROR_MESSAGE);
+        }
+
+        rows += size;
+    }
+
+    return status;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     FileOperation_SaveRawYUVRows
+ *
+ * \brief  Write rows [y_begin, y_end) of raw yuv image file, into every plane of frame, so
+ *         frame can be written strip by strip.
+ *
+ * \param  [In]  fp           Opened raw yuv image file.
+ * \param  [In]  format       Layout of frame.
+ * \param  [In]  width        Width of image.
+ * \param  [In]  height       Height of image.
+ * \param  [In]  y_begin      First row.
+ * \param  [In]  y_end        One past last row.
+ * \param  [In]  YUV_rows     Rows, as YUV frame of width x (y_end - y_begin) pixels.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status FileOperation_SaveRawYUVRows(FILE* fp, const YuvFormat* const format, uint32_t width,
+                                        uint32_t height, uint32_t y_begin, uint32_t y_end,
+                                        const uint8_t* const YUV_rows)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    const uint8_t* rows = YUV_rows;
+    size_t row_size;
+    uint32_t row_shift;
+    uint32_t plane;
+    off_t offset;
+
+    if(NULL == fp || NULL == YUV_rows || YuvFormat_ValidateSize(format, width, height) ||
+       y_begin > y_end || y_end > height ||
+       0U != (y_begin | y_end) % (1U << format->chroma_shift_y))
+    {
+        status = LDC_STATUS_INVALID_ARGUMENT;
+        LdcLog_Write(LDC_LOG_ERROR, status, "Invalid rows %u to %u of yuv image.", y_begin,
+                     y_end);
+    }
+
+    for(plane = 0;LDC_STATUS_OK == status &&
+        FileOperation_GetPlane(format, width, height, plane, &offset, &row_size, &row_shift);
+        plane++)
+    {
+        size_t size = (size_t)((y_end - y_begin) >> row_shift) * row_size;
+
+        offset += (off_t)((size_t)(y_begin >> row_shift) * row_size);
+
+        if(0 != fseeko(fp, offset, SEEK_SET) || size != fwrite(rows, 1, size, fp))
+        {
+            status = LDC_STATUS_FILE_ERROR;
+            LdcLog_Write(LDC_LOG_ERROR, status, OUTPUT_FILE_HANDLING_ERROR_MESSAGE);
+        }
+
+        rows += size;
+    }
+
+    return status;
+}
+
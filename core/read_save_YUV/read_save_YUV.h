@@ -24,9 +24,11 @@ extern "C" {
 /* ============================================================================================== */
 
 #include <stdint.h>
+#include <stddef.h>
 #include <stdio.h>
 
 #include "../lib/ldc_types.h"
+#include "../lib/yuv_format.h"
 
 
 /* ============================================================================================== */
@@ -69,7 +71,7 @@ extern "C" {
  ***************************************************************************************************
  */
 LDC_Status FileOperation_ReadRawYUV(const char* const filename, uint8_t** YUV, uint32_t width,
-                                    uint32_t height, uint32_t* img_size, YUV_Type yuv_type);
+                                    uint32_t height, size_t* img_size, YUV_Type yuv_type);
 
 /**
  ***************************************************************************************************
@@ -89,7 +91,56 @@ LDC_Status FileOperation_ReadRawYUV(const char* const filename, uint8_t** YUV, u
  ***************************************************************************************************
  */
 LDC_Status FileOperation_SaveRawYUV(const char* const filename, const uint8_t* const yuv_image,
-                                    uint32_t img_size, uint32_t width, uint32_t height);
+                                    size_t img_size, uint32_t width, uint32_t height);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     FileOperation_ReadRawYUVRows
+ *
+ * \brief  Read rows [y_begin, y_end) of raw yuv image file, from every plane of frame. Rows are
+ *         stored as YUV frame of width x (y_end - y_begin) pixels, with layout of format, so
+ *         they can be split with YuvFormat_Split. Rows have to start and end at chroma row.
+ *
+ * \param  [In]  fp           Opened raw yuv image file.
+ * \param  [In]  format       Layout of frame.
+ * \param  [In]  width        Width of image.
+ * \param  [In]  height       Height of image.
+ * \param  [In]  y_begin      First row.
+ * \param  [In]  y_end        One past last row.
+ * \param  [Out] YUV_rows     Rows, of YuvFormat_GetFrameSize(width, y_end - y_begin) bytes.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status FileOperation_ReadRawYUVRows(FILE* fp, const YuvFormat* const format, uint32_t width,
+                                        uint32_t height, uint32_t y_begin, uint32_t y_end,
+                                        uint8_t* const YUV_rows);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     FileOperation_SaveRawYUVRows
+ *
+ * \brief  Write rows [y_begin, y_end) of raw yuv image file, into every plane of frame, so
+ *         frame can be written strip by strip.
+ *
+ * \param  [In]  fp           Opened raw yuv image file.
+ * \param  [In]  format       Layout of frame.
+ * \param  [In]  width        Width of image.
+ * \param  [In]  height       Height of image.
+ * \param  [In]  y_begin      First row.
+ * \param  [In]  y_end        One past last row.
+ * \param  [In]  YUV_rows     Rows, as YUV frame of width x (y_end - y_begin) pixels.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status FileOperation_SaveRawYUVRows(FILE* fp, const YuvFormat* const format, uint32_t width,
+                                        uint32_t height, uint32_t y_begin, uint32_t y_end,
+                                        const uint8_t* const YUV_rows);
 
 #ifdef __cplusplus
 }
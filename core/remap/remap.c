@@ -0,0 +1,691 @@
+/**
+ ***************************************************************************************************
+ *
+ * \file  remap.c
+ *
+ * \brief This file contains API for remapping frames with map, with kernels specialized at
+ *        compile time for every layout of components and interpolation.
+ *
+ * \arg author:  Dejan Milojica
+ * \arg version: 1.2
+ * \arg date:    13.01.2021
+ *
+ ***************************************************************************************************
+ */
+
+/* ============================================================================================== */
+/*                                       Include Files                                            */
+/* ============================================================================================== */
+
+#include "remap.h"
+#include "../lib/ldc_internal.h"
+#include "../lib/ldc_log.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* ============================================================================================== */
+/*                              Internal Helper Functions                                         */
+/* ============================================================================================== */
+
+/* Top left pixel, and weight of next pixel, of position p on axis of size pixels (size >= 2). */
+static void Remap_GetBilinearAxis(float p, uint32_t size, uint32_t* index, uint32_t* weight)
+{
+    float last = (float)(size - 1U);
+
+    p = (p < 0.0f) ? 0.0f : ((p > last) ? last : p);
+    *index = (uint32_t)p;
+
+    if(*index >= size - 1U)
+    {
+        *index = size - 2U;
+        *weight = REMAP_WEIGHT_ONE;
+    }
+    else
+    {
+        *weight = (uint32_t)((p - (float)*index) * (float)REMAP_WEIGHT_ONE + 0.5f);
+    }
+}
+
+/* Bilinear interpolation of 2x2 pixels at src[offset], weights are in REMAP_WEIGHT_ONE units. */
+#define REMAP_DEFINE_INTERPOLATE(BITS, SAMPLE)                                                    \
+static SAMPLE Remap_Interpolate##BITS(const SAMPLE* const src, size_t offset, size_t stride,     \
+                                      uint32_t weight)                                           \
+{                                                                                                 \
+    const SAMPLE* p = &src[offset];                                                               \
+    uint32_t wx = weight & 0xFFFFU;                                                               \
+    uint32_t wy = weight >> 16;                                                                   \
+    uint32_t top = p[0] * (REMAP_WEIGHT_ONE - wx) + p[1] * wx;                                    \
+    uint32_t bottom = p[stride] * (REMAP_WEIGHT_ONE - wx) + p[stride + 1] * wx;                   \
+                                                                                                  \
+    return (SAMPLE)((top * (REMAP_WEIGHT_ONE - wy) + bottom * wy +                                \
+                     REMAP_WEIGHT_ONE * REMAP_WEIGHT_ONE / 2) >> 16);                             \
+}
+
+REMAP_DEFINE_INTERPOLATE(8, uint8_t)
+REMAP_DEFINE_INTERPOLATE(16, uint16_t)
+
+/* Kernels of one layout. Sample type and chroma subsampling are compile time constants, so
+   address of every component reduces to row pointer plus column, or precomputed offset. */
+#define REMAP_DEFINE_KERNELS(SUFFIX, BITS, SAMPLE, SHIFT_X, SHIFT_Y)                              \
+static void Remap_Fill##SUFFIX(const Remap_Frame* const frame, const LDC_Color* const border,    \
+                               uint32_t y, uint32_t x_begin, uint32_t x_end)                     \
+{                                                                                                 \
+    uint32_t border_shift = 8U * (uint32_t)(sizeof(SAMPLE) - 1U);                                 \
+    SAMPLE* Y_row = &((SAMPLE*)frame->Y_out)[(size_t)y * frame->width];                           \
+    SAMPLE* U_row = &((SAMPLE*)frame->U_out)[(size_t)(y >> SHIFT_Y) * (frame->width >> SHIFT_X)]; \
+    SAMPLE* V_row = &((SAMPLE*)frame->V_out)[(size_t)(y >> SHIFT_Y) * (frame->width >> SHIFT_X)]; \
+    uint32_t x;                                                                                   \
+                                                                                                  \
+    /* Border colour is 8 bit, so it is placed in high bits of wider samples. */                  \
+    for(x = x_begin;x < x_end;x++)                                                                \
+    {                                                                                             \
+        Y_row[x] = (SAMPLE)(border->y << border_shift);                                           \
+    }                                                                                             \
+                                                                                                  \
+    for(x = x_begin >> SHIFT_X;x <= (x_end - 1U) >> SHIFT_X;x++)                                  \
+    {                                                                                             \
+        U_row[x] = (SAMPLE)(border->u << border_shift);                                           \
+        V_row[x] = (SAMPLE)(border->v << border_shift);                                           \
+    }                                                                                             \
+}                                                                                                 \
+                                                                                                  \
+static void Remap_MapNearest##SUFFIX(const Remap_Frame* const frame, uint32_t y,                 \
+                                     uint32_t x_begin, uint32_t x_end)                            \
+{                                                                                                 \
+    const SAMPLE* Y = (const SAMPLE*)frame->Y;                                                    \
+    const SAMPLE* U = (const SAMPLE*)frame->U;                                                    \
+    const SAMPLE* V = (const SAMPLE*)frame->V;                                                    \
+    SAMPLE* Y_row = &((SAMPLE*)frame->Y_out)[(size_t)y * frame->width];                           \
+    SAMPLE* U_row = &((SAMPLE*)frame->U_out)[(size_t)(y >> SHIFT_Y) * (frame->width >> SHIFT_X)]; \
+    SAMPLE* V_row = &((SAMPLE*)frame->V_out)[(size_t)(y >> SHIFT_Y) * (frame->width >> SHIFT_X)]; \
+    const float* h_d = &frame->h_d[(size_t)y * frame->map_width];                                 \
+    const float* v_d = &frame->v_d[(size_t)y * frame->map_width];                                 \
+    int32_t src_width = (int32_t)frame->src_width;                                                \
+    int32_t src_chroma_width = (int32_t)(frame->src_width >> SHIFT_X);                            \
+    uint32_t x;                                                                                   \
+                                                                                                  \
+    /* Every position inside of span is valid, so there is no range check. */                     \
+    for(x = x_begin;x < x_end;x++)                                                                \
+    {                                                                                             \
+        /* Casting the float coordinates into int. Add +0.5 to get higher position. */            \
+        int32_t srcX = (int32_t)(h_d[x] + 0.5f);                                                  \
+        int32_t srcY = (int32_t)(v_d[x] + 0.5f);                                                  \
+        size_t src_chroma = (size_t)(srcY >> SHIFT_Y) * src_chroma_width +                        \
+                            (srcX >> SHIFT_X);                                                    \
+                                                                                                  \
+        Y_row[x] = Y[(size_t)srcY * src_width + srcX];                                            \
+        U_row[x >> SHIFT_X] = U[src_chroma];                                                      \
+        V_row[x >> SHIFT_X] = V[src_chroma];                                                      \
+    }                                                                                             \
+}                                                                                                 \
+                                                                                                  \
+static void Remap_MapBilinear##SUFFIX(const Remap_Frame* const frame, uint32_t y,                \
+                                      uint32_t x_begin, uint32_t x_end)                           \
+{                                                                                                 \
+    const SAMPLE* Y = (const SAMPLE*)frame->Y;                                                    \
+    const SAMPLE* U = (const SAMPLE*)frame->U;                                                    \
+    const SAMPLE* V = (const SAMPLE*)frame->V;                                                    \
+    SAMPLE* Y_row = &((SAMPLE*)frame->Y_out)[(size_t)y * frame->width];                           \
+    SAMPLE* U_row = &((SAMPLE*)frame->U_out)[(size_t)(y >> SHIFT_Y) * (frame->width >> SHIFT_X)]; \
+    SAMPLE* V_row = &((SAMPLE*)frame->V_out)[(size_t)(y >> SHIFT_Y) * (frame->width >> SHIFT_X)]; \
+    const float* h_d = &frame->h_d[(size_t)y * frame->map_width];                                 \
+    const float* v_d = &frame->v_d[(size_t)y * frame->map_width];                                 \
+    uint32_t src_width = frame->src_width;                                                        \
+    uint32_t src_chroma_width = frame->src_width >> SHIFT_X;                                      \
+    uint32_t src_chroma_height = frame->src_height >> SHIFT_Y;                                    \
+    float chroma_scale_x = 1.0f / (float)(1U << SHIFT_X);                                         \
+    float chroma_scale_y = 1.0f / (float)(1U << SHIFT_Y);                                         \
+    uint32_t x;                                                                                   \
+                                                                                                  \
+    /* Same offsets and weights as bilinear plan, computed for every pixel. */                    \
+    for(x = x_begin;x < x_end;x++)                                                                \
+    {                                                                                             \
+        uint32_t x0;                                                                              \
+        uint32_t y0;                                                                              \
+        uint32_t wx;                                                                              \
+        uint32_t wy;                                                                              \
+        size_t src_chroma;                                                                        \
+        uint32_t chroma_weight;                                                                   \
+                                                                                                  \
+        Remap_GetBilinearAxis(h_d[x], src_width, &x0, &wx);                                       \
+        Remap_GetBilinearAxis(v_d[x], frame->src_height, &y0, &wy);                               \
+        Y_row[x] = Remap_Interpolate##BITS(Y, (size_t)y0 * src_width + x0, src_width,             \
+                                           wx | (wy << 16));                                      \
+                                                                                                  \
+        Remap_GetBilinearAxis(h_d[x] * chroma_scale_x, src_chroma_width, &x0, &wx);               \
+        Remap_GetBilinearAxis(v_d[x] * chroma_scale_y, src_chroma_height, &y0, &wy);              \
+        src_chroma = (size_t)y0 * src_chroma_width + x0;                                          \
+        chroma_weight = wx | (wy << 16);                                                          \
+        U_row[x >> SHIFT_X] = Remap_Interpolate##BITS(U, src_chroma, src_chroma_width,            \
+                                                      chroma_weight);                             \
+        V_row[x >> SHIFT_X] = Remap_Interpolate##BITS(V, src_chroma, src_chroma_width,            \
+                                                      chroma_weight);                             \
+    }                                                                                             \
+}                                                                                                 \
+                                                                                                  \
+static void Remap_PlanNearest##SUFFIX(const Remap_Frame* const frame, uint32_t y,                \
+                                      uint32_t x_begin, uint32_t x_end)                           \
+{                                                                                                 \
+    const SAMPLE* Y = (const SAMPLE*)frame->Y;                                                    \
+    const SAMPLE* U = (const SAMPLE*)frame->U;                                                    \
+    const SAMPLE* V = (const SAMPLE*)frame->V;                                                    \
+    SAMPLE* Y_row = &((SAMPLE*)frame->Y_out)[(size_t)y * frame->width];                           \
+    SAMPLE* U_row = &((SAMPLE*)frame->U_out)[(size_t)(y >> SHIFT_Y) * (frame->width >> SHIFT_X)]; \
+    SAMPLE* V_row = &((SAMPLE*)frame->V_out)[(size_t)(y >> SHIFT_Y) * (frame->width >> SHIFT_X)]; \
+    const uint32_t* luma_offset = &frame->plan->luma_offset[(size_t)y * frame->map_width];        \
+    const uint32_t* chroma_offset = &frame->plan->chroma_offset[(size_t)y * frame->map_width];    \
+    uint32_t x;                                                                                   \
+                                                                                                  \
+    for(x = x_begin;x < x_end;x++)                                                                \
+    {                                                                                             \
+        Y_row[x] = Y[luma_offset[x]];                                                             \
+        U_row[x >> SHIFT_X] = U[chroma_offset[x]];                                                \
+        V_row[x >> SHIFT_X] = V[chroma_offset[x]];                                                \
+    }                                                                                             \
+}                                                                                                 \
+                                                                                                  \
+static void Remap_PlanBilinear##SUFFIX(const Remap_Frame* const frame, uint32_t y,               \
+                                       uint32_t x_begin, uint32_t x_end)                          \
+{                                                                                                 \
+    const SAMPLE* Y = (const SAMPLE*)frame->Y;                                                    \
+    const SAMPLE* U = (const SAMPLE*)frame->U;                                                    \
+    const SAMPLE* V = (const SAMPLE*)frame->V;                                                    \
+    SAMPLE* Y_row = &((SAMPLE*)frame->Y_out)[(size_t)y * frame->width];                           \
+    SAMPLE* U_row = &((SAMPLE*)frame->U_out)[(size_t)(y >> SHIFT_Y) * (frame->width >> SHIFT_X)]; \
+    SAMPLE* V_row = &((SAMPLE*)frame->V_out)[(size_t)(y >> SHIFT_Y) * (frame->width >> SHIFT_X)]; \
+    const uint32_t* luma_offset = &frame->plan->luma_offset[(size_t)y * frame->map_width];        \
+    const uint32_t* chroma_offset = &frame->plan->chroma_offset[(size_t)y * frame->map_width];    \
+    const uint32_t* luma_weight = &frame->plan->luma_weight[(size_t)y * frame->map_width];        \
+    const uint32_t* chroma_weight = &frame->plan->chroma_weight[(size_t)y * frame->map_width];    \
+    uint32_t src_width = frame->src_width;                                                        \
+    uint32_t src_chroma_width = frame->src_width >> SHIFT_X;                                      \
+    uint32_t x;                                                                                   \
+                                                                                                  \
+    for(x = x_begin;x < x_end;x++)                                                                \
+    {                                                                                             \
+        Y_row[x] = Remap_Interpolate##BITS(Y, luma_offset[x], src_width, luma_weight[x]);         \
+        U_row[x >> SHIFT_X] = Remap_Interpolate##BITS(U, chroma_offset[x], src_chroma_width,      \
+                                                      chroma_weight[x]);                          \
+        V_row[x >> SHIFT_X] = Remap_Interpolate##BITS(V, chroma_offset[x], src_chroma_width,      \
+                                                      chroma_weight[x]);                          \
+    }                                                                                             \
+}
+
+REMAP_DEFINE_KERNELS(420_8, 8, uint8_t, 1U, 1U)
+REMAP_DEFINE_KERNELS(422_8, 8, uint8_t, 1U, 0U)
+REMAP_DEFINE_KERNELS(444_8, 8, uint8_t, 0U, 0U)
+REMAP_DEFINE_KERNELS(420_16, 16, uint16_t, 1U, 1U)
+REMAP_DEFINE_KERNELS(422_16, 16, uint16_t, 1U, 0U)
+
+/* ============================================================================================== */
+/*                                       Global variables                                         */
+/* ============================================================================================== */
+
+static const struct
+{
+    uint32_t bytes_per_sample;
+    uint32_t chroma_shift_x;
+    uint32_t chroma_shift_y;
+    Remap_Kernels kernels;
+}remap_kernels[] =
+{
+    {1U, 1U, 1U, {Remap_Fill420_8,  Remap_MapNearest420_8,  Remap_MapBilinear420_8,
+                  Remap_PlanNearest420_8,  Remap_PlanBilinear420_8}},
+    {1U, 1U, 0U, {Remap_Fill422_8,  Remap_MapNearest422_8,  Remap_MapBilinear422_8,
+                  Remap_PlanNearest422_8,  Remap_PlanBilinear422_8}},
+    {1U, 0U, 0U, {Remap_Fill444_8,  Remap_MapNearest444_8,  Remap_MapBilinear444_8,
+                  Remap_PlanNearest444_8,  Remap_PlanBilinear444_8}},
+    {2U, 1U, 1U, {Remap_Fill420_16, Remap_MapNearest420_16, Remap_MapBilinear420_16,
+                  Remap_PlanNearest420_16, Remap_PlanBilinear420_16}},
+    {2U, 1U, 0U, {Remap_Fill422_16, Remap_MapNearest422_16, Remap_MapBilinear422_16,
+                  Remap_PlanNearest422_16, Remap_PlanBilinear422_16}},
+};
+
+/* ============================================================================================== */
+
+/*                                     API Functions                                              */
+
+/* ============================================================================================== */
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     Remap_GetKernels
+ *
+ * \brief  Get kernels specialized for sample size and chroma subsampling of format.
+ *
+ * \param  [In]  format       Layout of YUV format.
+ *
+ * \return const Remap_Kernels*   Kernels, or NULL when layout has no kernels.
+ *
+ ***************************************************************************************************
+ */
+const Remap_Kernels* Remap_GetKernels(const YuvFormat* const format)
+{
+    const Remap_Kernels* kernels = NULL;
+    uint32_t i;
+
+    for(i = 0;NULL != format && i < sizeof(remap_kernels) / sizeof(remap_kernels[0]);i++)
+    {
+        if(remap_kernels[i].bytes_per_sample == format->bytes_per_sample &&
+           remap_kernels[i].chroma_shift_x == format->chroma_shift_x &&
+           remap_kernels[i].chroma_shift_y == format->chroma_shift_y)
+        {
+            kernels = &remap_kernels[i].kernels;
+            break;
+        }
+    }
+
+    return kernels;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     Remap_ApplyRois
+ *
+ * \brief  Remap regions of interest with kernels, selected once for frame. Pixels inside of
+ *         map spans are remapped, and other pixels are set to border colour, if fill kernel is
+ *         given.
+ *
+ * \param  [In]  map          Map with spans of valid positions.
+ * \param  [In]  frame        Arguments of kernels.
+ * \param  [In]  remap        Remap kernel.
+ * \param  [In]  fill         Fill kernel, or NULL to leave pixels without source untouched.
+ * \param  [In]  rois         Validated regions of interest, or NULL for regions of map.
+ * \param  [In]  num_of_rois  Number of regions of interest.
+ * \param  [In]  border       Border colour.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void Remap_ApplyRois(const LDC_Map* const map, const Remap_Frame* const frame, Remap_Kernel remap,
+                     Remap_FillKernel fill, const LDC_Roi* const rois, uint32_t num_of_rois,
+                     const LDC_Color* const border)
+{
+    const LDC_Roi* apply_rois = (NULL == rois) ? map->rois : rois;
+    uint32_t apply_num_of_rois = (NULL == rois) ? map->num_of_rois : num_of_rois;
+    uint32_t r;
+
+    for(r = 0;r < apply_num_of_rois;r++)
+    {
+        const LDC_Roi* roi = &apply_rois[r];
+        uint32_t roi_end = roi->x + roi->width;
+        uint32_t y;
+        uint32_t i;
+
+        /* Border first, so chroma shared with valid pixels is overwritten by remap below. */
+        for(y = roi->y;NULL != fill && NULL != border && y < roi->y + roi->height;y++)
+        {
+            uint32_t x = roi->x;
+
+            for(i = map->row_spans[y];i < map->row_spans[y + 1];i++)
+            {
+                uint32_t start = LDC_MAX(map->spans[i].start, roi->x);
+                uint32_t end = LDC_MIN(map->spans[i].end, roi_end);
+
+                if(start < end)
+                {
+                    if(x < start)
+                    {
+                        fill(frame, border, y, x, start);
+                    }
+                    x = end;
+                }
+            }
+
+            if(x < roi_end)
+            {
+                fill(frame, border, y, x, roi_end);
+            }
+        }
+
+        for(y = roi->y;y < roi->y + roi->height;y++)
+        {
+            for(i = map->row_spans[y];i < map->row_spans[y + 1];i++)
+            {
+                uint32_t start = LDC_MAX(map->spans[i].start, roi->x);
+                uint32_t end = LDC_MIN(map->spans[i].end, roi_end);
+
+                if(start < end)
+                {
+                    remap(frame, y, start, end);
+                }
+            }
+        }
+    }
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     Remap_CreatePlan
+ *
+ * \brief  Precompute source offsets, and bilinear weights, of every output pixel inside of map
+ *         spans, for YUV format and interpolation. Offsets are 32 bit indices of samples, so
+ *         source component has to have fewer than 2^32 samples.
+ *
+ * \param  [Out] plan         Created plan. Has to be released with Remap_FreePlan.
+ * \param  [In]  map          Generated map.
+ * \param  [In]  yuv_type     Type of YUV image.
+ * \param  [In]  interpolation  Sampling of source frame.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status Remap_CreatePlan(Remap_Plan* plan, const LDC_Map* const map, YUV_Type yuv_type,
+                            LDC_Interpolation interpolation)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    const YuvFormat* format = YuvFormat_Get(yuv_type);
+
+    if(NULL == plan)
+    {
+        return LDC_STATUS_INVALID_ARGUMENT;
+    }
+
+    memset(plan, 0, sizeof(Remap_Plan));
+
+    if(NULL == map || NULL == map->h_d || NULL == map->v_d || NULL == map->row_spans ||
+       (LDC_INTERPOLATION_NEAREST != interpolation &&
+        LDC_INTERPOLATION_BILINEAR != interpolation))
+    {
+        status = LDC_STATUS_INVALID_ARGUMENT;
+    }
+    else if(NULL == Remap_GetKernels(format))
+    {
+        status = LDC_STATUS_UNSUPPORTED_FORMAT;
+    }
+    /* Chroma components are sized by subsampling, so frames have to be its multiples. */
+    else if(YuvFormat_ValidateSize(format, map->width, map->height) ||
+            YuvFormat_ValidateSize(format, map->src_width, map->src_height))
+    {
+        status = LDC_STATUS_INVALID_ARGUMENT;
+    }
+    /* Offsets of plan are 32 bit. */
+    else if((uint64_t)map->src_width * map->src_height > UINT32_MAX)
+    {
+        status = LDC_STATUS_INVALID_ARGUMENT;
+        LdcLog_Write(LDC_LOG_ERROR, status, "Source %ux%u has more than 2^32 samples.",
+                     map->src_width, map->src_height);
+    }
+    /* Bilinear interpolation needs 2x2 pixels of every component. */
+    else if(LDC_INTERPOLATION_BILINEAR == interpolation &&
+            ((map->src_width >> format->chroma_shift_x) < 2U ||
+             (map->src_height >> format->chroma_shift_y) < 2U))
+    {
+        status = LDC_STATUS_INVALID_ARGUMENT;
+    }
+    else
+    {
+        size_t size = (size_t)map->width * map->height;
+        uint32_t src_width = map->src_width;
+        uint32_t src_chroma_width = src_width >> format->chroma_shift_x;
+        float chroma_scale_x = 1.0f / (float)(1U << format->chroma_shift_x);
+        float chroma_scale_y = 1.0f / (float)(1U << format->chroma_shift_y);
+        uint32_t y;
+        uint32_t i;
+        uint32_t x;
+
+        plan->map = map;
+        plan->yuv_type = yuv_type;
+        plan->interpolation = interpolation;
+        plan->luma_offset = (uint32_t*)malloc(size * sizeof(uint32_t));
+        plan->chroma_offset = (uint32_t*)malloc(size * sizeof(uint32_t));
+
+        if(LDC_INTERPOLATION_BILINEAR == interpolation)
+        {
+            plan->luma_weight = (uint32_t*)malloc(size * sizeof(uint32_t));
+            plan->chroma_weight = (uint32_t*)malloc(size * sizeof(uint32_t));
+        }
+
+        if(NULL == plan->luma_offset || NULL == plan->chroma_offset ||
+           (LDC_INTERPOLATION_BILINEAR == interpolation &&
+            (NULL == plan->luma_weight || NULL == plan->chroma_weight)))
+        {
+            Remap_FreePlan(plan);
+            status = LDC_STATUS_OUT_OF_MEMORY;
+        }
+
+        /* Only entries inside of spans are computed, other entries are never read. */
+        for(y = 0;LDC_STATUS_OK == status && y < map->height;y++)
+        {
+            for(i = map->row_spans[y];i < map->row_spans[y + 1];i++)
+            {
+                for(x = map->spans[i].start;x < map->spans[i].end;x++)
+                {
+                    size_t k = (size_t)y * map->width + x;
+                    float h_d = map->h_d[k];
+                    float v_d = map->v_d[k];
+
+                    if(LDC_INTERPOLATION_NEAREST == interpolation)
+                    {
+                        uint32_t srcX = (uint32_t)(int32_t)(h_d + 0.5f);
+                        uint32_t srcY = (uint32_t)(int32_t)(v_d + 0.5f);
+
+                        plan->luma_offset[k] = srcY * src_width + srcX;
+                        plan->chroma_offset[k] = (srcY >> format->chroma_shift_y) *
+                                                 src_chroma_width +
+                                                 (srcX >> format->chroma_shift_x);
+                    }
+                    else
+                    {
+                        uint32_t x0;
+                        uint32_t y0;
+                        uint32_t wx;
+                        uint32_t wy;
+
+                        Remap_GetBilinearAxis(h_d, src_width, &x0, &wx);
+                        Remap_GetBilinearAxis(v_d, map->src_height, &y0, &wy);
+                        plan->luma_offset[k] = y0 * src_width + x0;
+                        plan->luma_weight[k] = wx | (wy << 16);
+
+                        Remap_GetBilinearAxis(h_d * chroma_scale_x, src_chroma_width, &x0, &wx);
+                        Remap_GetBilinearAxis(v_d * chroma_scale_y,
+                                              map->src_height >> format->chroma_shift_y,
+                                              &y0, &wy);
+                        plan->chroma_offset[k] = y0 * src_chroma_width + x0;
+                        plan->chroma_weight[k] = wx | (wy << 16);
+                    }
+                }
+            }
+        }
+    }
+
+    return status;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     Remap_ApplyPlan
+ *
+ * \brief  Remap Y, U, V components of frame with plan. Semantics are same as for
+ *         FrameCorrection_ApplyMap.
+ *
+ * \param  [In]  plan         Plan created with Remap_CreatePlan.
+ * \param  [Out] Y_out        Y component of undistorted frame, with resolution of map output.
+ * \param  [Out] U_out        U component of undistorted frame, with resolution of map output.
+ * \param  [Out] V_out        V component of undistorted frame, with resolution of map output.
+ * \param  [In]  Y            Y component of YUV frame, with resolution of map source.
+ * \param  [In]  U            U component of YUV frame, with resolution of map source.
+ * \param  [In]  V            V component of YUV frame, with resolution of map source.
+ * \param  [In]  rois         Regions of interest, or NULL for all regions computed in map.
+ * \param  [In]  num_of_rois  Number of regions of interest.
+ * \param  [In]  border       Border colour, or NULL to leave pixels without source untouched.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status Remap_ApplyPlan(const Remap_Plan* const plan, uint8_t* const Y_out,
+                           uint8_t* const U_out, uint8_t* const V_out, const uint8_t* const Y,
+                           const uint8_t* const U, const uint8_t* const V,
+                           const LDC_Roi* const rois, uint32_t num_of_rois,
+                           const LDC_Color* const border)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+
+    if(NULL == plan || NULL == plan->map || NULL == plan->luma_offset ||
+       NULL == Y_out || NULL == U_out || NULL == V_out ||
+       NULL == Y || NULL == U || NULL == V)
+    {
+        status = LDC_STATUS_INVALID_ARGUMENT;
+    }
+    else if(NULL != rois && FrameCorrection_ValidateRois(plan->map->width, plan->map->height,
+                                                         rois, num_of_rois))
+    {
+        status = LDC_STATUS_INVALID_ARGUMENT;
+    }
+    else
+    {
+        /* Kernels are selected once for frame. */
+        const Remap_Kernels* kernels = Remap_GetKernels(YuvFormat_Get(plan->yuv_type));
+        Remap_Frame frame;
+
+        frame.Y_out = Y_out;
+        frame.U_out = U_out;
+        frame.V_out = V_out;
+        frame.Y = Y;
+        frame.U = U;
+        frame.V = V;
+        frame.width = plan->map->width;
+        frame.src_width = plan->map->src_width;
+        frame.src_height = plan->map->src_height;
+        frame.map_width = plan->map->width;
+        frame.h_d = plan->map->h_d;
+        frame.v_d = plan->map->v_d;
+        frame.plan = plan;
+
+        Remap_ApplyRois(plan->map, &frame,
+                        (LDC_INTERPOLATION_BILINEAR == plan->interpolation) ?
+                        kernels->plan_bilinear : kernels->plan_nearest,
+                        kernels->fill, rois, num_of_rois, border);
+    }
+
+    return status;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     Remap_CropPlanSource
+ *
+ * \brief  Find source rows [first_row, end_row), that are read by plan, and rebase offsets of
+ *         plan to first of them, so plan remaps from components of these rows only. Rows start
+ *         and end at chroma row. Map of plan keeps positions in whole source frame.
+ *
+ * \param  [In]  plan         Plan created with Remap_CreatePlan.
+ * \param  [Out] first_row    First source row read by plan.
+ * \param  [Out] end_row      One past last source row read by plan, same as first_row when
+ *                            plan has no spans.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status Remap_CropPlanSource(Remap_Plan* plan, uint32_t* first_row, uint32_t* end_row)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+
+    if(NULL == plan || NULL == plan->map || NULL == plan->luma_offset || NULL == first_row ||
+       NULL == end_row)
+    {
+        status = LDC_STATUS_INVALID_ARGUMENT;
+    }
+    else
+    {
+        const LDC_Map* map = plan->map;
+        const YuvFormat* format = YuvFormat_Get(plan->yuv_type);
+        uint32_t src_chroma_width = map->src_width >> format->chroma_shift_x;
+        uint32_t chroma_rows = 1U << format->chroma_shift_y;
+        uint32_t next = (LDC_INTERPOLATION_BILINEAR == plan->interpolation) ? 1U : 0U;
+        uint32_t first = map->src_height;
+        uint32_t end = 0;
+        uint32_t luma_base;
+        uint32_t chroma_base;
+        uint32_t y;
+        uint32_t i;
+        uint32_t x;
+
+        /* Bilinear interpolation reads also next row of offset. */
+        for(y = 0;y < map->height;y++)
+        {
+            for(i = map->row_spans[y];i < map->row_spans[y + 1];i++)
+            {
+                for(x = map->spans[i].start;x < map->spans[i].end;x++)
+                {
+                    size_t k = (size_t)y * map->width + x;
+                    uint32_t luma_row = plan->luma_offset[k] / map->src_width;
+                    uint32_t chroma_row = plan->chroma_offset[k] / src_chroma_width;
+
+                    first = LDC_MIN(first, LDC_MIN(luma_row,
+                                                   chroma_row << format->chroma_shift_y));
+                    end = LDC_MAX(end, LDC_MAX(luma_row + next + 1U,
+                                               (chroma_row + next + 1U) <<
+                                               format->chroma_shift_y));
+                }
+            }
+        }
+
+        if(end <= first)
+        {
+            first = 0;
+            end = 0;
+        }
+
+        first -= first % chroma_rows;
+        end = LDC_MIN(end + (chroma_rows - end % chroma_rows) % chroma_rows, map->src_height);
+        luma_base = first * map->src_width;
+        chroma_base = (first >> format->chroma_shift_y) * src_chroma_width;
+
+        for(y = 0;0U != first && y < map->height;y++)
+        {
+            for(i = map->row_spans[y];i < map->row_spans[y + 1];i++)
+            {
+                for(x = map->spans[i].start;x < map->spans[i].end;x++)
+                {
+                    size_t k = (size_t)y * map->width + x;
+
+                    plan->luma_offset[k] -= luma_base;
+                    plan->chroma_offset[k] -= chroma_base;
+                }
+            }
+        }
+
+        *first_row = first;
+        *end_row = end;
+    }
+
+    return status;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     Remap_FreePlan
+ *
+ * \brief  Release memory of plan.
+ *
+ * \param  [In]  plan         Plan created with Remap_CreatePlan.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void Remap_FreePlan(Remap_Plan* plan)
+{
+    if(NULL != plan)
+    {
+        free(plan->luma_offset);
+        free(plan->chroma_offset);
+        free(plan->luma_weight);
+        free(plan->chroma_weight);
+        plan->luma_offset = NULL;
+        plan->chroma_offset = NULL;
+        plan->luma_weight = NULL;
+        plan->chroma_weight = NULL;
+    }
+}
@@ -0,0 +1,247 @@
+/**
+ ***************************************************************************************************
+ *
+ * \file  remap.h
+ *
+ * \brief This file contains API for remapping frames with map, with kernels specialized at
+ *        compile time for every layout of components and interpolation.
+ *
+ * \arg author:  Dejan Milojica
+ * \arg version: 1.2
+ * \arg date:    13.01.2021
+ *
+ ***************************************************************************************************
+ */
+
+#ifndef REMAP_H
+#define REMAP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================================== */
+/*                                       Include Files                                            */
+/* ============================================================================================== */
+
+#include <stdint.h>
+
+#include "../lib/ldc_types.h"
+#include "../lib/yuv_format.h"
+#include "../correction_distortion/correction_distortion.h"
+
+/* ============================================================================================== */
+/*                                     Macros & Typedefs                                          */
+/* ============================================================================================== */
+
+#define REMAP_WEIGHT_ONE (256U)                 /* Bilinear weight of whole pixel.             */
+
+/**
+ ***************************************************************************************************
+ *
+ * \typedef Remap_Plan
+ *
+ * \brief   Structure which represents map, prepared for one YUV format and interpolation.
+ *          Source offsets of every output pixel inside of map spans are precomputed, so remap
+ *          of pixel is one load per component (nearest), or four loads with precomputed
+ *          weights (bilinear). Plan refers to spans of its map, so map has to outlive plan.
+ *
+ ***************************************************************************************************
+ */
+typedef struct
+{
+    const LDC_Map* map;                         /* Map of plan.                           */
+    YUV_Type yuv_type;                          /* Type of YUV image.                     */
+    LDC_Interpolation interpolation;            /* Sampling of source frame.              */
+    uint32_t* luma_offset;                      /* Source Y offset of every output pixel. */
+    uint32_t* chroma_offset;                    /* Source U/V offset of every pixel.      */
+    uint32_t* luma_weight;                      /* Bilinear weights, x | y << 16.         */
+    uint32_t* chroma_weight;                    /* Bilinear weights of U/V, x | y << 16.  */
+}Remap_Plan;
+
+/**
+ ***************************************************************************************************
+ *
+ * \typedef Remap_Frame
+ *
+ * \brief   Structure which represents arguments of remap kernels, for one frame.
+ *
+ ***************************************************************************************************
+ */
+typedef struct
+{
+    uint8_t* Y_out;                             /* Y component of output frame.           */
+    uint8_t* U_out;                             /* U component of output frame.           */
+    uint8_t* V_out;                             /* V component of output frame.           */
+    const uint8_t* Y;                           /* Y component of source frame.           */
+    const uint8_t* U;                           /* U component of source frame.           */
+    const uint8_t* V;                           /* V component of source frame.           */
+    uint32_t width;                             /* Width of output frame.                 */
+    uint32_t src_width;                         /* Width of source frame.                 */
+    uint32_t src_height;                        /* Height of source frame.                */
+    uint32_t map_width;                         /* Row stride of positions and offsets.   */
+    const float* h_d;                           /* Horizontal source positions of map.    */
+    const float* v_d;                           /* Vertical source positions of map.      */
+    const Remap_Plan* plan;                     /* Plan, for precomputed kernels.         */
+}Remap_Frame;
+
+/* Remap pixels [x_begin, x_end) of output row y, that are inside of map span. */
+typedef void (*Remap_Kernel)(const Remap_Frame* const frame, uint32_t y, uint32_t x_begin,
+                             uint32_t x_end);
+
+/* Set pixels [x_begin, x_end) of output row y to border colour. */
+typedef void (*Remap_FillKernel)(const Remap_Frame* const frame, const LDC_Color* const border,
+                                 uint32_t y, uint32_t x_begin, uint32_t x_end);
+
+/**
+ ***************************************************************************************************
+ *
+ * \typedef Remap_Kernels
+ *
+ * \brief   Structure which represents kernels of one layout of components.
+ *
+ ***************************************************************************************************
+ */
+typedef struct
+{
+    Remap_FillKernel fill;                      /* Border fill.                           */
+    Remap_Kernel map_nearest;                   /* Nearest, positions from map.           */
+    Remap_Kernel map_bilinear;                  /* Bilinear, positions from map.          */
+    Remap_Kernel plan_nearest;                  /* Nearest, offsets from plan.            */
+    Remap_Kernel plan_bilinear;                 /* Bilinear, offsets from plan.           */
+}Remap_Kernels;
+
+/* ============================================================================================== */
+/*                                     Function Declarations                                      */
+/* ============================================================================================== */
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     Remap_GetKernels
+ *
+ * \brief  Get kernels specialized for sample size and chroma subsampling of format.
+ *
+ * \param  [In]  format       Layout of YUV format.
+ *
+ * \return const Remap_Kernels*   Kernels, or NULL when layout has no kernels.
+ *
+ ***************************************************************************************************
+ */
+const Remap_Kernels* Remap_GetKernels(const YuvFormat* const format);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     Remap_ApplyRois
+ *
+ * \brief  Remap regions of interest with kernels, selected once for frame. Pixels inside of
+ *         map spans are remapped, and other pixels are set to border colour, if fill kernel is
+ *         given.
+ *
+ * \param  [In]  map          Map with spans of valid positions.
+ * \param  [In]  frame        Arguments of kernels.
+ * \param  [In]  remap        Remap kernel.
+ * \param  [In]  fill         Fill kernel, or NULL to leave pixels without source untouched.
+ * \param  [In]  rois         Validated regions of interest, or NULL for regions of map.
+ * \param  [In]  num_of_rois  Number of regions of interest.
+ * \param  [In]  border       Border colour.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void Remap_ApplyRois(const LDC_Map* const map, const Remap_Frame* const frame, Remap_Kernel remap,
+                     Remap_FillKernel fill, const LDC_Roi* const rois, uint32_t num_of_rois,
+                     const LDC_Color* const border);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     Remap_CreatePlan
+ *
+ * \brief  Precompute source offsets, and bilinear weights, of every output pixel inside of map
+ *         spans, for YUV format and interpolation. Offsets are 32 bit indices of samples, so
+ *         source component has to have fewer than 2^32 samples.
+ *
+ * \param  [Out] plan         Created plan. Has to be released with Remap_FreePlan.
+ * \param  [In]  map          Generated map.
+ * \param  [In]  yuv_type     Type of YUV image.
+ * \param  [In]  interpolation  Sampling of source frame.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status Remap_CreatePlan(Remap_Plan* plan, const LDC_Map* const map, YUV_Type yuv_type,
+                            LDC_Interpolation interpolation);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     Remap_ApplyPlan
+ *
+ * \brief  Remap Y, U, V components of frame with plan. Semantics are same as for
+ *         FrameCorrection_ApplyMap.
+ *
+ * \param  [In]  plan         Plan created with Remap_CreatePlan.
+ * \param  [Out] Y_out        Y component of undistorted frame, with resolution of map output.
+ * \param  [Out] U_out        U component of undistorted frame, with resolution of map output.
+ * \param  [Out] V_out        V component of undistorted frame, with resolution of map output.
+ * \param  [In]  Y            Y component of YUV frame, with resolution of map source.
+ * \param  [In]  U            U component of YUV frame, with resolution of map source.
+ * \param  [In]  V            V component of YUV frame, with resolution of map source.
+ * \param  [In]  rois         Regions of interest, or NULL for all regions computed in map.
+ * \param  [In]  num_of_rois  Number of regions of interest.
+ * \param  [In]  border       Border colour, or NULL to leave pixels without source untouched.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status Remap_ApplyPlan(const Remap_Plan* const plan, uint8_t* const Y_out,
+                           uint8_t* const U_out, uint8_t* const V_out, const uint8_t* const Y,
+                           const uint8_t* const U, const uint8_t* const V,
+                           const LDC_Roi* const rois, uint32_t num_of_rois,
+                           const LDC_Color* const border);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     Remap_CropPlanSource
+ *
+ * \brief  Find source rows [first_row, end_row), that are read by plan, and rebase offsets of
+ *         plan to first of them, so plan remaps from components of these rows only. Rows start
+ *         and end at chroma row. Map of plan keeps positions in whole source frame.
+ *
+ * \param  [In]  plan         Plan created with Remap_CreatePlan.
+ * \param  [Out] first_row    First source row read by plan.
+ * \param  [Out] end_row      One past last source row read by plan, same as first_row when
+ *                            plan has no spans.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status Remap_CropPlanSource(Remap_Plan* plan, uint32_t* first_row, uint32_t* end_row);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     Remap_FreePlan
+ *
+ * \brief  Release memory of plan.
+ *
+ * \param  [In]  plan         Plan created with Remap_CreatePlan.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void Remap_FreePlan(Remap_Plan* plan);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
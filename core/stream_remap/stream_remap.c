@@ -0,0 +1,361 @@
+/**
+ ***************************************************************************************************
+ *
+ * \file  stream_remap.c
+ *
+ * \brief This file contains API of low-latency correction of frame, that arrives in chunks of
+ *        rows. Last source row, needed by every band of output rows, is computed once from
+ *        plan, and every band is remapped as soon as its source rows are received, instead of
+ *        waiting for whole source frame.
+ *
+ * \arg author:  Dejan Milojica
+ * \arg version: 1.2
+ * \arg date:    13.01.2021
+ *
+ ***************************************************************************************************
+ */
+
+/* ============================================================================================== */
+/*                                       Include Files                                            */
+/* ============================================================================================== */
+
+#include "stream_remap.h"
+#include "../lib/ldc_internal.h"
+#include "../lib/ldc_log.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* ============================================================================================== */
+/*                                     Macros & Typedefs                                          */
+/* ============================================================================================== */
+
+typedef struct
+{
+    const StreamRemap* stream;
+    uint32_t first_band;
+}StreamRemap_Task;
+
+/* ============================================================================================== */
+/*                              Internal Helper Functions                                         */
+/* ============================================================================================== */
+
+/* Source rows needed by output row, from offsets of plan. Bilinear reads also next row. */
+static uint32_t StreamRemap_GetRowSourceRows(const StreamRemap* const stream, uint32_t y)
+{
+    const Remap_Plan* plan = stream->plan;
+    const LDC_Map* map = plan->map;
+    uint32_t src_chroma_width = map->src_width >> stream->format->chroma_shift_x;
+    uint32_t next = (LDC_INTERPOLATION_BILINEAR == plan->interpolation) ? 2U : 1U;
+    uint32_t rows = 0;
+    uint32_t i;
+    uint32_t x;
+
+    for(i = map->row_spans[y];i < map->row_spans[y + 1];i++)
+    {
+        for(x = map->spans[i].start;x < map->spans[i].end;x++)
+        {
+            size_t k = (size_t)y * map->width + x;
+            uint32_t luma = plan->luma_offset[k] / map->src_width + next;
+            uint32_t chroma = (plan->chroma_offset[k] / src_chroma_width + next) <<
+                              stream->format->chroma_shift_y;
+
+            rows = LDC_MAX(rows, LDC_MAX(luma, chroma));
+        }
+    }
+
+    return LDC_MIN(rows, map->src_height);
+}
+
+static void StreamRemap_ApplyBand(void* arg, uint32_t index)
+{
+    const StreamRemap_Task* task = (const StreamRemap_Task*)arg;
+    const StreamRemap* stream = task->stream;
+    const LDC_Map* map = stream->plan->map;
+    uint32_t y_begin = (task->first_band + index) * stream->band_rows;
+    uint32_t y_end = LDC_MIN(y_begin + stream->band_rows, map->height);
+    uint32_t i;
+
+    /* Regions in same order as in Remap_ApplyPlan. Band starts and ends at chroma row, so
+       chroma row is written by same regions in same order. */
+    for(i = 0;i < map->num_of_rois;i++)
+    {
+        LDC_Roi roi = map->rois[i];
+        uint32_t roi_begin = LDC_MAX(roi.y, y_begin);
+        uint32_t roi_end = LDC_MIN(roi.y + roi.height, y_end);
+
+        if(roi_begin < roi_end)
+        {
+            roi.y = roi_begin;
+            roi.height = roi_end - roi_begin;
+            (void)Remap_ApplyPlan(stream->plan, stream->Y_out, stream->U_out, stream->V_out,
+                                  stream->Y, stream->U, stream->V, &roi, 1U, stream->border_ptr);
+        }
+    }
+}
+
+/* ============================================================================================== */
+
+/*                                     API Functions                                              */
+
+/* ============================================================================================== */
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     StreamRemap_Init
+ *
+ * \brief  Compute number of source rows, needed by every band of output rows of plan, and
+ *         allocate source frame of state.
+ *
+ * \param  [Out] stream       Created state. Has to be released with StreamRemap_Deinit.
+ * \param  [In]  plan         Remap plan, that outlives state.
+ * \param  [In]  band_rows    Output rows of band, multiple of chroma rows, or 0 for default.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status StreamRemap_Init(StreamRemap* stream, const Remap_Plan* const plan,
+                            uint32_t band_rows)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    const LDC_Map* map;
+    uint32_t chroma_rows;
+    uint32_t band;
+    uint32_t y;
+
+    if(NULL == stream)
+    {
+        return LDC_STATUS_INVALID_ARGUMENT;
+    }
+
+    memset(stream, 0, sizeof(StreamRemap));
+    band_rows = (0U == band_rows) ? STREAM_REMAP_BAND_ROWS : band_rows;
+
+    if(NULL == plan || NULL == plan->map || NULL == plan->luma_offset ||
+       NULL == YuvFormat_Get(plan->yuv_type))
+    {
+        status = LDC_STATUS_INVALID_ARGUMENT;
+        LdcLog_Write(LDC_LOG_ERROR, status, "Invalid remap plan of stream.");
+        return status;
+    }
+
+    map = plan->map;
+    stream->plan = plan;
+    stream->format = YuvFormat_Get(plan->yuv_type);
+    chroma_rows = 1U << stream->format->chroma_shift_y;
+
+    if(0U != band_rows % chroma_rows || 0U != map->src_height % chroma_rows)
+    {
+        status = LDC_STATUS_INVALID_ARGUMENT;
+        LdcLog_Write(LDC_LOG_ERROR, status, "Band of %u rows does not fit chroma rows.",
+                     band_rows);
+        return status;
+    }
+
+    stream->band_rows = band_rows;
+    stream->num_of_bands = (map->height + band_rows - 1U) / band_rows;
+    stream->luma_row_size = (size_t)map->src_width * stream->format->bytes_per_sample;
+    stream->chroma_row_size = (size_t)(map->src_width >> stream->format->chroma_shift_x) *
+                              stream->format->bytes_per_sample;
+    stream->source_rows = (uint32_t*)malloc(stream->num_of_bands * sizeof(uint32_t));
+    stream->Y = (uint8_t*)malloc(stream->luma_row_size * map->src_height);
+    stream->U = (uint8_t*)malloc(stream->chroma_row_size * (map->src_height / chroma_rows));
+    stream->V = (uint8_t*)malloc(stream->chroma_row_size * (map->src_height / chroma_rows));
+
+    if(NULL == stream->source_rows || NULL == stream->Y || NULL == stream->U ||
+       NULL == stream->V)
+    {
+        status = LDC_STATUS_OUT_OF_MEMORY;
+        LdcLog_Write(LDC_LOG_ERROR, status, "Allocation of stream failed.");
+        StreamRemap_Deinit(stream);
+        return status;
+    }
+
+    /* Bands are remapped in order, so band needs source rows of all bands before it. */
+    for(band = 0;band < stream->num_of_bands;band++)
+    {
+        uint32_t rows = (0U == band) ? 0U : stream->source_rows[band - 1U];
+
+        for(y = band * band_rows;y < LDC_MIN((band + 1U) * band_rows, map->height);y++)
+        {
+            rows = LDC_MAX(rows, StreamRemap_GetRowSourceRows(stream, y));
+        }
+
+        stream->source_rows[band] = rows;
+    }
+
+    return status;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     StreamRemap_GetSourceRows
+ *
+ * \brief  Get number of source rows, that have to be received before output rows
+ *         [0, (band + 1) * band_rows) are remapped.
+ *
+ * \param  [In]  stream       State of streamed correction.
+ * \param  [In]  band         Output band.
+ *
+ * \return uint32_t     Source rows, or 0 for invalid band.
+ *
+ ***************************************************************************************************
+ */
+uint32_t StreamRemap_GetSourceRows(const StreamRemap* const stream, uint32_t band)
+{
+    return (NULL == stream || NULL == stream->source_rows || band >= stream->num_of_bands) ?
+           0U : stream->source_rows[band];
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     StreamRemap_Begin
+ *
+ * \brief  Start new frame. Output components have to stay valid until last band is remapped.
+ *
+ * \param  [In]  stream       State of streamed correction.
+ * \param  [Out] Y_out        Y component of output frame, with resolution of map output.
+ * \param  [Out] U_out        U component of output frame, with resolution of map output.
+ * \param  [Out] V_out        V component of output frame, with resolution of map output.
+ * \param  [In]  border       Border colour, or NULL to leave pixels without source untouched.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status StreamRemap_Begin(StreamRemap* stream, uint8_t* const Y_out, uint8_t* const U_out,
+                             uint8_t* const V_out, const LDC_Color* const border)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+
+    if(NULL == stream || NULL == stream->source_rows || NULL == Y_out || NULL == U_out ||
+       NULL == V_out)
+    {
+        status = LDC_STATUS_INVALID_ARGUMENT;
+        LdcLog_Write(LDC_LOG_ERROR, status, "Invalid stream or output frame.");
+    }
+    else
+    {
+        stream->Y_out = Y_out;
+        stream->U_out = U_out;
+        stream->V_out = V_out;
+        stream->border_ptr = NULL;
+        stream->received_rows = 0;
+        stream->next_band = 0;
+
+        if(NULL != border)
+        {
+            stream->border = *border;
+            stream->border_ptr = &stream->border;
+        }
+    }
+
+    return status;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     StreamRemap_PushRows
+ *
+ * \brief  Receive next chunk of source rows, and remap every band, whose source rows are all
+ *         received. Output is same as output of Remap_ApplyPlan for all regions of map.
+ *
+ * \param  [In]  stream       State of streamed correction.
+ * \param  [In]  Y            Y component of chunk, of num_of_rows rows.
+ * \param  [In]  U            U component of chunk, of chroma rows of chunk.
+ * \param  [In]  V            V component of chunk, of chroma rows of chunk.
+ * \param  [In]  num_of_rows  Source rows of chunk, multiple of chroma rows.
+ * \param  [In]  pool         Worker pool that remaps ready bands in parallel, or NULL.
+ * \param  [Out] output_rows  Output rows, that are final after chunk, or NULL.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status StreamRemap_PushRows(StreamRemap* stream, const uint8_t* const Y,
+                                const uint8_t* const U, const uint8_t* const V,
+                                uint32_t num_of_rows, WorkerPool* pool, uint32_t* output_rows)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    StreamRemap_Task task;
+    uint32_t shift_y;
+    uint32_t ready;
+
+    if(NULL == stream || NULL == stream->Y_out || NULL == Y || NULL == U || NULL == V)
+    {
+        status = LDC_STATUS_INVALID_ARGUMENT;
+        LdcLog_Write(LDC_LOG_ERROR, status, "Invalid stream, frame is not started.");
+        return status;
+    }
+
+    shift_y = stream->format->chroma_shift_y;
+
+    if(0U != num_of_rows % (1U << shift_y) ||
+       num_of_rows > stream->plan->map->src_height - stream->received_rows)
+    {
+        status = LDC_STATUS_INVALID_ARGUMENT;
+        LdcLog_Write(LDC_LOG_ERROR, status, "Chunk of %u rows after %u received rows.",
+                     num_of_rows, stream->received_rows);
+        return status;
+    }
+
+    memcpy(stream->Y + stream->luma_row_size * stream->received_rows, Y,
+           stream->luma_row_size * num_of_rows);
+    memcpy(stream->U + stream->chroma_row_size * (stream->received_rows >> shift_y), U,
+           stream->chroma_row_size * (num_of_rows >> shift_y));
+    memcpy(stream->V + stream->chroma_row_size * (stream->received_rows >> shift_y), V,
+           stream->chroma_row_size * (num_of_rows >> shift_y));
+    stream->received_rows += num_of_rows;
+
+    /* Bands, whose source rows are received, are independent of each other. */
+    ready = stream->next_band;
+
+    while(ready < stream->num_of_bands && stream->source_rows[ready] <= stream->received_rows)
+    {
+        ready++;
+    }
+
+    if(ready > stream->next_band)
+    {
+        task.stream = stream;
+        task.first_band = stream->next_band;
+        WorkerPool_Run(pool, StreamRemap_ApplyBand, &task, ready - stream->next_band);
+        stream->next_band = ready;
+    }
+
+    if(NULL != output_rows)
+    {
+        *output_rows = LDC_MIN(stream->next_band * stream->band_rows, stream->plan->map->height);
+    }
+
+    return status;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     StreamRemap_Deinit
+ *
+ * \brief  Release memory of state.
+ *
+ * \param  [In]  stream       State of streamed correction.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void StreamRemap_Deinit(StreamRemap* stream)
+{
+    if(NULL != stream)
+    {
+        free(stream->source_rows);
+        free(stream->Y);
+        free(stream->U);
+        free(stream->V);
+        memset(stream, 0, sizeof(StreamRemap));
+    }
+}
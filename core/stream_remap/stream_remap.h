@@ -0,0 +1,178 @@
+/**
+ ***************************************************************************************************
+ *
+ * \file  stream_remap.h
+ *
+ * \brief This file contains API of low-latency correction of frame, that arrives in chunks of
+ *        rows. Last source row, needed by every band of output rows, is computed once from
+ *        plan, and every band is remapped as soon as its source rows are received, instead of
+ *        waiting for whole source frame.
+ *
+ * \arg author:  Dejan Milojica
+ * \arg version: 1.2
+ * \arg date:    13.01.2021
+ *
+ ***************************************************************************************************
+ */
+
+#ifndef STREAM_REMAP_H
+#define STREAM_REMAP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================================== */
+/*                                       Include Files                                            */
+/* ============================================================================================== */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "../lib/ldc_types.h"
+#include "../lib/yuv_format.h"
+#include "../remap/remap.h"
+#include "../worker_pool/worker_pool.h"
+
+/* ============================================================================================== */
+/*                                     Macros & Typedefs                                          */
+/* ============================================================================================== */
+
+#define STREAM_REMAP_BAND_ROWS (16U)            /* Default output rows, remapped together.     */
+
+/**
+ ***************************************************************************************************
+ *
+ * \typedef StreamRemap
+ *
+ * \brief   Structure which represents state of streamed correction, for one remap plan. Source
+ *          rows are copied into source frame of state as they arrive, and output bands are
+ *          remapped in order, so output rows [0, output_rows) are final at any time.
+ *
+ ***************************************************************************************************
+ */
+typedef struct
+{
+    const Remap_Plan* plan;                     /* Remap plan, with its map.              */
+    const YuvFormat* format;                    /* Layout of components.                  */
+    uint32_t band_rows;                         /* Output rows of band.                   */
+    uint32_t num_of_bands;                      /* Output bands of frame.                 */
+    uint32_t* source_rows;                      /* Source rows needed by bands [0, band]. */
+    uint8_t* Y;                                 /* Source frame, filled by chunks.        */
+    uint8_t* U;
+    uint8_t* V;
+    size_t luma_row_size;                       /* Bytes of source Y row.                 */
+    size_t chroma_row_size;                     /* Bytes of source U or V row.            */
+    uint8_t* Y_out;                             /* Output frame of current frame.         */
+    uint8_t* U_out;
+    uint8_t* V_out;
+    LDC_Color border;                           /* Border colour of current frame.        */
+    const LDC_Color* border_ptr;                /* Border, or NULL to leave pixels.       */
+    uint32_t received_rows;                     /* Source rows of current frame.          */
+    uint32_t next_band;                         /* First band, that is not remapped.      */
+}StreamRemap;
+
+/* ============================================================================================== */
+/*                                     Function Declarations                                      */
+/* ============================================================================================== */
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     StreamRemap_Init
+ *
+ * \brief  Compute number of source rows, needed by every band of output rows of plan, and
+ *         allocate source frame of state.
+ *
+ * \param  [Out] stream       Created state. Has to be released with StreamRemap_Deinit.
+ * \param  [In]  plan         Remap plan, that outlives state.
+ * \param  [In]  band_rows    Output rows of band, multiple of chroma rows, or 0 for default.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status StreamRemap_Init(StreamRemap* stream, const Remap_Plan* const plan,
+                            uint32_t band_rows);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     StreamRemap_GetSourceRows
+ *
+ * \brief  Get number of source rows, that have to be received before output rows
+ *         [0, (band + 1) * band_rows) are remapped.
+ *
+ * \param  [In]  stream       State of streamed correction.
+ * \param  [In]  band         Output band.
+ *
+ * \return uint32_t     Source rows, or 0 for invalid band.
+ *
+ ***************************************************************************************************
+ */
+uint32_t StreamRemap_GetSourceRows(const StreamRemap* const stream, uint32_t band);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     StreamRemap_Begin
+ *
+ * \brief  Start new frame. Output components have to stay valid until last band is remapped.
+ *
+ * \param  [In]  stream       State of streamed correction.
+ * \param  [Out] Y_out        Y component of output frame, with resolution of map output.
+ * \param  [Out] U_out        U component of output frame, with resolution of map output.
+ * \param  [Out] V_out        V component of output frame, with resolution of map output.
+ * \param  [In]  border       Border colour, or NULL to leave pixels without source untouched.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status StreamRemap_Begin(StreamRemap* stream, uint8_t* const Y_out, uint8_t* const U_out,
+                             uint8_t* const V_out, const LDC_Color* const border);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     StreamRemap_PushRows
+ *
+ * \brief  Receive next chunk of source rows, and remap every band, whose source rows are all
+ *         received. Output is same as output of Remap_ApplyPlan for all regions of map.
+ *
+ * \param  [In]  stream       State of streamed correction.
+ * \param  [In]  Y            Y component of chunk, of num_of_rows rows.
+ * \param  [In]  U            U component of chunk, of chroma rows of chunk.
+ * \param  [In]  V            V component of chunk, of chroma rows of chunk.
+ * \param  [In]  num_of_rows  Source rows of chunk, multiple of chroma rows.
+ * \param  [In]  pool         Worker pool that remaps ready bands in parallel, or NULL.
+ * \param  [Out] output_rows  Output rows, that are final after chunk, or NULL.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status StreamRemap_PushRows(StreamRemap* stream, const uint8_t* const Y,
+                                const uint8_t* const U, const uint8_t* const V,
+                                uint32_t num_of_rows, WorkerPool* pool, uint32_t* output_rows);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     StreamRemap_Deinit
+ *
+ * \brief  Release memory of state.
+ *
+ * \param  [In]  stream       State of streamed correction.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void StreamRemap_Deinit(StreamRemap* stream);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
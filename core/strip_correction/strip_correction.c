@@ -0,0 +1,451 @@
+/**
+ ***************************************************************************************************
+ *
+ * \file  strip_correction.c
+ *
+ * \brief This file contains API for correction of very large raw YUV files, strip by strip of
+ *        output rows. Map of every strip is generated and planned alone, and only source rows,
+ *        that plan of strip reads, are loaded from input file, so memory depends on width of
+ *        frame and height of strip, not on size of frame.
+ *
+ * \arg author:  Dejan Milojica
+ * \arg version: 1.2
+ * \arg date:    13.01.2021
+ *
+ ***************************************************************************************************
+ */
+
+/* ============================================================================================== */
+/*                                       Include Files                                            */
+/* ============================================================================================== */
+
+/* 64 bit file offsets, for frames larger than 2 GB also on 32 bit systems. */
+#define _FILE_OFFSET_BITS 64
+
+#include "strip_correction.h"
+#include "../lib/ldc_internal.h"
+#include "../lib/ldc_log.h"
+#include "../lib/yuv_format.h"
+#include "../remap/remap.h"
+#include "../read_save_YUV/read_save_YUV.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+
+/* ============================================================================================== */
+/*                                     Macros & Typedefs                                          */
+/* ============================================================================================== */
+
+#define STRIP_SOURCE_SIZE_ERROR_MESSAGE (\
+    "Error, size of source file is not size of frame.")
+
+typedef struct
+{
+    uint8_t* data;
+    size_t size;
+}StripCorrection_Buffer;
+
+typedef struct
+{
+    FILE* in_fp;
+    FILE* out_fp;
+    FILE* mask_fp;
+    const YuvFormat* format;
+    uint32_t width;                             /* Source frame.                          */
+    uint32_t height;
+    uint32_t out_width;                         /* Output frame.                          */
+    uint32_t out_height;
+    const LensProfile* lens;
+    const LDC_OutputSpec* output;
+    const LDC_Roi* rois;
+    uint32_t num_of_rois;
+    LDC_Roi* strip_rois;                        /* Regions, clipped to current strip.     */
+    const LDC_Color* border;
+    LDC_Interpolation interpolation;
+    WorkerPool* pool;
+    StripCorrection_Buffer source;              /* Source rows of strip, as read.         */
+    StripCorrection_Buffer source_Y;            /* Source rows of strip, split.           */
+    StripCorrection_Buffer source_U;
+    StripCorrection_Buffer source_V;
+    StripCorrection_Buffer strip;               /* Output rows of strip, combined.        */
+    StripCorrection_Buffer strip_Y;             /* Output rows of strip, remapped.        */
+    StripCorrection_Buffer strip_U;
+    StripCorrection_Buffer strip_V;
+    StripCorrection_Buffer mask;                /* Validity mask of strip.                */
+    StripCorrection_Stats stats;
+}StripCorrection_State;
+
+/* ============================================================================================== */
+/*                              Internal Helper Functions                                         */
+/* ============================================================================================== */
+
+/* Buffers only grow, so strips after largest one do not allocate. */
+static LDC_Status StripCorrection_Reserve(StripCorrection_State* state,
+                                          StripCorrection_Buffer* buffer, size_t size)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+
+    if(size > buffer->size)
+    {
+        uint8_t* data = (uint8_t*)realloc(buffer->data, size);
+
+        if(NULL == data)
+        {
+            status = LDC_STATUS_OUT_OF_MEMORY;
+        }
+        else
+        {
+            state->stats.peak_buffer_size += size - buffer->size;
+            buffer->data = data;
+            buffer->size = size;
+        }
+    }
+
+    return status;
+}
+
+/* Reserve separate components of frame of width x rows. */
+static LDC_Status StripCorrection_ReserveComponents(StripCorrection_State* state,
+                                                    StripCorrection_Buffer* Y,
+                                                    StripCorrection_Buffer* U,
+                                                    StripCorrection_Buffer* V,
+                                                    uint32_t width, uint32_t rows)
+{
+    YUV_Type yuv_type = state->format->yuv_type;
+    size_t luma_size = (size_t)width * rows * state->format->bytes_per_sample;
+    size_t chroma_size = (size_t)YuvFormat_GetChromaWidth(width, yuv_type) *
+                         YuvFormat_GetChromaHeight(rows, yuv_type) *
+                         state->format->bytes_per_sample;
+
+    return (StripCorrection_Reserve(state, Y, luma_size) ||
+            StripCorrection_Reserve(state, U, chroma_size) ||
+            StripCorrection_Reserve(state, V, chroma_size)) ? LDC_STATUS_OUT_OF_MEMORY :
+                                                              LDC_STATUS_OK;
+}
+
+/* Clip regions to output rows [y0, y0 + rows), in same order, relative to strip. */
+static uint32_t StripCorrection_ClipRois(StripCorrection_State* state, uint32_t y0,
+                                         uint32_t rows)
+{
+    uint32_t num_of_rois = 0;
+    uint32_t i;
+
+    for(i = 0;i < state->num_of_rois;i++)
+    {
+        const LDC_Roi* roi = &state->rois[i];
+        uint32_t top = LDC_MAX(roi->y, y0);
+        uint32_t bottom = LDC_MIN(roi->y + roi->height, y0 + rows);
+
+        if(top < bottom)
+        {
+            state->strip_rois[num_of_rois].x = roi->x;
+            state->strip_rois[num_of_rois].y = top - y0;
+            state->strip_rois[num_of_rois].width = roi->width;
+            state->strip_rois[num_of_rois].height = bottom - top;
+            num_of_rois++;
+        }
+    }
+
+    return num_of_rois;
+}
+
+/* Remap output rows [y0, y0 + rows) into strip components, from source rows of their plan. */
+static LDC_Status StripCorrection_RemapStrip(StripCorrection_State* state, uint32_t y0,
+                                             uint32_t rows, uint32_t num_of_rois)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    LDC_Map map;
+    Remap_Plan plan;
+    uint32_t chroma_rows = 1U << state->format->chroma_shift_y;
+    uint32_t first_row = 0;
+    uint32_t end_row = 0;
+
+    if(FrameCorrection_GenerateStripMap(&map, state->width, state->height, state->output, y0,
+                                        rows, (NULL == state->rois) ? NULL : state->strip_rois,
+                                        num_of_rois, state->lens, state->pool))
+    {
+        status = LDC_STATUS_ERROR;
+    }
+    else
+    {
+        if(Remap_CreatePlan(&plan, &map, state->format->yuv_type, state->interpolation))
+        {
+            status = LDC_STATUS_ERROR;
+        }
+        else
+        {
+            /* Plan of strip reads only these rows, so only they are loaded. */
+            if(Remap_CropPlanSource(&plan, &first_row, &end_row))
+            {
+                status = LDC_STATUS_ERROR;
+            }
+            /* Strip without valid pixels reads nothing, but components must exist. */
+            else if(StripCorrection_ReserveComponents(state, &state->source_Y,
+                                                      &state->source_U, &state->source_V,
+                                                      state->width,
+                                                      LDC_MAX(end_row - first_row,
+                                                              chroma_rows)) ||
+                    StripCorrection_Reserve(state, &state->source,
+                                            YuvFormat_GetFrameSize(state->width,
+                                                                   end_row - first_row,
+                                                                   state->format->yuv_type)))
+            {
+                status = LDC_STATUS_OUT_OF_MEMORY;
+            }
+            else if(end_row > first_row &&
+                    FileOperation_ReadRawYUVRows(state->in_fp, state->format, state->width,
+                                                 state->height, first_row, end_row,
+                                                 state->source.data))
+            {
+                status = LDC_STATUS_FILE_ERROR;
+            }
+            else
+            {
+                if(end_row > first_row)
+                {
+                    YuvFormat_Split(state->format, state->source.data, state->source_Y.data,
+                                    state->source_U.data, state->source_V.data, state->width,
+                                    end_row - first_row);
+                }
+
+                state->stats.max_source_rows = LDC_MAX(state->stats.max_source_rows,
+                                                       end_row - first_row);
+
+                if(Remap_ApplyPlan(&plan, state->strip_Y.data, state->strip_U.data,
+                                   state->strip_V.data, state->source_Y.data,
+                                   state->source_U.data, state->source_V.data, NULL, 0,
+                                   state->border))
+                {
+                    status = LDC_STATUS_ERROR;
+                }
+                else if(NULL != state->mask_fp &&
+                        FrameCorrection_GetValidityMask(&map, state->mask.data))
+                {
+                    status = LDC_STATUS_ERROR;
+                }
+            }
+
+            Remap_FreePlan(&plan);
+        }
+
+        FrameCorrection_FreeMap(&map);
+    }
+
+    return status;
+}
+
+/* Correct output rows [y0, y0 + rows), and write them into output files. */
+static LDC_Status StripCorrection_CorrectStrip(StripCorrection_State* state, uint32_t y0,
+                                               uint32_t rows)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    uint32_t num_of_rois = (NULL == state->rois) ? 1U :
+                           StripCorrection_ClipRois(state, y0, rows);
+    size_t mask_size = (size_t)rows * VALIDITY_MASK_STRIDE(state->out_width);
+
+    /* With regions of interest, rest of frame is set to zero. */
+    memset(state->strip_Y.data, 0, state->strip_Y.size);
+    memset(state->strip_U.data, 0, state->strip_U.size);
+    memset(state->strip_V.data, 0, state->strip_V.size);
+    memset(state->mask.data, 0, state->mask.size);
+
+    if(0U != num_of_rois)
+    {
+        status = StripCorrection_RemapStrip(state, y0, rows, num_of_rois);
+    }
+
+    if(LDC_STATUS_OK == status)
+    {
+        YuvFormat_Combine(state->format, state->strip.data, state->strip_Y.data,
+                          state->strip_U.data, state->strip_V.data, state->out_width, rows);
+
+        if(FileOperation_SaveRawYUVRows(state->out_fp, state->format, state->out_width,
+                                        state->out_height, y0, y0 + rows, state->strip.data))
+        {
+            status = LDC_STATUS_FILE_ERROR;
+        }
+        else if(NULL != state->mask_fp &&
+                (0 != fseeko(state->mask_fp,
+                             (off_t)y0 * VALIDITY_MASK_STRIDE(state->out_width), SEEK_SET) ||
+                 mask_size != fwrite(state->mask.data, 1, mask_size, state->mask_fp)))
+        {
+            status = LDC_STATUS_FILE_ERROR;
+        }
+    }
+
+    return status;
+}
+
+/* Check that size of opened source file is size of frame. */
+static LDC_Status StripCorrection_CheckSourceSize(StripCorrection_State* state)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    size_t expected_size = YuvFormat_GetFrameSize(state->width, state->height,
+                                                  state->format->yuv_type);
+
+    if(0 != fseeko(state->in_fp, 0, SEEK_END) ||
+       (off_t)expected_size != ftello(state->in_fp))
+    {
+        status = LDC_STATUS_FILE_ERROR;
+        LdcLog_Write(LDC_LOG_ERROR, status, STRIP_SOURCE_SIZE_ERROR_MESSAGE);
+    }
+
+    return status;
+}
+
+/* ============================================================================================== */
+
+/*                                     API Functions                                              */
+
+/* ============================================================================================== */
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     StripCorrection_CorrectFile
+ *
+ * \brief  Correct raw YUV file into raw YUV file, strip by strip. Output file (and mask file)
+ *         is same as output of FrameCorrection_CorrectLensDistortion for whole frame.
+ *
+ * \param  [In]  input_filename   Raw YUV file of source frame.
+ * \param  [In]  output_filename  Raw YUV file of output frame.
+ * \param  [In]  mask_filename    Validity mask file (see FrameCorrection_GetValidityMask), or
+ *                                NULL when mask is not needed.
+ * \param  [In]  width            Width of source frame.
+ * \param  [In]  height           Height of source frame.
+ * \param  [In]  yuv_type         Type of YUV image.
+ * \param  [In]  lens             Lens profile.
+ * \param  [In]  output           Output frame specification, or NULL for output same as input.
+ * \param  [In]  rois             Regions of interest, or NULL for whole frame. Pixels outside
+ *                                of regions are set to zero.
+ * \param  [In]  num_of_rois      Number of regions of interest.
+ * \param  [In]  border           Colour of pixels without valid source pixel.
+ * \param  [In]  interpolation    Sampling of source frame.
+ * \param  [In]  strip_rows       Output rows of strip, multiple of chroma rows, or 0 for
+ *                                default.
+ * \param  [In]  pool             Worker pool that generates maps of strips, or NULL.
+ * \param  [Out] stats            Memory use of correction, or NULL.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status StripCorrection_CorrectFile(const char* const input_filename,
+                                       const char* const output_filename,
+                                       const char* const mask_filename, uint32_t width,
+                                       uint32_t height, YUV_Type yuv_type,
+                                       const LensProfile* const lens,
+                                       const LDC_OutputSpec* const output,
+                                       const LDC_Roi* const rois, uint32_t num_of_rois,
+                                       const LDC_Color* const border,
+                                       LDC_Interpolation interpolation, uint32_t strip_rows,
+                                       WorkerPool* pool, StripCorrection_Stats* stats)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    StripCorrection_State state;
+    uint32_t chroma_rows;
+
+    memset(&state, 0, sizeof(StripCorrection_State));
+    state.format = YuvFormat_Get(yuv_type);
+    state.width = width;
+    state.height = height;
+    state.out_width = (NULL == output) ? width : output->width;
+    state.out_height = (NULL == output) ? height : output->height;
+    state.lens = lens;
+    state.output = output;
+    state.rois = rois;
+    state.num_of_rois = num_of_rois;
+    state.border = border;
+    state.interpolation = interpolation;
+    state.pool = pool;
+    strip_rows = (0U == strip_rows) ? STRIP_CORRECTION_ROWS : strip_rows;
+    chroma_rows = (NULL == state.format) ? 1U : 1U << state.format->chroma_shift_y;
+
+    /* Source, output and strips have to be multiples of chroma subsampling of format. */
+    if(NULL == input_filename || NULL == output_filename || NULL == lens || NULL == border ||
+       YuvFormat_ValidateSize(state.format, width, height) ||
+       YuvFormat_ValidateSize(state.format, state.out_width, state.out_height) ||
+       0U != strip_rows % chroma_rows)
+    {
+        status = LDC_STATUS_INVALID_ARGUMENT;
+    }
+    else if(NULL != rois && FrameCorrection_ValidateRois(state.out_width, state.out_height,
+                                                         rois, num_of_rois))
+    {
+        status = LDC_STATUS_INVALID_ARGUMENT;
+    }
+    else
+    {
+        strip_rows = LDC_MIN(strip_rows, state.out_height);
+        state.in_fp = fopen(input_filename, "rb");
+        state.out_fp = fopen(output_filename, "wb");
+        state.mask_fp = (NULL == mask_filename) ? NULL : fopen(mask_filename, "wb");
+        state.strip_rois = (NULL == rois) ? NULL :
+                           (LDC_Roi*)malloc(LDC_MAX(num_of_rois, 1U) * sizeof(LDC_Roi));
+
+        if(NULL == state.in_fp || NULL == state.out_fp ||
+           (NULL != mask_filename && NULL == state.mask_fp))
+        {
+            status = LDC_STATUS_FILE_ERROR;
+        }
+        else if((NULL != rois && NULL == state.strip_rois) ||
+                StripCorrection_ReserveComponents(&state, &state.strip_Y, &state.strip_U,
+                                                  &state.strip_V, state.out_width,
+                                                  strip_rows) ||
+                StripCorrection_Reserve(&state, &state.strip,
+                                        YuvFormat_GetFrameSize(state.out_width, strip_rows,
+                                                               yuv_type)) ||
+                StripCorrection_Reserve(&state, &state.mask,
+                                        (size_t)strip_rows *
+                                        VALIDITY_MASK_STRIDE(state.out_width)))
+        {
+            status = LDC_STATUS_OUT_OF_MEMORY;
+        }
+        else
+        {
+            uint32_t y0;
+
+            status = StripCorrection_CheckSourceSize(&state);
+
+            for(y0 = 0;LDC_STATUS_OK == status && y0 < state.out_height;y0 += strip_rows)
+            {
+                status = StripCorrection_CorrectStrip(&state, y0,
+                                                      LDC_MIN(strip_rows,
+                                                              state.out_height - y0));
+                state.stats.num_of_strips++;
+            }
+        }
+
+        if(NULL != state.in_fp)
+        {
+            fclose(state.in_fp);
+        }
+        if(NULL != state.out_fp && 0 != fclose(state.out_fp) && LDC_STATUS_OK == status)
+        {
+            status = LDC_STATUS_FILE_ERROR;
+        }
+        if(NULL != state.mask_fp && 0 != fclose(state.mask_fp) && LDC_STATUS_OK == status)
+        {
+            status = LDC_STATUS_FILE_ERROR;
+        }
+
+        free(state.strip_rois);
+        free(state.source.data);
+        free(state.source_Y.data);
+        free(state.source_U.data);
+        free(state.source_V.data);
+        free(state.strip.data);
+        free(state.strip_Y.data);
+        free(state.strip_U.data);
+        free(state.strip_V.data);
+        free(state.mask.data);
+    }
+
+    if(NULL != stats)
+    {
+        *stats = state.stats;
+    }
+
+    return status;
+}
@@ -0,0 +1,108 @@
+/**
+ ***************************************************************************************************
+ *
+ * \file  strip_correction.h
+ *
+ * \brief This file contains API for correction of very large raw YUV files, strip by strip of
+ *        output rows. Map of every strip is generated and planned alone, and only source rows,
+ *        that plan of strip reads, are loaded from input file, so memory depends on width of
+ *        frame and height of strip, not on size of frame.
+ *
+ * \arg author:  Dejan Milojica
+ * \arg version: 1.2
+ * \arg date:    13.01.2021
+ *
+ ***************************************************************************************************
+ */
+
+#ifndef STRIP_CORRECTION_H
+#define STRIP_CORRECTION_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================================== */
+/*                                       Include Files                                            */
+/* ============================================================================================== */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "../lib/ldc_types.h"
+#include "../correction_distortion/correction_distortion.h"
+#include "../worker_pool/worker_pool.h"
+
+/* ============================================================================================== */
+/*                                     Macros & Typedefs                                          */
+/* ============================================================================================== */
+
+#define STRIP_CORRECTION_ROWS (64U)             /* Default output rows of strip.               */
+
+/**
+ ***************************************************************************************************
+ *
+ * \typedef StripCorrection_Stats
+ *
+ * \brief   Structure which represents memory use of strip correction.
+ *
+ ***************************************************************************************************
+ */
+typedef struct
+{
+    uint32_t num_of_strips;                     /* Strips of output frame.                */
+    uint32_t max_source_rows;                   /* Most source rows, read for one strip.  */
+    size_t peak_buffer_size;                    /* Bytes of frame buffers, at most.       */
+}StripCorrection_Stats;
+
+/* ============================================================================================== */
+/*                                     Function Declarations                                      */
+/* ============================================================================================== */
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     StripCorrection_CorrectFile
+ *
+ * \brief  Correct raw YUV file into raw YUV file, strip by strip. Output file (and mask file)
+ *         is same as output of FrameCorrection_CorrectLensDistortion for whole frame.
+ *
+ * \param  [In]  input_filename   Raw YUV file of source frame.
+ * \param  [In]  output_filename  Raw YUV file of output frame.
+ * \param  [In]  mask_filename    Validity mask file (see FrameCorrection_GetValidityMask), or
+ *                                NULL when mask is not needed.
+ * \param  [In]  width            Width of source frame.
+ * \param  [In]  height           Height of source frame.
+ * \param  [In]  yuv_type         Type of YUV image.
+ * \param  [In]  lens             Lens profile.
+ * \param  [In]  output           Output frame specification, or NULL for output same as input.
+ * \param  [In]  rois             Regions of interest, or NULL for whole frame. Pixels outside
+ *                                of regions are set to zero.
+ * \param  [In]  num_of_rois      Number of regions of interest.
+ * \param  [In]  border           Colour of pixels without valid source pixel.
+ * \param  [In]  interpolation    Sampling of source frame.
+ * \param  [In]  strip_rows       Output rows of strip, multiple of chroma rows, or 0 for
+ *                                default.
+ * \param  [In]  pool             Worker pool that generates maps of strips, or NULL.
+ * \param  [Out] stats            Memory use of correction, or NULL.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status StripCorrection_CorrectFile(const char* const input_filename,
+                                       const char* const output_filename,
+                                       const char* const mask_filename, uint32_t width,
+                                       uint32_t height, YUV_Type yuv_type,
+                                       const LensProfile* const lens,
+                                       const LDC_OutputSpec* const output,
+                                       const LDC_Roi* const rois, uint32_t num_of_rois,
+                                       const LDC_Color* const border,
+                                       LDC_Interpolation interpolation, uint32_t strip_rows,
+                                       WorkerPool* pool, StripCorrection_Stats* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,420 @@
+/**
+ ***************************************************************************************************
+ *
+ * \file  virtual_camera.c
+ *
+ * \brief This file contains API for virtual camera (pan/tilt/zoom) views of fisheye frame.
+ *        Virtual camera is rectilinear camera in optical centre of lens, rotated by yaw, pitch
+ *        and roll, with its own field of view and output resolution. Map of view is regenerated
+ *        for every pose, so view can follow tracked object frame by frame.
+ *
+ * \arg author:  Dejan Milojica
+ * \arg version: 1.2
+ * \arg date:    13.01.2021
+ *
+ ***************************************************************************************************
+ */
+
+/* ============================================================================================== */
+/*                                       Include Files                                            */
+/* ============================================================================================== */
+
+#include "virtual_camera.h"
+#include "../lib/ldc_internal.h"
+#include "../lib/ldc_log.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define VIRTUAL_CAMERA_X86 (1)
+#include <immintrin.h>
+#endif
+
+/* ============================================================================================== */
+/*                              Internal Helper Functions                                         */
+/* ============================================================================================== */
+
+/* Same test as in FrameCorrection_UpdateSpans, rounded position is inside of source frame. */
+static int32_t VirtualCamera_IsValidPosition(float h_d, float v_d, float width, float height)
+{
+    return (h_d + 0.5f > -1.0f) && (h_d + 0.5f < width) &&
+           (v_d + 0.5f > -1.0f) && (v_d + 0.5f < height);
+}
+
+#ifdef VIRTUAL_CAMERA_X86
+
+/* Skip blocks of 4 positions, that are all valid, or all invalid. */
+__attribute__((target("sse2")))
+static uint32_t VirtualCamera_SkipRunSSE2(const float* const h_d, const float* const v_d,
+                                          uint32_t x, uint32_t width, float src_width,
+                                          float src_height, int32_t valid)
+{
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 low = _mm_set1_ps(-1.0f);
+    const __m128 high_x = _mm_set1_ps(src_width);
+    const __m128 high_y = _mm_set1_ps(src_height);
+    int32_t run = valid ? 0xF : 0;
+
+    for(;x + 4U <= width;x += 4U)
+    {
+        __m128 h = _mm_add_ps(_mm_loadu_ps(&h_d[x]), half);
+        __m128 v = _mm_add_ps(_mm_loadu_ps(&v_d[x]), half);
+        __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpgt_ps(h, low), _mm_cmplt_ps(h, high_x)),
+                                   _mm_and_ps(_mm_cmpgt_ps(v, low), _mm_cmplt_ps(v, high_y)));
+
+        if(_mm_movemask_ps(inside) != run)
+        {
+            break;
+        }
+    }
+
+    return x;
+}
+
+#endif
+
+static LDC_Status VirtualCamera_AppendSpan(VirtualCamera_Band* band, uint32_t start, uint32_t end)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+
+    if(band->num_of_spans == band->capacity)
+    {
+        uint32_t capacity = (0U == band->capacity) ? 2U * MAP_ROWS_PER_TASK : 2U * band->capacity;
+        LDC_Span* spans = (LDC_Span*)realloc(band->spans, capacity * sizeof(LDC_Span));
+
+        if(NULL == spans)
+        {
+            status = LDC_STATUS_OUT_OF_MEMORY;
+        }
+        else
+        {
+            band->spans = spans;
+            band->capacity = capacity;
+        }
+    }
+
+    if(LDC_STATUS_OK == status)
+    {
+        band->spans[band->num_of_spans].start = start;
+        band->spans[band->num_of_spans].end = end;
+        band->num_of_spans++;
+    }
+
+    return status;
+}
+
+static void VirtualCamera_GenerateBand(void* arg, uint32_t index)
+{
+    VirtualCamera* camera = (VirtualCamera*)arg;
+    VirtualCamera_Band* band = &camera->bands[index];
+    LDC_Map* map = &camera->map;
+    uint32_t y_end = LDC_MIN((index + 1U) * MAP_ROWS_PER_TASK, map->height);
+    uint32_t width = map->width;
+    float src_width = (float)map->src_width;
+    float src_height = (float)map->src_height;
+    float step[3];
+    uint32_t i;
+    uint32_t k;
+
+    band->num_of_spans = 0;
+    band->status = LDC_STATUS_OK;
+
+    for(k = 0;k < 3U;k++)
+    {
+        step[k] = (float)camera->step_x[k];
+    }
+
+    for(i = index * MAP_ROWS_PER_TASK;i < y_end && LDC_STATUS_OK == band->status;i++)
+    {
+        const float* h_d = map->h_d + (size_t)i * map->width;
+        const float* v_d = map->v_d + (size_t)i * map->width;
+        uint32_t first = band->num_of_spans;
+        uint32_t x = 0;
+        uint32_t start;
+        float ray[3];
+
+        /* First ray of every row is computed in double, so error does not accumulate. */
+        for(k = 0;k < 3U;k++)
+        {
+            ray[k] = (float)(camera->ray[k] + (double)i * camera->step_y[k]);
+        }
+
+        FastMap_DistortRays(&camera->lut, map->width, ray, step, map->h_d + (size_t)i * map->width,
+                            map->v_d + (size_t)i * map->width);
+
+        /* Runs of valid positions, view is one region of whole frame. */
+        while(x < width && LDC_STATUS_OK == band->status)
+        {
+#ifdef VIRTUAL_CAMERA_X86
+            x = VirtualCamera_SkipRunSSE2(h_d, v_d, x, width, src_width, src_height, 0);
+#endif
+            while(x < width && !VirtualCamera_IsValidPosition(h_d[x], v_d[x], src_width,
+                                                              src_height))
+            {
+                x++;
+            }
+
+            start = x;
+
+#ifdef VIRTUAL_CAMERA_X86
+            x = VirtualCamera_SkipRunSSE2(h_d, v_d, x, width, src_width, src_height, 1);
+#endif
+            while(x < width && VirtualCamera_IsValidPosition(h_d[x], v_d[x], src_width,
+                                                             src_height))
+            {
+                x++;
+            }
+
+            if(start < x)
+            {
+                band->status = VirtualCamera_AppendSpan(band, start, x);
+            }
+        }
+
+        /* Number of spans of row, offsets are summed after all bands. */
+        map->row_spans[i] = band->num_of_spans - first;
+    }
+}
+
+/* Spans of bands, concatenated in order of rows. */
+static LDC_Status VirtualCamera_GatherSpans(VirtualCamera* camera)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    LDC_Map* map = &camera->map;
+    uint32_t num_of_spans = 0;
+    uint32_t i;
+
+    for(i = 0;i < camera->num_of_bands && LDC_STATUS_OK == status;i++)
+    {
+        status = camera->bands[i].status;
+        num_of_spans += camera->bands[i].num_of_spans;
+    }
+
+    if(LDC_STATUS_OK == status && num_of_spans > camera->span_capacity)
+    {
+        LDC_Span* spans = (LDC_Span*)realloc(map->spans, num_of_spans * sizeof(LDC_Span));
+
+        if(NULL == spans)
+        {
+            status = LDC_STATUS_OUT_OF_MEMORY;
+        }
+        else
+        {
+            map->spans = spans;
+            camera->span_capacity = num_of_spans;
+        }
+    }
+
+    if(LDC_STATUS_OK == status)
+    {
+        map->num_of_spans = 0;
+
+        for(i = 0;i < camera->num_of_bands;i++)
+        {
+            if(camera->bands[i].num_of_spans > 0U)
+            {
+                memcpy(map->spans + map->num_of_spans, camera->bands[i].spans,
+                       camera->bands[i].num_of_spans * sizeof(LDC_Span));
+                map->num_of_spans += camera->bands[i].num_of_spans;
+            }
+        }
+
+        for(i = 0, num_of_spans = 0;i < map->height;i++)
+        {
+            uint32_t count = map->row_spans[i];
+
+            map->row_spans[i] = num_of_spans;
+            num_of_spans += count;
+        }
+
+        map->row_spans[map->height] = num_of_spans;
+    }
+
+    return status;
+}
+
+/* ============================================================================================== */
+
+/*                                     API Functions                                              */
+
+/* ============================================================================================== */
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     VirtualCamera_Init
+ *
+ * \brief  Allocate map of virtual camera. Map is generated with first VirtualCamera_Update.
+ *
+ * \param  [Out] camera       Virtual camera. Has to be released with VirtualCamera_Deinit.
+ * \param  [In]  lens         Lens profile of fisheye camera.
+ * \param  [In]  src_width    Width of source (fisheye) frame.
+ * \param  [In]  src_height   Height of source (fisheye) frame.
+ * \param  [In]  width        Width of view.
+ * \param  [In]  height       Height of view.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status VirtualCamera_Init(VirtualCamera* camera, const LensProfile* const lens,
+                              uint32_t src_width, uint32_t src_height, uint32_t width,
+                              uint32_t height)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    LDC_OutputSpec output;
+
+    memset(camera, 0, sizeof(VirtualCamera));
+    memset(&output, 0, sizeof(LDC_OutputSpec));
+    output.width = width;
+    output.height = height;
+
+    if(NULL == lens || 0U == width || 0U == height)
+    {
+        status = LDC_STATUS_INVALID_ARGUMENT;
+        LdcLog_Write(LDC_LOG_ERROR, status, "Invalid lens or size of virtual camera view.");
+    }
+    else if(FrameCorrection_AllocateMap(&camera->map, src_width, src_height, &output, NULL, 0))
+    {
+        status = LDC_STATUS_OUT_OF_MEMORY;
+    }
+    else
+    {
+        camera->num_of_bands = (height + MAP_ROWS_PER_TASK - 1U) / MAP_ROWS_PER_TASK;
+        camera->bands = (VirtualCamera_Band*)calloc(camera->num_of_bands,
+                                                    sizeof(VirtualCamera_Band));
+        camera->map.row_spans = (uint32_t*)calloc(height + 1U, sizeof(uint32_t));
+    }
+
+    if(LDC_STATUS_OK == status && (NULL == camera->bands || NULL == camera->map.row_spans))
+    {
+        status = LDC_STATUS_OUT_OF_MEMORY;
+        VirtualCamera_Deinit(camera);
+    }
+    else if(LDC_STATUS_OK == status)
+    {
+        /* Lens function, moved to optical centre of source frame, same as in map generation. */
+        memcpy(&camera->lut, &lens->lut, sizeof(FastMap_RadialLut));
+        camera->lut.hc = (float)((src_width - 1)/2);
+        camera->lut.vc = (float)((src_height - 1)/2);
+    }
+
+    return status;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     VirtualCamera_Deinit
+ *
+ * \brief  Release memory of virtual camera.
+ *
+ * \param  [In]  camera       Virtual camera.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void VirtualCamera_Deinit(VirtualCamera* camera)
+{
+    uint32_t i;
+
+    for(i = 0;NULL != camera->bands && i < camera->num_of_bands;i++)
+    {
+        free(camera->bands[i].spans);
+    }
+
+    free(camera->bands);
+    FrameCorrection_FreeMap(&camera->map);
+    camera->bands = NULL;
+    camera->num_of_bands = 0;
+    camera->span_capacity = 0;
+    camera->generated = 0;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     VirtualCamera_Update
+ *
+ * \brief  Generate camera->map for pose. Rays of row are first ray and multiples of step, so
+ *         rows are generated with FastMap_DistortRays, in bands on worker pool, and spans of
+ *         band are found while band is in cache. Map is kept, when pose is same as last pose.
+ *         Positions outside of source frame, or outside of field of view of lens, are invalid.
+ *
+ * \param  [In]  camera       Virtual camera.
+ * \param  [In]  pose         Pose of view, with field of view in (0, VIRTUAL_CAMERA_MAX_FOV].
+ * \param  [In]  pool         Worker pool, or NULL.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status VirtualCamera_Update(VirtualCamera* camera, const VirtualCamera_Pose* const pose,
+                                WorkerPool* pool)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    LDC_Map* map = &camera->map;
+    double deg = M_PI / 180.0;
+    double cy = cos(pose->yaw * deg);
+    double sy = sin(pose->yaw * deg);
+    double cp = cos(pose->pitch * deg);
+    double sp = sin(pose->pitch * deg);
+    double cr = cos(pose->roll * deg);
+    double sr = sin(pose->roll * deg);
+    double rotation[9];
+    double focal;
+    double u;
+    double v;
+    uint32_t k;
+
+    if(NULL == map->h_d || !(pose->fov > 0.0 && pose->fov <= VIRTUAL_CAMERA_MAX_FOV))
+    {
+        status = LDC_STATUS_INVALID_ARGUMENT;
+        LdcLog_Write(LDC_LOG_ERROR, status, "Invalid virtual camera, or field of view %f.",
+                     pose->fov);
+    }
+    else if(!camera->generated || memcmp(&camera->pose, pose, sizeof(VirtualCamera_Pose)))
+    {
+        /* Rotation yaw * pitch * roll, from view to lens (x to the right, y down, z along
+           optical axis), stored by rows. */
+        rotation[0] = cy * cr + sy * sp * sr;
+        rotation[1] = -cy * sr + sy * sp * cr;
+        rotation[2] = sy * cp;
+        rotation[3] = cp * sr;
+        rotation[4] = cp * cr;
+        rotation[5] = -sp;
+        rotation[6] = -sy * cr + cy * sp * sr;
+        rotation[7] = sy * sr + cy * sp * cr;
+        rotation[8] = cy * cp;
+
+        /* Pinhole view, with centre of output frame same as in map generation. */
+        focal = 0.5 * map->width / tan(0.5 * pose->fov * deg);
+        u = -(double)((map->width - 1)/2);
+        v = -(double)((map->height - 1)/2);
+
+        for(k = 0;k < 3U;k++)
+        {
+            camera->step_x[k] = rotation[3U * k];
+            camera->step_y[k] = rotation[3U * k + 1U];
+            camera->ray[k] = u * rotation[3U * k] + v * rotation[3U * k + 1U] +
+                             focal * rotation[3U * k + 2U];
+        }
+
+        camera->generated = 0;
+        WorkerPool_Run(pool, VirtualCamera_GenerateBand, camera, camera->num_of_bands);
+
+        /* Source pixels per output pixel, at centre of view. */
+        map->scale = camera->lut.z / focal;
+        status = VirtualCamera_GatherSpans(camera);
+
+        if(LDC_STATUS_OK == status)
+        {
+            camera->pose = *pose;
+            camera->generated = 1;
+        }
+    }
+
+    return status;
+}
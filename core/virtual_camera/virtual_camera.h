@@ -0,0 +1,170 @@
+/**
+ ***************************************************************************************************
+ *
+ * \file  virtual_camera.h
+ *
+ * \brief This file contains API for virtual camera (pan/tilt/zoom) views of fisheye frame.
+ *        Virtual camera is rectilinear camera in optical centre of lens, rotated by yaw, pitch
+ *        and roll, with its own field of view and output resolution. Map of view is regenerated
+ *        for every pose, so view can follow tracked object frame by frame.
+ *
+ * \arg author:  Dejan Milojica
+ * \arg version: 1.2
+ * \arg date:    13.01.2021
+ *
+ ***************************************************************************************************
+ */
+
+#ifndef VIRTUAL_CAMERA_H
+#define VIRTUAL_CAMERA_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================================== */
+/*                                       Include Files                                            */
+/* ============================================================================================== */
+
+#include <stdint.h>
+
+#include "../lib/ldc_types.h"
+#include "../correction_distortion/correction_distortion.h"
+#include "../fast_map/fast_map.h"
+#include "../lens_registry/lens_registry.h"
+#include "../worker_pool/worker_pool.h"
+
+/* ============================================================================================== */
+/*                                     Macros & Typedefs                                          */
+/* ============================================================================================== */
+
+#define VIRTUAL_CAMERA_MAX_FOV (179.0)          /* Max horizontal field of view, in degrees.  */
+
+/**
+ ***************************************************************************************************
+ *
+ * \typedef VirtualCamera_Pose
+ *
+ * \brief   Structure which represents pose and zoom of virtual camera. Angles are in degrees.
+ *          Yaw turns view to the right, pitch turns view up, and roll turns view clockwise
+ *          around its axis. Rotations are applied in order roll, pitch and yaw.
+ *
+ ***************************************************************************************************
+ */
+typedef struct
+{
+    double yaw;                                 /* Rotation around vertical axis.         */
+    double pitch;                               /* Rotation around horizontal axis.       */
+    double roll;                                /* Rotation around axis of view.          */
+    double fov;                                 /* Horizontal field of view of view.      */
+}VirtualCamera_Pose;
+
+/**
+ ***************************************************************************************************
+ *
+ * \typedef VirtualCamera_Band
+ *
+ * \brief   Structure which represents spans of valid positions of band of map rows, found by
+ *          task that generated band.
+ *
+ ***************************************************************************************************
+ */
+typedef struct
+{
+    LDC_Span* spans;                            /* Spans of rows of band, row by row.     */
+    uint32_t num_of_spans;                      /* Number of spans.                       */
+    uint32_t capacity;                          /* Allocated spans.                       */
+    LDC_Status status;                          /* Status of generation of band.          */
+}VirtualCamera_Band;
+
+/**
+ ***************************************************************************************************
+ *
+ * \typedef VirtualCamera
+ *
+ * \brief   Structure which represents virtual camera, with map of its last pose. Map is
+ *          allocated once, and positions of every pose are written into it.
+ *
+ ***************************************************************************************************
+ */
+typedef struct
+{
+    LDC_Map map;                                /* Map of last pose.                      */
+    FastMap_RadialLut lut;                      /* Lens function, at centre of source.    */
+    VirtualCamera_Pose pose;                    /* Last pose.                             */
+    uint32_t generated;                         /* Map is generated for pose.             */
+    double ray[3];                              /* Ray of top left pixel, of last pose.   */
+    double step_x[3];                           /* Difference of rays of neighbour pixels.*/
+    double step_y[3];                           /* Difference of rays of neighbour rows.  */
+    VirtualCamera_Band* bands;                  /* Bands of MAP_ROWS_PER_TASK rows.       */
+    uint32_t num_of_bands;                      /* Number of bands.                       */
+    uint32_t span_capacity;                     /* Allocated spans of map.                */
+}VirtualCamera;
+
+/* ============================================================================================== */
+/*                                     Function Declarations                                      */
+/* ============================================================================================== */
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     VirtualCamera_Init
+ *
+ * \brief  Allocate map of virtual camera. Map is generated with first VirtualCamera_Update.
+ *
+ * \param  [Out] camera       Virtual camera. Has to be released with VirtualCamera_Deinit.
+ * \param  [In]  lens         Lens profile of fisheye camera.
+ * \param  [In]  src_width    Width of source (fisheye) frame.
+ * \param  [In]  src_height   Height of source (fisheye) frame.
+ * \param  [In]  width        Width of view.
+ * \param  [In]  height       Height of view.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status VirtualCamera_Init(VirtualCamera* camera, const LensProfile* const lens,
+                              uint32_t src_width, uint32_t src_height, uint32_t width,
+                              uint32_t height);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     VirtualCamera_Deinit
+ *
+ * \brief  Release memory of virtual camera.
+ *
+ * \param  [In]  camera       Virtual camera.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void VirtualCamera_Deinit(VirtualCamera* camera);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     VirtualCamera_Update
+ *
+ * \brief  Generate camera->map for pose. Rays of row are first ray and multiples of step, so
+ *         rows are generated with FastMap_DistortRays, in bands on worker pool, and spans of
+ *         band are found while band is in cache. Map is kept, when pose is same as last pose.
+ *         Positions outside of source frame, or outside of field of view of lens, are invalid.
+ *
+ * \param  [In]  camera       Virtual camera.
+ * \param  [In]  pose         Pose of view, with field of view in (0, VIRTUAL_CAMERA_MAX_FOV].
+ * \param  [In]  pool         Worker pool, or NULL.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status VirtualCamera_Update(VirtualCamera* camera, const VirtualCamera_Pose* const pose,
+                                WorkerPool* pool);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,354 @@
+/**
+ ***************************************************************************************************
+ *
+ * \file  worker_pool.c
+ *
+ * \brief This file contains API for pool of worker threads, shared by map generation and
+ *        frame correction of many streams.
+ *
+ * \arg author:  Dejan Milojica
+ * \arg version: 1.2
+ * \arg date:    13.01.2021
+ *
+ ***************************************************************************************************
+ */
+
+/* ============================================================================================== */
+/*                                       Include Files                                            */
+/* ============================================================================================== */
+
+#include "worker_pool.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* ============================================================================================== */
+/*                              Internal Helper Functions                                         */
+/* ============================================================================================== */
+
+static void WorkerPool_Enqueue(WorkerPool* pool, WorkerPool_Job* job)
+{
+    job->next = NULL;
+
+    if(NULL == pool->tail)
+    {
+        pool->head = job;
+    }
+    else
+    {
+        pool->tail->next = job;
+    }
+
+    pool->tail = job;
+}
+
+static void WorkerPool_Dequeue(WorkerPool* pool, WorkerPool_Job* job)
+{
+    WorkerPool_Job* prev = NULL;
+    WorkerPool_Job* it = pool->head;
+
+    while(NULL != it && it != job)
+    {
+        prev = it;
+        it = it->next;
+    }
+
+    if(NULL != it)
+    {
+        if(NULL == prev)
+        {
+            pool->head = it->next;
+        }
+        else
+        {
+            prev->next = it->next;
+        }
+
+        if(pool->tail == it)
+        {
+            pool->tail = prev;
+        }
+    }
+}
+
+/* Take next index of job. Job leaves queue, when its last index is taken. Lock is held. */
+static uint32_t WorkerPool_TakeIndex(WorkerPool* pool, WorkerPool_Job* job)
+{
+    uint32_t index = job->next_index++;
+
+    if(job->next_index == job->count)
+    {
+        WorkerPool_Dequeue(pool, job);
+    }
+
+    return index;
+}
+
+/* Mark one index of job as done, and return nonzero when whole job is done. Lock is held. */
+static int32_t WorkerPool_FinishIndex(WorkerPool* pool, WorkerPool_Job* job)
+{
+    int32_t done = (0U == --job->remaining);
+
+    if(done && !job->detached)
+    {
+        pthread_cond_broadcast(&pool->done_cond);
+    }
+
+    return done;
+}
+
+static void* WorkerPool_Worker(void* arg)
+{
+    WorkerPool* pool = (WorkerPool*)arg;
+
+    pthread_mutex_lock(&pool->lock);
+
+    for(;;)
+    {
+        WorkerPool_Job* job;
+        uint32_t index;
+
+        while(NULL == pool->head && !pool->stop)
+        {
+            pthread_cond_wait(&pool->work_cond, &pool->lock);
+        }
+
+        /* Queued jobs are finished, before workers stop. */
+        if(NULL == pool->head)
+        {
+            break;
+        }
+
+        job = pool->head;
+        index = WorkerPool_TakeIndex(pool, job);
+
+        pthread_mutex_unlock(&pool->lock);
+        job->task(job->arg, index);
+        pthread_mutex_lock(&pool->lock);
+
+        /* Submitted jobs are owned by pool. */
+        if(WorkerPool_FinishIndex(pool, job) && job->detached)
+        {
+            free(job);
+        }
+    }
+
+    pthread_mutex_unlock(&pool->lock);
+
+    return NULL;
+}
+
+/* ============================================================================================== */
+
+/*                                     API Functions                                              */
+
+/* ============================================================================================== */
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     WorkerPool_Init
+ *
+ * \brief  Start worker threads.
+ *
+ * \param  [Out] pool            Worker pool.
+ * \param  [In]  num_of_threads  Number of worker threads, or 0 for number of online cores.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status WorkerPool_Init(WorkerPool* pool, uint32_t num_of_threads)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    uint32_t i;
+
+    memset(pool, 0, sizeof(WorkerPool));
+
+    if(0U == num_of_threads)
+    {
+        long num_of_cores = sysconf(_SC_NPROCESSORS_ONLN);
+        num_of_threads = (num_of_cores > 0) ? (uint32_t)num_of_cores : 1U;
+    }
+
+    pool->threads = (pthread_t*)malloc(num_of_threads * sizeof(pthread_t));
+
+    if(NULL == pool->threads)
+    {
+        return LDC_STATUS_ERROR;
+    }
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work_cond, NULL);
+    pthread_cond_init(&pool->done_cond, NULL);
+
+    for(i = 0;i < num_of_threads;i++)
+    {
+        if(0 != pthread_create(&pool->threads[i], NULL, WorkerPool_Worker, pool))
+        {
+            status = LDC_STATUS_ERROR;
+            break;
+        }
+
+        pool->num_of_threads++;
+    }
+
+    if(LDC_STATUS_OK != status)
+    {
+        WorkerPool_Deinit(pool);
+    }
+
+    return status;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     WorkerPool_Deinit
+ *
+ * \brief  Finish all queued jobs, and stop worker threads.
+ *
+ * \param  [In]  pool            Worker pool.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void WorkerPool_Deinit(WorkerPool* pool)
+{
+    uint32_t i;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = 1U;
+    pthread_cond_broadcast(&pool->work_cond);
+    pthread_mutex_unlock(&pool->lock);
+
+    for(i = 0;i < pool->num_of_threads;i++)
+    {
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    pthread_cond_destroy(&pool->done_cond);
+    pthread_cond_destroy(&pool->work_cond);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->threads);
+    memset(pool, 0, sizeof(WorkerPool));
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     WorkerPool_Submit
+ *
+ * \brief  Queue job, that calls task(arg, index) for every index in [0, count), and return
+ *         without waiting for it.
+ *
+ * \param  [In]  pool            Worker pool.
+ * \param  [In]  task            Task function.
+ * \param  [In]  arg             Argument of task function.
+ * \param  [In]  count           Number of task invocations.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status WorkerPool_Submit(WorkerPool* pool, WorkerPool_Task task, void* arg, uint32_t count)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    WorkerPool_Job* job;
+
+    if(NULL == pool || NULL == task)
+    {
+        status = LDC_STATUS_ERROR;
+    }
+    else if(0U < count)
+    {
+        job = (WorkerPool_Job*)malloc(sizeof(WorkerPool_Job));
+
+        if(NULL == job)
+        {
+            status = LDC_STATUS_ERROR;
+        }
+        else
+        {
+            job->task = task;
+            job->arg = arg;
+            job->count = count;
+            job->next_index = 0;
+            job->remaining = count;
+            job->detached = 1U;
+
+            pthread_mutex_lock(&pool->lock);
+            WorkerPool_Enqueue(pool, job);
+            pthread_cond_broadcast(&pool->work_cond);
+            pthread_mutex_unlock(&pool->lock);
+        }
+    }
+
+    return status;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     WorkerPool_Run
+ *
+ * \brief  Call task(arg, index) for every index in [0, count), in parallel, and wait until all
+ *         calls are done. Calling thread executes tasks too, so pool may be NULL, and function
+ *         may be called from task of another job.
+ *
+ * \param  [In]  pool            Worker pool, or NULL for execution on calling thread.
+ * \param  [In]  task            Task function.
+ * \param  [In]  arg             Argument of task function.
+ * \param  [In]  count           Number of task invocations.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void WorkerPool_Run(WorkerPool* pool, WorkerPool_Task task, void* arg, uint32_t count)
+{
+    uint32_t i;
+
+    if(NULL == pool || 0U == pool->num_of_threads || count < 2U)
+    {
+        for(i = 0;i < count;i++)
+        {
+            task(arg, i);
+        }
+    }
+    else
+    {
+        WorkerPool_Job job;
+
+        job.task = task;
+        job.arg = arg;
+        job.count = count;
+        job.next_index = 0;
+        job.remaining = count;
+        job.detached = 0U;
+
+        pthread_mutex_lock(&pool->lock);
+        WorkerPool_Enqueue(pool, &job);
+        pthread_cond_broadcast(&pool->work_cond);
+
+        /* Help workers, instead of only waiting for them. */
+        while(job.next_index < job.count)
+        {
+            uint32_t index = WorkerPool_TakeIndex(pool, &job);
+
+            pthread_mutex_unlock(&pool->lock);
+            task(arg, index);
+            pthread_mutex_lock(&pool->lock);
+
+            (void)WorkerPool_FinishIndex(pool, &job);
+        }
+
+        while(0U < job.remaining)
+        {
+            pthread_cond_wait(&pool->done_cond, &pool->lock);
+        }
+
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
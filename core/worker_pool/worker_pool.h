@@ -0,0 +1,166 @@
+/**
+ ***************************************************************************************************
+ *
+ * \file  worker_pool.h
+ *
+ * \brief This file contains API for pool of worker threads, shared by map generation and
+ *        frame correction of many streams.
+ *
+ * \arg author:  Dejan Milojica
+ * \arg version: 1.2
+ * \arg date:    13.01.2021
+ *
+ ***************************************************************************************************
+ */
+
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================================== */
+/*                                       Include Files                                            */
+/* ============================================================================================== */
+
+#include <stdint.h>
+#include <pthread.h>
+
+#include "../lib/ldc_types.h"
+
+/* ============================================================================================== */
+/*                                     Macros & Typedefs                                          */
+/* ============================================================================================== */
+
+/**
+ ***************************************************************************************************
+ *
+ * \typedef WorkerPool_Task
+ *
+ * \brief   Function executed by worker, once for every index of job.
+ *
+ ***************************************************************************************************
+ */
+typedef void (*WorkerPool_Task)(void* arg, uint32_t index);
+
+/**
+ ***************************************************************************************************
+ *
+ * \typedef WorkerPool_Job
+ *
+ * \brief   Structure which represents queued job, with count invocations of task.
+ *
+ ***************************************************************************************************
+ */
+typedef struct WorkerPool_Job
+{
+    WorkerPool_Task task;                       /* Task function.                         */
+    void* arg;                                  /* Argument of task function.             */
+    uint32_t count;                             /* Number of task invocations.            */
+    uint32_t next_index;                        /* Next index, that is not started.       */
+    uint32_t remaining;                         /* Number of indices, that are not done.  */
+    uint32_t detached;                          /* Job is freed by worker, when done.     */
+    struct WorkerPool_Job* next;                /* Next job in queue.                     */
+}WorkerPool_Job;
+
+/**
+ ***************************************************************************************************
+ *
+ * \typedef WorkerPool
+ *
+ * \brief   Structure which represents pool of worker threads, with FIFO queue of jobs.
+ *
+ ***************************************************************************************************
+ */
+typedef struct
+{
+    pthread_t* threads;                         /* Worker threads.                        */
+    uint32_t num_of_threads;                    /* Number of worker threads.              */
+    WorkerPool_Job* head;                       /* First job in queue.                    */
+    WorkerPool_Job* tail;                       /* Last job in queue.                     */
+    uint32_t stop;                              /* Workers have to exit.                  */
+    pthread_mutex_t lock;                       /* Protects queue of jobs.                */
+    pthread_cond_t work_cond;                   /* Signaled when job is queued.           */
+    pthread_cond_t done_cond;                   /* Signaled when job is done.             */
+}WorkerPool;
+
+/* ============================================================================================== */
+/*                                     Function Declarations                                      */
+/* ============================================================================================== */
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     WorkerPool_Init
+ *
+ * \brief  Start worker threads.
+ *
+ * \param  [Out] pool            Worker pool.
+ * \param  [In]  num_of_threads  Number of worker threads, or 0 for number of online cores.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status WorkerPool_Init(WorkerPool* pool, uint32_t num_of_threads);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     WorkerPool_Deinit
+ *
+ * \brief  Finish all queued jobs, and stop worker threads.
+ *
+ * \param  [In]  pool            Worker pool.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void WorkerPool_Deinit(WorkerPool* pool);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     WorkerPool_Submit
+ *
+ * \brief  Queue job, that calls task(arg, index) for every index in [0, count), and return
+ *         without waiting for it.
+ *
+ * \param  [In]  pool            Worker pool.
+ * \param  [In]  task            Task function.
+ * \param  [In]  arg             Argument of task function.
+ * \param  [In]  count           Number of task invocations.
+ *
+ * \return LDC_Status   Exit status.
+ *
+ ***************************************************************************************************
+ */
+LDC_Status WorkerPool_Submit(WorkerPool* pool, WorkerPool_Task task, void* arg, uint32_t count);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     WorkerPool_Run
+ *
+ * \brief  Call task(arg, index) for every index in [0, count), in parallel, and wait until all
+ *         calls are done. Calling thread executes tasks too, so pool may be NULL, and function
+ *         may be called from task of another job.
+ *
+ * \param  [In]  pool            Worker pool, or NULL for execution on calling thread.
+ * \param  [In]  task            Task function.
+ * \param  [In]  arg             Argument of task function.
+ * \param  [In]  count           Number of task invocations.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void WorkerPool_Run(WorkerPool* pool, WorkerPool_Task task, void* arg, uint32_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,158 @@
+/**
+ ***************************************************************************************************
+ *
+ * \file  daemon_main.c
+ *
+ * \brief This file contains main function of correction daemon, that keeps maps of lenses warm
+ *        and corrects frames of clients over Unix domain socket.
+ *
+ * \arg author:  Dejan Milojica
+ * \arg version: 1.2
+ * \arg date:    13.01.2021
+ *
+ ***************************************************************************************************
+ */
+
+/* ============================================================================================== */
+/*                               Internal Include Files                                           */
+/* ============================================================================================== */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <signal.h>
+#include "../core/lib/ldc_log.h"
+#include "../core/ldc_daemon/ldc_daemon.h"
+
+/* ============================================================================================== */
+/*                              Global Variables                                                  */
+/* ============================================================================================== */
+
+#define DAEMON_HELP_MESSAGE (\
+    "Daemon supports the following arguments:\n"\
+    "--help                   Help\n"\
+    "-s [SOCKET]              Path of Unix domain socket, default /tmp/ldc_daemon.sock\n"\
+    "-p [ID:CSV FILE]         Lens ID and lens camera specification file, can be repeated.\n"\
+    "                         File is watched, and maps of lens are regenerated on change.\n"\
+    "-m [MAPS]                Number of warm maps, least recently used are evicted, default 32\n")
+
+#define DAEMON_DEFAULT_SOCKET ("/tmp/ldc_daemon.sock")
+
+#define DAEMON_INVALID_LENS_MESSAGE (\
+    "Invalid lens. Lens has to be given as ID:CSV FILE, with valid lens specification file.\n")
+
+#define DAEMON_INVALID_ARGUMENTS_MESSAGE (\
+    "Invalid arguments. Run the daemon with --help for help on how to use it.\n")
+
+static LdcDaemon_Server server;
+
+/* ============================================================================================== */
+/*                              Internal Helper Functions                                         */
+/* ============================================================================================== */
+
+static void DaemonMain_PrintLogMessage(LDC_LogLevel level, LDC_Status status,
+                                       const char* message, void* user_data)
+{
+    (void)level;
+    (void)status;
+    (void)user_data;
+
+    printf("%s\n", message);
+    fflush(stdout);
+}
+
+static void DaemonMain_HandleSignal(int32_t signal_number)
+{
+    (void)signal_number;
+    LdcDaemon_Stop(&server);
+}
+
+/* ============================================================================================== */
+/*                                        Main Function                                           */
+/* ============================================================================================== */
+
+int32_t main(int32_t argc, char** argv)
+{
+    const char* socketPath = DAEMON_DEFAULT_SOCKET;
+    int32_t argIteratorCounter = 1;
+    LDC_Status status;
+
+    LdcLog_SetCallback(DaemonMain_PrintLogMessage, NULL);
+
+    /* Socket path is needed before lenses are added. */
+    for (argIteratorCounter = 1;argIteratorCounter < argc;argIteratorCounter++)
+    {
+        if (0 == strcmp(argv[argIteratorCounter], "--help"))
+        {
+            printf(DAEMON_HELP_MESSAGE);
+            return EXIT_SUCCESS;
+        }
+        else if (0 == strcmp(argv[argIteratorCounter], "-s") && argIteratorCounter + 1 < argc)
+        {
+            socketPath = argv[++argIteratorCounter];
+        }
+        else if ((0 == strcmp(argv[argIteratorCounter], "-p") ||
+                  0 == strcmp(argv[argIteratorCounter], "-m")) && argIteratorCounter + 1 < argc)
+        {
+            argIteratorCounter++;
+        }
+        else
+        {
+            printf(DAEMON_INVALID_ARGUMENTS_MESSAGE);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (LdcDaemon_Init(&server, socketPath))
+    {
+        return EXIT_FAILURE;
+    }
+
+    for (argIteratorCounter = 1;argIteratorCounter < argc;argIteratorCounter++)
+    {
+        if (0 == strcmp(argv[argIteratorCounter], "-p"))
+        {
+            const char* lens = argv[++argIteratorCounter];
+            const char* separator = strchr(lens, ':');
+            uint32_t lensId;
+
+            if (NULL == separator || 1 != sscanf(lens, "%u:", &lensId) ||
+                LdcDaemon_AddLens(&server, lensId, separator + 1))
+            {
+                printf(DAEMON_INVALID_LENS_MESSAGE);
+                LdcDaemon_Deinit(&server);
+                return EXIT_FAILURE;
+            }
+
+            printf("Lens %u: %s\n", lensId, separator + 1);
+        }
+        else if (0 == strcmp(argv[argIteratorCounter], "-m"))
+        {
+            uint32_t maxMaps;
+
+            if (1 != sscanf(argv[++argIteratorCounter], "%u", &maxMaps) ||
+                LdcDaemon_SetMaxMaps(&server, maxMaps))
+            {
+                printf(DAEMON_INVALID_ARGUMENTS_MESSAGE);
+                LdcDaemon_Deinit(&server);
+                return EXIT_FAILURE;
+            }
+        }
+        else if (0 == strcmp(argv[argIteratorCounter], "-s"))
+        {
+            argIteratorCounter++;
+        }
+    }
+
+    signal(SIGINT, DaemonMain_HandleSignal);
+    signal(SIGTERM, DaemonMain_HandleSignal);
+
+    printf("Listening on %s\n", socketPath);
+    fflush(stdout);
+
+    status = LdcDaemon_Run(&server);
+    LdcDaemon_Deinit(&server);
+
+    return (LDC_STATUS_OK == status) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
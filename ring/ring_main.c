@@ -0,0 +1,355 @@
+/**
+ ***************************************************************************************************
+ *
+ * \file  ring_main.c
+ *
+ * \brief This file contains main function of frame ring demo. Capture process publishes frames
+ *        to input ring, corrector corrects them from input ring into output ring, and display
+ *        process consumes them, and throughput and latency of pipeline are measured.
+ *
+ * \arg author:  Dejan Milojica
+ * \arg version: 1.2
+ * \arg date:    13.01.2021
+ *
+ ***************************************************************************************************
+ */
+
+/* ============================================================================================== */
+/*                               Internal Include Files                                           */
+/* ============================================================================================== */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "../core/lib/ldc_log.h"
+#include "../core/frame_ring/frame_ring.h"
+#include "../core/lens_registry/lens_registry.h"
+#include "../core/correction_distortion/correction_distortion.h"
+
+/* ============================================================================================== */
+/*                              Global Variables                                                  */
+/* ============================================================================================== */
+
+#define RING_HELP_MESSAGE (\
+    "Frame ring demo supports the following arguments:\n"\
+    "--help                   Help\n"\
+    "-p [CSV FILE]            Lens camera specification file\n"\
+    "-w [WIDTH]               Width of frames, default 1920\n"\
+    "-h [HEIGHT]              Height of frames, default 1080\n"\
+    "-f [1-9]                 YUV type of frames, default 1 (NV12)\n"\
+    "-n [FRAMES]              Number of frames, default 300\n"\
+    "-s [SLOTS]               Slots of each ring, default 4\n"\
+    "-r [FPS]                 Frame rate of capture, default 0 (as fast as possible)\n")
+
+#define RING_INVALID_ARGUMENTS_MESSAGE (\
+    "Invalid arguments. Run the demo with --help for help on how to use it.\n")
+
+#define RING_TIMEOUT_MS (5000)                  /* Max wait of stalled pipeline.               */
+
+/* ============================================================================================== */
+/*                              Internal Helper Functions                                         */
+/* ============================================================================================== */
+
+static uint64_t RingMain_GetTime(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+static void RingMain_PrintLogMessage(LDC_LogLevel level, LDC_Status status, const char* message,
+                                     void* user_data)
+{
+    (void)level;
+    (void)user_data;
+
+    printf("%s (%s)\n", message, LdcLog_GetStatusName(status));
+}
+
+static int32_t RingMain_Compare(const void* a, const void* b)
+{
+    uint64_t left = *(const uint64_t*)a;
+    uint64_t right = *(const uint64_t*)b;
+
+    return (left > right) - (left < right);
+}
+
+/* Capture process, writes frames into slots of input ring. */
+static int32_t RingMain_Produce(const char* const name, uint32_t num_of_frames, uint32_t fps)
+{
+    FrameRing ring;
+    FrameRing_Slot slot;
+    uint64_t start;
+    uint32_t i;
+
+    if(FrameRing_Open(&ring, name))
+    {
+        return EXIT_FAILURE;
+    }
+
+    start = RingMain_GetTime();
+    for(i = 0;i < num_of_frames;i++)
+    {
+        if(fps)
+        {
+            uint64_t due = start + (uint64_t)i * 1000000000ULL / fps;
+            struct timespec wake;
+
+            wake.tv_sec = (time_t)(due / 1000000000ULL);
+            wake.tv_nsec = (long)(due % 1000000000ULL);
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, NULL);
+        }
+
+        if(FrameRing_AcquireWrite(&ring, &slot, RING_TIMEOUT_MS))
+        {
+            break;
+        }
+
+        /* Whole frame is written, as by capture DMA. */
+        memset(slot.Y, (int32_t)(16U + i % 220U), ring.luma_size);
+        memset(slot.U, 128, 2U * ring.chroma_size);
+        FrameRing_Publish(&ring, i, RingMain_GetTime());
+    }
+
+    FrameRing_Shutdown(&ring);
+    FrameRing_Close(&ring);
+
+    return (i == num_of_frames) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* Display process, consumes corrected frames and measures latency from capture. */
+static int32_t RingMain_Consume(const char* const name, uint32_t num_of_frames, uint32_t fps)
+{
+    FrameRing ring;
+    FrameRing_Slot slot;
+    uint64_t* latency = (uint64_t*)malloc(sizeof(uint64_t) * num_of_frames);
+    uint64_t first = 0;
+    uint64_t last = 0;
+    uint64_t sum = 0;
+    uint32_t received = 0;
+    uint32_t in_order = 1U;
+
+    (void)fps;
+
+    if(NULL == latency || FrameRing_Open(&ring, name))
+    {
+        free(latency);
+        return EXIT_FAILURE;
+    }
+
+    while(received < num_of_frames && !FrameRing_AcquireRead(&ring, &slot, RING_TIMEOUT_MS))
+    {
+        last = RingMain_GetTime();
+        first = (0U == received) ? last : first;
+        in_order = in_order && slot.sequence == received;
+        latency[received] = last - slot.timestamp_ns;
+        sum += latency[received];
+        received++;
+        FrameRing_Release(&ring);
+    }
+
+    FrameRing_Close(&ring);
+
+    if(received > 0U)
+    {
+        qsort(latency, received, sizeof(uint64_t), RingMain_Compare);
+        printf("Frames received: %u of %u, %s\n", received, num_of_frames,
+               in_order ? "in order" : "OUT OF ORDER");
+        if(received > 1U)
+        {
+            printf("Throughput: %.1f fps\n",
+                   (received - 1U) * 1e9 / (double)(last - first + (last == first)));
+        }
+        printf("Latency capture to display: min %.3f ms, avg %.3f ms, p99 %.3f ms, "
+               "max %.3f ms\n", latency[0] / 1e6, sum / 1e6 / received,
+               latency[(uint32_t)((received - 1U) * 0.99)] / 1e6, latency[received - 1U] / 1e6);
+    }
+
+    free(latency);
+
+    return (received == num_of_frames && in_order) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static pid_t RingMain_Fork(int32_t (*role)(const char* const, uint32_t, uint32_t),
+                           const char* const name, uint32_t num_of_frames, uint32_t fps)
+{
+    pid_t pid = fork();
+
+    if(0 == pid)
+    {
+        int32_t status = role(name, num_of_frames, fps);
+
+        fflush(stdout);
+        _exit(status);
+    }
+
+    return pid;
+}
+
+/* ============================================================================================== */
+/*                                        Main Function                                           */
+/* ============================================================================================== */
+
+int32_t main(int32_t argc, char** argv)
+{
+    const char* lensFileName = NULL;
+    uint32_t width = 1920;
+    uint32_t height = 1080;
+    uint32_t yuvType = YUV420_NV12;
+    uint32_t numOfFrames = 300;
+    uint32_t numOfSlots = 4;
+    uint32_t fps = 0;
+    int32_t argIteratorCounter;
+    const LDC_Color border = {16, 128, 128};
+    char inName[FRAME_RING_MAX_NAME];
+    char outName[FRAME_RING_MAX_NAME];
+    const LensProfile* lens = NULL;
+    LDC_Map map;
+    Remap_Plan plan;
+    FrameRing inRing;
+    FrameRing outRing;
+    pid_t producer;
+    pid_t consumer;
+    int32_t producerStatus = EXIT_FAILURE;
+    int32_t consumerStatus = EXIT_FAILURE;
+    uint32_t corrected = 0;
+    uint64_t remapTime = 0;
+
+    LdcLog_SetCallback(RingMain_PrintLogMessage, NULL);
+
+    for(argIteratorCounter = 1;argIteratorCounter < argc;argIteratorCounter++)
+    {
+        uint32_t* value = NULL;
+
+        if(0 == strcmp(argv[argIteratorCounter], "--help"))
+        {
+            printf(RING_HELP_MESSAGE);
+            return EXIT_SUCCESS;
+        }
+        else if(argIteratorCounter + 1 >= argc)
+        {
+            printf(RING_INVALID_ARGUMENTS_MESSAGE);
+            return EXIT_FAILURE;
+        }
+        else if(0 == strcmp(argv[argIteratorCounter], "-p"))
+        {
+            lensFileName = argv[++argIteratorCounter];
+            continue;
+        }
+
+        value = (0 == strcmp(argv[argIteratorCounter], "-w")) ? &width :
+                (0 == strcmp(argv[argIteratorCounter], "-h")) ? &height :
+                (0 == strcmp(argv[argIteratorCounter], "-f")) ? &yuvType :
+                (0 == strcmp(argv[argIteratorCounter], "-n")) ? &numOfFrames :
+                (0 == strcmp(argv[argIteratorCounter], "-s")) ? &numOfSlots :
+                (0 == strcmp(argv[argIteratorCounter], "-r")) ? &fps : NULL;
+
+        if(NULL == value || 1 != sscanf(argv[++argIteratorCounter], "%u", value))
+        {
+            printf(RING_INVALID_ARGUMENTS_MESSAGE);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if(NULL == lensFileName || 0U == numOfFrames ||
+       LensProfile_LoadFile(0U, lensFileName, &lens))
+    {
+        printf(RING_INVALID_ARGUMENTS_MESSAGE);
+        return EXIT_FAILURE;
+    }
+
+    if(FrameCorrection_GenerateMap(&map, width, height, NULL, NULL, 0, lens, NULL))
+    {
+        printf("Map generation failed.\n");
+        LensProfile_Release(lens);
+        return EXIT_FAILURE;
+    }
+
+    LensProfile_Release(lens);
+
+    snprintf(inName, sizeof(inName), "/ldc_ring_in_%d", (int32_t)getpid());
+    snprintf(outName, sizeof(outName), "/ldc_ring_out_%d", (int32_t)getpid());
+
+    if(Remap_CreatePlan(&plan, &map, (YUV_Type)yuvType, LDC_INTERPOLATION_NEAREST))
+    {
+        printf(RING_INVALID_ARGUMENTS_MESSAGE);
+        FrameCorrection_FreeMap(&map);
+        return EXIT_FAILURE;
+    }
+
+    if(FrameRing_Create(&inRing, inName, width, height, (YUV_Type)yuvType, numOfSlots))
+    {
+        printf("Ring creation failed.\n");
+        Remap_FreePlan(&plan);
+        FrameCorrection_FreeMap(&map);
+        return EXIT_FAILURE;
+    }
+
+    if(FrameRing_Create(&outRing, outName, map.width, map.height, (YUV_Type)yuvType, numOfSlots))
+    {
+        printf("Ring creation failed.\n");
+        FrameRing_Close(&inRing);
+        Remap_FreePlan(&plan);
+        FrameCorrection_FreeMap(&map);
+        return EXIT_FAILURE;
+    }
+
+    printf("Rings %s -> %s, %ux%u, %u slots, %u frames\n", inName, outName, width, height,
+           numOfSlots, numOfFrames);
+    fflush(stdout);
+
+    /* Capture and display are separate processes, that open rings by name. */
+    consumer = RingMain_Fork(RingMain_Consume, outName, numOfFrames, fps);
+    producer = RingMain_Fork(RingMain_Produce, inName, numOfFrames, fps);
+
+    if(producer > 0 && consumer > 0)
+    {
+        for(;;)
+        {
+            uint64_t start = RingMain_GetTime();
+
+            if(FrameRing_CorrectFrame(&plan, &inRing, &outRing, &border, RING_TIMEOUT_MS))
+            {
+                break;
+            }
+
+            remapTime += RingMain_GetTime() - start;
+            corrected++;
+        }
+
+        printf("Frames corrected: %u, %s\n", corrected,
+               FrameRing_IsDrained(&inRing) ? "input drained" : "input stalled");
+    }
+
+    FrameRing_Shutdown(&outRing);
+
+    if(producer > 0)
+    {
+        waitpid(producer, &producerStatus, 0);
+    }
+
+    if(consumer > 0)
+    {
+        waitpid(consumer, &consumerStatus, 0);
+    }
+
+    if(corrected > 0U)
+    {
+        printf("Corrector: %.3f ms per frame, with waits for rings\n",
+               remapTime / 1e6 / corrected);
+    }
+
+    FrameRing_Close(&outRing);
+    FrameRing_Close(&inRing);
+    Remap_FreePlan(&plan);
+    FrameCorrection_FreeMap(&map);
+
+    return (0 == producerStatus && 0 == consumerStatus && corrected == numOfFrames) ?
+           EXIT_SUCCESS : EXIT_FAILURE;
+}
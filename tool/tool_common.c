@@ -22,11 +22,1758 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <math.h>
+#include <float.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
 
 /* ============================================================================================== */
 /*                              Internal Helper Functions                                         */
 /* ============================================================================================== */
 
+/* FNV-1a hash of data, continued from hash. */
+static uint64_t ToolCommon_Checksum(const void* const data, size_t size, uint64_t hash)
+{
+    const uint8_t* bytes = (const uint8_t*)data;
+    size_t i;
+
+    for(i = 0;i < size;i++)
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001B3ULL;
+    }
+
+    return hash;
+}
+
+static void ToolCommon_ReportCheck(const char* const name, int32_t passed, LDC_Status* status)
+{
+    printf("[%s] %s\n", passed ? "PASS" : "FAIL", name);
+
+    if(!passed)
+    {
+        *status = LDC_STATUS_ERROR;
+    }
+}
+
+static double ToolCommon_GetTime(void)
+{
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return (double)time.tv_sec + (double)time.tv_nsec * 1e-9;
+}
+
+/* Lens table of equisolid lens, r = 2 * f * sin(theta / 2), in CSV format. */
+static LDC_Status ToolCommon_LoadSyntheticLens(const LensProfile** lens)
+{
+    LDC_Status status;
+    double focal_length = 1.8;
+    char* buffer = malloc(4096);
+    size_t size = 0;
+    uint32_t angle;
+
+    if(NULL == buffer)
+    {
+        return LDC_STATUS_ERROR;
+    }
+
+    size += sprintf(&buffer[size], "%.1f,\n0.003,\n1,\n", focal_length);
+
+    for(angle = 0;angle <= 96;angle++)
+    {
+        size += sprintf(&buffer[size], "%u,%.6f\n", angle,
+                        2.0 * focal_length * sin(angle * 3.14159265358979323846 / 360.0));
+    }
+
+    status = LensProfile_LoadBuffer(0U, buffer, size, lens);
+    free(buffer);
+
+    return status;
+}
+
+/* Smooth pattern with edges, in samples of format. */
+static void ToolCommon_FillComponents(const YuvFormat* const format, uint8_t* const Y,
+                                      uint8_t* const U, uint8_t* const V, uint32_t width,
+                                      uint32_t height)
+{
+    uint32_t chroma_width = width >> format->chroma_shift_x;
+    uint32_t chroma_height = height >> format->chroma_shift_y;
+    uint32_t x;
+    uint32_t y;
+
+    for(y = 0;y < height;y++)
+    {
+        for(x = 0;x < width;x++)
+        {
+            uint32_t value = ((x * 3U + y * 5U) ^ ((x >> 5) * 40U)) & 0xFFU;
+
+            if(1U == format->bytes_per_sample)
+            {
+                Y[y * width + x] = (uint8_t)value;
+            }
+            else
+            {
+                ((uint16_t*)Y)[y * width + x] = (uint16_t)((value << 8) | (x & 0xFFU));
+            }
+        }
+    }
+
+    for(y = 0;y < chroma_height;y++)
+    {
+        for(x = 0;x < chroma_width;x++)
+        {
+            uint32_t u = (x * 2U + 64U) & 0xFFU;
+            uint32_t v = (y * 3U + 32U) & 0xFFU;
+
+            if(1U == format->bytes_per_sample)
+            {
+                U[y * chroma_width + x] = (uint8_t)u;
+                V[y * chroma_width + x] = (uint8_t)v;
+            }
+            else
+            {
+                ((uint16_t*)U)[y * chroma_width + x] = (uint16_t)((u << 8) | (y & 0xFFU));
+                ((uint16_t*)V)[y * chroma_width + x] = (uint16_t)((v << 8) | (x & 0xFFU));
+            }
+        }
+    }
+}
+
+/* Components of frame, with sizes of format. */
+typedef struct
+{
+    uint8_t* Y;
+    uint8_t* U;
+    uint8_t* V;
+    size_t luma_size;
+    size_t chroma_size;
+}ToolCommon_Frame;
+
+static LDC_Status ToolCommon_AllocateFrame(ToolCommon_Frame* frame,
+                                           const YuvFormat* const format, uint32_t width,
+                                           uint32_t height)
+{
+    frame->luma_size = (size_t)width * height * format->bytes_per_sample;
+    frame->chroma_size = (size_t)(width >> format->chroma_shift_x) *
+                         (height >> format->chroma_shift_y) * format->bytes_per_sample;
+    frame->Y = calloc(frame->luma_size, 1);
+    frame->U = calloc(frame->chroma_size, 1);
+    frame->V = calloc(frame->chroma_size, 1);
+
+    return (NULL == frame->Y || NULL == frame->U || NULL == frame->V) ?
+           LDC_STATUS_ERROR : LDC_STATUS_OK;
+}
+
+static void ToolCommon_FreeFrame(ToolCommon_Frame* frame)
+{
+    free(frame->Y);
+    free(frame->U);
+    free(frame->V);
+}
+
+static int32_t ToolCommon_CompareFrames(const ToolCommon_Frame* const a,
+                                        const ToolCommon_Frame* const b)
+{
+    return !memcmp(a->Y, b->Y, a->luma_size) && !memcmp(a->U, b->U, a->chroma_size) &&
+           !memcmp(a->V, b->V, a->chroma_size);
+}
+
+static uint64_t ToolCommon_FrameChecksum(const ToolCommon_Frame* const frame)
+{
+    uint64_t hash = ToolCommon_Checksum(frame->Y, frame->luma_size, 0xCBF29CE484222325ULL);
+
+    hash = ToolCommon_Checksum(frame->U, frame->chroma_size, hash);
+
+    return ToolCommon_Checksum(frame->V, frame->chroma_size, hash);
+}
+
+static void ToolCommon_CheckGolden(const char* const name, uint64_t checksum, uint64_t golden,
+                                   LDC_Status* status)
+{
+    if(checksum != golden)
+    {
+        printf("       %s checksum 0x%016llX, golden 0x%016llX\n", name,
+               (unsigned long long)checksum, (unsigned long long)golden);
+    }
+
+    ToolCommon_ReportCheck(name, checksum == golden, status);
+}
+
+/* Incremental correction has to match whole remap, for static frame, changed rectangle, and
+   previous source frame of caller. */
+static void ToolCommon_CheckDirtyRemap(const YuvFormat* const format, const LDC_Map* const map,
+                                       const ToolCommon_Frame* const source,
+                                       LDC_Interpolation interpolation, LDC_Status* status)
+{
+    const LDC_Color border = {16, 128, 128};
+    uint32_t width = TOOL_SELF_CHECK_WIDTH;
+    uint32_t height = TOOL_SELF_CHECK_HEIGHT;
+    uint32_t bps = format->bytes_per_sample;
+    uint32_t chroma_width = width >> format->chroma_shift_x;
+    ToolCommon_Frame changed;
+    ToolCommon_Frame reference;
+    ToolCommon_Frame output;
+    Remap_Plan plan;
+    DirtyRemap dirty;
+    uint32_t num_of_static = 1U;
+    uint32_t num_of_changed = 0;
+    uint32_t y;
+    int32_t passed;
+    char name[128];
+
+    if(ToolCommon_AllocateFrame(&changed, format, width, height) ||
+       ToolCommon_AllocateFrame(&reference, format, width, height) ||
+       ToolCommon_AllocateFrame(&output, format, width, height) ||
+       Remap_CreatePlan(&plan, map, format->yuv_type, interpolation))
+    {
+        ToolCommon_ReportCheck("allocation of incremental correction", 0, status);
+        return;
+    }
+
+    /* Rectangle of 64x32 source pixels is inverted. */
+    memcpy(changed.Y, source->Y, source->luma_size);
+    memcpy(changed.U, source->U, source->chroma_size);
+    memcpy(changed.V, source->V, source->chroma_size);
+    for(y = height / 3U;y < height / 3U + 32U;y++)
+    {
+        uint8_t* row = changed.Y + ((size_t)y * width + width / 3U) * bps;
+        uint8_t* chroma = changed.U + ((size_t)(y >> format->chroma_shift_y) * chroma_width +
+                                       ((width / 3U) >> format->chroma_shift_x)) * bps;
+        uint32_t x;
+
+        for(x = 0;x < 64U * bps;x++)
+        {
+            row[x] = (uint8_t)~row[x];
+        }
+
+        for(x = 0;x < (64U >> format->chroma_shift_x) * bps;x++)
+        {
+            chroma[x] = (uint8_t)~chroma[x];
+        }
+    }
+
+    passed = !DirtyRemap_Init(&dirty, &plan, 0, 0) &&
+             !DirtyRemap_Apply(&dirty, output.Y, output.U, output.V, source->Y, source->U,
+                               source->V, NULL, NULL, NULL, &border, NULL) &&
+             !DirtyRemap_Apply(&dirty, output.Y, output.U, output.V, source->Y, source->U,
+                               source->V, NULL, NULL, NULL, &border, &num_of_static) &&
+             !DirtyRemap_Apply(&dirty, output.Y, output.U, output.V, changed.Y, changed.U,
+                               changed.V, NULL, NULL, NULL, &border, &num_of_changed) &&
+             !Remap_ApplyPlan(&plan, reference.Y, reference.U, reference.V, changed.Y,
+                              changed.U, changed.V, NULL, 0, &border) &&
+             ToolCommon_CompareFrames(&reference, &output);
+
+    snprintf(name, sizeof(name), "%s incremental correction, %s", format->name,
+             (LDC_INTERPOLATION_BILINEAR == interpolation) ? "bilinear" : "nearest");
+    ToolCommon_ReportCheck(name, passed && 0U == num_of_static && num_of_changed > 0U &&
+                           num_of_changed < dirty.num_of_regions, status);
+
+    /* Back to source frame, with previous source frame of caller. */
+    passed = !DirtyRemap_Apply(&dirty, output.Y, output.U, output.V, source->Y, source->U,
+                               source->V, changed.Y, changed.U, changed.V, &border, NULL) &&
+             !Remap_ApplyPlan(&plan, reference.Y, reference.U, reference.V, source->Y,
+                              source->U, source->V, NULL, 0, &border) &&
+             ToolCommon_CompareFrames(&reference, &output);
+
+    snprintf(name, sizeof(name), "%s incremental correction with previous frame, %s",
+             format->name, (LDC_INTERPOLATION_BILINEAR == interpolation) ? "bilinear" : "nearest");
+    ToolCommon_ReportCheck(name, passed, status);
+
+    DirtyRemap_Deinit(&dirty);
+    Remap_FreePlan(&plan);
+    ToolCommon_FreeFrame(&changed);
+    ToolCommon_FreeFrame(&reference);
+    ToolCommon_FreeFrame(&output);
+}
+
+/* Split/combine, and every remap path, for one format. */
+static void ToolCommon_CheckFormat(const YuvFormat* const format, const LDC_Map* const map,
+                                   const LDC_Map* const reference_map,
+                                   const LensProfile* const lens, LDC_Status* status)
+{
+    const LDC_Color border = {16, 128, 128};
+    uint32_t width = TOOL_SELF_CHECK_WIDTH;
+    uint32_t height = TOOL_SELF_CHECK_HEIGHT;
+    size_t frame_size = YuvFormat_GetFrameSize(width, height, format->yuv_type);
+    uint8_t* YUV = malloc(frame_size);
+    ToolCommon_Frame source;
+    ToolCommon_Frame split;
+    ToolCommon_Frame reference;
+    ToolCommon_Frame output;
+    Remap_Plan plan;
+    LazyMap lazy;
+    LDC_Map odd_map;
+    LDC_OutputSpec odd_output;
+    LDC_Status expected;
+    char name[128];
+
+    if(NULL == YUV || ToolCommon_AllocateFrame(&source, format, width, height) ||
+       ToolCommon_AllocateFrame(&split, format, width, height) ||
+       ToolCommon_AllocateFrame(&reference, format, width, height) ||
+       ToolCommon_AllocateFrame(&output, format, width, height))
+    {
+        ToolCommon_ReportCheck("allocation of frames", 0, status);
+        return;
+    }
+
+    ToolCommon_FillComponents(format, source.Y, source.U, source.V, width, height);
+
+    /* Frame has to be same after combine and split. */
+    YuvFormat_Combine(format, YUV, source.Y, source.U, source.V, width, height);
+    YuvFormat_Split(format, YUV, split.Y, split.U, split.V, width, height);
+    snprintf(name, sizeof(name), "%s combine/split round trip", format->name);
+    ToolCommon_ReportCheck(name, ToolCommon_CompareFrames(&source, &split), status);
+
+    /* Sizes, that are not multiple of chroma subsampling, are rejected. */
+    snprintf(name, sizeof(name), "%s size validation", format->name);
+    ToolCommon_ReportCheck(name, !YuvFormat_ValidateSize(format, width, height) &&
+                           (0U == format->chroma_shift_x) ==
+                           !YuvFormat_ValidateSize(format, width - 1U, height) &&
+                           (0U == format->chroma_shift_y) ==
+                           !YuvFormat_ValidateSize(format, width, height - 1U) &&
+                           YuvFormat_ValidateSize(format, 0U, height), status);
+
+    /* Odd output of subsampled format would overflow chroma components of output. */
+    odd_output.width = 31U;
+    odd_output.height = 17U;
+    odd_output.scale = 0.0;
+    odd_output.use_centre = 0U;
+    snprintf(name, sizeof(name), "%s odd output size", format->name);
+    if(!FrameCorrection_GenerateMap(&odd_map, width, height, &odd_output, NULL, 0, lens, NULL))
+    {
+        expected = (0U == (format->chroma_shift_x | format->chroma_shift_y)) ?
+                   LDC_STATUS_OK : LDC_STATUS_INVALID_ARGUMENT;
+        ToolCommon_ReportCheck(name, expected == Remap_CreatePlan(&plan, &odd_map,
+                                                                  format->yuv_type,
+                                                                  LDC_INTERPOLATION_NEAREST) &&
+                               expected == FrameCorrection_ApplyMap(&odd_map, output.Y, output.U,
+                                                                    output.V, source.Y, source.U,
+                                                                    source.V, format->yuv_type,
+                                                                    NULL, 0, &border), status);
+        Remap_FreePlan(&plan);
+        FrameCorrection_FreeMap(&odd_map);
+    }
+    else
+    {
+        ToolCommon_ReportCheck(name, 0, status);
+    }
+
+    /* Map kernel is reference of remap paths. */
+    FrameCorrection_ApplyMap(map, reference.Y, reference.U, reference.V, source.Y, source.U,
+                             source.V, format->yuv_type, NULL, 0, &border);
+
+    snprintf(name, sizeof(name), "%s remap plan, nearest", format->name);
+    ToolCommon_ReportCheck(name, !Remap_CreatePlan(&plan, map, format->yuv_type,
+                                                   LDC_INTERPOLATION_NEAREST) &&
+                           !Remap_ApplyPlan(&plan, output.Y, output.U, output.V, source.Y,
+                                            source.U, source.V, NULL, 0, &border) &&
+                           ToolCommon_CompareFrames(&reference, &output), status);
+    Remap_FreePlan(&plan);
+
+    memset(output.Y, 0, output.luma_size);
+    memset(output.U, 0, output.chroma_size);
+    memset(output.V, 0, output.chroma_size);
+    snprintf(name, sizeof(name), "%s lazy map", format->name);
+    ToolCommon_ReportCheck(name, !LazyMap_Init(&lazy, width, height, NULL, lens, 0) &&
+                           !LazyMap_ApplyMap(&lazy, output.Y, output.U, output.V, source.Y,
+                                             source.U, source.V, format->yuv_type,
+                                             LDC_INTERPOLATION_NEAREST, NULL, 0, &border) &&
+                           ToolCommon_CompareFrames(&reference, &output), status);
+
+    /* Bilinear tiles have to match bilinear plan of same map. */
+    memset(output.Y, 0, output.luma_size);
+    memset(output.U, 0, output.chroma_size);
+    memset(output.V, 0, output.chroma_size);
+    snprintf(name, sizeof(name), "%s lazy map, bilinear", format->name);
+    ToolCommon_ReportCheck(name, !Remap_CreatePlan(&plan, map, format->yuv_type,
+                                                   LDC_INTERPOLATION_BILINEAR) &&
+                           !Remap_ApplyPlan(&plan, reference.Y, reference.U, reference.V,
+                                            source.Y, source.U, source.V, NULL, 0, &border) &&
+                           !LazyMap_ApplyMap(&lazy, output.Y, output.U, output.V, source.Y,
+                                             source.U, source.V, format->yuv_type,
+                                             LDC_INTERPOLATION_BILINEAR, NULL, 0, &border) &&
+                           ToolCommon_CompareFrames(&reference, &output), status);
+    Remap_FreePlan(&plan);
+    LazyMap_Deinit(&lazy);
+
+    ToolCommon_CheckDirtyRemap(format, map, &source, LDC_INTERPOLATION_NEAREST, status);
+    ToolCommon_CheckDirtyRemap(format, map, &source, LDC_INTERPOLATION_BILINEAR, status);
+
+    /* Golden outputs are remapped with reference map, so they do not depend on SIMD of fast map. */
+    if(YUV420_NV12 == format->yuv_type && NULL != reference_map)
+    {
+        FrameCorrection_ApplyMap(reference_map, output.Y, output.U, output.V, source.Y, source.U,
+                                 source.V, format->yuv_type, NULL, 0, &border);
+        ToolCommon_CheckGolden("YUV420_NV12 golden nearest output",
+                               ToolCommon_FrameChecksum(&output),
+                               TOOL_GOLDEN_NEAREST_CHECKSUM, status);
+
+        if(!Remap_CreatePlan(&plan, reference_map, format->yuv_type,
+                             LDC_INTERPOLATION_BILINEAR) &&
+           !Remap_ApplyPlan(&plan, output.Y, output.U, output.V, source.Y, source.U, source.V,
+                            NULL, 0, &border))
+        {
+            ToolCommon_CheckGolden("YUV420_NV12 golden bilinear output",
+                                   ToolCommon_FrameChecksum(&output),
+                                   TOOL_GOLDEN_BILINEAR_CHECKSUM, status);
+        }
+        else
+        {
+            ToolCommon_ReportCheck("YUV420_NV12 bilinear remap plan", 0, status);
+        }
+
+        Remap_FreePlan(&plan);
+    }
+
+    free(YUV);
+    ToolCommon_FreeFrame(&source);
+    ToolCommon_FreeFrame(&split);
+    ToolCommon_FreeFrame(&reference);
+    ToolCommon_FreeFrame(&output);
+}
+
+/* Library context, created from loaded lens, has to correct frames exactly as map kernel. Sizes
+   that are not multiples of chroma subsampling, and invalid lens text, are rejected. */
+static void ToolCommon_CheckLibrary(const YuvFormat* const format, const LDC_Map* const map,
+                                    const LensProfile* const lens, LDC_Status* status)
+{
+    static const char invalid_lens[] = "8.0\n0.003\n1.0\n0.0,x\n";
+    const LDC_Color border = {16, 128, 128};
+    size_t in_size = YuvFormat_GetFrameSize(map->src_width, map->src_height, format->yuv_type);
+    size_t out_size = YuvFormat_GetFrameSize(map->width, map->height, format->yuv_type);
+    uint8_t* in = (uint8_t*)malloc(in_size);
+    uint8_t* out = (uint8_t*)malloc(out_size);
+    Ldc_Context* context = NULL;
+    Ldc_Config config;
+    ToolCommon_Frame source;
+    ToolCommon_Frame reference;
+    ToolCommon_Frame output;
+    LDC_Status expected;
+    size_t context_in_size = 0;
+    size_t context_out_size = 0;
+    uint32_t i;
+    int32_t passed;
+    char name[128];
+
+    memset(&source, 0, sizeof(ToolCommon_Frame));
+    memset(&reference, 0, sizeof(ToolCommon_Frame));
+    memset(&output, 0, sizeof(ToolCommon_Frame));
+    memset(&config, 0, sizeof(Ldc_Config));
+    config.lens = lens;
+    config.width = map->src_width;
+    config.height = map->src_height;
+    config.yuv_type = format->yuv_type;
+    config.interpolation = LDC_INTERPOLATION_NEAREST;
+    config.border = border;
+    config.use_border = 1U;
+
+    passed = NULL != in && NULL != out &&
+             !ToolCommon_AllocateFrame(&source, format, map->src_width, map->src_height) &&
+             !ToolCommon_AllocateFrame(&reference, format, map->width, map->height) &&
+             !ToolCommon_AllocateFrame(&output, format, map->width, map->height) &&
+             !Ldc_Create(&config, &context) &&
+             !Ldc_GetFrameSizes(context, &context_in_size, &context_out_size) &&
+             in_size == context_in_size && out_size == context_out_size;
+
+    if(passed)
+    {
+        ToolCommon_FillComponents(format, source.Y, source.U, source.V, map->src_width,
+                                  map->src_height);
+        YuvFormat_Combine(format, in, source.Y, source.U, source.V, map->src_width,
+                          map->src_height);
+        passed = !FrameCorrection_ApplyMap(map, reference.Y, reference.U, reference.V, source.Y,
+                                           source.U, source.V, format->yuv_type, NULL, 0,
+                                           &border);
+    }
+
+    /* Second frame reuses scratch components of first frame. */
+    for(i = 0;passed && i < 2U;i++)
+    {
+        memset(out, 0, out_size);
+        passed = !Ldc_CorrectFrame(context, in, in_size, out, out_size);
+        if(passed)
+        {
+            YuvFormat_Split(format, out, output.Y, output.U, output.V, map->width, map->height);
+            passed = ToolCommon_CompareFrames(&reference, &output);
+        }
+    }
+
+    /* Rejected frames and configurations are expected, so their errors are not printed. */
+    LdcLog_SetCallback(NULL, NULL);
+
+    snprintf(name, sizeof(name), "%s library context against map", format->name);
+    ToolCommon_ReportCheck(name, passed && LDC_STATUS_INVALID_ARGUMENT ==
+                           Ldc_CorrectFrame(context, in, in_size - 1U, out, out_size), status);
+    Ldc_Destroy(context);
+    context = NULL;
+
+    /* Odd output of subsampled format would overflow chroma components of output. */
+    config.output.width = 31U;
+    config.output.height = 17U;
+    expected = (0U == (format->chroma_shift_x | format->chroma_shift_y)) ?
+               LDC_STATUS_OK : LDC_STATUS_INVALID_ARGUMENT;
+    snprintf(name, sizeof(name), "%s library context rejects odd output size", format->name);
+    ToolCommon_ReportCheck(name, expected == Ldc_Create(&config, &context), status);
+    Ldc_Destroy(context);
+    context = NULL;
+
+    config.output.width = 0U;
+    config.output.height = 0U;
+    config.lens = NULL;
+    config.lens_buffer = invalid_lens;
+    config.lens_buffer_size = sizeof(invalid_lens) - 1U;
+    snprintf(name, sizeof(name), "%s library context rejects invalid lens", format->name);
+    ToolCommon_ReportCheck(name, LDC_STATUS_INVALID_LENS == Ldc_Create(&config, &context) &&
+                           NULL == context, status);
+    Ldc_Destroy(context);
+    LdcLog_SetCallback(ToolCommon_PrintLogMessage, NULL);
+
+    free(in);
+    free(out);
+    ToolCommon_FreeFrame(&source);
+    ToolCommon_FreeFrame(&reference);
+    ToolCommon_FreeFrame(&output);
+}
+
+/* Analytic models in closed form, against their double precision reference map. Synthetic table
+   is equisolid, so equisolid and polynomial model have to fit it. */
+static void ToolCommon_CheckLensModels(const LensProfile* const table, uint32_t width,
+                                       uint32_t height, LDC_Status* status)
+{
+    static const char* const names[] = {"table", "equisolid", "equidistant", "stereographic",
+                                        "polynomial"};
+    uint32_t type;
+    char name[128];
+
+    for(type = LENS_MODEL_EQUISOLID;type <= LENS_MODEL_POLYNOMIAL;type++)
+    {
+        const LensProfile* lens = NULL;
+        LensModel model;
+        LDC_Map map;
+        LDC_Map reference;
+        double fit_error;
+        double max_error = DBL_MAX;
+        int32_t fitted;
+
+        fitted = !LensModel_Fit((LensModel_Type)type, table->focal_length_in_mm /
+                                table->sensor_pixel_pitch_in_mm, table->angle, table->height,
+                                table->num_of_useful_elements, &model, &fit_error) &&
+                 !LensProfile_LoadModel(0U, &model, table->sensor_pixel_pitch_in_mm,
+                                        table->scaling_factor, &lens);
+
+        if(fitted && !FrameCorrection_GenerateMap(&map, width, height, NULL, NULL, 0, lens,
+                                                  NULL))
+        {
+            if(!FrameCorrection_GenerateReferenceMap(&reference, width, height, NULL, NULL, 0,
+                                                     lens, NULL))
+            {
+                FrameCorrection_GetMapMaxError(&map, &reference, &max_error);
+                FrameCorrection_FreeMap(&reference);
+            }
+
+            FrameCorrection_FreeMap(&map);
+        }
+
+        sprintf(name, "%s model map against reference map", names[type]);
+        ToolCommon_ReportCheck(name, max_error <= FAST_MAP_MAX_COORDINATE_ERROR, status);
+
+        if(LENS_MODEL_EQUISOLID == type || LENS_MODEL_POLYNOMIAL == type)
+        {
+            sprintf(name, "%s model against lens table", names[type]);
+            ToolCommon_ReportCheck(name, fitted && fit_error <= FAST_MAP_MAX_COORDINATE_ERROR,
+                                   status);
+        }
+
+        LensProfile_Release(lens);
+    }
+}
+
+/* Virtual camera without rotation is map of output frame with same scale. Centre pixel of
+   view, turned by yaw or pitch, is at distorted radius of that angle. */
+static void ToolCommon_CheckVirtualCamera(const LensProfile* const lens, uint32_t width,
+                                          uint32_t height, LDC_Status* status)
+{
+    VirtualCamera_Pose pose = {0.0, 0.0, 0.0, 100.0};
+    VirtualCamera camera;
+    LDC_OutputSpec output;
+    LDC_Map map;
+    WorkerPool pool;
+    double max_error = 0.0;
+    double theta[2] = {30.0 * M_PI / 180.0, 20.0 * M_PI / 180.0};
+    double r_d[2];
+    uint32_t centre;
+    uint32_t i;
+    int32_t passed;
+
+    if(VirtualCamera_Init(&camera, lens, width, height, width / 2U, height / 2U) ||
+       VirtualCamera_Update(&camera, &pose, NULL))
+    {
+        ToolCommon_ReportCheck("virtual camera", 0, status);
+        VirtualCamera_Deinit(&camera);
+        return;
+    }
+
+    memset(&output, 0, sizeof(LDC_OutputSpec));
+    output.width = camera.map.width;
+    output.height = camera.map.height;
+    output.scale = camera.map.scale;
+
+    ToolCommon_ReportCheck("virtual camera without rotation against map",
+                           !FrameCorrection_GenerateMap(&map, width, height, &output, NULL, 0,
+                                                        lens, NULL) &&
+                           !FrameCorrection_GetMapMaxError(&camera.map, &map, &max_error) &&
+                           max_error <= FAST_MAP_MAX_COORDINATE_ERROR &&
+                           camera.map.num_of_spans == map.num_of_spans, status);
+    FrameCorrection_FreeMap(&map);
+
+    LensProfile_InterpolateHeight(lens, theta, r_d, 2U);
+    centre = (camera.map.height - 1U) / 2U * camera.map.width + (camera.map.width - 1U) / 2U;
+
+    pose.yaw = 30.0;
+    passed = !VirtualCamera_Update(&camera, &pose, NULL) &&
+             fabs(camera.map.h_d[centre] - (camera.lut.hc + r_d[0])) <=
+             FAST_MAP_MAX_COORDINATE_ERROR &&
+             fabs(camera.map.v_d[centre] - camera.lut.vc) <= FAST_MAP_MAX_COORDINATE_ERROR;
+
+    pose.yaw = 0.0;
+    pose.pitch = 20.0;
+    pose.roll = 45.0;
+    passed = passed && !VirtualCamera_Update(&camera, &pose, NULL) &&
+             fabs(camera.map.h_d[centre] - camera.lut.hc) <= FAST_MAP_MAX_COORDINATE_ERROR &&
+             fabs(camera.map.v_d[centre] - (camera.lut.vc - r_d[1])) <=
+             FAST_MAP_MAX_COORDINATE_ERROR;
+    ToolCommon_ReportCheck("virtual camera turned by yaw and pitch", passed, status);
+
+    /* Spans found by bands have to be same as spans of whole map. */
+    map = camera.map;
+    map.row_spans = NULL;
+    map.spans = NULL;
+    ToolCommon_ReportCheck("spans of virtual camera",
+                           !FrameCorrection_UpdateSpans(&map) &&
+                           map.num_of_spans == camera.map.num_of_spans &&
+                           !memcmp(map.row_spans, camera.map.row_spans,
+                                   (map.height + 1U) * sizeof(uint32_t)) &&
+                           !memcmp(map.spans, camera.map.spans,
+                                   map.num_of_spans * sizeof(LDC_Span)), status);
+    free(map.row_spans);
+    free(map.spans);
+    VirtualCamera_Deinit(&camera);
+
+    /* Pose changes every frame, so every update generates whole map. */
+    if(!WorkerPool_Init(&pool, TOOL_SELF_CHECK_THREADS))
+    {
+        double start;
+
+        passed = !VirtualCamera_Init(&camera, lens, TOOL_PERF_WIDTH, TOOL_PERF_HEIGHT,
+                                     TOOL_PERF_WIDTH, TOOL_PERF_HEIGHT);
+        start = ToolCommon_GetTime();
+
+        for(i = 0;passed && i < TOOL_PERF_ITERATIONS;i++)
+        {
+            pose.yaw = -20.0 + (double)i;
+            pose.pitch = 10.0 - 0.5 * (double)i;
+            passed = !VirtualCamera_Update(&camera, &pose, &pool);
+        }
+
+        printf("       Virtual camera map %ux%u, %u threads: %.3f ms\n", TOOL_PERF_WIDTH,
+               TOOL_PERF_HEIGHT, TOOL_SELF_CHECK_THREADS,
+               (ToolCommon_GetTime() - start) * 1000.0 / TOOL_PERF_ITERATIONS);
+        ToolCommon_ReportCheck("virtual camera, pose of every frame", passed, status);
+        VirtualCamera_Deinit(&camera);
+        WorkerPool_Deinit(&pool);
+    }
+}
+
+/* Remap frame with new plan of map. */
+static LDC_Status ToolCommon_RemapWithPlan(const LDC_Map* const map, YUV_Type yuv_type,
+                                           LDC_Interpolation interpolation,
+                                           ToolCommon_Frame* output,
+                                           const ToolCommon_Frame* const source)
+{
+    const LDC_Color border = {16, 128, 128};
+    Remap_Plan plan;
+    LDC_Status status = Remap_CreatePlan(&plan, map, yuv_type, interpolation);
+
+    if(LDC_STATUS_OK == status)
+    {
+        status = Remap_ApplyPlan(&plan, output->Y, output->U, output->V, source->Y, source->U,
+                                 source->V, NULL, 0, &border);
+    }
+
+    Remap_FreePlan(&plan);
+
+    return status;
+}
+
+/* Composed map against map, followed by standalone warp of transform. Rotations and flips have
+   to give same frame, homography only close frame, because positions are interpolated instead
+   of pixels. */
+static void ToolCommon_CheckMapComposition(const LDC_Map* const map, LDC_Status* status)
+{
+    static const char* const names[] = {"rotation 90", "rotation 180", "rotation 270",
+                                        "mirror", "rotation 90 and mirror", "second map",
+                                        "homography"};
+    const double homography[MAP_COMPOSE_TRANSFORM_SIZE] = {1.0, 0.03, -6.0, -0.02, 0.98, 9.0,
+                                                           2e-5, -1e-5, 1.0};
+    const YuvFormat* format = YuvFormat_Get(YUV444_PLANAR);
+    uint32_t width = TOOL_SELF_CHECK_WIDTH;
+    uint32_t height = TOOL_SELF_CHECK_HEIGHT;
+    double transform[MAP_COMPOSE_TRANSFORM_SIZE];
+    double flip[MAP_COMPOSE_TRANSFORM_SIZE];
+    ToolCommon_Frame source;
+    ToolCommon_Frame corrected;
+    uint32_t c;
+    uint32_t interpolation;
+    char name[128];
+
+    if(ToolCommon_AllocateFrame(&source, format, width, height) ||
+       ToolCommon_AllocateFrame(&corrected, format, width, height))
+    {
+        ToolCommon_ReportCheck("allocation of composition frames", 0, status);
+        return;
+    }
+
+    ToolCommon_FillComponents(format, source.Y, source.U, source.V, width, height);
+
+    for(c = 0;c < sizeof(names) / sizeof(names[0]);c++)
+    {
+        uint32_t out_width = width;
+        uint32_t out_height = height;
+        LDC_Map identity;
+        LDC_Map warp;
+        LDC_Map composed;
+        int32_t built;
+
+        if(c < 3U)
+        {
+            MapCompose_GetRotation(c + 1U, width, height, transform, &out_width, &out_height);
+        }
+        else if(3U == c || 5U == c)
+        {
+            MapCompose_GetFlip(1U, 0U, width, height, transform);
+        }
+        else if(4U == c)
+        {
+            MapCompose_GetRotation(1U, width, height, transform, &out_width, &out_height);
+            MapCompose_GetFlip(1U, 0U, out_width, out_height, flip);
+            MapCompose_MultiplyTransforms(transform, flip, transform);
+        }
+        else
+        {
+            uint32_t x;
+            uint32_t y;
+
+            /* Pattern has sharp edges, where interpolated positions and pixels differ, so
+               homography is checked with smooth ramp. */
+            for(y = 0;y < height;y++)
+            {
+                for(x = 0;x < width;x++)
+                {
+                    source.Y[y * width + x] = (uint8_t)((x * 255U / width +
+                                                         y * 255U / height) / 2U);
+                }
+            }
+
+            memcpy(transform, homography, sizeof(homography));
+        }
+
+        /* Standalone warp is identity map, composed with transform. */
+        built = !MapCompose_CreateIdentity(&identity, width, height);
+        built = built && !MapCompose_Transform(&warp, &identity, transform, out_width,
+                                               out_height);
+        built = built && ((5U == c) ? !MapCompose_Maps(&composed, map, &warp) :
+                                      !MapCompose_Transform(&composed, map, transform,
+                                                            out_width, out_height));
+
+        for(interpolation = 0;built && interpolation < 2U;interpolation++)
+        {
+            ToolCommon_Frame sequential;
+            ToolCommon_Frame single;
+            int32_t passed = 0;
+
+            if(!ToolCommon_AllocateFrame(&sequential, format, out_width, out_height) &&
+               !ToolCommon_AllocateFrame(&single, format, out_width, out_height) &&
+               !ToolCommon_RemapWithPlan(map, YUV444_PLANAR, (LDC_Interpolation)interpolation,
+                                         &corrected, &source) &&
+               !ToolCommon_RemapWithPlan(&warp, YUV444_PLANAR,
+                                         (LDC_Interpolation)interpolation, &sequential,
+                                         &corrected) &&
+               !ToolCommon_RemapWithPlan(&composed, YUV444_PLANAR,
+                                         (LDC_Interpolation)interpolation, &single, &source))
+            {
+                if(6U != c)
+                {
+                    passed = ToolCommon_CompareFrames(&sequential, &single);
+                }
+                else
+                {
+                    double difference = 0.0;
+                    size_t i;
+
+                    for(i = 0;i < single.luma_size;i++)
+                    {
+                        difference += abs((int32_t)single.Y[i] - (int32_t)sequential.Y[i]);
+                    }
+
+                    difference /= (double)single.luma_size;
+                    printf("       Homography, mean difference from sequential warps %.3f\n",
+                           difference);
+                    passed = difference <= TOOL_COMPOSE_MAX_MEAN_DIFFERENCE;
+                }
+            }
+
+            snprintf(name, sizeof(name), "composed map, %s, %s", names[c],
+                     interpolation ? "bilinear" : "nearest");
+            ToolCommon_ReportCheck(name, passed, status);
+            ToolCommon_FreeFrame(&sequential);
+            ToolCommon_FreeFrame(&single);
+        }
+
+        if(!built)
+        {
+            snprintf(name, sizeof(name), "composed map, %s", names[c]);
+            ToolCommon_ReportCheck(name, 0, status);
+        }
+
+        FrameCorrection_FreeMap(&identity);
+        FrameCorrection_FreeMap(&warp);
+        FrameCorrection_FreeMap(&composed);
+    }
+
+    ToolCommon_FreeFrame(&source);
+    ToolCommon_FreeFrame(&corrected);
+}
+
+/* Component of half width and height, as 2x2 averages, for reference pyramid. */
+static void ToolCommon_ReduceComponent(const uint8_t* const src, uint8_t* const dst,
+                                       uint32_t width, uint32_t height,
+                                       uint32_t bytes_per_sample)
+{
+    uint32_t x;
+    uint32_t y;
+    uint32_t i;
+
+    for(y = 0;y < height;y++)
+    {
+        for(x = 0;x < width;x++)
+        {
+            uint32_t sum = 2U;
+
+            for(i = 0;i < 4U;i++)
+            {
+                size_t index = (size_t)(2U * y + (i >> 1)) * (2U * width) + 2U * x + (i & 1U);
+
+                sum += (1U == bytes_per_sample) ? src[index] : ((const uint16_t*)src)[index];
+            }
+
+            if(1U == bytes_per_sample)
+            {
+                dst[y * width + x] = (uint8_t)(sum >> 2);
+            }
+            else
+            {
+                ((uint16_t*)dst)[y * width + x] = (uint16_t)(sum >> 2);
+            }
+        }
+    }
+}
+
+/* Pyramid of one pass against remap of full frame, followed by reductions of whole levels. */
+static void ToolCommon_CheckPyramid(const LDC_Map* const map, WorkerPool* pool,
+                                    LDC_Status* status)
+{
+    const uint32_t num_of_levels = 3U;
+    ToolCommon_Frame source;
+    ToolCommon_Frame reference[3];
+    ToolCommon_Frame output[3];
+    Pyramid_Level levels[3];
+    uint32_t yuv_type;
+    uint32_t level;
+    char name[128];
+
+    for(yuv_type = 1;NULL != YuvFormat_Get((YUV_Type)yuv_type);yuv_type++)
+    {
+        const YuvFormat* format = YuvFormat_Get((YUV_Type)yuv_type);
+        uint32_t interpolation = yuv_type & 1U;
+        const LDC_Color border = {16, 128, 128};
+        Remap_Plan plan;
+        int32_t passed;
+
+        memset(&plan, 0, sizeof(Remap_Plan));
+        passed = !ToolCommon_AllocateFrame(&source, format, map->width, map->height) &&
+                 !Remap_CreatePlan(&plan, map, (YUV_Type)yuv_type,
+                                   (LDC_Interpolation)interpolation);
+
+        for(level = 0;level < num_of_levels;level++)
+        {
+            passed = !ToolCommon_AllocateFrame(&reference[level], format,
+                                               map->width >> level, map->height >> level) &&
+                     !ToolCommon_AllocateFrame(&output[level], format, map->width >> level,
+                                               map->height >> level) && passed;
+            levels[level].Y = output[level].Y;
+            levels[level].U = output[level].U;
+            levels[level].V = output[level].V;
+        }
+
+        if(passed)
+        {
+            ToolCommon_FillComponents(format, source.Y, source.U, source.V, map->width,
+                                      map->height);
+            passed = !Remap_ApplyPlan(&plan, reference[0].Y, reference[0].U, reference[0].V,
+                                      source.Y, source.U, source.V, NULL, 0, &border);
+
+            for(level = 1;level < num_of_levels;level++)
+            {
+                uint32_t width = map->width >> level;
+                uint32_t height = map->height >> level;
+
+                ToolCommon_ReduceComponent(reference[level - 1U].Y, reference[level].Y, width,
+                                           height, format->bytes_per_sample);
+                ToolCommon_ReduceComponent(reference[level - 1U].U, reference[level].U,
+                                           width >> format->chroma_shift_x,
+                                           height >> format->chroma_shift_y,
+                                           format->bytes_per_sample);
+                ToolCommon_ReduceComponent(reference[level - 1U].V, reference[level].V,
+                                           width >> format->chroma_shift_x,
+                                           height >> format->chroma_shift_y,
+                                           format->bytes_per_sample);
+            }
+
+            /* Serial, and then parallel pass into same levels. */
+            passed = passed && !Pyramid_ApplyPlan(&plan, levels, num_of_levels, source.Y,
+                                                  source.U, source.V, &border, NULL);
+
+            for(level = 0;level < num_of_levels;level++)
+            {
+                passed = passed && ToolCommon_CompareFrames(&reference[level], &output[level]);
+                memset(output[level].Y, 0, output[level].luma_size);
+            }
+
+            passed = passed && !Pyramid_ApplyPlan(&plan, levels, num_of_levels, source.Y,
+                                                  source.U, source.V, &border, pool);
+
+            for(level = 0;level < num_of_levels;level++)
+            {
+                passed = passed && ToolCommon_CompareFrames(&reference[level], &output[level]);
+            }
+        }
+
+        snprintf(name, sizeof(name), "pyramid of %u levels, %s", num_of_levels, format->name);
+        ToolCommon_ReportCheck(name, passed, status);
+
+        Remap_FreePlan(&plan);
+        ToolCommon_FreeFrame(&source);
+
+        for(level = 0;level < num_of_levels;level++)
+        {
+            ToolCommon_FreeFrame(&reference[level]);
+            ToolCommon_FreeFrame(&output[level]);
+        }
+    }
+}
+
+static uint32_t ToolCommon_LoadSample(const uint8_t* const component, size_t index,
+                                      uint32_t bytes_per_sample)
+{
+    return (1U == bytes_per_sample) ? component[index] : ((const uint16_t*)component)[index];
+}
+
+/* Reference components of output YUV type, from components of plan YUV type. */
+static void ToolCommon_ConvertComponents(const YuvFormat* const in, const YuvFormat* const out,
+                                         const ToolCommon_Frame* const src,
+                                         const ToolCommon_Frame* const dst, uint32_t width,
+                                         uint32_t height)
+{
+    uint32_t up = (out->bytes_per_sample > in->bytes_per_sample) ? 8U : 0U;
+    uint32_t down = (out->bytes_per_sample < in->bytes_per_sample) ? 8U : 0U;
+    uint32_t in_width = width >> in->chroma_shift_x;
+    uint32_t out_width = width >> out->chroma_shift_x;
+    size_t i;
+    uint32_t x;
+    uint32_t y;
+
+    for(i = 0;i < (size_t)width * height;i++)
+    {
+        uint32_t value = (ToolCommon_LoadSample(src->Y, i, in->bytes_per_sample) << up) >> down;
+
+        if(1U == out->bytes_per_sample)
+        {
+            dst->Y[i] = (uint8_t)value;
+        }
+        else
+        {
+            ((uint16_t*)dst->Y)[i] = (uint16_t)value;
+        }
+    }
+
+    for(y = 0;y < (height >> out->chroma_shift_y);y++)
+    {
+        for(x = 0;x < out_width;x++)
+        {
+            size_t s = (size_t)((y << out->chroma_shift_y) >> in->chroma_shift_y) * in_width +
+                       ((x << out->chroma_shift_x) >> in->chroma_shift_x);
+            size_t d = (size_t)y * out_width + x;
+            uint32_t u = (ToolCommon_LoadSample(src->U, s, in->bytes_per_sample) << up) >> down;
+            uint32_t v = (ToolCommon_LoadSample(src->V, s, in->bytes_per_sample) << up) >> down;
+
+            if(1U == out->bytes_per_sample)
+            {
+                dst->U[d] = (uint8_t)u;
+                dst->V[d] = (uint8_t)v;
+            }
+            else
+            {
+                ((uint16_t*)dst->U)[d] = (uint16_t)u;
+                ((uint16_t*)dst->V)[d] = (uint16_t)v;
+            }
+        }
+    }
+}
+
+/* Largest difference of RGB output against floating point matrix, of planar remap output. */
+static double ToolCommon_GetRgbError(const YuvFormat* const format,
+                                     const ToolCommon_Frame* const frame,
+                                     const OutputConvert_Spec* const spec,
+                                     const uint8_t* const output, uint32_t width,
+                                     uint32_t height)
+{
+    static const double matrices[2][4] = {{1.596027, 0.391762, 0.812968, 2.017232},
+                                          {1.792741, 0.213249, 0.532909, 2.112402}};
+    const double* m = matrices[spec->matrix];
+    uint32_t shift = 8U * (format->bytes_per_sample - 1U);
+    double max_error = 0.0;
+    uint32_t x;
+    uint32_t y;
+    uint32_t c;
+
+    for(y = 0;y < height;y++)
+    {
+        for(x = 0;x < width;x++)
+        {
+            size_t i = (size_t)y * width + x;
+            size_t k = (size_t)(y >> format->chroma_shift_y) * (width >> format->chroma_shift_x) +
+                       (x >> format->chroma_shift_x);
+            double luma = 1.164384 * ((ToolCommon_LoadSample(frame->Y, i,
+                                                             format->bytes_per_sample) >>
+                                       shift) - 16.0);
+            double u = (ToolCommon_LoadSample(frame->U, k, format->bytes_per_sample) >> shift) -
+                       128.0;
+            double v = (ToolCommon_LoadSample(frame->V, k, format->bytes_per_sample) >> shift) -
+                       128.0;
+            double rgb[3];
+
+            rgb[0] = luma + m[0] * v;
+            rgb[1] = luma - m[1] * u - m[2] * v;
+            rgb[2] = luma + m[3] * u;
+
+            for(c = 0;c < 3U;c++)
+            {
+                double expected = fmin(fmax(rgb[c], 0.0), 255.0);
+                double actual;
+
+                if(OUTPUT_CONVERT_RGB_PLANAR_F32 == spec->type)
+                {
+                    actual = 255.0 * ((const float*)output)[(size_t)c * width * height + i];
+                }
+                else
+                {
+                    actual = output[3U * i + ((OUTPUT_CONVERT_BGR24 == spec->type) ? 2U - c : c)];
+                }
+
+                max_error = fmax(max_error, fabs(actual - expected));
+            }
+        }
+    }
+
+    return max_error;
+}
+
+/* Fused conversion against planar remap of whole frame, converted by tool. */
+static void ToolCommon_CheckOutputConvert(const LDC_Map* const map, WorkerPool* pool,
+                                          LDC_Status* status)
+{
+    /* RGB outputs of 8 and 16 bit, 4:2:0 and 4:2:2 frames, and then YUV layouts. */
+    static const YUV_Type inputs[12] = {YUV420_NV12, YUV420_NV12, YUV420_NV12, YUV420_P010,
+                                        YUV420_P010, YUV422I_UYVY, YUV420_NV12, YUV420_NV12,
+                                        YUV422I_UYVY, YUV420_NV12, YUV420_P016, YUV444_PLANAR};
+    static const YUV_Type outputs[12] = {YUV420_NV12, YUV420_NV12, YUV420_NV12, YUV420_NV12,
+                                         YUV420_NV12, YUV420_NV12, YUV422I_UYVY, YUV420_I420,
+                                         YUV420_NV12, YUV420_P010, YUV422I_YUYV, YUV420_NV21};
+    static const char* const names[4] = {"", "RGB24", "BGR24", "planar float RGB"};
+    const LDC_Color border = {16, 128, 128};
+    LDC_Roi roi = {0, 0, map->width, map->height};
+    uint32_t width = map->width;
+    uint32_t height = map->height;
+    uint32_t i;
+    char name[160];
+
+    for(i = 0;i < 12U;i++)
+    {
+        OutputConvert_Spec spec;
+        const YuvFormat* format;
+        const YuvFormat* out_format;
+        ToolCommon_Frame source;
+        ToolCommon_Frame planar;
+        ToolCommon_Frame converted;
+        Remap_Plan plan;
+        uint8_t* output;
+        uint8_t* expected;
+        size_t size;
+        int32_t passed;
+
+        spec.type = (i < 6U) ? (OutputConvert_Type)(1U + i % 3U) : OUTPUT_CONVERT_YUV;
+        spec.matrix = (OutputConvert_Matrix)(i & 1U);
+        spec.yuv_type = outputs[i];
+        format = YuvFormat_Get(inputs[i]);
+        out_format = (OUTPUT_CONVERT_YUV == spec.type) ? YuvFormat_Get(spec.yuv_type) : format;
+        size = OutputConvert_GetFrameSize(&spec, width, height);
+
+        memset(&plan, 0, sizeof(Remap_Plan));
+        output = (uint8_t*)calloc(size, 1);
+        expected = (uint8_t*)calloc(size, 1);
+        passed = NULL != output && NULL != expected &&
+                 !ToolCommon_AllocateFrame(&source, format, width, height) &&
+                 !ToolCommon_AllocateFrame(&planar, format, width, height) &&
+                 !ToolCommon_AllocateFrame(&converted, out_format, width, height) &&
+                 !Remap_CreatePlan(&plan, map, format->yuv_type, (LDC_Interpolation)(i & 1U));
+
+        if(passed)
+        {
+            ToolCommon_FillComponents(format, source.Y, source.U, source.V, width, height);
+            passed = !Remap_ApplyPlan(&plan, planar.Y, planar.U, planar.V, source.Y, source.U,
+                                      source.V, &roi, 1U, &border) &&
+                     !OutputConvert_ApplyPlan(&plan, &spec, output, source.Y, source.U,
+                                              source.V, &border, (i & 2U) ? pool : NULL);
+
+            if(OUTPUT_CONVERT_YUV == spec.type)
+            {
+                ToolCommon_ConvertComponents(format, out_format, &planar, &converted, width,
+                                             height);
+                YuvFormat_Combine(out_format, expected, converted.Y, converted.U, converted.V,
+                                  width, height);
+                passed = passed && !memcmp(output, expected, size);
+            }
+            else
+            {
+                /* Integer output is rounded, float output only differs by float precision. */
+                passed = passed && ToolCommon_GetRgbError(format, &planar, &spec, output, width,
+                                                          height) <=
+                         ((OUTPUT_CONVERT_RGB_PLANAR_F32 == spec.type) ? 0.001 : 1.0);
+            }
+        }
+
+        snprintf(name, sizeof(name), "fused output conversion, %s to %s%s", format->name,
+                 names[spec.type], (OUTPUT_CONVERT_YUV == spec.type) ? out_format->name : "");
+        ToolCommon_ReportCheck(name, passed, status);
+
+        Remap_FreePlan(&plan);
+        ToolCommon_FreeFrame(&source);
+        ToolCommon_FreeFrame(&planar);
+        ToolCommon_FreeFrame(&converted);
+        free(output);
+        free(expected);
+    }
+}
+
+/* Streamed correction in chunks of rows against remap of whole frame. Every band is also
+   remapped from frame, whose rows after source rows of band are overwritten, and it has to be
+   same, so band never needs row, that is not received. */
+static void ToolCommon_CheckStreamRemap(const LDC_Map* const map, WorkerPool* pool,
+                                        LDC_Status* status)
+{
+    static const YUV_Type types[4] = {YUV420_NV12, YUV420_P010, YUV422I_UYVY, YUV420_I420};
+    const LDC_Color border = {16, 128, 128};
+    uint32_t i;
+    char name[128];
+
+    for(i = 0;i < 4U;i++)
+    {
+        const YuvFormat* format = YuvFormat_Get(types[i]);
+        uint32_t chunk = (2U + 3U * i) << format->chroma_shift_y;
+        ToolCommon_Frame source;
+        ToolCommon_Frame reference;
+        ToolCommon_Frame output;
+        ToolCommon_Frame cut;
+        StreamRemap stream;
+        Remap_Plan plan;
+        double latency = 0.0;
+        uint32_t received = 0;
+        uint32_t output_rows = 0;
+        int32_t passed;
+
+        memset(&plan, 0, sizeof(Remap_Plan));
+        memset(&stream, 0, sizeof(StreamRemap));
+        passed = !ToolCommon_AllocateFrame(&source, format, map->src_width, map->src_height) &&
+                 !ToolCommon_AllocateFrame(&reference, format, map->width, map->height) &&
+                 !ToolCommon_AllocateFrame(&output, format, map->width, map->height) &&
+                 !ToolCommon_AllocateFrame(&cut, format, map->src_width, map->src_height) &&
+                 !Remap_CreatePlan(&plan, map, types[i], (LDC_Interpolation)(i & 1U)) &&
+                 !StreamRemap_Init(&stream, &plan, 0U) &&
+                 !StreamRemap_Begin(&stream, output.Y, output.U, output.V, &border);
+
+        if(passed)
+        {
+            size_t luma_row = (size_t)map->src_width * format->bytes_per_sample;
+            size_t chroma_row = (size_t)(map->src_width >> format->chroma_shift_x) *
+                                format->bytes_per_sample;
+            size_t out_luma_row = (size_t)map->width * format->bytes_per_sample;
+            size_t out_chroma_row = (size_t)(map->width >> format->chroma_shift_x) *
+                                    format->bytes_per_sample;
+            uint32_t band;
+
+            ToolCommon_FillComponents(format, source.Y, source.U, source.V, map->src_width,
+                                      map->src_height);
+            passed = !Remap_ApplyPlan(&plan, reference.Y, reference.U, reference.V, source.Y,
+                                      source.U, source.V, NULL, 0, &border);
+
+            /* Output rows are weighted by received part of source frame, when they are final. */
+            while(passed && received < map->src_height)
+            {
+                uint32_t rows = (chunk < map->src_height - received) ?
+                                chunk : map->src_height - received;
+                uint32_t previous = output_rows;
+
+                passed = !StreamRemap_PushRows(&stream, source.Y + luma_row * received,
+                                               source.U + chroma_row *
+                                               (received >> format->chroma_shift_y),
+                                               source.V + chroma_row *
+                                               (received >> format->chroma_shift_y), rows,
+                                               (i & 2U) ? pool : NULL, &output_rows) &&
+                         output_rows >= previous;
+                received += rows;
+                latency += (double)(output_rows - previous) * received / map->src_height;
+            }
+
+            passed = passed && output_rows == map->height &&
+                     ToolCommon_CompareFrames(&reference, &output);
+
+            for(band = 0;passed && band < stream.num_of_bands;band++)
+            {
+                uint32_t rows = StreamRemap_GetSourceRows(&stream, band);
+                uint32_t end = ((band + 1U) * stream.band_rows < map->height) ?
+                               (band + 1U) * stream.band_rows : map->height;
+
+                memcpy(cut.Y, source.Y, luma_row * rows);
+                memset(cut.Y + luma_row * rows, 0xFF, luma_row * (map->src_height - rows));
+                memcpy(cut.U, source.U, chroma_row * (rows >> format->chroma_shift_y));
+                memset(cut.U + chroma_row * (rows >> format->chroma_shift_y), 0xFF,
+                       chroma_row * ((map->src_height - rows) >> format->chroma_shift_y));
+                memcpy(cut.V, source.V, chroma_row * (rows >> format->chroma_shift_y));
+                memset(cut.V + chroma_row * (rows >> format->chroma_shift_y), 0xFF,
+                       chroma_row * ((map->src_height - rows) >> format->chroma_shift_y));
+                passed = !Remap_ApplyPlan(&plan, output.Y, output.U, output.V, cut.Y, cut.U,
+                                          cut.V, NULL, 0, &border) &&
+                         !memcmp(output.Y, reference.Y, out_luma_row * end) &&
+                         !memcmp(output.U, reference.U,
+                                 out_chroma_row * (end >> format->chroma_shift_y)) &&
+                         !memcmp(output.V, reference.V,
+                                 out_chroma_row * (end >> format->chroma_shift_y));
+            }
+
+            printf("       %s: output rows final after %.1f %% of source frame on average\n",
+                   format->name, 100.0 * latency / map->height);
+        }
+
+        snprintf(name, sizeof(name), "streamed correction in chunks of %u rows, %s", chunk,
+                 format->name);
+        ToolCommon_ReportCheck(name, passed, status);
+
+        StreamRemap_Deinit(&stream);
+        Remap_FreePlan(&plan);
+        ToolCommon_FreeFrame(&source);
+        ToolCommon_FreeFrame(&reference);
+        ToolCommon_FreeFrame(&output);
+        ToolCommon_FreeFrame(&cut);
+    }
+}
+
+/* Frame counters of ring start below 2^32, and ring has number of slots which is not power of
+   two, so slots of frames have to stay consecutive when counters pass 32 bits. Producer and
+   consumer use separate mappings, and steps of both sides are mixed, so ring is full and empty
+   several times. */
+static void ToolCommon_CheckFrameRing(LDC_Status* status)
+{
+    const uint32_t num_of_slots = 3U;
+    const uint64_t start = 0xFFFFFFFFULL - 4U;
+    FrameRing producer;
+    FrameRing consumer;
+    FrameRing_Slot slot;
+    char name[FRAME_RING_MAX_NAME];
+    uint64_t written = 0;
+    uint64_t read = 0;
+    uint32_t step;
+    int32_t passed;
+    uint32_t num_of_full = 0;
+    int32_t empty;
+
+    memset(&consumer, 0, sizeof(FrameRing));
+    consumer.fd = -1;
+    snprintf(name, sizeof(name), "/ldc_self_check_%d", (int32_t)getpid());
+    passed = !FrameRing_Create(&producer, name, 64U, 32U, YUV420_NV12, num_of_slots) &&
+             !FrameRing_Open(&consumer, name);
+
+    if(passed)
+    {
+        producer.header->published = start;
+        producer.header->released = start;
+    }
+
+    empty = passed && LDC_STATUS_TIMEOUT == FrameRing_AcquireRead(&consumer, &slot, 0);
+
+    /* Producer steps twice for every step of consumer, until it has written 40 frames, and then
+       consumer reads remaining frames. */
+    for(step = 0;passed && (written < 40U || read < written);step++)
+    {
+        if(written < 40U && 2U != step % 3U)
+        {
+            LDC_Status write_status = FrameRing_AcquireWrite(&producer, &slot, 0);
+
+            if(written - read < num_of_slots)
+            {
+                passed = LDC_STATUS_OK == write_status &&
+                         slot.index == (start + written) % num_of_slots;
+                if(passed)
+                {
+                    slot.Y[0] = (uint8_t)written;
+                    slot.V[0] = (uint8_t)~written;
+                    FrameRing_Publish(&producer, written, 1000U * written);
+                    written++;
+                }
+            }
+            else
+            {
+                passed = LDC_STATUS_TIMEOUT == write_status;
+                num_of_full++;
+            }
+        }
+        else
+        {
+            LDC_Status read_status = FrameRing_AcquireRead(&consumer, &slot, 0);
+
+            if(read < written)
+            {
+                passed = LDC_STATUS_OK == read_status &&
+                         slot.index == (start + read) % num_of_slots && slot.sequence == read &&
+                         slot.timestamp_ns == 1000U * read && slot.Y[0] == (uint8_t)read &&
+                         slot.V[0] == (uint8_t)~read;
+                FrameRing_Release(&consumer);
+                read++;
+            }
+            else
+            {
+                empty = empty && LDC_STATUS_TIMEOUT == read_status;
+            }
+        }
+    }
+
+    if(passed)
+    {
+        empty = empty && LDC_STATUS_TIMEOUT == FrameRing_AcquireRead(&consumer, &slot, 0);
+        FrameRing_Shutdown(&producer);
+        passed = FrameRing_IsDrained(&consumer) &&
+                 LDC_STATUS_ERROR == FrameRing_AcquireRead(&consumer, &slot, 0) &&
+                 start + written == consumer.header->released;
+    }
+
+    ToolCommon_ReportCheck("frame ring publish, acquire and release order", passed, status);
+    ToolCommon_ReportCheck("frame ring full and empty", passed && num_of_full > 0U && empty,
+                           status);
+
+    FrameRing_Close(&consumer);
+    FrameRing_Close(&producer);
+}
+
+/* Frames reported by scheduler, for one stream. */
+typedef struct
+{
+    uint32_t stream_id;                         /* ID of stream.                          */
+    uint32_t num_of_done;                       /* Number of reported frames.             */
+    int32_t in_order;                           /* Frames are reported in submit order.   */
+}ToolCommon_StreamRecord;
+
+static void ToolCommon_RecordFrame(void* user_data, uint32_t stream_id, void* frame_data,
+                                   LDC_Status status)
+{
+    ToolCommon_StreamRecord* record = (ToolCommon_StreamRecord*)user_data;
+
+    record->in_order = record->in_order && stream_id == record->stream_id &&
+                       (uint32_t)(uintptr_t)frame_data == record->num_of_done &&
+                       LDC_STATUS_OK == status;
+    record->num_of_done++;
+}
+
+/* Two streams, of different maps and formats, share worker pool. Frames of every stream have
+   to be reported in submit order, and have to be same as output of map kernel. Sources differ
+   from frame to frame, so output written from source of other frame is found. */
+static void ToolCommon_CheckMultiStream(const LDC_Map* const map, const LensProfile* const lens,
+                                        WorkerPool* pool, LDC_Status* status)
+{
+    static const YUV_Type types[TOOL_SELF_CHECK_STREAMS] = {YUV420_NV12, YUV422I_UYVY};
+    const LDC_Color border = {16, 128, 128};
+    const LDC_Map* maps[TOOL_SELF_CHECK_STREAMS];
+    ToolCommon_Frame sources[TOOL_SELF_CHECK_STREAMS][TOOL_SELF_CHECK_SOURCES];
+    ToolCommon_Frame references[TOOL_SELF_CHECK_STREAMS][TOOL_SELF_CHECK_SOURCES];
+    ToolCommon_Frame outputs[TOOL_SELF_CHECK_STREAMS][TOOL_SELF_CHECK_STREAM_FRAMES];
+    ToolCommon_StreamRecord records[TOOL_SELF_CHECK_STREAMS];
+    MultiStream_Scheduler scheduler;
+    LDC_OutputSpec small_output;
+    LDC_Map small_map;
+    uint32_t s;
+    uint32_t i;
+    size_t j;
+    int32_t passed;
+
+    small_output.width = map->width / 2U;
+    small_output.height = map->height / 2U;
+    small_output.scale = 0.0;
+    small_output.use_centre = 0U;
+    memset(sources, 0, sizeof(sources));
+    memset(references, 0, sizeof(references));
+    memset(outputs, 0, sizeof(outputs));
+    maps[0] = map;
+    maps[1] = &small_map;
+
+    passed = !FrameCorrection_GenerateMap(&small_map, map->src_width, map->src_height,
+                                          &small_output, NULL, 0, lens, NULL);
+
+    for(s = 0;passed && s < TOOL_SELF_CHECK_STREAMS;s++)
+    {
+        const YuvFormat* format = YuvFormat_Get(types[s]);
+
+        for(i = 0;passed && i < TOOL_SELF_CHECK_SOURCES;i++)
+        {
+            passed = !ToolCommon_AllocateFrame(&sources[s][i], format, maps[s]->src_width,
+                                               maps[s]->src_height) &&
+                     !ToolCommon_AllocateFrame(&references[s][i], format, maps[s]->width,
+                                               maps[s]->height);
+            if(passed)
+            {
+                ToolCommon_FillComponents(format, sources[s][i].Y, sources[s][i].U,
+                                          sources[s][i].V, maps[s]->src_width,
+                                          maps[s]->src_height);
+                for(j = 0;j < sources[s][i].luma_size;j++)
+                {
+                    sources[s][i].Y[j] = (uint8_t)(sources[s][i].Y[j] + 37U * i);
+                }
+
+                passed = !FrameCorrection_ApplyMap(maps[s], references[s][i].Y,
+                                                   references[s][i].U, references[s][i].V,
+                                                   sources[s][i].Y, sources[s][i].U,
+                                                   sources[s][i].V, types[s], NULL, 0, &border);
+            }
+        }
+
+        for(i = 0;passed && i < TOOL_SELF_CHECK_STREAM_FRAMES;i++)
+        {
+            passed = !ToolCommon_AllocateFrame(&outputs[s][i], format, maps[s]->width,
+                                               maps[s]->height);
+        }
+    }
+
+    if(passed && !MultiStream_Init(&scheduler, pool))
+    {
+        for(s = 0;passed && s < TOOL_SELF_CHECK_STREAMS;s++)
+        {
+            records[s].num_of_done = 0;
+            records[s].in_order = 1;
+            passed = !MultiStream_AddStream(&scheduler, maps[s], types[s], &border,
+                                            ToolCommon_RecordFrame, &records[s],
+                                            &records[s].stream_id);
+        }
+
+        /* Frames of streams are submitted interleaved, and corrected concurrently. */
+        for(i = 0;passed && i < TOOL_SELF_CHECK_STREAM_FRAMES;i++)
+        {
+            for(s = 0;passed && s < TOOL_SELF_CHECK_STREAMS;s++)
+            {
+                const ToolCommon_Frame* source = &sources[s][i % TOOL_SELF_CHECK_SOURCES];
+                MultiStream_Frame frame;
+
+                frame.Y_out = outputs[s][i].Y;
+                frame.U_out = outputs[s][i].U;
+                frame.V_out = outputs[s][i].V;
+                frame.Y = source->Y;
+                frame.U = source->U;
+                frame.V = source->V;
+                frame.frame_data = (void*)(uintptr_t)i;
+                passed = !MultiStream_SubmitFrame(&scheduler, records[s].stream_id, &frame);
+            }
+        }
+
+        MultiStream_WaitIdle(&scheduler);
+        MultiStream_Deinit(&scheduler);
+
+        for(s = 0;passed && s < TOOL_SELF_CHECK_STREAMS;s++)
+        {
+            passed = records[s].in_order &&
+                     TOOL_SELF_CHECK_STREAM_FRAMES == records[s].num_of_done;
+
+            for(i = 0;passed && i < TOOL_SELF_CHECK_STREAM_FRAMES;i++)
+            {
+                passed = ToolCommon_CompareFrames(&references[s][i % TOOL_SELF_CHECK_SOURCES],
+                                                  &outputs[s][i]);
+            }
+        }
+    }
+    else
+    {
+        passed = 0;
+    }
+
+    ToolCommon_ReportCheck("multi stream frames in order, against map", passed, status);
+
+    for(s = 0;s < TOOL_SELF_CHECK_STREAMS;s++)
+    {
+        for(i = 0;i < TOOL_SELF_CHECK_SOURCES;i++)
+        {
+            ToolCommon_FreeFrame(&sources[s][i]);
+            ToolCommon_FreeFrame(&references[s][i]);
+        }
+
+        for(i = 0;i < TOOL_SELF_CHECK_STREAM_FRAMES;i++)
+        {
+            ToolCommon_FreeFrame(&outputs[s][i]);
+        }
+    }
+
+    FrameCorrection_FreeMap(&small_map);
+}
+
+/* Write frame into new temporary file, named from template. */
+static LDC_Status ToolCommon_WriteTempFrame(char* const filename, const YuvFormat* const format,
+                                            const ToolCommon_Frame* const frame, uint32_t width,
+                                            uint32_t height)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    size_t size = YuvFormat_GetFrameSize(width, height, format->yuv_type);
+    uint8_t* YUV = malloc(size);
+    int32_t fd = mkstemp(filename);
+
+    if(NULL == YUV || fd < 0)
+    {
+        status = LDC_STATUS_ERROR;
+    }
+    else
+    {
+        YuvFormat_Combine(format, YUV, frame->Y, frame->U, frame->V, width, height);
+        status = ((ssize_t)size == write(fd, YUV, size)) ? LDC_STATUS_OK : LDC_STATUS_ERROR;
+    }
+
+    if(fd >= 0)
+    {
+        close(fd);
+    }
+    free(YUV);
+
+    return status;
+}
+
+/* Create new empty temporary file, named from template. */
+static LDC_Status ToolCommon_ReserveTempFile(char* const filename)
+{
+    int32_t fd = mkstemp(filename);
+
+    if(fd >= 0)
+    {
+        close(fd);
+    }
+
+    return (fd < 0) ? LDC_STATUS_ERROR : LDC_STATUS_OK;
+}
+
+/* Whole file read back, for comparison with frame in memory. */
+static int32_t ToolCommon_FileEquals(const char* const filename, const uint8_t* const data,
+                                     size_t size)
+{
+    FILE* fp = fopen(filename, "rb");
+    uint8_t* content = malloc(size + 1U);
+    int32_t equals = (NULL != fp && NULL != content && size == fread(content, 1, size + 1U, fp) &&
+                      !memcmp(content, data, size));
+
+    if(NULL != fp)
+    {
+        fclose(fp);
+    }
+    free(content);
+
+    return equals;
+}
+
+/* Strip correction of file against correction of whole frame in memory, with output
+   specification, regions of interest and mask. Source rows read by strips are reported. */
+static void ToolCommon_CheckStripCorrection(const LensProfile* const lens, WorkerPool* pool,
+                                            LDC_Status* status)
+{
+    static const YUV_Type types[4] = {YUV420_NV12, YUV420_P010, YUV422I_UYVY, YUV420_I420};
+    static const uint32_t strip_rows[4] = {32U, 30U, 17U, 64U};
+    static const LDC_Roi rois[2] = {{10, 30, 200, 101}, {300, 0, 100, 200}};
+    const LDC_Color border = {16, 128, 128};
+    const LDC_OutputSpec output = {500, 300, 1.3, 300.5, 200.25, 1};
+    const LDC_OutputSpec odd_output = {499, 300, 1.3, 300.5, 200.25, 1};
+    uint32_t width = TOOL_SELF_CHECK_WIDTH;
+    uint32_t height = TOOL_SELF_CHECK_HEIGHT;
+    uint32_t i;
+    char name[128];
+
+    for(i = 0;i < 4U;i++)
+    {
+        const YuvFormat* format = YuvFormat_Get(types[i]);
+        const LDC_OutputSpec* spec = (i & 1U) ? &output : NULL;
+        uint32_t out_width = (NULL == spec) ? width : spec->width;
+        uint32_t out_height = (NULL == spec) ? height : spec->height;
+        uint32_t num_of_rois = (i & 2U) ? 2U : 0U;
+        size_t mask_size = (size_t)out_height * VALIDITY_MASK_STRIDE(out_width);
+        uint8_t* mask = calloc(mask_size, 1);
+        uint8_t* YUV_out = NULL;
+        char input_filename[] = "/tmp/ldc_strip_XXXXXX";
+        char output_filename[] = "/tmp/ldc_strip_out_XXXXXX";
+        char mask_filename[] = "/tmp/ldc_strip_mask_XXXXXX";
+        StripCorrection_Stats stats;
+        ToolCommon_Frame source;
+        int32_t passed;
+
+        passed = !ToolCommon_AllocateFrame(&source, format, width, height) && NULL != mask;
+
+        if(passed)
+        {
+            ToolCommon_FillComponents(format, source.Y, source.U, source.V, width, height);
+            passed = !ToolCommon_WriteTempFrame(input_filename, format, &source, width,
+                                                height) &&
+                     !ToolCommon_ReserveTempFile(output_filename) &&
+                     !ToolCommon_ReserveTempFile(mask_filename) &&
+                     !FrameCorrection_CorrectLensDistortion(&YUV_out, source.Y, source.U,
+                                                            source.V,
+                                                            YuvFormat_GetFrameSize(width, height,
+                                                                                   types[i]),
+                                                            width, height, types[i], lens, spec,
+                                                            num_of_rois ? rois : NULL,
+                                                            num_of_rois, &border,
+                                                            (LDC_Interpolation)(i & 1U),
+                                                            mask) &&
+                     !StripCorrection_CorrectFile(input_filename, output_filename,
+                                                  mask_filename, width, height, types[i], lens,
+                                                  spec, num_of_rois ? rois : NULL, num_of_rois,
+                                                  &border, (LDC_Interpolation)(i & 1U),
+                                                  strip_rows[i], (i & 2U) ? pool : NULL,
+                                                  &stats) &&
+                     ToolCommon_FileEquals(output_filename, YUV_out,
+                                           YuvFormat_GetFrameSize(out_width, out_height,
+                                                                  types[i])) &&
+                     ToolCommon_FileEquals(mask_filename, mask, mask_size);
+        }
+
+        if(passed)
+        {
+            printf("       %s: at most %u of %u source rows per strip, %.1f kB of buffers\n",
+                   format->name, stats.max_source_rows, height,
+                   (double)stats.peak_buffer_size / 1024.0);
+        }
+
+        snprintf(name, sizeof(name), "strip correction of file in strips of %u rows, %s",
+                 strip_rows[i], format->name);
+        ToolCommon_ReportCheck(name, passed, status);
+
+        remove(input_filename);
+        remove(output_filename);
+        remove(mask_filename);
+        ToolCommon_FreeFrame(&source);
+        free(YUV_out);
+        free(mask);
+    }
+
+    /* Odd source or output width of subsampled format is rejected before files are opened. */
+    ToolCommon_ReportCheck("strip correction rejects odd widths",
+                           LDC_STATUS_INVALID_ARGUMENT ==
+                           StripCorrection_CorrectFile("/nonexistent.yuv", "/nonexistent.yuv",
+                                                       NULL, width - 1U, height, YUV420_NV12,
+                                                       lens, NULL, NULL, 0, &border,
+                                                       LDC_INTERPOLATION_NEAREST, 0, NULL,
+                                                       NULL) &&
+                           LDC_STATUS_INVALID_ARGUMENT ==
+                           StripCorrection_CorrectFile("/nonexistent.yuv", "/nonexistent.yuv",
+                                                       NULL, width, height, YUV422I_UYVY, lens,
+                                                       &odd_output, NULL, 0, &border,
+                                                       LDC_INTERPOLATION_NEAREST, 0, NULL,
+                                                       NULL), status);
+}
+
+/* Best time of remap of fixed workload, compared with baseline file, or recorded to it. */
+static void ToolCommon_CheckPerformance(const LensProfile* const lens,
+                                        const char* const baselineFilename, double threshold,
+                                        LDC_Status* status)
+{
+    const LDC_Color border = {16, 128, 128};
+    const YuvFormat* format = YuvFormat_Get(YUV420_NV12);
+    ToolCommon_Frame source;
+    ToolCommon_Frame output;
+    LDC_Map map;
+    double best = 0.0;
+    double baseline;
+    uint32_t i;
+    FILE* fp;
+
+    if(ToolCommon_AllocateFrame(&source, format, TOOL_PERF_WIDTH, TOOL_PERF_HEIGHT) ||
+       ToolCommon_AllocateFrame(&output, format, TOOL_PERF_WIDTH, TOOL_PERF_HEIGHT) ||
+       FrameCorrection_GenerateMap(&map, TOOL_PERF_WIDTH, TOOL_PERF_HEIGHT, NULL, NULL, 0, lens,
+                                   NULL))
+    {
+        ToolCommon_ReportCheck("performance workload", 0, status);
+        return;
+    }
+
+    ToolCommon_FillComponents(format, source.Y, source.U, source.V, TOOL_PERF_WIDTH,
+                              TOOL_PERF_HEIGHT);
+
+    for(i = 0;i < TOOL_PERF_ITERATIONS;i++)
+    {
+        double start = ToolCommon_GetTime();
+        double elapsed;
+
+        FrameCorrection_ApplyMap(&map, output.Y, output.U, output.V, source.Y, source.U,
+                                 source.V, YUV420_NV12, NULL, 0, &border);
+        elapsed = (ToolCommon_GetTime() - start) * 1000.0;
+        best = (0U == i || elapsed < best) ? elapsed : best;
+    }
+
+    printf("       Remap %ux%u YUV420_NV12: %.3f ms\n", TOOL_PERF_WIDTH, TOOL_PERF_HEIGHT, best);
+
+    if(NULL != baselineFilename)
+    {
+        fp = fopen(baselineFilename, "r");
+
+        if(NULL != fp && 1 == fscanf(fp, "%lf", &baseline))
+        {
+            printf("       Baseline %.3f ms, allowed slowdown %.1f %%\n", baseline, threshold);
+            ToolCommon_ReportCheck("remap performance against baseline",
+                                   best <= baseline * (1.0 + threshold / 100.0), status);
+        }
+        else
+        {
+            FILE* out = fopen(baselineFilename, "w");
+
+            ToolCommon_ReportCheck("recording of performance baseline",
+                                   NULL != out && fprintf(out, "%.6f\n", best) > 0, status);
+
+            if(NULL != out)
+            {
+                fclose(out);
+            }
+        }
+
+        if(NULL != fp)
+        {
+            fclose(fp);
+        }
+    }
+
+    FrameCorrection_FreeMap(&map);
+    ToolCommon_FreeFrame(&source);
+    ToolCommon_FreeFrame(&output);
+}
+
 /* ============================================================================================== */
 /*                                     API Functions                                              */
 /* ============================================================================================== */
@@ -128,6 +1875,32 @@ void ToolCommon_PrintInvalidArgsMessage(void)
     printf(INVALID_ARGUMENTS_MESSAGE);
 }
 
+/**
+ ***************************************************************************************************
+ *
+ * \fn     ToolCommon_PrintLogMessage
+ *
+ * \brief  Logging callback of tool, prints library messages to stdout.
+ *
+ * \param  [In]  level        Level of message.
+ * \param  [In]  status       Reported status.
+ * \param  [In]  message      Message of library.
+ * \param  [In]  user_data    Not used.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void ToolCommon_PrintLogMessage(LDC_LogLevel level, LDC_Status status, const char* message,
+                                void* user_data)
+{
+    (void)level;
+    (void)status;
+    (void)user_data;
+
+    printf("%s\n", message);
+}
+
 /**
  ***************************************************************************************************
  *
@@ -146,14 +1919,10 @@ LDC_Status ToolCommon_ValidateFormat(uint32_t pFrameFormat, YUV_Type* yuv_type)
 
     LDC_Status status = LDC_STATUS_ERROR;
 
-    if(1U == pFrameFormat)
-    {
-        *yuv_type = YUV420_NV12;
-        status = LDC_STATUS_OK;
-    }
-    else if(2U == pFrameFormat)
+    /* Format numbers are values of YUV_Type. */
+    if(NULL != YuvFormat_Get((YUV_Type)pFrameFormat))
     {
-        *yuv_type = YUV422I_UYVY;
+        *yuv_type = (YUV_Type)pFrameFormat;
         status = LDC_STATUS_OK;
     }
 
@@ -191,6 +1960,371 @@ LDC_Status ToolCommon_ValidateDimensions(uint32_t pFrameWidth, uint32_t pFrameHe
     return status;
 }
 
+/**
+ ***************************************************************************************************
+ *
+ * \fn     ToolCommon_ParseRoi
+ *
+ * \brief  Helper function used to parse region of interest, given as X,Y,WIDTH,HEIGHT
+ *
+ * \param  [In]  pRoiArgument       Command line argument of region
+ * \param  [Out] roi                Parsed region of interest
+ *
+ * \return LDC_Status    Validation code
+ *
+ ***************************************************************************************************
+ */
+LDC_Status ToolCommon_ParseRoi(const char* const pRoiArgument, LDC_Roi* roi)
+{
+
+    LDC_Status status = LDC_STATUS_ERROR;
+    int32_t x;
+    int32_t y;
+    int32_t width;
+    int32_t height;
+
+    if(4 == sscanf(pRoiArgument, "%d,%d,%d,%d", &x, &y, &width, &height))
+    {
+        if(x >= 0 && y >= 0 && width > 0 && height > 0)
+        {
+            roi->x = x;
+            roi->y = y;
+            roi->width = width;
+            roi->height = height;
+            status = LDC_STATUS_OK;
+        }
+    }
+
+    return status;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     ToolCommon_ParseColor
+ *
+ * \brief  Helper function used to parse border colour, given as Y,U,V
+ *
+ * \param  [In]  pColorArgument     Command line argument of colour
+ * \param  [Out] color              Parsed colour
+ *
+ * \return LDC_Status    Validation code
+ *
+ ***************************************************************************************************
+ */
+LDC_Status ToolCommon_ParseColor(const char* const pColorArgument, LDC_Color* color)
+{
+
+    LDC_Status status = LDC_STATUS_ERROR;
+    int32_t y;
+    int32_t u;
+    int32_t v;
+
+    if(3 == sscanf(pColorArgument, "%d,%d,%d", &y, &u, &v))
+    {
+        if(y >= 0 && y <= 255 && u >= 0 && u <= 255 && v >= 0 && v <= 255)
+        {
+            color->y = (uint8_t)y;
+            color->u = (uint8_t)u;
+            color->v = (uint8_t)v;
+            status = LDC_STATUS_OK;
+        }
+    }
+
+    return status;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     ToolCommon_LoadLens
+ *
+ * \brief  Helper function used to load lens specification file, and to fit analytic lens model
+ *         to its table, with print of fit error and coefficients
+ *
+ * \param  [In]  lensSpecFilename    Lens Specifiacation file name
+ * \param  [In]  lensModel           Lens function, LENS_MODEL_TABLE for table of file
+ * \param  [Out] lens                Loaded lens profile
+ *
+ * \return LDC_Status    Validation code
+ *
+ ***************************************************************************************************
+ */
+LDC_Status ToolCommon_LoadLens(const char* const lensSpecFilename, LensModel_Type lensModel,
+                               const LensProfile** lens)
+{
+    LDC_Status status = LDC_STATUS_OK;
+    const LensProfile* table;
+    LensModel model;
+    double max_error;
+
+    if(LensProfile_LoadFile(0U, lensSpecFilename, &table))
+    {
+        return LDC_STATUS_ERROR;
+    }
+
+    if(LENS_MODEL_TABLE == lensModel)
+    {
+        *lens = table;
+        return LDC_STATUS_OK;
+    }
+
+    /* Lens table stays reference, model is fitted to it. */
+    if(LensModel_Fit(lensModel, table->focal_length_in_mm / table->sensor_pixel_pitch_in_mm,
+                     table->angle, table->height, table->num_of_useful_elements, &model,
+                     &max_error) ||
+       LensProfile_LoadModel(0U, &model, table->sensor_pixel_pitch_in_mm,
+                             table->scaling_factor, lens))
+    {
+        status = LDC_STATUS_ERROR;
+    }
+    else
+    {
+        printf("Lens model max error against table: %lf px\n", max_error);
+
+        if(LENS_MODEL_POLYNOMIAL == lensModel)
+        {
+            printf("Polynomial coefficients: f %.9g, k1 %.9g, k2 %.9g, k3 %.9g, k4 %.9g\n",
+                   model.focal_length, model.k[0], model.k[1], model.k[2], model.k[3]);
+        }
+    }
+
+    LensProfile_Release(table);
+
+    return status;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     ToolCommon_VerifyMap
+ *
+ * \brief  Helper function used to compare fast map with reference map, and print max error
+ *
+ * \param  [In] lens                 Lens profile
+ * \param  [In] width                Width of the input frame
+ * \param  [In] height               Height of the input frame
+ * \param  [In] output               Output frame specification
+ * \param  [In] rois                 Regions of interest, or NULL for whole frame
+ * \param  [In] num_of_rois          Number of regions of interest
+ *
+ * \return LDC_Status    Error when maps differ more than FAST_MAP_MAX_COORDINATE_ERROR
+ *
+ ***************************************************************************************************
+ */
+LDC_Status ToolCommon_VerifyMap(const LensProfile* const lens, uint32_t width,
+                                uint32_t height, const LDC_OutputSpec* const output,
+                                const LDC_Roi* const rois, uint32_t num_of_rois)
+{
+
+    LDC_Status status = LDC_STATUS_ERROR;
+    LDC_Map map;
+    LDC_Map reference;
+    double max_error;
+
+    if(!FrameCorrection_GenerateMap(&map, width, height, output, rois, num_of_rois, lens, NULL))
+    {
+        if(!FrameCorrection_GenerateReferenceMap(&reference, width, height, output, rois,
+                                                 num_of_rois, lens, NULL))
+        {
+            if(!FrameCorrection_GetMapMaxError(&map, &reference, &max_error))
+            {
+                printf("Map max error: %lf px (allowed %lf px)\n", max_error,
+                       FAST_MAP_MAX_COORDINATE_ERROR);
+
+                if(max_error <= FAST_MAP_MAX_COORDINATE_ERROR)
+                {
+                    status = LDC_STATUS_OK;
+                }
+            }
+
+            FrameCorrection_FreeMap(&reference);
+        }
+
+        FrameCorrection_FreeMap(&map);
+    }
+
+    return status;
+}
+
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     ToolCommon_CorrectWithDaemon
+ *
+ * \brief  Helper function used to correct frame by ldc_daemon, with frames in shared memory
+ *
+ * \param  [In]  socketPath         Path of daemon socket
+ * \param  [In]  request            Request parameters
+ * \param  [In]  YUV_in             Input frame
+ * \param  [In]  img_size           Size of input frame
+ * \param  [In]  out_img_size       Size of output frame
+ * \param  [Out] YUV_out            Output frame, allocated by function
+ *
+ * \return LDC_Status    Validation code
+ *
+ ***************************************************************************************************
+ */
+LDC_Status ToolCommon_CorrectWithDaemon(const char* const socketPath,
+                                        const LdcDaemon_Request* const request,
+                                        const uint8_t* const YUV_in, size_t img_size,
+                                        size_t out_img_size, uint8_t** YUV_out)
+{
+    LDC_Status status = LDC_STATUS_ERROR;
+    LdcDaemon_Response response;
+    int32_t socket_fd;
+    int32_t in_fd;
+    int32_t out_fd;
+
+    *YUV_out = (uint8_t*)malloc(out_img_size);
+
+    if(NULL == *YUV_out || LdcDaemon_Connect(socketPath, &socket_fd))
+    {
+        return status;
+    }
+
+    /* Daemon gets descriptors of memory, that is sealed against shrinking. */
+    (void)LdcDaemon_CreateFrameMemory(img_size, &in_fd);
+    (void)LdcDaemon_CreateFrameMemory(out_img_size, &out_fd);
+
+    if(in_fd >= 0 && out_fd >= 0 &&
+       (ssize_t)img_size == pwrite(in_fd, YUV_in, img_size, 0) &&
+       !LdcDaemon_Correct(socket_fd, request, in_fd, out_fd, &response) &&
+       (ssize_t)out_img_size == pread(out_fd, *YUV_out, out_img_size, 0))
+    {
+        printf("Daemon correction time: %.3f ms%s\n", response.remap_time_ns / 1e6,
+               response.map_generated ? " (map generated)" : "");
+        status = LDC_STATUS_OK;
+    }
+
+    if(in_fd >= 0)
+    {
+        close(in_fd);
+    }
+
+    if(out_fd >= 0)
+    {
+        close(out_fd);
+    }
+
+    close(socket_fd);
+
+    return status;
+}
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     ToolCommon_SelfCheck
+ *
+ * \brief  Helper function used to check optimised paths against reference behaviour, on
+ *         synthetic lens table and frames. Fast, parallel and swept maps are compared with
+ *         reference map, remap kernels and frame split/combine are compared for every format,
+ *         outputs are compared with golden checksums, and remap time is compared with baseline.
+ *
+ * \param  [In] baselineFilename     File with baseline remap time, or NULL. Baseline is recorded
+ *                                   when file does not exist.
+ * \param  [In] threshold            Allowed slowdown against baseline, in percents
+ *
+ * \return LDC_Status    Error when any check fails
+ *
+ ***************************************************************************************************
+ */
+LDC_Status ToolCommon_SelfCheck(const char* const baselineFilename, double threshold)
+{
+    LDC_Status status = LDC_STATUS_OK; /* EXIT Status. */
+    uint32_t width = TOOL_SELF_CHECK_WIDTH;
+    uint32_t height = TOOL_SELF_CHECK_HEIGHT;
+    size_t map_size = (size_t)width * height * sizeof(float);
+    const LensProfile* lens = NULL;
+    LDC_Map map;
+    LDC_Map reference;
+    LDC_Map parallel;
+    MapSweep sweep;
+    WorkerPool pool;
+    double max_error;
+    uint64_t checksum;
+    uint32_t yuv_type;
+
+    if(ToolCommon_LoadSyntheticLens(&lens) ||
+       FrameCorrection_GenerateMap(&map, width, height, NULL, NULL, 0, lens, NULL))
+    {
+        LensProfile_Release(lens);
+        ToolCommon_ReportCheck("synthetic lens and map", 0, &status);
+        return status;
+    }
+
+    if(!FrameCorrection_GenerateReferenceMap(&reference, width, height, NULL, NULL, 0, lens,
+                                             NULL))
+    {
+        checksum = ToolCommon_Checksum(reference.h_d, map_size, 0xCBF29CE484222325ULL);
+        checksum = ToolCommon_Checksum(reference.v_d, map_size, checksum);
+        ToolCommon_CheckGolden("golden reference map", checksum,
+                               TOOL_GOLDEN_REFERENCE_MAP_CHECKSUM, &status);
+
+        ToolCommon_ReportCheck("fast map against reference map",
+                               !FrameCorrection_GetMapMaxError(&map, &reference, &max_error) &&
+                               max_error <= FAST_MAP_MAX_COORDINATE_ERROR, &status);
+
+        ToolCommon_ReportCheck("swept map against reference map",
+                               !MapSweep_Init(&sweep, width, height, NULL, NULL, 0, NULL) &&
+                               !MapSweep_Derive(&sweep, lens, NULL, NULL) &&
+                               !FrameCorrection_GetMapMaxError(&sweep.map, &reference,
+                                                               &max_error) &&
+                               max_error <= FAST_MAP_MAX_COORDINATE_ERROR, &status);
+        MapSweep_Deinit(&sweep);
+    }
+    else
+    {
+        ToolCommon_ReportCheck("reference map", 0, &status);
+    }
+
+    /* Parallel map has to be same as serial map, for any number of threads. */
+    if(!WorkerPool_Init(&pool, TOOL_SELF_CHECK_THREADS))
+    {
+        ToolCommon_ReportCheck("parallel map against serial map",
+                               !FrameCorrection_GenerateMap(&parallel, width, height, NULL, NULL,
+                                                            0, lens, &pool) &&
+                               !memcmp(parallel.h_d, map.h_d, map_size) &&
+                               !memcmp(parallel.v_d, map.v_d, map_size) &&
+                               parallel.num_of_spans == map.num_of_spans, &status);
+        FrameCorrection_FreeMap(&parallel);
+        ToolCommon_CheckPyramid(&map, &pool, &status);
+        ToolCommon_CheckOutputConvert(&map, &pool, &status);
+        ToolCommon_CheckStreamRemap(&map, &pool, &status);
+        ToolCommon_CheckStripCorrection(lens, &pool, &status);
+        ToolCommon_CheckMultiStream(&map, lens, &pool, &status);
+        WorkerPool_Deinit(&pool);
+    }
+    else
+    {
+        ToolCommon_ReportCheck("worker pool", 0, &status);
+    }
+
+    for(yuv_type = 1;NULL != YuvFormat_Get((YUV_Type)yuv_type);yuv_type++)
+    {
+        ToolCommon_CheckFormat(YuvFormat_Get((YUV_Type)yuv_type), &map,
+                               (NULL != reference.h_d) ? &reference : NULL, lens, &status);
+        ToolCommon_CheckLibrary(YuvFormat_Get((YUV_Type)yuv_type), &map, lens, &status);
+    }
+
+    ToolCommon_CheckLensModels(lens, width, height, &status);
+
+    ToolCommon_CheckMapComposition(&map, &status);
+
+    ToolCommon_CheckFrameRing(&status);
+
+    ToolCommon_CheckVirtualCamera(lens, width, height, &status);
+
+    ToolCommon_CheckPerformance(lens, baselineFilename, threshold, &status);
+
+    FrameCorrection_FreeMap(&reference);
+    FrameCorrection_FreeMap(&map);
+    LensProfile_Release(lens);
+
+    return status;
+}
 
 /**
  ***************************************************************************************************
@@ -214,7 +2348,7 @@ LDC_Status ToolCommon_ValidateDimensions(uint32_t pFrameWidth, uint32_t pFrameHe
 void ToolCommon_PrintCorrectionInformation(const char* const inputFilename,
                                            const char* const outputFilename,
                                            const char* const lensSPecFilename, 
-                                           uint32_t img_size, uint32_t width,
+                                           size_t img_size, uint32_t width,
                                            uint32_t height, YUV_Type yuv_type)
 {
     printf("------------------------------------------------------------------------\n");
@@ -224,7 +2358,7 @@ void ToolCommon_PrintCorrectionInformation(const char* const inputFilename,
     printf("Output Filename: %s\n", outputFilename);
     printf("Lens Spec. file: %s\n", lensSPecFilename);
     printf("Frame Dimensions: (%d, %d)\n", width, height);
-    printf("Frame Mem. storage: %d B\n", img_size);
-    printf("Type of YUV frame: '%s'\n", (1U == yuv_type) ? "YUV420_NV12" : "YUV422I_UYVY");
+    printf("Frame Mem. storage: %llu B\n", (unsigned long long)img_size);
+    printf("Type of YUV frame: '%s'\n", YuvFormat_Get(yuv_type)->name);
     printf("-------------------------------------------------------------------------\n");
 }
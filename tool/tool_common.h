@@ -23,8 +23,26 @@
 #include <stdint.h>
 #include <stdio.h>
 #include "../core/lib/ldc_types.h"
+#include "../core/lib/ldc_log.h"
 #include "../core/correction_distortion/correction_distortion.h"
 #include "../core/read_save_YUV/read_save_YUV.h"
+#include "../core/remap/remap.h"
+#include "../core/lazy_map/lazy_map.h"
+#include "../core/dirty_remap/dirty_remap.h"
+#include "../core/map_compose/map_compose.h"
+#include "../core/virtual_camera/virtual_camera.h"
+#include "../core/pyramid/pyramid.h"
+#include "../core/output_convert/output_convert.h"
+#include "../core/stream_remap/stream_remap.h"
+#include "../core/strip_correction/strip_correction.h"
+#include "../core/map_sweep/map_sweep.h"
+#include "../core/worker_pool/worker_pool.h"
+#include "../core/lens_registry/lens_registry.h"
+#include "../core/lens_model/lens_model.h"
+#include "../core/ldc_daemon/ldc_daemon.h"
+#include "../core/frame_ring/frame_ring.h"
+#include "../core/libldc/libldc.h"
+#include "../core/multi_stream/multi_stream.h"
 
 /* ============================================================================================== */
 /*                              Global Variables                                                  */
@@ -39,10 +57,40 @@
     "-w [WIDTH]               Frame width\n"\
     "-h [HEIGHT]              Frame height\n"\
     "-f [FORMAT]              Format of YUV frame\n"\
+    "-W [WIDTH]               Output frame width, default is input width\n"\
+    "-H [HEIGHT]              Output frame height, default is input height\n"\
+    "-s [SCALE]               Input pixels per output pixel, default keeps horizontal FoV\n"\
+    "-c [X,Y]                 Position of output centre in input frame\n"\
+    "-r [X,Y,WIDTH,HEIGHT]    Region of interest to correct, can be repeated\n"\
+    "-b [Y,U,V]               Border colour of pixels without source, default 0,128,128\n"\
+    "-m [MASK FILE]           Output 1-bit validity mask file\n"\
+    "-S [ROWS]                Correct file strip by strip of output rows, for very large frames\n"\
+    "-v                       Verify fast map against double precision reference map\n"\
+    "-n [INTERPOLATION]       0 for nearest source pixel (default), 1 for bilinear\n"\
+    "-l [LENS MODEL]          Lens function, fitted to lens specification file\n"\
+    "-d [SOCKET]              Correct frame by ldc_daemon, with its lens (-p is not needed)\n"\
+    "-L [LENS ID]             Lens ID registered in ldc_daemon, default 0\n"\
+    "--self-check             Check optimised paths against reference and golden outputs\n"\
+    "--baseline [FILE]        Self check: compare remap time with baseline file, or record it\n"\
+    "--threshold [PERCENT]    Self check: allowed slowdown against baseline, default 10\n"\
     "\n"\
     "Supported frame formats:\n"\
     "1:       YUV_420_NV12      12 bpp\n"\
-    "2:       YUV422I_UYVY      16 bpp \n")
+    "2:       YUV422I_UYVY      16 bpp \n"\
+    "3:       YUV420_P010       24 bpp, 10 bit samples in high bits\n"\
+    "4:       YUV420_P016       24 bpp\n"\
+    "5:       YUV422I_Y210      32 bpp, 10 bit samples in high bits\n"\
+    "6:       YUV420_I420       12 bpp\n"\
+    "7:       YUV420_NV21       12 bpp\n"\
+    "8:       YUV422I_YUYV      16 bpp\n"\
+    "9:       YUV444_PLANAR     24 bpp\n"\
+    "\n"\
+    "Supported lens models:\n"\
+    "0:       Table             Lens specification table (default)\n"\
+    "1:       Equisolid         r = 2 f sin(theta / 2)\n"\
+    "2:       Equidistant       r = f theta\n"\
+    "3:       Stereographic     r = 2 f tan(theta / 2)\n"\
+    "4:       Polynomial        r = f (theta + k1 theta^3 + ... + k4 theta^9), least squares\n")
 
 #define MISSING_ARGUMENTS_MESSAGE (\
     "Missing arguments. Run the program with --help for help on how to use the tool.\n")
@@ -60,7 +108,8 @@
     "Invalid file names. File names can't be left empty, and must have appropriate extensions.\n")
 
 #define INVALID_DIMENSION_MESSAGE (\
-    "Invalid frame dimensions. Frame dimensions have to be positive integers.\n")
+    "Invalid frame dimensions. Frame dimensions have to be positive integers, multiples of chroma\n"\
+    "subsampling of format.\n")
 
 #define INVALID_FORMAT_MESSAGE (\
     "Invalid file format. Run the tool with --help to see the supported format list.\n")
@@ -69,16 +118,78 @@
     "You must provide a flag for the tool run yuv_type and only one yuv_type can be provided."\
     "Run the tool with --help to see available run yuv_types.\n")
 
+#define INVALID_SCALE_MESSAGE (\
+    "Invalid output scale. Scale has to be a number greater than zero.\n")
+
+#define INVALID_CENTRE_MESSAGE (\
+    "Invalid output centre. Centre has to be given as X,Y.\n")
+
+#define INVALID_ROI_MESSAGE (\
+    "Invalid region of interest. Region has to be given as X,Y,WIDTH,HEIGHT.\n")
+
+#define INVALID_BORDER_COLOR_MESSAGE (\
+    "Invalid border colour. Colour has to be given as Y,U,V, with values from 0 to 255.\n")
+
+#define INVALID_INTERPOLATION_MESSAGE (\
+    "Invalid interpolation. Interpolation has to be 0 (nearest) or 1 (bilinear).\n")
+
+#define INVALID_LENS_MODEL_MESSAGE (\
+    "Invalid lens model. Run the tool with --help to see the supported lens models.\n")
+
+#define LENS_LOADING_ERROR_MESSAGE (\
+    "Error in loading of lens specification, or in fitting of lens model.\n")
+
+#define TOO_MANY_ROIS_MESSAGE (\
+    "Too many regions of interest.\n")
+
+#define MAP_VERIFICATION_ERROR_MESSAGE (\
+    "Fast map differs from reference map more than allowed.\n")
+
 #define SPLIT_YUV_COMPONENTS_ERROR_MESSAGE (\
     "Error in split YUV components. Check type of YUV format, or main YUV file.\n")
 
 #define CORRECTION_DISTORTION_ERROR_MESSAGE (\
     "Error in correction of frame distortion. Check YUV components.\n")
 
+#define MASK_ALLOCATION_ERROR_MESSAGE (\
+    "Error in allocation of validity mask.\n")
+
+#define INVALID_THRESHOLD_MESSAGE (\
+    "Invalid threshold. Threshold has to be a number of percents, not less than zero.\n")
+
+#define INVALID_STRIP_ROWS_MESSAGE (\
+    "Invalid strip rows. Strip has to be a positive number of output rows.\n")
+
+#define DAEMON_ERROR_MESSAGE (\
+    "Error in correction by daemon. Check daemon socket, lens ID and frame parameters.\n")
+
+#define SELF_CHECK_ERROR_MESSAGE (\
+    "Self check failed.\n")
+
 /* ============================================================================================== */
 /*                                     Macros & Typedefs                                          */
 /* ============================================================================================== */
 
+#define TOOL_MAX_NUM_OF_ROIS (16U)      /* Maximum number of regions of interest. */
+
+#define TOOL_SELF_CHECK_WIDTH (640U)            /* Frame of functional checks.            */
+#define TOOL_SELF_CHECK_HEIGHT (480U)
+#define TOOL_SELF_CHECK_THREADS (4U)            /* Threads of parallel map generation.    */
+#define TOOL_SELF_CHECK_STREAMS (2U)            /* Streams of multi stream check.         */
+#define TOOL_SELF_CHECK_STREAM_FRAMES (30U)     /* Frames of every stream.                */
+#define TOOL_SELF_CHECK_SOURCES (3U)            /* Different source frames of stream.     */
+#define TOOL_COMPOSE_MAX_MEAN_DIFFERENCE (2.0) /* Homography, composed against sequential.  */
+#define TOOL_PERF_WIDTH (1920U)                 /* Frame of performance check.            */
+#define TOOL_PERF_HEIGHT (1080U)
+#define TOOL_PERF_ITERATIONS (20U)              /* Best of iterations is compared.        */
+#define TOOL_PERF_DEFAULT_THRESHOLD (10.0)      /* Allowed slowdown in percents.          */
+
+/* Golden checksums (FNV-1a) of reference behaviour, for synthetic lens and frame of self check.
+   Reference map is computed in double precision, so it depends on libm of platform. */
+#define TOOL_GOLDEN_REFERENCE_MAP_CHECKSUM (0xE76988EF8F86322BULL)
+#define TOOL_GOLDEN_NEAREST_CHECKSUM (0x34BA18639FE6C564ULL)
+#define TOOL_GOLDEN_BILINEAR_CHECKSUM (0xF9E3A1ADF629E737ULL)
+
 /* ============================================================================================== */
 /*                                     Function Declarations                                      */
 /* ============================================================================================== */
@@ -110,6 +221,25 @@ void ToolCommon_PrintHelpMenu(void);
  */
 void ToolCommon_PrintInvalidArgsMessage(void);
 
+/**
+ ***************************************************************************************************
+ *
+ * \fn     ToolCommon_PrintLogMessage
+ *
+ * \brief  Logging callback of tool, prints library messages to stdout.
+ *
+ * \param  [In]  level        Level of message.
+ * \param  [In]  status       Reported status.
+ * \param  [In]  message      Message of library.
+ * \param  [In]  user_data    Not used.
+ *
+ * \return void
+ *
+ ***************************************************************************************************
+ */
+void ToolCommon_PrintLogMessage(LDC_LogLevel level, LDC_Status status, const char* message,
+                                void* user_data);
+
 /**
  ***************************************************************************************************
  *
@@ -160,6 +290,122 @@ LDC_Status ToolCommon_ValidateFormat(uint32_t pFrameFormat, YUV_Type* yuv_type);
  */
 LDC_Status ToolCommon_ValidateDimensions(uint32_t pFrameWidth, uint32_t pFrameHeight);
 
+/**
+ ***************************************************************************************************
+ *
+ * \fn     ToolCommon_ParseRoi
+ *
+ * \brief  Helper function used to parse region of interest, given as X,Y,WIDTH,HEIGHT
+ *
+ * \param  [In]  pRoiArgument       Command line argument of region
+ * \param  [Out] roi                Parsed region of interest
+ *
+ * \return LDC_Status    Validation code
+ *
+ ***************************************************************************************************
+ */
+LDC_Status ToolCommon_ParseRoi(const char* const pRoiArgument, LDC_Roi* roi);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     ToolCommon_ParseColor
+ *
+ * \brief  Helper function used to parse border colour, given as Y,U,V
+ *
+ * \param  [In]  pColorArgument     Command line argument of colour
+ * \param  [Out] color              Parsed colour
+ *
+ * \return LDC_Status    Validation code
+ *
+ ***************************************************************************************************
+ */
+LDC_Status ToolCommon_ParseColor(const char* const pColorArgument, LDC_Color* color);
+
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     ToolCommon_LoadLens
+ *
+ * \brief  Helper function used to load lens specification file, and to fit analytic lens model
+ *         to its table, with print of fit error and coefficients
+ *
+ * \param  [In]  lensSpecFilename    Lens Specifiacation file name
+ * \param  [In]  lensModel           Lens function, LENS_MODEL_TABLE for table of file
+ * \param  [Out] lens                Loaded lens profile
+ *
+ * \return LDC_Status    Validation code
+ *
+ ***************************************************************************************************
+ */
+LDC_Status ToolCommon_LoadLens(const char* const lensSpecFilename, LensModel_Type lensModel,
+                               const LensProfile** lens);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     ToolCommon_VerifyMap
+ *
+ * \brief  Helper function used to compare fast map with reference map, and print max error
+ *
+ * \param  [In] lens                 Lens profile
+ * \param  [In] width                Width of the input frame
+ * \param  [In] height               Height of the input frame
+ * \param  [In] output               Output frame specification
+ * \param  [In] rois                 Regions of interest, or NULL for whole frame
+ * \param  [In] num_of_rois          Number of regions of interest
+ *
+ * \return LDC_Status    Error when maps differ more than FAST_MAP_MAX_COORDINATE_ERROR
+ *
+ ***************************************************************************************************
+ */
+LDC_Status ToolCommon_VerifyMap(const LensProfile* const lens, uint32_t width,
+                                uint32_t height, const LDC_OutputSpec* const output,
+                                const LDC_Roi* const rois, uint32_t num_of_rois);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     ToolCommon_CorrectWithDaemon
+ *
+ * \brief  Helper function used to correct frame by ldc_daemon, with frames in shared memory
+ *
+ * \param  [In]  socketPath         Path of daemon socket
+ * \param  [In]  request            Request parameters
+ * \param  [In]  YUV_in             Input frame
+ * \param  [In]  img_size           Size of input frame
+ * \param  [In]  out_img_size       Size of output frame
+ * \param  [Out] YUV_out            Output frame, allocated by function
+ *
+ * \return LDC_Status    Validation code
+ *
+ ***************************************************************************************************
+ */
+LDC_Status ToolCommon_CorrectWithDaemon(const char* const socketPath,
+                                        const LdcDaemon_Request* const request,
+                                        const uint8_t* const YUV_in, size_t img_size,
+                                        size_t out_img_size, uint8_t** YUV_out);
+
+/**
+ ***************************************************************************************************
+ *
+ * \fn     ToolCommon_SelfCheck
+ *
+ * \brief  Helper function used to check optimised paths against reference behaviour, on
+ *         synthetic lens table and frames. Fast, parallel and swept maps are compared with
+ *         reference map, remap kernels and frame split/combine are compared for every format,
+ *         outputs are compared with golden checksums, and remap time is compared with baseline.
+ *
+ * \param  [In] baselineFilename     File with baseline remap time, or NULL. Baseline is recorded
+ *                                   when file does not exist.
+ * \param  [In] threshold            Allowed slowdown against baseline, in percents
+ *
+ * \return LDC_Status    Error when any check fails
+ *
+ ***************************************************************************************************
+ */
+LDC_Status ToolCommon_SelfCheck(const char* const baselineFilename, double threshold);
 
 /**
  ***************************************************************************************************
@@ -183,6 +429,6 @@ LDC_Status ToolCommon_ValidateDimensions(uint32_t pFrameWidth, uint32_t pFrameHe
 void ToolCommon_PrintCorrectionInformation(const char* const inputFilename,
                                            const char* const outputFilename,
                                            const char* const lensSPecFilename,
-                                           uint32_t img_size, uint32_t width,
+                                           size_t img_size, uint32_t width,
                                            uint32_t height, YUV_Type yuv_type);
 #endif
@@ -27,8 +27,9 @@
 /* ============================================================================================== */
 
 void ToolMain_MemoryFree(uint8_t* YUV_in, uint8_t* YUV_out, uint8_t* Y_in,
-                         uint8_t* U_in, uint8_t* V_in)
+                         uint8_t* U_in, uint8_t* V_in, const LensProfile* lens)
 {
+    LensProfile_Release(lens);
     free(YUV_out);
     free(Y_in);
     free(U_in);
@@ -48,12 +49,30 @@ int32_t main(int32_t argc, char** argv)
     char* inputFileName              = NULL;
     char* outputFileName             = NULL;
     char* inputLensFileParameters    = NULL;
+    char* maskFileName               = NULL;
+    char* baselineFileName           = NULL;
+    char* daemonSocket               = NULL;
 
     uint32_t argIteratorCounter         = 1;
     uint32_t frameFormat                = 0;
     uint32_t frameWidth                 = 0;
     uint32_t frameHeight                = 0;
-    uint32_t img_size;
+    uint32_t outputFrameWidth           = 0;
+    uint32_t outputFrameHeight          = 0;
+    size_t outputImgSize;
+    size_t img_size;
+    uint32_t numOfRois                  = 0;
+    uint32_t verifyMap                  = 0;
+    uint32_t selfCheck                  = 0;
+    uint32_t lensId                     = 0;
+    uint32_t stripRows                  = 0;
+    double perfThreshold                = TOOL_PERF_DEFAULT_THRESHOLD;
+    LDC_Roi rois[TOOL_MAX_NUM_OF_ROIS];
+    LDC_Color border                    = {0, 128, 128};
+    LDC_OutputSpec output               = {0, 0, 0.0, 0.0, 0.0, 0};
+    LDC_Interpolation interpolation     = LDC_INTERPOLATION_NEAREST;
+    LensModel_Type lensModel            = LENS_MODEL_TABLE;
+    const LensProfile* lens             = NULL;
     YUV_Type yuv_type;
 
     /* YUV format declaration! */
@@ -62,8 +81,12 @@ int32_t main(int32_t argc, char** argv)
     uint8_t* Y_in       = NULL;
     uint8_t* U_in       = NULL;
     uint8_t* V_in       = NULL;
+    uint8_t* mask       = NULL;
 
 
+    /* Library reports its errors through callback. */
+    LdcLog_SetCallback(ToolCommon_PrintLogMessage, NULL);
+
     /* Minimum must be exe file and --help option. */
     if (argc < 2)
     {
@@ -157,6 +180,207 @@ int32_t main(int32_t argc, char** argv)
                 return EXIT_FAILURE;
             }
         }
+        else if (0 == strcmp(argv[argIteratorCounter], "-W"))
+        {
+            if (argIteratorCounter + 1 < argc)
+            {
+                outputFrameWidth = atoi(argv[argIteratorCounter + 1]);
+                argIteratorCounter++;
+            }
+            else
+            {
+                printf(INVALID_WIDTH_PARAM_MESSGE);
+                return EXIT_FAILURE;
+            }
+        }
+        else if (0 == strcmp(argv[argIteratorCounter], "-H"))
+        {
+            if (argIteratorCounter + 1 < argc)
+            {
+                outputFrameHeight = atoi(argv[argIteratorCounter + 1]);
+                argIteratorCounter++;
+            }
+            else
+            {
+                printf(INVALID_HEIGHT_PARAM_MESSGE);
+                return EXIT_FAILURE;
+            }
+        }
+        else if (0 == strcmp(argv[argIteratorCounter], "-s"))
+        {
+            if (argIteratorCounter + 1 < argc && atof(argv[argIteratorCounter + 1]) > 0.0)
+            {
+                output.scale = atof(argv[argIteratorCounter + 1]);
+                argIteratorCounter++;
+            }
+            else
+            {
+                printf(INVALID_SCALE_MESSAGE);
+                return EXIT_FAILURE;
+            }
+        }
+        else if (0 == strcmp(argv[argIteratorCounter], "-c"))
+        {
+            if (argIteratorCounter + 1 < argc &&
+                2 == sscanf(argv[argIteratorCounter + 1], "%lf,%lf",
+                            &output.centre_x, &output.centre_y))
+            {
+                output.use_centre = 1;
+                argIteratorCounter++;
+            }
+            else
+            {
+                printf(INVALID_CENTRE_MESSAGE);
+                return EXIT_FAILURE;
+            }
+        }
+        else if (0 == strcmp(argv[argIteratorCounter], "-r"))
+        {
+            if (numOfRois >= TOOL_MAX_NUM_OF_ROIS)
+            {
+                printf(TOO_MANY_ROIS_MESSAGE);
+                return EXIT_FAILURE;
+            }
+            else if (argIteratorCounter + 1 < argc &&
+                     !ToolCommon_ParseRoi(argv[argIteratorCounter + 1], &rois[numOfRois]))
+            {
+                numOfRois++;
+                argIteratorCounter++;
+            }
+            else
+            {
+                printf(INVALID_ROI_MESSAGE);
+                return EXIT_FAILURE;
+            }
+        }
+        else if (0 == strcmp(argv[argIteratorCounter], "-b"))
+        {
+            if (argIteratorCounter + 1 < argc &&
+                !ToolCommon_ParseColor(argv[argIteratorCounter + 1], &border))
+            {
+                argIteratorCounter++;
+            }
+            else
+            {
+                printf(INVALID_BORDER_COLOR_MESSAGE);
+                return EXIT_FAILURE;
+            }
+        }
+        else if (0 == strcmp(argv[argIteratorCounter], "-v"))
+        {
+            verifyMap = 1;
+        }
+        else if (0 == strcmp(argv[argIteratorCounter], "-n"))
+        {
+            if (argIteratorCounter + 1 < argc &&
+                (0 == strcmp(argv[argIteratorCounter + 1], "0") ||
+                 0 == strcmp(argv[argIteratorCounter + 1], "1")))
+            {
+                interpolation = (LDC_Interpolation)atoi(argv[argIteratorCounter + 1]);
+                argIteratorCounter++;
+            }
+            else
+            {
+                printf(INVALID_INTERPOLATION_MESSAGE);
+                return EXIT_FAILURE;
+            }
+        }
+        else if (0 == strcmp(argv[argIteratorCounter], "-l"))
+        {
+            if (argIteratorCounter + 1 < argc && 1 == strlen(argv[argIteratorCounter + 1]) &&
+                argv[argIteratorCounter + 1][0] >= '0' && argv[argIteratorCounter + 1][0] <= '4')
+            {
+                lensModel = (LensModel_Type)atoi(argv[argIteratorCounter + 1]);
+                argIteratorCounter++;
+            }
+            else
+            {
+                printf(INVALID_LENS_MODEL_MESSAGE);
+                return EXIT_FAILURE;
+            }
+        }
+        else if (0 == strcmp(argv[argIteratorCounter], "-d"))
+        {
+            if (argIteratorCounter + 1 < argc)
+            {
+                daemonSocket = argv[argIteratorCounter + 1];
+                argIteratorCounter++;
+            }
+            else
+            {
+                printf(INVALID_FILE_NAME_MESSAGE);
+                return EXIT_FAILURE;
+            }
+        }
+        else if (0 == strcmp(argv[argIteratorCounter], "-L"))
+        {
+            if (argIteratorCounter + 1 < argc)
+            {
+                lensId = atoi(argv[argIteratorCounter + 1]);
+                argIteratorCounter++;
+            }
+            else
+            {
+                printf(INVALID_ARGUMENTS_MESSAGE);
+                return EXIT_FAILURE;
+            }
+        }
+        else if (0 == strcmp(argv[argIteratorCounter], "-S"))
+        {
+            if (argIteratorCounter + 1 < argc && atoi(argv[argIteratorCounter + 1]) > 0)
+            {
+                stripRows = atoi(argv[argIteratorCounter + 1]);
+                argIteratorCounter++;
+            }
+            else
+            {
+                printf(INVALID_STRIP_ROWS_MESSAGE);
+                return EXIT_FAILURE;
+            }
+        }
+        else if (0 == strcmp(argv[argIteratorCounter], "--self-check"))
+        {
+            selfCheck = 1;
+        }
+        else if (0 == strcmp(argv[argIteratorCounter], "--baseline"))
+        {
+            if (argIteratorCounter + 1 < argc)
+            {
+                baselineFileName = argv[argIteratorCounter + 1];
+                argIteratorCounter++;
+            }
+            else
+            {
+                printf(INVALID_FILE_NAME_MESSAGE);
+                return EXIT_FAILURE;
+            }
+        }
+        else if (0 == strcmp(argv[argIteratorCounter], "--threshold"))
+        {
+            if (argIteratorCounter + 1 < argc && atof(argv[argIteratorCounter + 1]) >= 0.0)
+            {
+                perfThreshold = atof(argv[argIteratorCounter + 1]);
+                argIteratorCounter++;
+            }
+            else
+            {
+                printf(INVALID_THRESHOLD_MESSAGE);
+                return EXIT_FAILURE;
+            }
+        }
+        else if (0 == strcmp(argv[argIteratorCounter], "-m"))
+        {
+            if (argIteratorCounter + 1 < argc)
+            {
+                maskFileName = argv[argIteratorCounter + 1];
+                argIteratorCounter++;
+            }
+            else
+            {
+                printf(INVALID_FILE_NAME_MESSAGE);
+                return EXIT_FAILURE;
+            }
+        }
         else
         {
             printf(INVALID_ARGUMENTS_MESSAGE);
@@ -167,6 +391,18 @@ int32_t main(int32_t argc, char** argv)
     }
 
 
+    /* Self check does not need input files. */
+    if (selfCheck)
+    {
+        if (ToolCommon_SelfCheck(baselineFileName, perfThreshold))
+        {
+            printf(SELF_CHECK_ERROR_MESSAGE);
+            return EXIT_FAILURE;
+        }
+
+        return EXIT_SUCCESS;
+    }
+
     /* Validating image dimensions. */
     if (ToolCommon_ValidateDimensions(frameWidth, frameHeight))
     {
@@ -174,8 +410,14 @@ int32_t main(int32_t argc, char** argv)
         return EXIT_FAILURE;
     }
 
-    /* Validate input/output image filename, and Lens parameters filename. */
-    if (ToolCommon_ValidateFileNames(inputFileName, outputFileName, inputLensFileParameters))
+    /* Output frame has input dimensions, unless they are given. */
+    output.width = (0U == outputFrameWidth) ? frameWidth : outputFrameWidth;
+    output.height = (0U == outputFrameHeight) ? frameHeight : outputFrameHeight;
+
+    /* Validate input/output image filename, and Lens parameters filename. Lens of daemon is
+       loaded by daemon, so only extension of placeholder is checked. */
+    if (ToolCommon_ValidateFileNames(inputFileName, outputFileName,
+                                     (NULL == daemonSocket) ? inputLensFileParameters : ".csv"))
     {
         printf(INVALID_FILE_NAME_MESSAGE);
         return EXIT_FAILURE;
@@ -188,10 +430,106 @@ int32_t main(int32_t argc, char** argv)
         return EXIT_FAILURE;
     }
 
+    /* Input and output frames have to be multiples of chroma subsampling of format. */
+    if (YuvFormat_ValidateSize(YuvFormat_Get(yuv_type), frameWidth, frameHeight) ||
+        YuvFormat_ValidateSize(YuvFormat_Get(yuv_type), output.width, output.height))
+    {
+        printf(INVALID_DIMENSION_MESSAGE);
+        return EXIT_FAILURE;
+    }
+
+    /* Correction by daemon, with its warm map. */
+    if (NULL != daemonSocket)
+    {
+        LdcDaemon_Request request;
+        int32_t result = EXIT_FAILURE;
+
+        memset(&request, 0, sizeof(request));
+        request.lens_id = lensId;
+        request.yuv_type = (uint32_t)yuv_type;
+        request.width = frameWidth;
+        request.height = frameHeight;
+        request.out_width = output.width;
+        request.out_height = output.height;
+        request.scale = output.scale;
+        request.centre_x = output.centre_x;
+        request.centre_y = output.centre_y;
+        request.use_centre = output.use_centre;
+        request.interpolation = (uint32_t)interpolation;
+        request.border_y = border.y;
+        request.border_u = border.u;
+        request.border_v = border.v;
+        request.use_border = 1U;
+
+        outputImgSize = ComponentsStructure_GetFrameSize(output.width, output.height, yuv_type);
+
+        if (FileOperation_ReadRawYUV(inputFileName, &YUV_in, frameWidth, frameHeight,
+                                     &img_size, yuv_type))
+        {
+            return EXIT_FAILURE;
+        }
+
+        if (ToolCommon_CorrectWithDaemon(daemonSocket, &request, YUV_in, img_size,
+                                         outputImgSize, &YUV_out))
+        {
+            printf(DAEMON_ERROR_MESSAGE);
+        }
+        else if (!FileOperation_SaveRawYUV(outputFileName, YUV_out, outputImgSize,
+                                           output.width, output.height))
+        {
+            result = EXIT_SUCCESS;
+        }
+
+        ToolMain_MemoryFree(YUV_in, YUV_out, NULL, NULL, NULL, NULL);
+
+        return result;
+    }
+
+    /* Lens specification is read once, and lens model is fitted to it. */
+    if (ToolCommon_LoadLens(inputLensFileParameters, lensModel, &lens))
+    {
+        printf(LENS_LOADING_ERROR_MESSAGE);
+        return EXIT_FAILURE;
+    }
+
+    /* Compare fast map with reference map. */
+    if (verifyMap && ToolCommon_VerifyMap(lens, frameWidth, frameHeight,
+                                          &output, (numOfRois > 0) ? rois : NULL, numOfRois))
+    {
+        LensProfile_Release(lens);
+        printf(MAP_VERIFICATION_ERROR_MESSAGE);
+        return EXIT_FAILURE;
+    }
+
+    /* Strip mode reads only source rows of every output strip, never whole frame. */
+    if(0U != stripRows)
+    {
+        if(StripCorrection_CorrectFile(inputFileName, outputFileName, maskFileName,
+                                       frameWidth, frameHeight, yuv_type, lens, &output,
+                                       (numOfRois > 0) ? rois : NULL, numOfRois, &border,
+                                       interpolation, stripRows, NULL, NULL))
+        {
+            LensProfile_Release(lens);
+            printf(CORRECTION_DISTORTION_ERROR_MESSAGE);
+            return EXIT_FAILURE;
+        }
+
+        ToolCommon_PrintCorrectionInformation(inputFileName, outputFileName,
+                                              inputLensFileParameters,
+                                              ComponentsStructure_GetFrameSize(frameWidth,
+                                                                               frameHeight,
+                                                                               yuv_type),
+                                              frameWidth, frameHeight, yuv_type);
+        LensProfile_Release(lens);
+
+        return EXIT_SUCCESS;
+    }
+
     /* Read input YUV image data. */
     if(FileOperation_ReadRawYUV(inputFileName, &YUV_in, frameWidth, frameHeight,
                                 &img_size, yuv_type))
     {
+        LensProfile_Release(lens);
         return EXIT_FAILURE;
     }
 
@@ -200,25 +538,57 @@ int32_t main(int32_t argc, char** argv)
     if(ComponentsStructure_SplitYUV2Component(YUV_in, &Y_in, &U_in, &V_in, frameWidth,
                                               frameHeight, img_size, yuv_type))
     {
-        ToolMain_MemoryFree(YUV_in, YUV_out, Y_in, U_in, V_in);
+        ToolMain_MemoryFree(YUV_in, YUV_out, Y_in, U_in, V_in, lens);
         printf(SPLIT_YUV_COMPONENTS_ERROR_MESSAGE);
         return EXIT_FAILURE;
     }
 
+    /* Validity mask of output frame, when requested. */
+    if(NULL != maskFileName)
+    {
+        mask = malloc((size_t)output.height * VALIDITY_MASK_STRIDE(output.width));
+        if (NULL == mask)
+        {
+            ToolMain_MemoryFree(YUV_in, YUV_out, Y_in, U_in, V_in, lens);
+            printf(MASK_ALLOCATION_ERROR_MESSAGE);
+            return EXIT_FAILURE;
+        }
+    }
+
     /* Correction of image distortion. */
     if(FrameCorrection_CorrectLensDistortion(&YUV_out, Y_in, U_in, V_in, img_size,
                                              frameWidth, frameHeight, yuv_type,
-                                             inputLensFileParameters))
+                                             lens, &output,
+                                             (numOfRois > 0) ? rois : NULL, numOfRois,
+                                             &border, interpolation, mask))
     {
-        ToolMain_MemoryFree(YUV_in, YUV_out, Y_in, U_in, V_in);
+        ToolMain_MemoryFree(YUV_in, YUV_out, Y_in, U_in, V_in, lens);
+        free(mask);
         printf(CORRECTION_DISTORTION_ERROR_MESSAGE);
         return EXIT_FAILURE;
     }
 
+    /* Save validity mask. */
+    if(NULL != mask)
+    {
+        if(FileOperation_SaveRawYUV(maskFileName, mask,
+                                    (size_t)output.height * VALIDITY_MASK_STRIDE(output.width),
+                                    output.width, output.height))
+        {
+            ToolMain_MemoryFree(YUV_in, YUV_out, Y_in, U_in, V_in, lens);
+            free(mask);
+            return EXIT_FAILURE;
+        }
+
+        free(mask);
+    }
+
     /* Save YUV output data. */
-    if(FileOperation_SaveRawYUV(outputFileName, YUV_out, img_size, frameWidth, frameHeight))
+    outputImgSize = ComponentsStructure_GetFrameSize(output.width, output.height, yuv_type);
+    if(FileOperation_SaveRawYUV(outputFileName, YUV_out, outputImgSize,
+                                output.width, output.height))
     {
-        ToolMain_MemoryFree(YUV_in, YUV_out, Y_in, U_in, V_in);
+        ToolMain_MemoryFree(YUV_in, YUV_out, Y_in, U_in, V_in, lens);
         return EXIT_FAILURE;
     }
 
@@ -227,7 +597,7 @@ int32_t main(int32_t argc, char** argv)
                                           img_size, frameWidth, frameHeight, yuv_type);
 
     /* Free allocated memory. */
-    ToolMain_MemoryFree(YUV_in, YUV_out, Y_in, U_in, V_in);
+    ToolMain_MemoryFree(YUV_in, YUV_out, Y_in, U_in, V_in, lens);
 
     return EXIT_SUCCESS;
 }